@@ -0,0 +1,199 @@
+//
+// Created by TinaFlow Team
+//
+
+// 读取性能基准：生成一个约100万个单元格的工作簿，比较逐单元格读取和各批量读取路径的耗时，
+// 并检查各路径读出的数据完全一致。
+//
+// 用法：ReadRangeBenchmark [行数] [重复次数]
+//   行数默认100000（10列，共100万个单元格），重复次数默认3，每项取最短耗时。
+
+#include "SheetReader.hpp"
+#include "SheetValueCache.hpp"
+#include "StreamingSheetReader.hpp"
+#include "data/RangeData.hpp"
+#include "data/StringPool.hpp"
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QTemporaryDir>
+#include <QVariant>
+#include <XLCellReference.hpp>
+#include <XLDocument.hpp>
+#include <XLRow.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int ColumnCount = 10;
+constexpr const char* SheetName = "Data";
+
+// 每列一种典型内容：整数、浮点数、少量重复的分类文本、各不相同的文本、布尔值，部分单元格为空
+void generateWorkbook(const std::string& path, int rowCount)
+{
+    static const char* categories[] = {"北京", "上海", "广州", "深圳", "杭州", "成都", "武汉", "西安"};
+
+    OpenXLSX::XLDocument document;
+    document.create(path, OpenXLSX::XLForceOverwrite);
+    auto worksheet = document.workbook().worksheet("Sheet1");
+    worksheet.setName(SheetName);
+
+    std::vector<OpenXLSX::XLCellValue> values(ColumnCount);
+    for (int row = 1; row <= rowCount; ++row) {
+        values[0] = int64_t(row);
+        values[1] = row * 0.25;
+        values[2] = std::string(categories[row % 8]);
+        values[3] = "item-" + std::to_string(row);
+        values[4] = row % 3 == 0;
+        values[5] = int64_t(row) * 7 % 1000;
+        values[6] = row % 5 == 0 ? OpenXLSX::XLCellValue() : OpenXLSX::XLCellValue(row / 3.0);
+        values[7] = std::string(row % 2 ? "已完成" : "处理中");
+        values[8] = row % 7 == 0 ? OpenXLSX::XLCellValue() : OpenXLSX::XLCellValue(int64_t(row) * 31);
+        values[9] = -row * 1.5;
+        worksheet.row(static_cast<uint32_t>(row)).values() = values;
+    }
+    document.save();
+    document.close();
+}
+
+// 改为按行迭代之前ReadRangeModel的读取方式：每个单元格单独查找，并多次解码类型
+std::vector<std::vector<QVariant>> readPerCell(const OpenXLSX::XLWorksheet& worksheet, int rowCount)
+{
+    std::vector<std::vector<QVariant>> data;
+    data.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        std::vector<QVariant> rowData;
+        rowData.reserve(ColumnCount);
+        for (int col = 0; col < ColumnCount; ++col) {
+            auto cell = worksheet.cell(OpenXLSX::XLCellReference(row + 1, col + 1));
+            QVariant cellValue;
+            if (cell.value().type() == OpenXLSX::XLValueType::Empty) {
+                cellValue = QVariant();
+            } else if (cell.value().type() == OpenXLSX::XLValueType::Boolean) {
+                cellValue = cell.value().get<bool>();
+            } else if (cell.value().type() == OpenXLSX::XLValueType::Integer) {
+                cellValue = static_cast<qint64>(cell.value().get<int64_t>());
+            } else if (cell.value().type() == OpenXLSX::XLValueType::Float) {
+                cellValue = cell.value().get<double>();
+            } else if (cell.value().type() == OpenXLSX::XLValueType::String) {
+                cellValue = QString::fromUtf8(cell.value().get<std::string>().c_str());
+            } else {
+                cellValue = QString("(未知类型)");
+            }
+            rowData.push_back(cellValue);
+        }
+        data.push_back(std::move(rowData));
+    }
+    return data;
+}
+
+// 重复执行，返回最短耗时（毫秒）
+double bestOf(int repeat, const std::function<void()>& run)
+{
+    double best = 0.0;
+    for (int i = 0; i < repeat; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        run();
+        const double elapsed = timer.nsecsElapsed() / 1e6;
+        best = i == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+bool sameData(const RangeData& actual, const std::vector<std::vector<QVariant>>& expected)
+{
+    if (actual.rowCount() != static_cast<int>(expected.size()) || actual.columnCount() != ColumnCount) {
+        return false;
+    }
+    for (int row = 0; row < actual.rowCount(); ++row) {
+        for (int col = 0; col < ColumnCount; ++col) {
+            if (actual.cellValue(row, col) != expected[row][col]) {
+                std::fprintf(stderr, "mismatch at row %d, column %d\n", row + 1, col + 1);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int rowCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100000;
+    const int repeat = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        std::fprintf(stderr, "cannot create temporary directory\n");
+        return 1;
+    }
+    const QString filePath = directory.filePath("benchmark.xlsx");
+    const QString rangeAddress = QString("A1:J%1").arg(rowCount);
+    const OpenXLSX::XLCellReference topLeft(1, 1);
+    const OpenXLSX::XLCellReference bottomRight(rowCount, ColumnCount);
+
+    QElapsedTimer timer;
+    timer.start();
+    generateWorkbook(filePath.toStdString(), rowCount);
+    std::printf("generated %d x %d cells in %.0f ms\n", rowCount, ColumnCount, timer.nsecsElapsed() / 1e6);
+
+    // 逐单元格读取会在DOM中创建缺失的单元格，使用单独的文档
+    std::vector<std::vector<QVariant>> expected;
+    double perCell = 0.0;
+    {
+        OpenXLSX::XLDocument document;
+        document.open(filePath.toStdString());
+        const auto worksheet = document.workbook().worksheet(SheetName);
+        perCell = bestOf(repeat, [&]() { expected = readPerCell(worksheet, rowCount); });
+        document.close();
+    }
+
+    OpenXLSX::XLDocument document;
+    document.open(filePath.toStdString());
+    const auto worksheet = document.workbook().worksheet(SheetName);
+
+    std::shared_ptr<RangeData> rowIterator;
+    const double rowIteratorTime = bestOf(repeat, [&]() {
+        auto pool = std::make_shared<StringPool>();
+        rowIterator = std::make_shared<RangeData>(rangeAddress,
+            SheetReader::readRange(worksheet, topLeft, bottomRight, pool.get()), pool);
+    });
+
+    std::shared_ptr<const SheetValueCache> values;
+    const double decodeTime = bestOf(repeat, [&]() {
+        values = SheetValueCache::fromWorksheet(worksheet, std::make_shared<StringPool>());
+    });
+    std::shared_ptr<RangeData> cached;
+    const double cachedTime = bestOf(repeat, [&]() {
+        cached = values->readRange(CellRange{{1, 1}, {static_cast<uint32_t>(rowCount), ColumnCount}}, rangeAddress);
+    });
+
+    std::shared_ptr<RangeData> streamed;
+    const double streamingTime = bestOf(repeat, [&]() {
+        StreamingSheetReader reader(filePath);
+        streamed = reader.readRange(SheetName, rangeAddress);
+    });
+    document.close();
+
+    const bool ok = sameData(*rowIterator, expected) && sameData(*cached, expected) && sameData(*streamed, expected);
+
+    const auto report = [perCell](const char* name, double ms) {
+        std::printf("%-44s %10.1f ms %8.1fx\n", name, ms, perCell / ms);
+    };
+    std::printf("\nbest of %d run(s), speedup relative to per-cell lookup\n", repeat);
+    report("per-cell lookup (before)", perCell);
+    report("SheetReader::readRange (row iterator)", rowIteratorTime);
+    report("SheetValueCache::fromWorksheet (decode)", decodeTime);
+    report("SheetValueCache::readRange (decoded)", cachedTime);
+    report("StreamingSheetReader::readRange (file)", streamingTime);
+    std::printf("\nresults %s\n", ok ? "identical" : "DIFFER");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,531 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief 单元格在工作表中的位置（行列号从1开始）
+ */
+struct CellPosition
+{
+    uint32_t row = 0;
+    uint16_t column = 0;
+
+    constexpr bool isValid() const { return row > 0 && column > 0; }
+    constexpr bool operator==(const CellPosition&) const = default;
+};
+
+/**
+ * @brief 矩形单元格范围，包含两端
+ */
+struct CellRange
+{
+    CellPosition topLeft;
+    CellPosition bottomRight;
+
+    constexpr uint32_t rowCount() const { return bottomRight.row - topLeft.row + 1; }
+    constexpr uint32_t columnCount() const { return bottomRight.column - topLeft.column + 1u; }
+
+    constexpr bool contains(const CellPosition& cell) const
+    {
+        return cell.row >= topLeft.row && cell.row <= bottomRight.row
+            && cell.column >= topLeft.column && cell.column <= bottomRight.column;
+    }
+
+    constexpr bool contains(const CellRange& other) const
+    {
+        return contains(other.topLeft) && contains(other.bottomRight);
+    }
+
+    constexpr bool operator==(const CellRange&) const = default;
+};
+
+namespace CellReferenceDetail {
+
+/// 一到两个字母的列名（A..ZZ，共702列）
+struct ColumnLetters
+{
+    char text[2];
+    uint8_t size;
+};
+
+constexpr std::array<ColumnLetters, 703> makeColumnTable()
+{
+    std::array<ColumnLetters, 703> table{};
+    for (int column = 1; column <= 26; ++column) {
+        table[column] = {{static_cast<char>('A' + column - 1), 0}, 1};
+    }
+    for (int column = 27; column <= 702; ++column) {
+        const int index = column - 27;
+        table[column] = {{static_cast<char>('A' + index / 26), static_cast<char>('A' + index % 26)}, 2};
+    }
+    return table;
+}
+
+inline constexpr auto ColumnTable = makeColumnTable();
+
+} // namespace CellReferenceDetail
+
+/**
+ * @brief A1/R1C1单元格引用的解析与格式化
+ *
+ * 所有函数都不分配堆内存，可以在编译期求值：
+ * - 解析直接扫描字符，支持char（XML、std::string）和char16_t（QString）输入
+ * - A1引用允许$绝对引用标记，列字母不区分大小写，行号不能有前导零
+ * - 列号到列名通过编译期生成的表查找，三个字母的列名由表中的两个字母加前缀得到
+ * - 格式化结果写入固定容量的Text，需要时再转换为QString或std::string
+ */
+class CellReference
+{
+public:
+    static constexpr uint32_t MaxRows = 1048576;    ///< Excel最大行数
+    static constexpr uint16_t MaxColumns = 16384;   ///< Excel最大列数（XFD列）
+
+    /**
+     * @brief 解析错误
+     */
+    enum class Error : uint8_t
+    {
+        None,
+        Empty,              ///< 输入为空
+        Syntax,             ///< 格式不正确
+        ColumnOutOfRange,   ///< 列超出XFD
+        RowOutOfRange,      ///< 行超出1048576
+        Order               ///< 范围的起始单元格不在结束单元格左上方
+    };
+
+    /**
+     * @brief 引用格式
+     */
+    enum class Notation : uint8_t
+    {
+        A1,
+        R1C1
+    };
+
+    /**
+     * @brief 解析结果
+     */
+    template<typename T>
+    struct Parsed
+    {
+        T value{};
+        Error error = Error::Syntax;
+
+        constexpr explicit operator bool() const { return error == Error::None; }
+        constexpr const T& operator*() const { return value; }
+        constexpr const T* operator->() const { return &value; }
+    };
+
+    /**
+     * @brief 固定容量的引用文本
+     */
+    class Text
+    {
+    public:
+        /// 最长的引用为"R1048576C16384:R1048576C16384"
+        static constexpr size_t Capacity = 32;
+
+        constexpr std::string_view view() const { return {m_data.data(), m_size}; }
+        constexpr size_t size() const { return m_size; }
+        constexpr bool isEmpty() const { return m_size == 0; }
+
+        QString toQString() const { return QString::fromLatin1(m_data.data(), static_cast<qsizetype>(m_size)); }
+        std::string toStdString() const { return std::string(view()); }
+
+        constexpr void append(char ch) { m_data[m_size++] = ch; }
+
+        constexpr void append(std::string_view text)
+        {
+            for (char ch : text) {
+                append(ch);
+            }
+        }
+
+        constexpr void appendNumber(int64_t number)
+        {
+            if (number < 0) {
+                append('-');
+                number = -number;
+            }
+            char digits[20] = {};
+            int count = 0;
+            do {
+                digits[count++] = static_cast<char>('0' + number % 10);
+                number /= 10;
+            } while (number > 0);
+            while (count > 0) {
+                append(digits[--count]);
+            }
+        }
+
+    private:
+        std::array<char, Capacity> m_data{};
+        size_t m_size = 0;
+    };
+
+    // ===== 列号与列名 =====
+
+    /**
+     * @brief 列号转列名，1 -> "A"，28 -> "AB"，超出范围时返回空文本
+     */
+    static constexpr Text columnName(uint32_t column)
+    {
+        Text text;
+        if (column == 0 || column > MaxColumns) {
+            return text;
+        }
+        if (column > 702) {
+            // 三个字母：首字母每676列变化一次，后两个字母按AA..ZZ循环
+            const uint32_t index = column - 703;
+            text.append(static_cast<char>('A' + index / 676));
+            column = 27 + index % 676;
+        }
+        const auto& letters = CellReferenceDetail::ColumnTable[column];
+        text.append(std::string_view(letters.text, letters.size));
+        return text;
+    }
+
+    /**
+     * @brief 列名转列号，"AB" -> 28
+     * @return 列号，不是有效列名或超出范围时返回0
+     */
+    template<typename Char>
+    static constexpr uint16_t columnNumber(const Char* p, const Char* end)
+    {
+        uint32_t column = 0;
+        if (p == end || end - p > 3) {
+            return 0;
+        }
+        for (; p < end; ++p) {
+            const uint32_t letter = letterValue(*p);
+            if (letter == 0) {
+                return 0;
+            }
+            column = column * 26 + letter;
+        }
+        return column <= MaxColumns ? static_cast<uint16_t>(column) : 0;
+    }
+
+    static constexpr uint16_t columnNumber(std::string_view letters)
+    {
+        return columnNumber(letters.data(), letters.data() + letters.size());
+    }
+
+    static uint16_t columnNumber(QStringView letters)
+    {
+        return columnNumber(letters.utf16(), letters.utf16() + letters.size());
+    }
+
+    /**
+     * @brief 单元格引用开头的列号，如"AB12" -> 28，不校验行号
+     *
+     * 用于读取工作表XML中已知合法的r属性。
+     */
+    static constexpr uint16_t leadingColumn(std::string_view reference)
+    {
+        size_t letters = 0;
+        while (letters < reference.size() && letterValue(reference[letters]) != 0) {
+            ++letters;
+        }
+        return columnNumber(reference.substr(0, letters));
+    }
+
+    // ===== 解析 =====
+
+    /**
+     * @brief 解析A1引用，如"B5"、"$AA$100"
+     */
+    template<typename Char>
+    static constexpr Parsed<CellPosition> parseA1(const Char* p, const Char* end)
+    {
+        Parsed<CellPosition> result;
+        trim(p, end);
+        if (p == end) {
+            result.error = Error::Empty;
+            return result;
+        }
+
+        if (*p == '$') {
+            ++p;
+        }
+        const Char* lettersBegin = p;
+        while (p < end && letterValue(*p) != 0) {
+            ++p;
+        }
+        const auto letterCount = p - lettersBegin;
+        if (letterCount == 0) {
+            return result;
+        }
+
+        if (p < end && *p == '$') {
+            ++p;
+        }
+        // 行号必须以1-9开头
+        if (p == end || *p < '1' || *p > '9') {
+            return result;
+        }
+        uint32_t row = 0;
+        bool rowOverflow = false;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            if (row > MaxRows) {
+                rowOverflow = true;
+            } else {
+                row = row * 10 + static_cast<uint32_t>(*p - '0');
+            }
+        }
+        if (p != end) {
+            return result;
+        }
+
+        const uint16_t column = columnNumber(lettersBegin, lettersBegin + letterCount);
+        if (column == 0) {
+            result.error = Error::ColumnOutOfRange;
+            return result;
+        }
+        if (rowOverflow || row > MaxRows) {
+            result.error = Error::RowOutOfRange;
+            return result;
+        }
+
+        result.value = {row, column};
+        result.error = Error::None;
+        return result;
+    }
+
+    static constexpr Parsed<CellPosition> parseA1(std::string_view text)
+    {
+        return parseA1(text.data(), text.data() + text.size());
+    }
+
+    static Parsed<CellPosition> parseA1(QStringView text)
+    {
+        return parseA1(text.utf16(), text.utf16() + text.size());
+    }
+
+    /**
+     * @brief 解析R1C1引用，如"R5C3"，或相对于base的"R[-1]C[2]"、"RC[1]"
+     */
+    template<typename Char>
+    static constexpr Parsed<CellPosition> parseR1C1(const Char* p, const Char* end, CellPosition base = {1, 1})
+    {
+        Parsed<CellPosition> result;
+        trim(p, end);
+        if (p == end) {
+            result.error = Error::Empty;
+            return result;
+        }
+
+        int64_t row = 0;
+        int64_t column = 0;
+        if (!parseR1C1Part(p, end, 'R', base.row, row) || !parseR1C1Part(p, end, 'C', base.column, column) || p != end) {
+            return result;
+        }
+        if (column < 1 || column > MaxColumns) {
+            result.error = Error::ColumnOutOfRange;
+            return result;
+        }
+        if (row < 1 || row > MaxRows) {
+            result.error = Error::RowOutOfRange;
+            return result;
+        }
+
+        result.value = {static_cast<uint32_t>(row), static_cast<uint16_t>(column)};
+        result.error = Error::None;
+        return result;
+    }
+
+    static constexpr Parsed<CellPosition> parseR1C1(std::string_view text, CellPosition base = {1, 1})
+    {
+        return parseR1C1(text.data(), text.data() + text.size(), base);
+    }
+
+    static Parsed<CellPosition> parseR1C1(QStringView text, CellPosition base = {1, 1})
+    {
+        return parseR1C1(text.utf16(), text.utf16() + text.size(), base);
+    }
+
+    /**
+     * @brief 解析范围，如"A1:C10"；没有冒号时视为单个单元格的范围
+     */
+    template<typename Char>
+    static constexpr Parsed<CellRange> parseRange(const Char* p, const Char* end,
+                                                  Notation notation = Notation::A1,
+                                                  CellPosition base = {1, 1})
+    {
+        Parsed<CellRange> result;
+        trim(p, end);
+        if (p == end) {
+            result.error = Error::Empty;
+            return result;
+        }
+
+        const Char* colon = p;
+        while (colon < end && *colon != ':') {
+            ++colon;
+        }
+
+        const auto first = parseCell(p, colon, notation, base);
+        if (!first) {
+            result.error = first.error;
+            return result;
+        }
+        auto last = first;
+        if (colon < end) {
+            last = parseCell(colon + 1, end, notation, base);
+            if (!last) {
+                result.error = last.error;
+                return result;
+            }
+        }
+
+        if (first->row > last->row || first->column > last->column) {
+            result.error = Error::Order;
+            return result;
+        }
+
+        result.value = {*first, *last};
+        result.error = Error::None;
+        return result;
+    }
+
+    static constexpr Parsed<CellRange> parseRange(std::string_view text, Notation notation = Notation::A1,
+                                                  CellPosition base = {1, 1})
+    {
+        return parseRange(text.data(), text.data() + text.size(), notation, base);
+    }
+
+    static Parsed<CellRange> parseRange(QStringView text, Notation notation = Notation::A1,
+                                        CellPosition base = {1, 1})
+    {
+        return parseRange(text.utf16(), text.utf16() + text.size(), notation, base);
+    }
+
+    // ===== 格式化 =====
+
+    /**
+     * @brief 格式化为A1引用，如"AB12"
+     */
+    static constexpr Text formatA1(CellPosition cell)
+    {
+        Text text = columnName(cell.column);
+        text.appendNumber(cell.row);
+        return text;
+    }
+
+    /**
+     * @brief 格式化为R1C1引用，如"R12C28"
+     */
+    static constexpr Text formatR1C1(CellPosition cell)
+    {
+        Text text;
+        text.append('R');
+        text.appendNumber(cell.row);
+        text.append('C');
+        text.appendNumber(cell.column);
+        return text;
+    }
+
+    /**
+     * @brief 格式化范围，始终包含冒号，如"A1:C10"
+     */
+    static constexpr Text formatRange(CellRange range, Notation notation = Notation::A1)
+    {
+        Text text = notation == Notation::A1 ? formatA1(range.topLeft) : formatR1C1(range.topLeft);
+        text.append(':');
+        const Text last = notation == Notation::A1 ? formatA1(range.bottomRight) : formatR1C1(range.bottomRight);
+        text.append(last.view());
+        return text;
+    }
+
+    /**
+     * @brief 从左上角和行列数格式化范围
+     */
+    static constexpr Text formatRange(CellPosition topLeft, uint32_t rows, uint32_t columns)
+    {
+        return formatRange(CellRange{topLeft, {topLeft.row + rows - 1, static_cast<uint16_t>(topLeft.column + columns - 1)}});
+    }
+
+private:
+    template<typename Char>
+    static constexpr uint32_t letterValue(Char ch)
+    {
+        if (ch >= 'A' && ch <= 'Z') {
+            return static_cast<uint32_t>(ch - 'A' + 1);
+        }
+        if (ch >= 'a' && ch <= 'z') {
+            return static_cast<uint32_t>(ch - 'a' + 1);
+        }
+        return 0;
+    }
+
+    template<typename Char>
+    static constexpr void trim(const Char*& p, const Char*& end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            ++p;
+        }
+        while (end > p && (end[-1] == ' ' || end[-1] == '\t')) {
+            --end;
+        }
+    }
+
+    template<typename Char>
+    static constexpr Parsed<CellPosition> parseCell(const Char* p, const Char* end, Notation notation, CellPosition base)
+    {
+        return notation == Notation::A1 ? parseA1(p, end) : parseR1C1(p, end, base);
+    }
+
+    // 解析"R5"、"R[-1]"或单独的"R"（与base相同），成功时移动p
+    template<typename Char>
+    static constexpr bool parseR1C1Part(const Char*& p, const Char* end, char prefix, uint32_t base, int64_t& value)
+    {
+        if (p == end || (*p != prefix && *p != prefix + ('a' - 'A'))) {
+            return false;
+        }
+        ++p;
+
+        const bool relative = p < end && *p == '[';
+        if (relative) {
+            ++p;
+        }
+        bool negative = false;
+        if (relative && p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+
+        int64_t number = 0;
+        int digits = 0;
+        for (; p < end && *p >= '0' && *p <= '9' && digits < 8; ++p, ++digits) {
+            number = number * 10 + (*p - '0');
+        }
+        if (p < end && *p >= '0' && *p <= '9') {
+            return false;
+        }
+
+        if (relative) {
+            if (digits == 0 || p == end || *p != ']') {
+                return false;
+            }
+            ++p;
+            value = static_cast<int64_t>(base) + (negative ? -number : number);
+        } else {
+            value = digits == 0 ? static_cast<int64_t>(base) : number;
+        }
+        return true;
+    }
+};
+
+static_assert(CellReference::columnName(28).view() == "AB");
+static_assert(CellReference::columnName(CellReference::MaxColumns).view() == "XFD");
+static_assert(CellReference::parseA1(std::string_view("$XFD$1048576"))->column == CellReference::MaxColumns);
@@ -0,0 +1,54 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <functional>
+#include <memory>
+
+#include "data/RangeData.hpp"
+
+/**
+ * @brief CSV/TSV读取器
+ *
+ * 面向GB级的文本数据源：
+ * - 通过QFile::map()内存映射文件，不复制文件内容
+ * - 用SSE2一次比较16字节查找分隔符、引号和换行，不支持时退回逐字节扫描
+ * - 按引号奇偶性把文件切成若干块，在线程池中并行解析，再按顺序拼接列
+ * - 数值用std::from_chars解析，每列直接写入RangeColumn的类型化数组
+ *
+ * 输出与ReadRangeModel相同的RangeData，第一行决定列数，
+ * 不足的行补空，多出的字段忽略；带引号的字段始终作为文本。
+ */
+class CsvReader
+{
+public:
+    /// 进度的最大值
+    static constexpr int ProgressMax = 1000;
+
+    /// 每个并行块的最小字节数，小文件只用一个块
+    static constexpr qint64 MinChunkSize = 4 << 20;
+
+    /// 自动检测分隔符
+    static constexpr char AutoDelimiter = 0;
+
+    /**
+     * @brief 在当前线程中读取，大文件的各块在线程池中并行解析
+     * @param filePath 文件路径
+     * @param delimiter 分隔符，AutoDelimiter表示自动检测
+     * @param isCanceled 取消检查（可为空），返回true时停止并返回空指针
+     * @param progress 进度回调（可为空），参数范围0到ProgressMax，可能从工作线程调用
+     * @return 读取到的数据，失败时抛出std::runtime_error
+     */
+    static std::shared_ptr<RangeData> read(const QString& filePath,
+                                           char delimiter = AutoDelimiter,
+                                           const std::function<bool()>& isCanceled = {},
+                                           const std::function<void(int)>& progress = {});
+
+    /**
+     * @brief 检测分隔符：.tsv/.tab文件为制表符，否则取首行中出现最多的逗号、制表符或分号
+     */
+    static char detectDelimiter(const QString& filePath, const char* data, qint64 size);
+};
@@ -77,6 +77,13 @@ public:
      * @return 验证结果
      */
     static ValidationResult validateExcelFile(const QString& filePath);
+
+    /**
+     * @brief 验证CSV/TSV文件
+     * @param filePath 文本数据文件路径
+     * @return 验证结果
+     */
+    static ValidationResult validateCsvFile(const QString& filePath);
     
     /**
      * @brief 验证工作表名称
@@ -130,17 +137,8 @@ public:
                                         const QString& errorMessage = "格式不正确");
 
 private:
-    // Excel相关常量
-    static const int MAX_EXCEL_ROWS = 1048576;      // Excel最大行数
-    static const int MAX_EXCEL_COLUMNS = 16384;     // Excel最大列数（XFD列）
     static const QStringList EXCEL_EXTENSIONS;      // Excel文件扩展名
-    
-    // 辅助方法
-    static bool isValidColumnReference(const QString& column);
-    static int columnToNumber(const QString& column);
-    static QString numberToColumn(int number);
-    static bool isValidRowNumber(int row);
-    static QPair<QString, int> parseCellAddress(const QString& address);
+    static const QStringList CSV_EXTENSIONS;        // CSV/TSV文件扩展名
 };
 
 /**
@@ -0,0 +1,122 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <QVariant>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <XLFormula.hpp>
+
+#include "CellReference.hpp"
+#include "data/RangeData.hpp"
+
+class StreamingSheetReader;
+
+/**
+ * @brief 单个工作表的公式引擎
+ *
+ * 解析单元格公式并建立单元格之间的依赖关系，输入值变化后只重算受影响的公式：
+ * - 每个公式记录它引用的单元格和区域，反向索引按单元格和列建立，
+ *   由变化的单元格可以直接找到所有直接和间接依赖它的公式
+ * - 需要重算的公式按依赖关系分层，同一层的公式互不依赖，
+ *   数量较多时在线程池中并行计算
+ * - 循环引用中的公式（以及依赖它们的公式）得到#CIRC!错误
+ *
+ * 支持A1引用（含$绝对引用）、区域、整列区域、算术/比较/连接运算符，
+ * 以及常用的数学、统计、逻辑和文本函数。引用其他工作表的公式结果为#REF!，
+ * 无法解析的公式（结构化引用、数组常量等）保留文件中的缓存值，不参与重算。
+ *
+ * 不是线程安全的，所有调用应在同一线程中进行。
+ */
+class FormulaEngine
+{
+public:
+    /// 同一层中待计算的公式不少于该数量时并行计算
+    static constexpr int ParallelThreshold = 64;
+
+    /**
+     * @brief 一次重算的统计
+     */
+    struct RecalcStats
+    {
+        int recalculated = 0;   ///< 重新计算的公式数
+        int levels = 0;         ///< 依赖层数
+        int circular = 0;       ///< 因循环引用无法计算的公式数
+    };
+
+    /**
+     * @param sheetName 工作表名称，公式中以该名称限定的引用视为本表引用
+     */
+    explicit FormulaEngine(std::string sheetName = std::string());
+    ~FormulaEngine();
+
+    FormulaEngine(const FormulaEngine&) = delete;
+    FormulaEngine& operator=(const FormulaEngine&) = delete;
+
+    /**
+     * @brief 从工作簿文件加载工作表的值和公式
+     *
+     * 共享公式按从属单元格相对主单元格的偏移展开。加载后公式单元格的值是文件中的缓存值，
+     * 需要调用recalculateAll()得到计算结果。
+     */
+    static std::unique_ptr<FormulaEngine> fromSheet(const StreamingSheetReader& reader, const std::string& sheetName);
+
+    /**
+     * @brief 设置单元格的值，单元格原有的公式被清除
+     */
+    void setValue(CellPosition cell, const QVariant& value);
+
+    /**
+     * @brief 设置单元格的公式
+     * @param formula 公式文本，可以带或不带开头的"="
+     * @param errorMessage 解析失败时的原因
+     * @return 解析失败时返回false，单元格保持不变
+     */
+    bool setFormula(CellPosition cell, std::string_view formula, QString* errorMessage = nullptr);
+
+    bool setFormula(CellPosition cell, const OpenXLSX::XLFormula& formula, QString* errorMessage = nullptr);
+
+    /**
+     * @brief 单元格的当前值，错误值以"#DIV/0!"等文本返回，与读取错误单元格的结果一致
+     */
+    QVariant value(CellPosition cell) const;
+
+    bool hasFormula(CellPosition cell) const;
+
+    int formulaCount() const;
+
+    /**
+     * @brief 是否有尚未重算的修改
+     */
+    bool hasPendingChanges() const;
+
+    /**
+     * @brief 重算上次重算之后修改过的单元格所影响的公式
+     */
+    RecalcStats recalculate();
+
+    /**
+     * @brief 重算所有公式
+     */
+    RecalcStats recalculateAll();
+
+    /**
+     * @brief 读取矩形范围的当前值
+     */
+    std::shared_ptr<RangeData> readRange(const CellRange& range) const;
+
+    /**
+     * @brief 有值的单元格所占的区域，没有时返回std::nullopt
+     */
+    std::optional<CellRange> usedRange() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
@@ -0,0 +1,48 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "data/RangeData.hpp"
+
+/**
+ * @brief 多工作表/多工作簿并行读取器
+ *
+ * 每个读取任务（工作簿 + 工作表 + 范围）在工作线程中独立执行（见ParallelReadModel）：
+ * - 每个任务打开自己的XLDocument，文档只在该工作线程中使用，不与其他任务共享
+ * - SheetCache中已有的范围直接从缓存读取，新读取的范围写入缓存
+ * - 结果按任务顺序排列，单个任务失败不影响其他任务
+ */
+class ParallelSheetReader
+{
+public:
+    /**
+     * @brief 读取任务
+     */
+    struct Task
+    {
+        QString filePath;           ///< 工作簿路径
+        std::string sheetName;      ///< 工作表名称，为空时读取第一个工作表
+        QString rangeAddress;       ///< 范围地址，如"A1:C10"
+    };
+
+    /**
+     * @brief 任务结果
+     */
+    struct Result
+    {
+        std::shared_ptr<RangeData> range;   ///< 读取成功的数据
+        QString errorMessage;               ///< 失败原因
+    };
+
+    /**
+     * @brief 在当前线程中执行单个任务，各任务可以在不同线程中同时执行
+     */
+    static Result read(const Task& task);
+};
@@ -0,0 +1,111 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QFuture>
+#include <QList>
+#include <QObject>
+#include <QVariant>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "data/RowBatchData.hpp"
+
+/**
+ * @brief 后台产生、在GUI线程交付的行流
+ *
+ * 生产函数在线程池中运行，通过Writer逐行写入，攒够一批后交给GUI线程，
+ * 以dataReady信号依次发出Begin/Batch/End。源节点在该信号中把批次设为输出
+ * 并发出dataUpdated，下游节点同步处理完后才释放该批次占用的名额：
+ * - 在途批次不超过MaxPendingBatches，下游处理慢时生产者阻塞，内存有上界
+ * - 生产者读取下一批的同时GUI线程处理当前批，读取与下游处理流水线并行
+ *
+ * cancel()后不再交付旧流的数据；已经发出Begin时立即补发一个cancelled的End，
+ * 下游可以据此丢弃未完成的结果。
+ */
+class RowBatchStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// 已产生但尚未被GUI线程处理的批次上限
+    static constexpr int MaxPendingBatches = 4;
+
+    struct State;
+
+    /**
+     * @brief 生产者一侧的接口，只能在生产函数中使用
+     */
+    class Writer
+    {
+    public:
+        /**
+         * @brief 开始流，必须在第一行之前调用
+         * @param columnCount 每行的列数
+         * @param totalRows 总行数，未知时为-1
+         */
+        void begin(int columnCount, int totalRows = -1);
+
+        /**
+         * @brief 追加一行，攒够一批时交付，下游积压时阻塞
+         * @return 流已被取消时返回false，生产者应尽快返回
+         */
+        bool addRow(const std::vector<QVariant>& values);
+
+        bool isCanceled() const;
+
+        int rowCount() const { return m_rowIndex; }
+
+    private:
+        friend class RowBatchStream;
+        Writer(RowBatchStream* stream, std::shared_ptr<State> state, int batchSize);
+
+        bool flush();
+        bool post(std::shared_ptr<RowBatchData> data);
+
+        RowBatchStream* m_stream;
+        std::shared_ptr<State> m_state;
+        std::vector<RowData> m_rows;
+        int m_batchSize;
+        int m_rowIndex = 0;
+        int m_columnCount = 0;
+        int m_totalRows = -1;
+        bool m_begun = false;
+    };
+
+    /// 生产函数，在工作线程中调用；抛出的异常作为End的错误信息
+    using Producer = std::function<void(Writer& writer)>;
+
+    explicit RowBatchStream(QObject* parent = nullptr);
+    ~RowBatchStream() override;
+
+    /**
+     * @brief 开始新的流，未结束的旧流先被取消
+     * @param batchSize 每批行数
+     */
+    void start(Producer producer, int batchSize = RowBatchData::DefaultBatchSize);
+
+    /**
+     * @brief 取消当前的流
+     */
+    void cancel();
+
+    bool isRunning() const;
+
+signals:
+    /**
+     * @brief 在GUI线程中依次发出Begin、Batch和End
+     */
+    void dataReady(std::shared_ptr<RowBatchData> data);
+
+private:
+    void deliver(const std::shared_ptr<State>& state, const std::shared_ptr<RowBatchData>& data);
+
+    std::shared_ptr<State> m_state;
+    QList<QFuture<void>> m_futures;
+    bool m_open = false;            ///< 已交付Begin、尚未交付End
+    int m_deliveredRows = 0;
+};
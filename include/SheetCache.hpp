@@ -0,0 +1,169 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVariant>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "CellReference.hpp"
+#include "WorkbookCache.hpp"
+#include "data/RangeData.hpp"
+
+class SheetData;
+class SheetValueCache;
+
+/**
+ * @brief 工作表解码结果的磁盘缓存
+ *
+ * ReadRange解码过的数据以列式二进制文件保存在缓存目录中，
+ * 文件名由工作簿内容哈希和工作表名称决定。之后的运行直接内存映射该文件，
+ * 只复制请求范围内的行列，不再解压和解析工作表XML：
+ * - 每列的空值位图和类型化数组按8字节对齐存放，可以直接从映射内存读取
+ * - 字符串列保存为文件内字符串表的下标，读取时每个字符串只解码一次，驻留到本次读取的池中
+ * - 与列类型不一致的少量单元格用QDataStream序列化，保证读回的值完全一致
+ *
+ * 每个工作簿版本的每个工作表只保存一个文件。解码过整个工作表时保存其已使用区域，
+ * 区域外都是空单元格，任意范围都可以从这个文件读取，之后不再重写；
+ * 只读取过部分范围时保存读取的范围，新的范围包含已保存的范围时才替换。
+ *
+ * 失效规则：文件大小和修改时间不变时沿用记录的内容哈希；
+ * 任一变化时重新计算哈希，内容未变（例如只是被复制或touch）仍可命中，
+ * 内容变化后哈希不同，旧缓存不再被引用，按最近使用时间清理。
+ *
+ * 所有方法都是线程安全的。
+ */
+class SheetCache
+{
+public:
+    /// 缓存文件格式版本，格式变化时递增
+    static constexpr uint32_t FormatVersion = 2;
+
+    /// 缓存目录默认的大小上限
+    static constexpr qint64 DefaultMaxBytes = qint64(2) << 30;
+
+    /// 计算内容哈希时的读取进度回调：已读取字节数、总字节数，返回false时停止
+    using ReadProgress = std::function<bool(qint64 bytesRead, qint64 totalBytes)>;
+
+    static SheetCache& instance();
+
+    /**
+     * @brief 获取可以使用缓存的工作簿路径
+     *
+     * 工作表必须来自共享文档，且文档与磁盘上的文件是同一版本，
+     * 否则缓存中的内容可能与节点看到的数据不一致。
+     *
+     * @return 工作簿路径，不能使用缓存时返回空字符串
+     */
+    static QString cacheableWorkbookPath(const SheetData& sheet);
+
+    /**
+     * @brief 计算并登记工作簿的内容哈希
+     *
+     * 第一次计算需要读取整个文件，只能在工作线程中调用。查找只使用已登记的哈希，
+     * 在哈希可用之前直接跳过磁盘缓存，不会在GUI线程上计算。
+     *
+     * @param progress 读取文件时按块回调已读取和总字节数，返回false时停止计算
+     * @return 是否得到了哈希
+     */
+    bool prepareContentHash(const QString& workbookPath, const ReadProgress& progress = {});
+
+    /**
+     * @brief 从缓存读取范围数据
+     * @param workbookPath 工作簿路径
+     * @param sheetName 工作表名称
+     * @param rangeAddress 范围地址，如"A1:C10"
+     * @return 缓存完整覆盖该范围（或保存的是完整工作表）时返回数据，否则返回nullptr。
+     *         工作簿的内容哈希尚未计算时同样返回nullptr
+     */
+    std::shared_ptr<RangeData> findRange(const QString& workbookPath,
+                                         const std::string& sheetName,
+                                         const QString& rangeAddress);
+
+    /**
+     * @brief 从缓存读取单个单元格
+     * @param cell 单元格位置
+     * @return 缓存覆盖该单元格时返回值（空单元格为无效QVariant），否则返回std::nullopt
+     */
+    std::optional<QVariant> findCell(const QString& workbookPath,
+                                     const std::string& sheetName,
+                                     const CellPosition& cell);
+
+    /**
+     * @brief 保存解码后的范围数据
+     *
+     * 已有完整工作表的缓存时不写入；部分范围只在包含已保存的范围时替换，完整工作表总是替换部分范围。
+     * 文件先写入临时文件再原子替换，失败时只输出日志。
+     *
+     * @param data 范围数据，rangeAddress()的左上角决定数据在工作表中的位置
+     * @param completeSheet data是否为整个工作表的已使用区域
+     * @return 是否写入了新的缓存文件
+     */
+    bool store(const QString& workbookPath, const std::string& sheetName, const RangeData& data,
+               bool completeSheet = false);
+
+    /**
+     * @brief 在线程池中保存，避免阻塞GUI线程
+     */
+    void storeAsync(const QString& workbookPath, const std::string& sheetName, std::shared_ptr<const RangeData> data);
+
+    /**
+     * @brief 在线程池中保存整个工作表解码后的值（已使用区域）
+     */
+    void storeSheetAsync(const QString& workbookPath, const std::string& sheetName,
+                         std::shared_ptr<const SheetValueCache> values);
+
+    /**
+     * @brief 删除所有缓存文件
+     */
+    void clear();
+
+    /**
+     * @brief 缓存目录
+     */
+    QString directory() const;
+
+    void setDirectory(const QString& directory);
+
+    void setMaxBytes(qint64 maxBytes);
+
+private:
+    SheetCache();
+    SheetCache(const SheetCache&) = delete;
+    SheetCache& operator=(const SheetCache&) = delete;
+
+    struct HashEntry
+    {
+        qint64 size = -1;
+        qint64 lastModified = 0;     ///< 毫秒时间戳
+        QByteArray contentHash;
+    };
+
+    // 已登记（内存或上次运行写入的标识文件）的内容哈希，文件变化或尚未计算时返回空，不读取工作簿
+    QByteArray knownContentHash(const WorkbookCache::FileStamp& stamp);
+
+    // 文件内容哈希，必要时重新计算，失败或被progress停止时返回空。只在工作线程中调用
+    QByteArray contentHash(const QString& workbookPath, const ReadProgress& progress = {});
+
+    // 登记计算好的内容哈希，同时写入磁盘，下次启动时不需要重新计算
+    void rememberContentHash(const WorkbookCache::FileStamp& stamp, const QByteArray& contentHash);
+
+    QString cacheFilePath(const QByteArray& contentHash, const std::string& sheetName) const;
+    QString stampFilePath(const QString& canonicalPath) const;
+
+    // 按最近使用时间删除超出上限的缓存文件
+    void prune();
+
+    mutable QMutex m_mutex;
+    QHash<QString, HashEntry> m_hashes;     ///< 规范化路径 -> 内容哈希
+    QString m_directory;
+    qint64 m_maxBytes = DefaultMaxBytes;
+};
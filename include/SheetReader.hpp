@@ -0,0 +1,62 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <QVariant>
+#include <optional>
+#include <vector>
+
+#include <XLCellReference.hpp>
+#include <XLCellValue.hpp>
+#include <XLSheet.hpp>
+
+#include "CellReference.hpp"
+
+class StringPool;
+
+/**
+ * @brief 工作表批量读取器
+ *
+ * 按行顺序遍历工作表，一次性取出每一行已存在的单元格值，
+ * 避免逐个单元格调用worksheet.cell()带来的重复XML查找：
+ * - 不存在的行直接补空，不会在文档中创建新节点
+ * - 每个单元格的类型只解析一次
+ * - 输出与逐单元格读取完全一致的二维QVariant数组
+ */
+class SheetReader
+{
+public:
+    /**
+     * @brief 读取矩形范围内的所有单元格值
+     * @param worksheet 工作表
+     * @param topLeft 左上角单元格
+     * @param bottomRight 右下角单元格
+     * @param pool 文本驻留到的池，重复文本共享同一份QString；为空时每个单元格各自解码
+     * @return 按行组织的二维数据数组，空单元格为无效QVariant
+     */
+    static std::vector<std::vector<QVariant>> readRange(const OpenXLSX::XLWorksheet& worksheet,
+                                                        const OpenXLSX::XLCellReference& topLeft,
+                                                        const OpenXLSX::XLCellReference& bottomRight,
+                                                        StringPool* pool = nullptr);
+
+    /**
+     * @brief 工作表中实际有数据的区域
+     *
+     * 只遍历文档中存在的行，忽略没有值的单元格（例如只设置了格式的单元格），
+     * 因此反映的是当前文档内容，不依赖可能过时的<dimension>元素。
+     *
+     * @return 工作表没有数据时返回std::nullopt
+     */
+    static std::optional<CellRange> usedRange(const OpenXLSX::XLWorksheet& worksheet);
+
+    /**
+     * @brief 将OpenXLSX单元格值转换为QVariant
+     * @param value 已解码的单元格值
+     * @param pool 文本驻留到的池，为空时直接解码
+     * @return 对应的QVariant（空值返回无效QVariant）
+     */
+    static QVariant toVariant(const OpenXLSX::XLCellValue& value, StringPool* pool = nullptr);
+};
@@ -0,0 +1,91 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <QVariant>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <XLSheet.hpp>
+
+#include "CellReference.hpp"
+#include "data/RangeColumn.hpp"
+#include "data/RangeData.hpp"
+
+/**
+ * @brief 工作表解码值的内存缓存
+ *
+ * 一次解码工作表中所有有值的单元格，按行稀疏存放类型化的值：
+ * - 只保存有值的单元格，每个单元格是列号加上int64/double/bool/字符串句柄，不构造QVariant
+ * - 行号和每行的起始位置单独存放，按行号二分查找，行内按列号二分查找
+ * - 读取任意单元格或子范围都直接从内存得到，与SheetReader读取的值完全一致
+ *
+ * 缓存挂在WorkbookDocument的工作表状态上（见SheetData::values()），
+ * 同一工作表的所有读取节点共用，工作簿文件变化后随新的文档一起重建。
+ * 创建后不再修改，可以在多个线程中同时读取。
+ */
+class SheetValueCache
+{
+public:
+    using Type = RangeColumn::Type;
+
+    /**
+     * @brief 从已加载的工作表DOM解码，不会在文档中创建新节点
+     * @param pool 文本驻留到的池，通常是工作簿文档的池，缓存会一直持有它
+     */
+    static std::shared_ptr<const SheetValueCache> fromWorksheet(const OpenXLSX::XLWorksheet& worksheet,
+                                                                std::shared_ptr<StringPool> pool);
+
+    /**
+     * @brief 单元格的值，空单元格返回无效QVariant
+     */
+    QVariant value(CellPosition cell) const;
+
+    /**
+     * @brief 读取矩形范围，每列按出现最多的类型存储
+     * @param range 范围
+     * @param rangeAddress 输出数据的范围地址
+     */
+    std::shared_ptr<RangeData> readRange(const CellRange& range, const QString& rangeAddress) const;
+
+    /**
+     * @brief 有值的单元格所占的区域，没有时返回std::nullopt
+     */
+    std::optional<CellRange> usedRange() const { return m_usedRange; }
+
+    size_t cellCount() const { return m_cells.size(); }
+
+    size_t memoryUsage() const;
+
+private:
+    struct Cell
+    {
+        uint16_t column = 0;
+        Type type = Type::Empty;
+        union {
+            bool boolValue;
+            int64_t intValue;
+            double doubleValue;
+            StringPool::Handle stringValue;
+        };
+
+        QVariant toVariant(const StringPool& pool) const;
+    };
+
+    class Builder;
+
+    // 第row行的单元格在m_cells中的范围，行不存在时为空
+    std::pair<const Cell*, const Cell*> rowCells(uint32_t row) const;
+
+    std::vector<uint32_t> m_rows;           ///< 有值的行号，升序
+    std::vector<uint32_t> m_rowStarts;      ///< 每行第一个单元格的下标，末尾多一个结束位置
+    std::vector<Cell> m_cells;              ///< 按行、列排序的单元格
+    std::optional<CellRange> m_usedRange;
+    std::shared_ptr<StringPool> m_pool;     ///< 字符串句柄所属的池
+};
@@ -0,0 +1,47 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QVariant>
+#include <functional>
+
+#include <XLCellValue.hpp>
+#include <XLSheet.hpp>
+
+#include "data/RangeData.hpp"
+
+/**
+ * @brief 工作表批量写入器
+ *
+ * 与SheetReader对应，按整行写入RangeData：
+ * - 每行先组装成XLCellValue数组，再通过XLRow::values()一次写入
+ * - 列的类型在开始时确定，类型化列直接读取RangeColumn的原始数组
+ * - 进度通过回调上报，不处理事件循环
+ */
+class SheetWriter
+{
+public:
+    /// 进度回调：已写入的行数、总行数
+    using ProgressCallback = std::function<void(int rowsWritten, int totalRows)>;
+
+    /// 每写入多少行上报一次进度
+    static constexpr int ProgressInterval = 1000;
+
+    /**
+     * @brief 从A1开始写入范围数据
+     * @param worksheet 目标工作表
+     * @param data 要写入的数据
+     * @param progress 进度回调（可选）
+     */
+    static void writeRange(OpenXLSX::XLWorksheet& worksheet,
+                           const RangeData& data,
+                           const ProgressCallback& progress = {});
+
+    /**
+     * @brief 将QVariant转换为OpenXLSX单元格值
+     * @param value 任意值，无效值转换为空单元格
+     */
+    static OpenXLSX::XLCellValue toCellValue(const QVariant& value);
+};
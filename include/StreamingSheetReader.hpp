@@ -0,0 +1,125 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <QVariant>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <XLCellReference.hpp>
+
+#include "CellReference.hpp"
+#include "XlsxArchive.hpp"
+#include "data/RangeData.hpp"
+#include "data/StringPool.hpp"
+
+/**
+ * @brief 流式工作表读取器
+ *
+ * 面向只读流程，不构建工作表DOM：
+ * - 直接从压缩包边解压边解析工作表XML，内存占用只有一个解压块和当前行
+ * - <row>/<c>元素按文档顺序解码，读到范围最后一行后立即停止解压
+ * - 单元格类型规则与OpenXLSX一致，输出与SheetReader相同的值
+ * - 共享字符串可以直接复用已打开文档的句柄表，否则从压缩包流式加载
+ *
+ * 不是线程安全的，每个线程应使用独立的读取器。
+ */
+class StreamingSheetReader
+{
+public:
+    /// 行回调：行号（1开始）、该行范围内的值；返回false时停止读取
+    using RowCallback = std::function<bool(uint32_t row, const std::vector<QVariant>& values)>;
+
+    /**
+     * @brief 单元格的缓存值和公式
+     */
+    struct CellContent
+    {
+        CellPosition position;
+        QVariant value;             ///< 缓存值，没有<v>时为无效QVariant
+        std::string formula;        ///< 公式文本（不含"="），共享公式的从属单元格为空
+        int sharedIndex = -1;       ///< 共享公式的si，非共享公式为-1
+    };
+
+    /// 单元格回调，CellContent只在回调期间有效
+    using CellCallback = std::function<void(const CellContent& cell)>;
+
+    /**
+     * @brief 打开工作簿并流式加载共享字符串
+     * @param filePath 工作簿路径
+     */
+    explicit StreamingSheetReader(const QString& filePath);
+
+    /**
+     * @brief 打开工作簿并复用已有的共享字符串句柄
+     * @param filePath 工作簿路径
+     * @param pool 句柄所属的驻留池，读取的其他文本也驻留到这里
+     * @param sharedStrings 共享字符串索引到pool中句柄的映射
+     */
+    StreamingSheetReader(const QString& filePath, std::shared_ptr<StringPool> pool,
+                         std::vector<StringPool::Handle> sharedStrings);
+
+    /**
+     * @brief 工作簿中所有工作表的名称，按工作簿中的顺序排列
+     */
+    std::vector<std::string> sheetNames() const;
+
+    bool hasSheet(const std::string& sheetName) const;
+
+    /**
+     * @brief 按行读取矩形范围
+     * @param sheetName 工作表名称
+     * @param topLeft 左上角单元格
+     * @param bottomRight 右下角单元格
+     * @param callback 每行调用一次，范围内不存在的行以空值补齐
+     * @return 回调的行数
+     */
+    uint32_t readRows(const std::string& sheetName,
+                      const OpenXLSX::XLCellReference& topLeft,
+                      const OpenXLSX::XLCellReference& bottomRight,
+                      const RowCallback& callback) const;
+
+    /**
+     * @brief 按文档顺序读取工作表中所有有值或有公式的单元格
+     *
+     * 与readRows不同，公式文本也一并交出，供公式引擎建立依赖关系。
+     */
+    void readCells(const std::string& sheetName, const CellCallback& callback) const;
+
+    /**
+     * @brief 读取矩形范围为RangeData，逐行追加到列存储，不经过二维中间数组
+     * @param sheetName 工作表名称
+     * @param rangeAddress 范围地址，如"A1:C10"
+     */
+    std::shared_ptr<RangeData> readRange(const std::string& sheetName, const QString& rangeAddress) const;
+
+    /**
+     * @brief 工作表的已使用区域
+     *
+     * 有<dimension>元素时直接使用其范围，只解压工作表开头的一小段；
+     * 否则扫描有值的单元格，得到实际最后一个有数据的行列。
+     *
+     * @return 工作表没有数据时返回std::nullopt
+     */
+    std::optional<CellRange> usedRange(const std::string& sheetName) const;
+
+private:
+    void loadWorkbook();
+    void loadSharedStrings();
+    const std::string& sheetPath(const std::string& sheetName) const;
+
+private:
+    XlsxArchive m_archive;
+    std::vector<std::pair<std::string, std::string>> m_sheets;      ///< 工作表名称 -> 压缩包内路径
+    std::string m_sharedStringsPath;                               ///< 共享字符串路径，不存在时为空
+    std::shared_ptr<StringPool> m_pool;                            ///< 读取的文本驻留到这里
+    std::vector<StringPool::Handle> m_sharedStrings;
+};
@@ -0,0 +1,152 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <QVariant>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SheetWriter.hpp"
+#include "data/RangeData.hpp"
+
+/**
+ * @brief 流式工作簿导出器
+ *
+ * 与SheetWriter不同，不经过OpenXLSX的DOM，按行遍历RangeData时直接生成
+ * <sheetData>的XML，写入临时文件后再流式压缩进xlsx：
+ * - 内存占用只有固定大小的写缓冲区和共享字符串索引，与行数无关
+ * - 字符串可以写成内联字符串，或写入同步生成的共享字符串表
+ * - 输出新的工作簿，会覆盖目标文件的全部内容；多个工作表可以用WorkbookWriter一次写出
+ */
+class StreamingSheetWriter
+{
+public:
+    /// 字符串的存储方式
+    enum class StringMode
+    {
+        SharedStrings,      ///< 写入xl/sharedStrings.xml，重复文本只存一份
+        InlineStrings       ///< 直接写在单元格中，不生成共享字符串表
+    };
+
+    /// 默认压缩级别（0为仅存储，9为最高压缩）
+    static constexpr int DefaultCompressionLevel = 6;
+
+    /// 仅存储不压缩，打包最快，文件最大
+    static constexpr int StoreOnly = 0;
+
+    /**
+     * @brief 逐行写入的导出器，用于行数事先未知的数据（如分批到达的行流）
+     *
+     * 每行立即转换为XML写入临时文件，内存占用与已写入的行数无关。
+     * 行依次写在第1、2、3...行，从A列开始。
+     */
+    class RowWriter
+    {
+    public:
+        explicit RowWriter(StringMode stringMode);
+        ~RowWriter();
+
+        RowWriter(const RowWriter&) = delete;
+        RowWriter& operator=(const RowWriter&) = delete;
+
+        /**
+         * @brief 追加一行，超出Excel最大行数时抛出异常
+         */
+        void appendRow(const std::vector<QVariant>& values);
+
+        int rowCount() const;
+
+        /**
+         * @brief 结束写入并生成只有一个工作表的xlsx文件，之后不能再追加行
+         * @param filePath 输出路径，已存在时被覆盖
+         * @param sheetName 工作表名称
+         * @param compressionLevel 压缩级别
+         */
+        void finish(const QString& filePath, const std::string& sheetName,
+                    int compressionLevel = DefaultCompressionLevel);
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> d;
+    };
+
+    /**
+     * @brief 包含多个工作表的导出器
+     *
+     * 每个工作表在添加时立即转换为XML写入各自的临时文件，使用共享字符串的工作表共用一个共享字符串表，
+     * finish()时把整个工作簿一次写成压缩包。每个工作表条目可以使用不同的字符串方式和压缩级别。
+     */
+    class WorkbookWriter
+    {
+    public:
+        /**
+         * @param stringMode 未指定字符串方式的addSheet()使用的方式
+         */
+        explicit WorkbookWriter(StringMode stringMode);
+        ~WorkbookWriter();
+
+        WorkbookWriter(const WorkbookWriter&) = delete;
+        WorkbookWriter& operator=(const WorkbookWriter&) = delete;
+
+        /**
+         * @brief 添加工作表，按添加顺序排列；名称不符合Excel的规则（1到31个字符，不含[]:*?/\）
+         *        或与已有工作表重复（不区分大小写）时抛出异常
+         * @param sheetName 工作表名称
+         * @param data 要写入的数据，从A1开始
+         * @param compressionLevel 该工作表条目的压缩级别
+         * @param progress 进度回调（可选）
+         * @param isCanceled 取消检查（可选），返回true时抛出异常
+         */
+        void addSheet(const std::string& sheetName,
+                      const RangeData& data,
+                      int compressionLevel = DefaultCompressionLevel,
+                      const SheetWriter::ProgressCallback& progress = {},
+                      const std::function<bool()>& isCanceled = {});
+
+        /**
+         * @brief 添加工作表，使用指定的字符串方式
+         */
+        void addSheet(const std::string& sheetName,
+                      const RangeData& data,
+                      StringMode stringMode,
+                      int compressionLevel = DefaultCompressionLevel,
+                      const SheetWriter::ProgressCallback& progress = {},
+                      const std::function<bool()>& isCanceled = {});
+
+        int sheetCount() const;
+
+        /**
+         * @brief 生成xlsx文件，之后不能再添加工作表
+         * @param filePath 输出路径，已存在时被覆盖
+         * @param compressionLevel 共享字符串表和工作簿结构等其他条目的压缩级别
+         */
+        void finish(const QString& filePath, int compressionLevel = DefaultCompressionLevel);
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> d;
+    };
+
+    /**
+     * @brief 将数据导出为只有一个工作表的xlsx文件
+     * @param filePath 输出路径，已存在时被覆盖
+     * @param sheetName 工作表名称
+     * @param data 要写入的数据，从A1开始
+     * @param stringMode 字符串的存储方式
+     * @param progress 进度回调（可选）
+     * @param isCanceled 取消检查（可选），返回true时抛出异常
+     * @param compressionLevel 压缩级别
+     */
+    static void writeWorkbook(const QString& filePath,
+                              const std::string& sheetName,
+                              const RangeData& data,
+                              StringMode stringMode,
+                              const SheetWriter::ProgressCallback& progress = {},
+                              const std::function<bool()>& isCanceled = {},
+                              int compressionLevel = DefaultCompressionLevel);
+};
@@ -0,0 +1,141 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QtNodes/DataFlowGraphModel>
+#include "model/BaseNodeModel.hpp"
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief 带运行调度的数据流图模型
+ *
+ * QtNodes的DataFlowGraphModel在节点发出dataUpdated时立即、深度优先地把数据推给下游，
+ * 菱形连接中的汇合节点每条入边都会计算一次，其中几次用的还是一半旧的输入。
+ *
+ * 运行期间（startRun()到所有节点完成）改为按拓扑顺序调度：
+ * - 节点的所有上游节点都完成后才交付输入，每个节点每次运行只计算一次
+ * - 上游送来的数据先暂存，同一端口多次送达时只保留最后一次
+ * - 节点发出computingStarted后进入后台计算，直到computingFinished才算完成
+ * - 已经交付过输入的节点之后收到的数据直接交付，行流等分批输出不受影响
+ * - 没有收到任何输入的节点不计算，直接视为完成，计入运行结束时的跳过数
+ * - 声明为AnyThread的节点（见BaseNodeModel::threadAffinity()）通过BaseNodeModel::startCompute()
+ *   在WorkStealingPool中计算，彼此没有依赖的分支并行执行，只有应用结果（更新控件、发出dataUpdated）回到GUI线程
+ *
+ * 运行之间缓存节点的结果：节点的指纹由参数（save()）、外部状态（BaseNodeModel::externalState()）
+ * 和上游节点的指纹组成，与上一次运行相同且节点仍持有当时的输出时不再计算，直接复用。
+ * 修改某个节点后只有它和它的下游会重新计算。
+ *
+ * 没有可执行的节点、仍在计算的节点都在等待运行收尾（BaseNodeModel::isDeferredToRunEnd()）时
+ * 发出runDrained()，例如合并写入在此时写出，写出完成后这些节点结束，运行随之完成。
+ *
+ * 停止运行时仍在后台计算的节点，其之后送达的结果属于已取消的运行，不再传给下游，
+ * 直到节点开始新的计算。
+ *
+ * 不在运行中时行为与DataFlowGraphModel一致，编辑参数时仍然立即传播。
+ */
+class TinaFlowGraphModel : public QtNodes::DataFlowGraphModel
+{
+    Q_OBJECT
+
+public:
+    /// 执行源节点（没有连接输入的节点），节点在其中或之后发出dataUpdated
+    using SourceTrigger = std::function<void(QtNodes::NodeId nodeId)>;
+
+    explicit TinaFlowGraphModel(std::shared_ptr<QtNodes::NodeDelegateModelRegistry> registry);
+
+    /**
+     * @brief 开始一次运行，正在运行时先停止上一次
+     * @param triggerSource 执行源节点
+     */
+    void startRun(const SourceTrigger& triggerSource);
+
+    /**
+     * @brief 停止调度，暂存的输入被丢弃，正在后台计算的节点之后送达的结果不再传给下游
+     */
+    void stopRun();
+
+    bool isRunning() const { return m_run.has_value(); }
+
+    bool setPortData(QtNodes::NodeId nodeId,
+                     QtNodes::PortType portType,
+                     QtNodes::PortIndex portIndex,
+                     QVariant const& value,
+                     QtNodes::PortRole role = QtNodes::PortRole::Data) override;
+
+signals:
+    /**
+     * @brief 所有节点都已完成
+     * @param computedNodes 本次运行实际计算的节点数
+     * @param reusedNodes 复用上一次运行结果的节点数
+     * @param skippedNodes 没有收到输入、没有计算的节点数
+     * @param elapsedMs 运行耗时（毫秒）
+     */
+    void runFinished(int computedNodes, int reusedNodes, int skippedNodes, qint64 elapsedMs);
+
+    /**
+     * @brief 运行中只剩下等待运行收尾的节点（见BaseNodeModel::isDeferredToRunEnd()）
+     *
+     * 这些节点结束之前不会再有其他节点执行；它们结束后下游可能继续执行，之后可能再次发出。
+     */
+    void runDrained();
+
+private:
+    struct RunState
+    {
+        SourceTrigger triggerSource;
+        std::vector<QtNodes::NodeId> order;                                     ///< 节点按编号排序，用于处理环
+        std::unordered_map<QtNodes::NodeId, std::vector<QtNodes::NodeId>> downstream;
+        std::unordered_map<QtNodes::NodeId, int> pendingUpstream;               ///< 尚未完成的上游节点数
+        std::unordered_set<QtNodes::NodeId> sources;
+        std::unordered_set<QtNodes::NodeId> released;                           ///< 已经交付输入（或已触发）的节点
+        std::unordered_set<QtNodes::NodeId> settled;                            ///< 已完成的节点
+        std::unordered_set<QtNodes::NodeId> busy;                               ///< 正在后台计算的节点
+        std::unordered_set<QtNodes::NodeId> reused;                             ///< 复用上一次结果、没有计算的节点
+        std::unordered_set<QtNodes::NodeId> skipped;                            ///< 没有收到输入、没有计算的节点
+        std::unordered_map<QtNodes::NodeId, QByteArray> fingerprints;           ///< 本次运行的节点指纹，为空表示不能复用
+        std::unordered_map<QtNodes::NodeId, std::map<QtNodes::PortIndex, QVariant>> bufferedInputs;
+        std::deque<QtNodes::NodeId> ready;                                      ///< 可以执行的节点
+        std::vector<QMetaObject::Connection> connections;
+        int computed = 0;
+        QElapsedTimer timer;
+    };
+
+    /**
+     * @brief 上一次运行计算的节点结果
+     */
+    struct MemoEntry
+    {
+        QByteArray fingerprint;
+        std::vector<std::weak_ptr<QtNodes::NodeData>> outputs;  ///< 不延长输出的生命周期，只用于确认节点仍持有这些输出
+    };
+
+    void pump();
+    void execute(QtNodes::NodeId nodeId);
+    QByteArray fingerprint(QtNodes::NodeId nodeId);
+    bool canReuse(QtNodes::NodeId nodeId, QtNodes::NodeDelegateModel& model, const QByteArray& fingerprint) const;
+    void memoize(QtNodes::NodeId nodeId);
+    void settle(QtNodes::NodeId nodeId);
+    bool isDrained();
+    void finishRun();
+    void onComputingStarted(QtNodes::NodeId nodeId);
+    void onComputingFinished(QtNodes::NodeId nodeId);
+    void onNodeDeleted(QtNodes::NodeId nodeId);
+    bool fromStoppedNode(QtNodes::NodeId nodeId, QtNodes::PortIndex portIndex) const;
+    void resumeStoppedNode(QtNodes::NodeId nodeId);
+
+    std::optional<RunState> m_run;
+    std::unordered_map<QtNodes::NodeId, MemoEntry> m_memo;
+    std::unordered_map<QtNodes::NodeId, QMetaObject::Connection> m_stoppedNodes;  ///< 停止时仍在计算的节点，开始新的计算时移除
+    bool m_pumping = false;
+};
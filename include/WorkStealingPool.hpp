@@ -0,0 +1,75 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 工作窃取线程池
+ *
+ * 每个工作线程有自己的任务队列：
+ * - 工作线程中提交的任务进入本线程队列的尾部，按后进先出执行，数据多半还在缓存中
+ * - 其他线程提交的任务轮流分配到各个队列
+ * - 自己的队列为空时从其他队列的头部窃取最早的任务，负载不均时也能用满所有核心
+ *
+ * 任务不应抛出异常，需要把错误带回调用方时在任务内部捕获（见TinaFlowGraphModel）。
+ */
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief 全局线程池，线程数等于CPU核心数
+     */
+    static WorkStealingPool& instance();
+
+    /**
+     * @param threadCount 工作线程数，小于1时使用CPU核心数
+     */
+    explicit WorkStealingPool(int threadCount = 0);
+
+    /**
+     * @brief 等待已提交的任务执行完后结束所有线程
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief 提交任务，可以在任意线程中调用
+     */
+    void submit(Task task);
+
+    int threadCount() const { return static_cast<int>(m_workers.size()); }
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(int index);
+    bool popLocal(int index, Task& task);
+    bool steal(int index, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    int m_pending = 0;                      ///< 已提交尚未取出的任务数，由m_wakeMutex保护
+    bool m_stopping = false;                ///< 由m_wakeMutex保护
+    std::atomic<unsigned> m_nextQueue{0};   ///< 外部线程提交时轮流选择的队列
+};
@@ -0,0 +1,109 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <memory>
+
+#include "data/WorkbookDocument.hpp"
+
+/**
+ * @brief 工作簿文档缓存
+ *
+ * 按规范化路径、文件大小和修改时间缓存已解析的文档：
+ * - 多个节点打开同一个未修改的文件时共享同一份文档
+ * - 重复运行流程时不再重新解析
+ * - 文件大小或修改时间变化后对应条目失效
+ *
+ * 缓存只保存弱引用，文档的生命周期由持有它的WorkbookData决定。
+ * 所有方法都是线程安全的，可以在后台加载线程中调用。
+ */
+class WorkbookCache
+{
+public:
+    /**
+     * @brief 文件标识：规范化路径 + 大小 + 修改时间
+     */
+    struct FileStamp
+    {
+        QString canonicalPath;
+        qint64 size = -1;
+        QDateTime lastModified;
+
+        bool isValid() const { return !canonicalPath.isEmpty(); }
+
+        bool sameContentAs(const FileStamp& other) const
+        {
+            return size == other.size && lastModified == other.lastModified;
+        }
+
+        /**
+         * @brief 文本形式，用于节点结果缓存的指纹（见BaseNodeModel::externalState()）
+         */
+        QString toString() const
+        {
+            return QString("%1|%2|%3").arg(canonicalPath).arg(size).arg(lastModified.toMSecsSinceEpoch());
+        }
+
+        /**
+         * @brief 读取文件的当前标识
+         * @param filePath 文件路径
+         * @return 文件不存在时返回无效标识
+         */
+        static FileStamp of(const QString& filePath);
+    };
+
+    static WorkbookCache& instance();
+
+    /**
+     * @brief 查找与文件标识一致的文档
+     * @param stamp 文件标识
+     * @return 缓存的文档，不存在、已释放或文件已修改时返回nullptr
+     */
+    std::shared_ptr<WorkbookDocument> find(const FileStamp& stamp);
+
+    /**
+     * @brief 登记新解析的文档
+     * @param stamp 解析前读取的文件标识
+     * @param document 新文档
+     * @return 实际应使用的文档（如果其他线程已登记了相同文件，返回已有文档）
+     */
+    std::shared_ptr<WorkbookDocument> insert(const FileStamp& stamp, std::shared_ptr<WorkbookDocument> document);
+
+    /**
+     * @brief 使指定文件的缓存失效
+     */
+    void invalidate(const QString& filePath);
+
+    /**
+     * @brief 清空缓存
+     */
+    void clear();
+
+    /**
+     * @brief 当前仍然存活的缓存文档数量
+     */
+    int liveCount() const;
+
+private:
+    WorkbookCache() = default;
+    WorkbookCache(const WorkbookCache&) = delete;
+    WorkbookCache& operator=(const WorkbookCache&) = delete;
+
+    struct Entry
+    {
+        FileStamp stamp;
+        std::weak_ptr<WorkbookDocument> document;
+    };
+
+    // 调用者必须持有m_mutex
+    void pruneExpired();
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;    ///< 规范化路径 -> 缓存条目
+};
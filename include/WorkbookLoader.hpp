@@ -0,0 +1,50 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <functional>
+#include <memory>
+
+#include "data/WorkbookData.hpp"
+
+/**
+ * @brief 工作簿加载器
+ *
+ * 在调用线程（通常是节点计算的工作线程）中读取、解压并解析Excel文件：
+ * - 进度为0到ProgressMax；先按字节上报读取文件的进度，
+ *   解压和解析文档期间OpenXLSX不提供进度，此时上报Busy
+ * - isCanceled返回true后，读取文件时立即停止，解析期间在解析结束后停止，都不产生结果
+ * - 加载失败时结果中的workbook为空，errorMessage描述原因
+ */
+class WorkbookLoader
+{
+public:
+    /// 进度的最大值
+    static constexpr int ProgressMax = 1000;
+
+    /// 暂时无法获得进度（忙碌）
+    static constexpr int Busy = -1;
+
+    /**
+     * @brief 加载结果
+     */
+    struct Result
+    {
+        std::shared_ptr<WorkbookData> workbook;   ///< 加载成功的工作簿
+        QString errorMessage;                     ///< 失败原因
+        int sheetCount = 0;                       ///< 工作表数量，在加载线程中读取，显示时不需要锁定文档
+    };
+
+    /**
+     * @brief 在当前线程中打开工作簿
+     * @param filePath 文件路径
+     * @param isCanceled 取消检查（可为空），返回true时停止，结果中的workbook和errorMessage都为空
+     * @param progress 进度回调（可为空），参数为0到ProgressMax或Busy
+     */
+    static Result load(const QString& filePath,
+                       const std::function<bool()>& isCanceled = {},
+                       const std::function<void(int)>& progress = {});
+};
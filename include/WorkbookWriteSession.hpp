@@ -0,0 +1,161 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "SheetWriter.hpp"
+#include "StreamingSheetWriter.hpp"
+#include "data/RangeData.hpp"
+
+/**
+ * @brief 按输出路径合并的工作簿写入会话
+ *
+ * 一次流程运行（begin()到end()或abort()）期间，多个保存节点写往同一个文件的工作表先登记到会话中，
+ * 不再各自打开、改写、压缩一遍整个文件：
+ * - 同一路径的工作表在一个工作簿中，一次写出一个压缩包，同名工作表以最后登记的为准
+ * - 登记时不写出，运行中其他节点都完成后（TinaFlowGraphModel::runDrained()）调用flush()，
+ *   每个文件只写出一次
+ * - 每个节点（owner）只保留最近登记的一个工作表，节点改名、改路径或被删除（withdraw()）时
+ *   原来的工作表随之移除，不会再被写出
+ * - 运行期间保留本次运行登记的工作表，同一运行中再次写出时整个工作簿一起重写，
+ *   流式导出覆盖整个文件时也不会丢失其他节点的工作表；运行结束后全部释放
+ * - 写出在线程池中进行，同一路径同时只有一个写入任务，完成后发出workbookWritten，
+ *   登记时返回的编号表示本次登记的工作表已经写出
+ * - 停止运行（abort()）时不写出尚未写出的工作表，正在写出的工作簿被取消，目标文件保持不变，
+ *   这些登记以失败结束
+ *
+ * 不在运行中时不合并，节点按原来的方式立即保存。只能在GUI线程中使用。
+ */
+class WorkbookWriteSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 待写入的工作表
+     */
+    struct SheetEntry
+    {
+        QString sheetName;
+        std::shared_ptr<const RangeData> data;
+        bool keepOtherSheets = false;   ///< 通过OpenXLSX写入，保留文件中已有的其他工作表
+        StreamingSheetWriter::StringMode stringMode = StreamingSheetWriter::StringMode::SharedStrings;
+        int compressionLevel = StreamingSheetWriter::DefaultCompressionLevel;   ///< 该工作表条目的压缩级别
+    };
+
+    static WorkbookWriteSession& instance();
+
+    /**
+     * @brief 开始合并写入（流程开始运行），已经开始时不做任何事
+     */
+    void begin();
+
+    /**
+     * @brief 流程运行完成：写出尚未写出的工作簿，结束合并并释放本次运行登记的工作表
+     */
+    void end();
+
+    /**
+     * @brief 流程被停止：丢弃尚未写出的工作表并取消正在进行的写出，相应的登记以失败结束
+     */
+    void abort();
+
+    bool isActive() const { return m_active; }
+
+    /**
+     * @brief 登记工作表，在下一次flush()时写出
+     * @param owner 登记的节点，同一节点之前登记的工作表被替换
+     * @param filePath 输出路径
+     * @param entry 工作表，数据在写出前不能再被修改
+     * @return 本次登记的编号，写出完成时出现在workbookWritten的tickets中
+     */
+    quint64 addSheet(const QObject* owner, const QString& filePath, SheetEntry entry);
+
+    /**
+     * @brief 移除节点登记的工作表（节点被删除或不再合并写入），尚未写出的登记不再写出
+     */
+    void withdraw(const QObject* owner);
+
+    /**
+     * @brief 写出所有有新登记的工作簿，正在写出的工作簿在写完后接着写
+     */
+    void flush();
+
+    /**
+     * @brief 把若干工作表写成一个工作簿文件（可在工作线程中调用）
+     *
+     * 要求保留其他工作表时通过OpenXLSX打开已有文件写入（压缩级别由OpenXLSX决定），
+     * 否则流式生成只包含这些工作表的新文件，每个工作表使用自己的字符串方式和压缩级别。
+     * 两种模式混用时抛出异常。先写入临时文件，成功后原子替换目标文件。
+     * @param progress 进度回调（可选），按所有工作表的总行数计算
+     * @param isCanceled 取消检查（可选），返回true时放弃写入并抛出异常
+     */
+    static void writeWorkbook(const QString& filePath,
+                              const std::vector<SheetEntry>& sheets,
+                              const SheetWriter::ProgressCallback& progress = {},
+                              const std::function<bool()>& isCanceled = {});
+
+    /**
+     * @brief 在目标目录的临时文件中写入，成功后原子替换目标文件
+     * @param write 写入临时文件，抛出异常时删除临时文件，目标文件保持不变
+     */
+    static void replaceFileAtomically(const QString& filePath, const std::function<void(const QString& tempPath)>& write);
+
+signals:
+    /**
+     * @brief 一个工作簿写出完成
+     * @param filePath 输出路径
+     * @param tickets 本次写出包含的登记编号
+     * @param sheetCount 工作簿中的工作表数
+     * @param message 失败原因，成功时为空
+     */
+    void workbookWritten(const QString& filePath, const QList<quint64>& tickets, int sheetCount,
+                         bool success, const QString& message);
+
+private:
+    WorkbookWriteSession() = default;
+    ~WorkbookWriteSession() override = default;
+
+    WorkbookWriteSession(const WorkbookWriteSession&) = delete;
+    WorkbookWriteSession& operator=(const WorkbookWriteSession&) = delete;
+
+    /**
+     * @brief 某个节点登记的工作表
+     */
+    struct OwnedSheet
+    {
+        const QObject* owner = nullptr;
+        quint64 ticket = 0;
+        SheetEntry entry;
+    };
+
+    struct PendingWorkbook
+    {
+        QString filePath;
+        std::vector<OwnedSheet> sheets;                 ///< 本次运行登记的工作表，每个节点一个
+        QList<quint64> pendingTickets;                  ///< 尚未写出的登记
+        bool writing = false;                           ///< 正在后台写出
+        std::shared_ptr<std::atomic_bool> canceled;     ///< 正在进行的写出被取消
+    };
+
+    void removeSheets(PendingWorkbook& workbook, const std::function<bool(const OwnedSheet&)>& match);
+    void startWrite(const QString& key);
+    void onWriteFinished(const QString& key, const QList<quint64>& tickets, int sheetCount,
+                         bool success, const QString& message);
+
+    static QString pathKey(const QString& filePath);
+
+    QHash<QString, PendingWorkbook> m_workbooks;    ///< 规范化路径 -> 工作簿
+    quint64 m_nextTicket = 1;
+    bool m_active = false;
+};
@@ -0,0 +1,70 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * @brief xlsx压缩包的只读访问
+ *
+ * 直接基于miniz读取压缩包中的条目，不经过OpenXLSX的XLDocument：
+ * - 压缩包通过QFile按需随机读取，不会整体载入内存
+ * - streamEntry()边解压边回调，每次只占用一个固定大小的缓冲区
+ * - 支持中文等非ASCII路径
+ *
+ * 所有读取失败都以std::runtime_error抛出。
+ */
+class XlsxArchive
+{
+public:
+    /// 数据块回调：返回false时停止解压
+    using ChunkSink = std::function<bool(const char* data, size_t size)>;
+
+    /// 流式解压时每个数据块的大小
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    XlsxArchive();
+    ~XlsxArchive();
+
+    XlsxArchive(const XlsxArchive&) = delete;
+    XlsxArchive& operator=(const XlsxArchive&) = delete;
+
+    /**
+     * @brief 打开压缩包
+     * @param filePath 文件路径
+     */
+    void open(const QString& filePath);
+
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * @brief 检查条目是否存在
+     * @param name 条目名称，如"xl/workbook.xml"
+     */
+    bool hasEntry(const std::string& name) const;
+
+    /**
+     * @brief 读取整个条目，只用于workbook.xml等小文件
+     * @param name 条目名称
+     */
+    std::string readEntry(const std::string& name) const;
+
+    /**
+     * @brief 流式解压条目
+     * @param name 条目名称
+     * @param sink 数据块回调
+     * @return sink中途要求停止时返回false
+     */
+    bool streamEntry(const std::string& name, const ChunkSink& sink) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
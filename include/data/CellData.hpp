@@ -5,9 +5,22 @@
 #pragma once
 #include <QtNodes/NodeData>
 #include <XLCell.hpp>
+#include "CellReference.hpp"
+#include "SheetReader.hpp"
+#include "SheetData.hpp"
+#include "StringPool.hpp"
 #include <QString>
 #include <QVariant>
 
+/**
+ * @brief 单元格数据
+ *
+ * 有两种形式：
+ * - 活动单元格：持有文档中的XLCell，每次取值都重新读取XML节点，并使整个文档保持加载
+ * - 快照：读取时保存一次地址和类型化的值，之后不再访问文档，文档可以随时释放
+ *
+ * 只读取值的节点应输出快照（见snapshotOf），活动单元格只在需要写回文档时使用。
+ */
 class CellData : public QtNodes::NodeData
 {
 public:
@@ -17,17 +30,63 @@ public:
     {
     }
 
+    // source为单元格所在的工作表数据，持有它可以保证单元格所在的DOM不被释放
+    CellData(OpenXLSX::XLCell cell, std::shared_ptr<QtNodes::NodeData> source)
+        : m_cell(std::make_shared<OpenXLSX::XLCell>(cell)), m_source(std::move(source))
+    {
+    }
+
     // 新的构造函数，用于从地址和值创建虚拟单元格
     CellData(const QString& address, const QVariant& value)
         : m_address(address), m_value(value), m_cell(nullptr)
     {
     }
 
+    /**
+     * @brief 读取单元格的地址和值，创建不引用文档的快照
+     *
+     * 值的类型规则与SheetReader一致：整数为qint64，浮点数为double，
+     * 布尔值为bool，空单元格为无效QVariant。文本驻留到pool中，与同一工作簿读出的相同文本共享一份缓冲区；
+     * QVariant中的QString与句柄一样只占一个指针，快照不需要单独持有池。
+     *
+     * @param pool 文本驻留到的池，通常是工作簿文档的池，为空时直接解码
+     */
+    static CellData snapshotOf(const OpenXLSX::XLCell& cell, const std::shared_ptr<StringPool>& pool = {})
+    {
+        const auto reference = cell.cellReference();
+        CellData data;
+        data.m_address = CellReference::formatA1({reference.row(), reference.column()}).toQString();
+        data.m_value = SheetReader::toVariant(cell.value(), pool.get());
+        return data;
+    }
+
     QtNodes::NodeDataType type() const override
     {
         return {"cell", "Cell"};
     }
 
+    /**
+     * @brief 是否为快照（不引用文档）
+     */
+    bool isSnapshot() const
+    {
+        return m_cell == nullptr;
+    }
+
+    /**
+     * @brief 返回不引用文档的副本，活动单元格在此时读取一次值
+     */
+    CellData detached() const
+    {
+        if (!m_cell) {
+            return *this;
+        }
+        // 单元格来自工作表时文本驻留到其文档的池中
+        const auto sheet = std::dynamic_pointer_cast<SheetData>(m_source);
+        const auto document = sheet ? sheet->document() : nullptr;
+        return snapshotOf(*m_cell, document ? document->stringPool() : nullptr);
+    }
+
     std::shared_ptr<OpenXLSX::XLCell> cell() const
     {
         return m_cell;
@@ -42,7 +101,8 @@ public:
     QString address() const
     {
         if (m_cell) {
-            return QString::fromStdString(m_cell->cellReference().address());
+            const auto reference = m_cell->cellReference();
+            return CellReference::formatA1({reference.row(), reference.column()}).toQString();
         }
         return m_address;
     }
@@ -58,6 +118,7 @@ public:
 
 private:
     std::shared_ptr<OpenXLSX::XLCell> m_cell;
-    QString m_address;  // 用于虚拟单元格
-    QVariant m_value;   // 用于虚拟单元格
+    QString m_address;  // 用于快照和虚拟单元格
+    QVariant m_value;   // 用于快照和虚拟单元格
+    std::shared_ptr<QtNodes::NodeData> m_source;
 };
@@ -6,6 +6,7 @@
 
 #include <QtNodes/NodeData>
 #include <QList>
+#include <algorithm>
 #include "CellData.hpp"
 
 /**
@@ -15,6 +16,8 @@
  * - 循环处理的结果
  * - 筛选后的单元格集合
  * - 批量操作的目标单元格
+ *
+ * 调用detach()后所有单元格都成为快照，values()和addresses()不再访问文档。
  */
 class CellListData : public QtNodes::NodeData
 {
@@ -49,6 +52,28 @@ public:
         }
     }
     
+    /**
+     * @brief 将活动单元格转换为快照，每个单元格只读取一次
+     */
+    void detach()
+    {
+        for (auto& cell : m_cells) {
+            if (!cell.isSnapshot()) {
+                cell = cell.detached();
+            }
+        }
+    }
+
+    /**
+     * @brief 是否所有单元格都是快照
+     */
+    bool isDetached() const
+    {
+        return std::all_of(m_cells.begin(), m_cells.end(), [](const CellData& cell) {
+            return cell.isSnapshot();
+        });
+    }
+
     void clear() 
     {
         m_cells.clear();
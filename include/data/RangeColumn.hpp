@@ -0,0 +1,482 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include "StringPool.hpp"
+#include <QString>
+#include <QVariant>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief RangeData的列式存储
+ *
+ * 每一列只保存一种类型的连续数组（int64、double、bool或字符串句柄），
+ * 并用位图标记空值。列扫描时可以直接通过span访问原始数组，
+ * 不再需要为每个单元格构造QVariant。
+ *
+ * 与列类型不一致的少量单元格（例如数值列中的表头文本）保存在稀疏的例外表中，
+ * 因此通过value()读取到的值与写入时一致；int和uint与qint64一样按整数存储，读回时为qint64。
+ *
+ * 字符串句柄属于列持有的驻留池（stringPool()）。同一次读取产生的列共用一个池，
+ * 复制列时共享同一个池，池随最后一个引用它的列（或文档、读取器）释放。
+ */
+class RangeColumn
+{
+public:
+    /**
+     * @brief 列的存储类型
+     */
+    enum class Type : uint8_t {
+        Empty,      ///< 尚无类型化数据
+        Boolean,    ///< bool数组
+        Integer,    ///< int64数组
+        Double,     ///< double数组
+        String,     ///< 字符串句柄数组，句柄属于列的驻留池
+        Variant     ///< 无法类型化存储的值（仅用于分类，不会作为列类型）
+    };
+
+    RangeColumn() = default;
+
+    /**
+     * @brief 创建指定存储类型的空列
+     * @param type 存储类型，之后写入的其他类型值进入例外表
+     * @param reserveRows 预留的行数
+     * @param pool 字符串使用的驻留池，为空时在第一次写入字符串时创建
+     */
+    explicit RangeColumn(Type type, int reserveRows = 0, std::shared_ptr<StringPool> pool = {})
+        : m_pool(std::move(pool))
+    {
+        resetType(type == Type::Variant ? Type::Empty : type);
+        reserve(reserveRows);
+    }
+
+    /**
+     * @brief 根据一列值创建列，选择出现次数最多的类型作为存储类型
+     * @param values 该列所有行的值
+     * @param pool 字符串使用的驻留池，为空时创建新的池
+     * @return 构建好的列
+     */
+    static RangeColumn fromValues(const std::vector<QVariant>& values, std::shared_ptr<StringPool> pool = {})
+    {
+        int counts[static_cast<int>(Type::Variant) + 1] = {};
+        for (const auto& value : values) {
+            counts[static_cast<int>(classify(value))]++;
+        }
+
+        Type dominant = Type::Empty;
+        int best = 0;
+        for (Type type : {Type::Boolean, Type::Integer, Type::Double, Type::String}) {
+            if (counts[static_cast<int>(type)] > best) {
+                best = counts[static_cast<int>(type)];
+                dominant = type;
+            }
+        }
+
+        RangeColumn column;
+        column.m_pool = std::move(pool);
+        column.resetType(dominant);
+        column.reserve(static_cast<int>(values.size()));
+        for (const auto& value : values) {
+            column.append(value);
+        }
+        return column;
+    }
+
+    /**
+     * @brief 判断一个值对应的存储类型
+     */
+    static Type classify(const QVariant& value)
+    {
+        if (!value.isValid()) {
+            return Type::Empty;
+        }
+        switch (value.typeId()) {
+            case QMetaType::Bool: return Type::Boolean;
+            case QMetaType::Int:
+            case QMetaType::UInt:
+            case QMetaType::LongLong: return Type::Integer;
+            case QMetaType::Double: return Type::Double;
+            case QMetaType::QString: return Type::String;
+            default: return Type::Variant;
+        }
+    }
+
+    Type type() const { return m_type; }
+    int size() const { return m_size; }
+
+    /**
+     * @brief 预留行容量
+     */
+    void reserve(int rows)
+    {
+        m_nullBits.reserve((rows + 63) / 64);
+        switch (m_type) {
+            case Type::Boolean: m_bool.reserve(rows); break;
+            case Type::Integer: m_int64.reserve(rows); break;
+            case Type::Double: m_double.reserve(rows); break;
+            case Type::String: m_stringHandles.reserve(rows); break;
+            default: break;
+        }
+    }
+
+    /**
+     * @brief 检查类型化数组中该行是否有值
+     * @return 如果该行为空或保存在例外表中则返回false
+     */
+    bool hasTypedValue(int row) const
+    {
+        return row >= 0 && row < m_size && !(m_nullBits[row >> 6] & (uint64_t(1) << (row & 63)));
+    }
+
+    /**
+     * @brief 检查单元格是否为空
+     */
+    bool isNull(int row) const
+    {
+        if (hasTypedValue(row)) {
+            return false;
+        }
+        return m_exceptions.find(row) == m_exceptions.end();
+    }
+
+    /**
+     * @brief 获取单元格值
+     * @param row 行索引（0开始）
+     * @return 单元格值，空单元格返回无效QVariant
+     */
+    QVariant value(int row) const
+    {
+        if (!hasTypedValue(row)) {
+            auto it = m_exceptions.find(row);
+            return it != m_exceptions.end() ? it->second : QVariant();
+        }
+
+        switch (m_type) {
+            case Type::Boolean: return QVariant(m_bool[row] != 0);
+            case Type::Integer: return QVariant(static_cast<qint64>(m_int64[row]));
+            case Type::Double: return QVariant(m_double[row]);
+            case Type::String: return QVariant(m_pool->string(m_stringHandles[row]));
+            default: return QVariant();
+        }
+    }
+
+    /**
+     * @brief 获取整列的值
+     */
+    std::vector<QVariant> values() const
+    {
+        std::vector<QVariant> result;
+        result.reserve(m_size);
+        for (int row = 0; row < m_size; ++row) {
+            result.push_back(value(row));
+        }
+        return result;
+    }
+
+    /**
+     * @brief 在列尾追加一个值
+     */
+    void append(const QVariant& value)
+    {
+        if (m_size % 64 == 0) {
+            m_nullBits.push_back(0);
+        }
+        const int row = m_size++;
+
+        // 为类型化数组追加占位元素，保持数组长度与行数一致
+        switch (m_type) {
+            case Type::Boolean: m_bool.push_back(0); break;
+            case Type::Integer: m_int64.push_back(0); break;
+            case Type::Double: m_double.push_back(0.0); break;
+            case Type::String: m_stringHandles.push_back(0); break;
+            default: break;
+        }
+
+        setValue(row, value);
+    }
+
+    // ===== 类型化追加：列类型一致时直接写入原始数组，不构造QVariant =====
+
+    void appendNull()
+    {
+        if (m_size % 64 == 0) {
+            m_nullBits.push_back(0);
+        }
+        const int row = m_size++;
+        switch (m_type) {
+            case Type::Boolean: m_bool.push_back(0); break;
+            case Type::Integer: m_int64.push_back(0); break;
+            case Type::Double: m_double.push_back(0.0); break;
+            case Type::String: m_stringHandles.push_back(0); break;
+            default: break;
+        }
+        m_nullBits[row >> 6] |= uint64_t(1) << (row & 63);
+    }
+
+    void appendInt64(int64_t value)
+    {
+        if (!appendTypedSlot(Type::Integer)) {
+            append(QVariant(static_cast<qint64>(value)));
+            return;
+        }
+        m_int64.back() = value;
+    }
+
+    void appendDouble(double value)
+    {
+        if (!appendTypedSlot(Type::Double)) {
+            append(QVariant(value));
+            return;
+        }
+        m_double.back() = value;
+    }
+
+    void appendBool(bool value)
+    {
+        if (!appendTypedSlot(Type::Boolean)) {
+            append(QVariant(value));
+            return;
+        }
+        m_bool.back() = value ? 1 : 0;
+    }
+
+    /**
+     * @brief 追加字符串句柄
+     * @param handle 必须是本列驻留池（stringPool()）中的句柄
+     */
+    void appendString(StringPool::Handle handle)
+    {
+        if (!appendTypedSlot(Type::String)) {
+            append(QVariant(m_pool->string(handle)));
+            return;
+        }
+        m_stringHandles.back() = handle;
+    }
+
+    /**
+     * @brief 把UTF-8文本驻留到本列的池中并追加
+     */
+    void appendUtf8(std::string_view utf8)
+    {
+        appendString(stringPool()->intern(utf8));
+    }
+
+    /**
+     * @brief 在列尾追加另一列的全部行
+     *
+     * 两列类型相同（或其中一列没有类型化数据）时按数组整段拼接，
+     * 否则以行数多的一方的类型为准逐个值追加。
+     */
+    void appendColumn(const RangeColumn& other)
+    {
+        // 还没有字符串时直接沿用另一列的池，之后整段拼接句柄
+        if (other.m_pool && (m_type != Type::String || m_size == 0)) {
+            m_pool = other.m_pool;
+        }
+        if (m_type == Type::Empty && other.m_type != Type::Empty) {
+            resetType(other.m_type);
+        }
+        if (other.m_type != Type::Empty && other.m_type != m_type) {
+            // 类型不同时以行数多的一方为准，例如表头文本加上大量数值
+            if (other.m_size > m_size) {
+                RangeColumn merged;
+                merged.resetType(other.m_type);
+                merged.reserve(m_size + other.m_size);
+                for (int row = 0; row < m_size; ++row) {
+                    merged.append(value(row));
+                }
+                merged.appendColumn(other);
+                *this = std::move(merged);
+                return;
+            }
+            for (int row = 0; row < other.m_size; ++row) {
+                append(other.value(row));
+            }
+            return;
+        }
+
+        const int offset = m_size;
+        const int newSize = m_size + other.m_size;
+        // 另一列没有类型化数据时，只需补齐占位元素
+        if (other.m_type == Type::Empty) {
+            switch (m_type) {
+                case Type::Boolean: m_bool.resize(newSize, 0); break;
+                case Type::Integer: m_int64.resize(newSize, 0); break;
+                case Type::Double: m_double.resize(newSize, 0.0); break;
+                case Type::String: m_stringHandles.resize(newSize, 0); break;
+                default: break;
+            }
+        } else {
+            switch (m_type) {
+                case Type::Boolean: m_bool.insert(m_bool.end(), other.m_bool.begin(), other.m_bool.end()); break;
+                case Type::Integer: m_int64.insert(m_int64.end(), other.m_int64.begin(), other.m_int64.end()); break;
+                case Type::Double: m_double.insert(m_double.end(), other.m_double.begin(), other.m_double.end()); break;
+                case Type::String: appendHandles(other); break;
+                default: break;
+            }
+        }
+
+        m_nullBits.resize((newSize + 63) / 64, 0);
+        for (int row = 0; row < other.m_size; ++row) {
+            if (!other.hasTypedValue(row)) {
+                const int target = offset + row;
+                m_nullBits[target >> 6] |= uint64_t(1) << (target & 63);
+            }
+        }
+        for (const auto& [row, value] : other.m_exceptions) {
+            m_exceptions.emplace(offset + row, value);
+        }
+        m_size = newSize;
+    }
+
+    /**
+     * @brief 设置单元格值
+     * @param row 行索引（0开始）
+     * @param value 新值
+     */
+    void setValue(int row, const QVariant& value)
+    {
+        if (row < 0 || row >= m_size) {
+            return;
+        }
+
+        m_exceptions.erase(row);
+        Type valueType = classify(value);
+
+        // 列还没有类型时，由第一个可类型化的值决定列类型
+        if (m_type == Type::Empty && valueType != Type::Empty && valueType != Type::Variant) {
+            resetType(valueType);
+        }
+
+        if (valueType == m_type && valueType != Type::Empty) {
+            switch (m_type) {
+                case Type::Boolean: m_bool[row] = value.toBool() ? 1 : 0; break;
+                case Type::Integer: m_int64[row] = value.toLongLong(); break;
+                case Type::Double: m_double[row] = value.toDouble(); break;
+                case Type::String: m_stringHandles[row] = stringPool()->intern(value.toString()); break;
+                default: break;
+            }
+            m_nullBits[row >> 6] &= ~(uint64_t(1) << (row & 63));
+            return;
+        }
+
+        m_nullBits[row >> 6] |= uint64_t(1) << (row & 63);
+        if (valueType != Type::Empty) {
+            m_exceptions.emplace(row, value);
+        }
+    }
+
+    // ===== 列式直接访问（仅当type()为对应类型时非空） =====
+
+    std::span<const int64_t> int64Values() const { return m_int64; }
+    std::span<const double> doubleValues() const { return m_double; }
+    std::span<const uint8_t> boolValues() const { return m_bool; }
+    std::span<const StringPool::Handle> stringHandles() const { return m_stringHandles; }
+
+    /**
+     * @brief stringHandles()中句柄所属的驻留池，还没有时创建
+     */
+    const std::shared_ptr<StringPool>& stringPool()
+    {
+        if (!m_pool) {
+            m_pool = std::make_shared<StringPool>();
+        }
+        return m_pool;
+    }
+
+    /**
+     * @brief stringHandles()中句柄所属的驻留池，列中没有字符串时可能为空
+     */
+    const std::shared_ptr<StringPool>& stringPool() const { return m_pool; }
+
+    /**
+     * @brief 空值位图，第row位为1表示该行在类型化数组中没有值
+     */
+    std::span<const uint64_t> nullBitmap() const { return m_nullBits; }
+
+    /**
+     * @brief 与列类型不一致的单元格（行索引 -> 值）
+     */
+    const std::unordered_map<int, QVariant>& exceptions() const { return m_exceptions; }
+
+    /**
+     * @brief 估算该列占用的内存（字节），不含驻留池中的字符串
+     */
+    size_t memoryUsage() const
+    {
+        size_t bytes = m_nullBits.capacity() * sizeof(uint64_t)
+                     + m_int64.capacity() * sizeof(int64_t)
+                     + m_double.capacity() * sizeof(double)
+                     + m_bool.capacity() * sizeof(uint8_t)
+                     + m_stringHandles.capacity() * sizeof(StringPool::Handle)
+                     + m_exceptions.size() * (sizeof(int) + sizeof(QVariant) + 2 * sizeof(void*));
+        return bytes;
+    }
+
+private:
+    // 拼接另一列的字符串句柄，两列的池不同时按内容重新驻留
+    void appendHandles(const RangeColumn& other)
+    {
+        if (other.m_pool == m_pool) {
+            m_stringHandles.insert(m_stringHandles.end(), other.m_stringHandles.begin(), other.m_stringHandles.end());
+            return;
+        }
+        auto& pool = *stringPool();
+        for (const StringPool::Handle handle : other.m_stringHandles) {
+            m_stringHandles.push_back(handle == StringPool::EmptyHandle ? handle : pool.intern(other.m_pool->string(handle)));
+        }
+    }
+
+    // 为类型化追加预留一行，列类型不匹配时返回false
+    bool appendTypedSlot(Type type)
+    {
+        if (m_type == Type::Empty) {
+            resetType(type);
+        }
+        if (m_type != type) {
+            return false;
+        }
+        if (m_size % 64 == 0) {
+            m_nullBits.push_back(0);
+        }
+        ++m_size;
+        switch (m_type) {
+            case Type::Boolean: m_bool.push_back(0); break;
+            case Type::Integer: m_int64.push_back(0); break;
+            case Type::Double: m_double.push_back(0.0); break;
+            case Type::String: m_stringHandles.push_back(0); break;
+            default: break;
+        }
+        return true;
+    }
+
+    void resetType(Type type)
+    {
+        m_type = type;
+        switch (m_type) {
+            case Type::Boolean: m_bool.assign(m_size, 0); break;
+            case Type::Integer: m_int64.assign(m_size, 0); break;
+            case Type::Double: m_double.assign(m_size, 0.0); break;
+            case Type::String: m_stringHandles.assign(m_size, 0); break;
+            default: break;
+        }
+    }
+
+private:
+    Type m_type = Type::Empty;                          ///< 列的存储类型
+    int m_size = 0;                                     ///< 行数
+    std::vector<uint64_t> m_nullBits;                   ///< 空值位图
+    std::vector<int64_t> m_int64;                       ///< Integer列数据
+    std::vector<double> m_double;                       ///< Double列数据
+    std::vector<uint8_t> m_bool;                        ///< Boolean列数据
+    std::vector<StringPool::Handle> m_stringHandles;    ///< String列的字符串句柄
+    std::shared_ptr<StringPool> m_pool;                 ///< 字符串句柄所属的驻留池
+    std::unordered_map<int, QVariant> m_exceptions;     ///< 与列类型不一致的单元格
+};
@@ -4,10 +4,12 @@
 
 #pragma once
 
+#include "RangeColumn.hpp"
 #include <QVariant>
 #include <QString>
 #include <QStringList>
 #include <QtNodes/NodeData>
+#include <memory>
 #include <vector>
 
 /**
@@ -15,8 +17,10 @@
  * 
  * 这个类用于在节点之间传递单元格范围的数据，包括：
  * - 范围地址（如"A1:C10"）
- * - 二维数据数组
+ * - 按列存储的类型化数据（见RangeColumn）
  * - 行列信息
+ *
+ * 数据按矩形存储，列数以第一行为准；按行访问的接口会从列中组装结果。
  */
 class RangeData : public QtNodes::NodeData
 {
@@ -27,10 +31,24 @@ public:
      * @brief 构造函数
      * @param rangeAddress 范围地址，如"A1:C10"
      * @param data 二维数据数组
+     * @param pool 各列共用的驻留池，data中的字符串来自该池时不需要再复制，为空时创建新的池
      */
-    explicit RangeData(const QString& rangeAddress, const std::vector<std::vector<QVariant>>& data)
-        : m_rangeAddress(rangeAddress), m_data(data)
+    explicit RangeData(const QString& rangeAddress, const std::vector<std::vector<QVariant>>& data,
+                       std::shared_ptr<StringPool> pool = {})
+        : m_rangeAddress(rangeAddress)
     {
+        setData(data, std::move(pool));
+    }
+
+    /**
+     * @brief 直接从列构造
+     * @param rangeAddress 范围地址
+     * @param columns 各列数据，行数以第一列为准
+     */
+    explicit RangeData(const QString& rangeAddress, std::vector<RangeColumn> columns)
+        : m_rangeAddress(rangeAddress), m_columns(std::move(columns))
+    {
+        m_rowCount = m_columns.empty() ? 0 : m_columns.front().size();
     }
 
     /**
@@ -61,20 +79,40 @@ public:
 
     /**
      * @brief 获取数据
-     * @return 二维数据数组
+     * @return 二维数据数组（从列式存储组装的副本）
      */
-    const std::vector<std::vector<QVariant>>& data() const
+    std::vector<std::vector<QVariant>> data() const
     {
-        return m_data;
+        std::vector<std::vector<QVariant>> result;
+        result.reserve(m_rowCount);
+        for (int row = 0; row < m_rowCount; ++row) {
+            result.push_back(rowData(row));
+        }
+        return result;
     }
 
     /**
      * @brief 设置数据
      * @param data 二维数据数组
+     * @param pool 各列共用的驻留池，为空时创建新的池
      */
-    void setData(const std::vector<std::vector<QVariant>>& data)
+    void setData(const std::vector<std::vector<QVariant>>& data, std::shared_ptr<StringPool> pool = {})
     {
-        m_data = data;
+        if (!pool) {
+            pool = std::make_shared<StringPool>();
+        }
+        m_columns.clear();
+        m_rowCount = static_cast<int>(data.size());
+        const int colCount = data.empty() ? 0 : static_cast<int>(data[0].size());
+        m_columns.reserve(colCount);
+
+        std::vector<QVariant> columnValues(m_rowCount);
+        for (int col = 0; col < colCount; ++col) {
+            for (int row = 0; row < m_rowCount; ++row) {
+                columnValues[row] = col < static_cast<int>(data[row].size()) ? data[row][col] : QVariant();
+            }
+            m_columns.push_back(RangeColumn::fromValues(columnValues, pool));
+        }
     }
 
     /**
@@ -83,7 +121,7 @@ public:
      */
     int rowCount() const
     {
-        return static_cast<int>(m_data.size());
+        return m_rowCount;
     }
 
     /**
@@ -92,7 +130,29 @@ public:
      */
     int columnCount() const
     {
-        return m_data.empty() ? 0 : static_cast<int>(m_data[0].size());
+        return m_rowCount == 0 ? 0 : static_cast<int>(m_columns.size());
+    }
+
+    /**
+     * @brief 获取指定列的存储
+     * @param col 列索引（0开始）
+     * @return 列存储，越界时返回空列
+     */
+    const RangeColumn& column(int col) const
+    {
+        static const RangeColumn emptyColumn;
+        if (col >= 0 && col < columnCount()) {
+            return m_columns[col];
+        }
+        return emptyColumn;
+    }
+
+    /**
+     * @brief 获取所有列的存储
+     */
+    const std::vector<RangeColumn>& columns() const
+    {
+        return m_columns;
     }
 
     /**
@@ -104,7 +164,7 @@ public:
     QVariant cellValue(int row, int col) const
     {
         if (row >= 0 && row < rowCount() && col >= 0 && col < columnCount()) {
-            return m_data[row][col];
+            return m_columns[col].value(row);
         }
         return QVariant();
     }
@@ -118,7 +178,7 @@ public:
     void setCellValue(int row, int col, const QVariant& value)
     {
         if (row >= 0 && row < rowCount() && col >= 0 && col < columnCount()) {
-            m_data[row][col] = value;
+            m_columns[col].setValue(row, value);
         }
     }
 
@@ -129,10 +189,14 @@ public:
      */
     std::vector<QVariant> rowData(int row) const
     {
+        std::vector<QVariant> result;
         if (row >= 0 && row < rowCount()) {
-            return m_data[row];
+            result.reserve(m_columns.size());
+            for (const auto& column : m_columns) {
+                result.push_back(column.value(row));
+            }
         }
-        return std::vector<QVariant>();
+        return result;
     }
 
     /**
@@ -142,15 +206,10 @@ public:
      */
     std::vector<QVariant> columnData(int col) const
     {
-        std::vector<QVariant> result;
         if (col >= 0 && col < columnCount()) {
-            for (const auto& row : m_data) {
-                if (col < static_cast<int>(row.size())) {
-                    result.push_back(row[col]);
-                }
-            }
+            return m_columns[col].values();
         }
-        return result;
+        return std::vector<QVariant>();
     }
 
     /**
@@ -159,7 +218,19 @@ public:
      */
     bool isEmpty() const
     {
-        return m_data.empty() || m_rangeAddress.isEmpty();
+        return m_rowCount == 0 || m_rangeAddress.isEmpty();
+    }
+
+    /**
+     * @brief 估算数据占用的内存（字节）
+     */
+    size_t memoryUsage() const
+    {
+        size_t bytes = 0;
+        for (const auto& column : m_columns) {
+            bytes += column.memoryUsage();
+        }
+        return bytes;
     }
 
     /**
@@ -181,10 +252,11 @@ public:
     std::vector<QStringList> toStringMatrix() const
     {
         std::vector<QStringList> result;
-        for (const auto& row : m_data) {
+        result.reserve(m_rowCount);
+        for (int row = 0; row < m_rowCount; ++row) {
             QStringList stringRow;
-            for (const auto& cell : row) {
-                stringRow.append(cell.toString());
+            for (const auto& column : m_columns) {
+                stringRow.append(column.value(row).toString());
             }
             result.push_back(stringRow);
         }
@@ -193,11 +265,23 @@ public:
 
     /**
      * @brief 添加新行
-     * @param rowData 新行的数据
+     * @param rowData 新行的数据，超出现有列数的值会被忽略
+     * @param pool 添加第一行时各列共用的驻留池，行中的字符串来自该池时不需要再复制，为空时创建新的池
      */
-    void addRow(const std::vector<QVariant>& rowData)
+    void addRow(const std::vector<QVariant>& rowData, std::shared_ptr<StringPool> pool = {})
     {
-        m_data.push_back(rowData);
+        // 第一行决定列数
+        if (m_rowCount == 0) {
+            if (!pool) {
+                pool = std::make_shared<StringPool>();
+            }
+            m_columns.assign(rowData.size(), RangeColumn(RangeColumn::Type::Empty, 0, std::move(pool)));
+        }
+
+        for (size_t col = 0; col < m_columns.size(); ++col) {
+            m_columns[col].append(col < rowData.size() ? rowData[col] : QVariant());
+        }
+        ++m_rowCount;
     }
 
     /**
@@ -205,11 +289,13 @@ public:
      */
     void clear()
     {
-        m_data.clear();
+        m_columns.clear();
+        m_rowCount = 0;
         m_rangeAddress.clear();
     }
 
 private:
     QString m_rangeAddress;                        ///< 范围地址，如"A1:C10"
-    std::vector<std::vector<QVariant>> m_data;     ///< 二维数据数组
+    std::vector<RangeColumn> m_columns;            ///< 按列存储的数据
+    int m_rowCount = 0;                            ///< 行数
 };
@@ -0,0 +1,135 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <QtNodes/NodeData>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "RowData.hpp"
+
+/**
+ * @brief 分批传递的行流
+ *
+ * 大表不再作为一个完整的RangeData在节点之间传递，而是按固定行数分批发送，
+ * 每个中间节点只持有当前批次，内存占用与总行数无关。
+ * 一次完整的流由同一streamId的三类消息组成，按顺序经过同一个输出端口：
+ * - Begin：流开始，携带列数和总行数（未知时为-1），下游据此重置状态
+ * - Batch：若干连续的行，每行是带有rowIndex/totalRows的RowData
+ * - End：流结束，携带实际行数；errorMessage非空表示读取失败，cancelled表示被取消
+ *
+ * 下游节点在setInData中按kind()处理：转换节点对每个批次生成新的批次并转发，
+ * Begin/End原样转发（或替换列数），不需要等待整个流结束。
+ * 批次在节点之间共享，接收方不能修改。
+ */
+class RowBatchData : public QtNodes::NodeData
+{
+public:
+    enum class Kind
+    {
+        Begin,
+        Batch,
+        End
+    };
+
+    /// 默认每批行数
+    static constexpr int DefaultBatchSize = 4096;
+
+    RowBatchData() = default;
+
+    /**
+     * @brief 分配新的流标识
+     */
+    static quint64 nextStreamId()
+    {
+        static std::atomic<quint64> counter{0};
+        return ++counter;
+    }
+
+    static std::shared_ptr<RowBatchData> begin(quint64 streamId, int columnCount, int totalRows = -1)
+    {
+        auto data = std::make_shared<RowBatchData>();
+        data->m_kind = Kind::Begin;
+        data->m_streamId = streamId;
+        data->m_columnCount = columnCount;
+        data->m_totalRows = totalRows;
+        return data;
+    }
+
+    /**
+     * @param rows 连续的行，第一行的rowIndex为该批次在流中的起始位置
+     */
+    static std::shared_ptr<RowBatchData> batch(quint64 streamId, std::vector<RowData> rows, int columnCount, int totalRows = -1)
+    {
+        auto data = std::make_shared<RowBatchData>();
+        data->m_kind = Kind::Batch;
+        data->m_streamId = streamId;
+        data->m_rows = std::move(rows);
+        data->m_columnCount = columnCount;
+        data->m_totalRows = totalRows;
+        return data;
+    }
+
+    /**
+     * @param rowCount 流中实际的总行数
+     * @param errorMessage 失败原因，成功时为空
+     */
+    static std::shared_ptr<RowBatchData> end(quint64 streamId, int rowCount,
+                                             const QString& errorMessage = QString(), bool cancelled = false)
+    {
+        auto data = std::make_shared<RowBatchData>();
+        data->m_kind = Kind::End;
+        data->m_streamId = streamId;
+        data->m_totalRows = rowCount;
+        data->m_errorMessage = errorMessage;
+        data->m_cancelled = cancelled;
+        return data;
+    }
+
+    QtNodes::NodeDataType type() const override
+    {
+        return {"rowbatch", "RowBatch"};
+    }
+
+    Kind kind() const { return m_kind; }
+    bool isBegin() const { return m_kind == Kind::Begin; }
+    bool isBatch() const { return m_kind == Kind::Batch; }
+    bool isEnd() const { return m_kind == Kind::End; }
+
+    quint64 streamId() const { return m_streamId; }
+
+    /**
+     * @brief 批次中的行，只有Batch有数据
+     */
+    const std::vector<RowData>& rows() const { return m_rows; }
+
+    int rowCount() const { return static_cast<int>(m_rows.size()); }
+
+    /**
+     * @brief 批次第一行在流中的位置（从0开始），空批次返回-1
+     */
+    int firstRowIndex() const { return m_rows.empty() ? -1 : m_rows.front().rowIndex(); }
+
+    int columnCount() const { return m_columnCount; }
+
+    /**
+     * @brief 总行数：Begin和Batch中未知时为-1，End中为实际行数
+     */
+    int totalRows() const { return m_totalRows; }
+
+    bool succeeded() const { return m_kind == Kind::End && !m_cancelled && m_errorMessage.isEmpty(); }
+    bool isCancelled() const { return m_cancelled; }
+    const QString& errorMessage() const { return m_errorMessage; }
+
+private:
+    Kind m_kind = Kind::Batch;
+    quint64 m_streamId = 0;
+    std::vector<RowData> m_rows;
+    int m_columnCount = 0;
+    int m_totalRows = -1;
+    QString m_errorMessage;
+    bool m_cancelled = false;
+};
@@ -17,6 +17,9 @@
  * - 行索引（从0开始）
  * - 该行的所有列数据
  * - 行的元数据信息
+ *
+ * 流式读取产生的行（见RowBatchStream）中的文本来自读取器的驻留池，
+ * 相同文本共享池中的同一份缓冲区；QVariant中的QString与句柄一样只占一个指针，因此不再另存句柄。
  */
 class RowData : public QtNodes::NodeData
 {
@@ -4,10 +4,23 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <XLSheet.hpp>
 #include <QtNodes/NodeData>
 
+#include "WorkbookDocument.hpp"
+
+/**
+ * @brief 工作表数据
+ *
+ * 从共享文档创建时只保存工作表名称，第一次访问工作表内容时才解析工作表XML。
+ * SheetData存活期间，对应工作表的DOM不会被释放。访问DOM时先通过lockDom()锁定所在的文档，
+ * 这样可以在任意工作线程中读取，同一文档的读取依次执行。
+ * 解码后的值（values()）挂在文档的工作表状态上，引用同一工作表的SheetData共用一份。
+ */
 class SheetData : public QtNodes::NodeData
 {
 public:
@@ -18,6 +31,16 @@ public:
     {
     }
 
+    /**
+     * @brief 按需加载的工作表
+     * @param document 工作表所在的文档
+     * @param name 工作表名称
+     */
+    SheetData(std::shared_ptr<WorkbookDocument> document, const std::string& name)
+        : m_sheetName(name), m_document(std::move(document)), m_entry(m_document->sheetEntry(name))
+    {
+    }
+
     QtNodes::NodeDataType type() const override
     {
         return {"sheet", "Worksheet"};
@@ -28,12 +51,55 @@ public:
         return m_sheetName;
     }
 
+    /**
+     * @brief 锁定所在文档的DOM，访问worksheet()期间持有（见WorkbookDocument::lockDom()）
+     * @return 不是从共享文档创建时返回不持有任何锁的对象
+     */
+    [[nodiscard]] std::unique_lock<std::mutex> lockDom() const
+    {
+        return m_document ? m_document->lockDom() : std::unique_lock<std::mutex>();
+    }
+
+    // 调用方必须持有lockDom()
     OpenXLSX::XLWorksheet& worksheet()
     {
+        if (m_document) {
+            return m_document->worksheet(*m_entry);
+        }
         return m_xlsxWorksheet;
     }
 
+    // 工作表是否已经访问过，访问过的工作表XML通常已经解析
+    bool isLoaded() const
+    {
+        return !m_document || m_entry->worksheet.has_value();
+    }
+
+    std::shared_ptr<WorkbookDocument> document() const
+    {
+        return m_document;
+    }
+
+    /**
+     * @brief 工作表解码后的值，没有时调用build构建
+     * @return 不是从共享文档创建或build返回nullptr时为nullptr
+     */
+    std::shared_ptr<const SheetValueCache> values(const std::function<std::shared_ptr<const SheetValueCache>()>& build) const
+    {
+        return m_document ? m_document->sheetValues(*m_entry, build) : nullptr;
+    }
+
+    /**
+     * @brief 已经构建的解码值，不会构建
+     */
+    std::shared_ptr<const SheetValueCache> cachedValues() const
+    {
+        return m_document ? m_document->cachedSheetValues(*m_entry) : nullptr;
+    }
+
 private:
     std::string m_sheetName;
     OpenXLSX::XLWorksheet m_xlsxWorksheet;
+    std::shared_ptr<WorkbookDocument> m_document;
+    std::shared_ptr<WorkbookDocument::SheetEntry> m_entry;
 };
@@ -0,0 +1,350 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QAnyStringView>
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <QUtf8StringView>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <XLSharedStrings.hpp>
+
+/**
+ * @brief 字符串驻留池
+ *
+ * 单元格文本在表格中通常大量重复（状态码、地区名、共享字符串等），
+ * 驻留池为每个不同的字符串只保存一份QString，列中只需保存32位句柄，
+ * 取出的QString通过隐式共享引用池中的同一份缓冲区。
+ *
+ * 驻留池由使用它的数据通过shared_ptr共同持有：工作簿文档（WorkbookDocument::stringPool()）、
+ * 一次CSV读取、RangeData的各列等，最后一个持有者释放时池中的字符串随之释放。
+ * 句柄只在所属的池中有意义。
+ *
+ * - 只保存QString一种编码；按UTF-8内容查找时按码点计算哈希并直接比较，命中时不需要解码
+ * - 条目按段存放，段分配后不再移动，写入的条目不再修改，string()和view()不加锁
+ * - intern()查找时加读锁，只有插入新字符串时加写锁
+ * - 可以用工作簿的共享字符串表预先填充，每个共享字符串只解码一次
+ */
+class StringPool
+{
+public:
+    using Handle = uint32_t;
+
+    /// 空字符串的句柄
+    static constexpr Handle EmptyHandle = 0;
+
+    StringPool()
+    {
+        insert(QString(), hashOf(QStringView()));
+    }
+
+    ~StringPool()
+    {
+        for (auto& segment : m_segments) {
+            delete[] segment.load(std::memory_order_relaxed);
+        }
+    }
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    /**
+     * @brief 驻留UTF-8字符串
+     * @param utf8 UTF-8编码的文本
+     * @return 字符串句柄
+     */
+    Handle intern(std::string_view utf8)
+    {
+        const size_t hash = hashOf(utf8);
+        const QUtf8StringView key(utf8.data(), static_cast<qsizetype>(utf8.size()));
+        {
+            std::shared_lock lock(m_indexMutex);
+            if (const Handle handle = find(hash, key); handle != InvalidHandle) {
+                return handle;
+            }
+        }
+
+        // 在锁外解码，避免长字符串阻塞其他线程
+        QString str = QString::fromUtf8(utf8.data(), static_cast<qsizetype>(utf8.size()));
+
+        std::unique_lock lock(m_indexMutex);
+        if (const Handle handle = find(hash, key); handle != InvalidHandle) {
+            return handle;
+        }
+        return insert(std::move(str), hash);
+    }
+
+    /**
+     * @brief 驻留QString，新字符串与传入的QString共享缓冲区
+     * @param str 文本
+     * @return 字符串句柄
+     */
+    Handle intern(const QString& str)
+    {
+        const size_t hash = hashOf(QStringView(str));
+        {
+            std::shared_lock lock(m_indexMutex);
+            if (const Handle handle = find(hash, QStringView(str)); handle != InvalidHandle) {
+                return handle;
+            }
+        }
+
+        std::unique_lock lock(m_indexMutex);
+        if (const Handle handle = find(hash, QStringView(str)); handle != InvalidHandle) {
+            return handle;
+        }
+        return insert(str, hash);
+    }
+
+    /**
+     * @brief 根据句柄获取字符串，不加锁
+     * @param handle 字符串句柄
+     * @return 与池共享缓冲区的QString，无效句柄返回空字符串
+     */
+    QString string(Handle handle) const
+    {
+        const QString* slot = entry(handle);
+        return slot ? *slot : QString();
+    }
+
+    /**
+     * @brief 根据句柄获取文本视图，不加锁
+     * @return 指向池中数据的视图，在池的生命周期内有效
+     */
+    QStringView view(Handle handle) const
+    {
+        const QString* slot = entry(handle);
+        return slot ? QStringView(*slot) : QStringView();
+    }
+
+    /**
+     * @brief 驻留UTF-8字符串并返回共享的QString
+     */
+    QString pooled(std::string_view utf8)
+    {
+        return string(intern(utf8));
+    }
+
+    /**
+     * @brief 用工作簿的共享字符串表填充驻留池
+     * @param sharedStrings 共享字符串表
+     * @return 共享字符串索引到句柄的映射表
+     */
+    std::vector<Handle> seed(const OpenXLSX::XLSharedStrings& sharedStrings)
+    {
+        const int32_t count = sharedStrings.stringCount();
+        std::vector<Handle> handles;
+        handles.reserve(count);
+        for (int32_t i = 0; i < count; ++i) {
+            handles.push_back(intern(std::string_view(sharedStrings.getString(i))));
+        }
+        return handles;
+    }
+
+    /**
+     * @brief 已驻留的字符串数量
+     */
+    size_t size() const
+    {
+        return m_size.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr Handle InvalidHandle = ~Handle(0);
+
+    /// 第k段容纳(1 << FirstSegmentBits) << k个条目，所有段合计接近2^32个；第一段很小，空池几乎不占内存
+    static constexpr int FirstSegmentBits = 6;
+    static constexpr int SegmentCount = 26;
+
+    // 句柄 -> 段号和段内下标
+    static std::pair<int, size_t> locate(Handle handle)
+    {
+        const uint64_t position = uint64_t(handle) + (uint64_t(1) << FirstSegmentBits);
+        const int segment = std::bit_width(position) - 1 - FirstSegmentBits;
+        return {segment, static_cast<size_t>(position - (uint64_t(1) << (segment + FirstSegmentBits)))};
+    }
+
+    // m_size以release发布，读到的句柄范围内的段和条目都已写好
+    const QString* entry(Handle handle) const
+    {
+        if (handle >= m_size.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        const auto [segment, offset] = locate(handle);
+        return m_segments[segment].load(std::memory_order_acquire) + offset;
+    }
+
+    // 调用者必须持有锁
+    template<typename View>
+    Handle find(size_t hash, View key) const
+    {
+        const auto [begin, end] = m_index.equal_range(hash);
+        for (auto it = begin; it != end; ++it) {
+            if (QAnyStringView::equal(key, view(it->second))) {
+                return it->second;
+            }
+        }
+        return InvalidHandle;
+    }
+
+    // 调用者必须持有写锁
+    Handle insert(QString str, size_t hash)
+    {
+        const auto handle = static_cast<Handle>(m_size.load(std::memory_order_relaxed));
+        const auto [segment, offset] = locate(handle);
+        if (segment >= SegmentCount) {
+            throw std::length_error("StringPool: too many strings");
+        }
+
+        QString* slots = m_segments[segment].load(std::memory_order_relaxed);
+        if (!slots) {
+            slots = new QString[size_t(1) << (segment + FirstSegmentBits)];
+            m_segments[segment].store(slots, std::memory_order_release);
+        }
+        slots[offset] = std::move(str);
+        m_index.emplace(hash, handle);
+        m_size.store(handle + 1, std::memory_order_release);
+        return handle;
+    }
+
+    // 按Unicode码点计算FNV-1a哈希，同一文本的UTF-8和UTF-16形式结果相同。
+    // 无效的UTF-8字节按U+FFFD计算，与解码结果不一致时只会多驻留一份，不影响正确性
+    static constexpr uint64_t HashOffset = 14695981039346656037ull;
+    static constexpr uint64_t HashPrime = 1099511628211ull;
+
+    static size_t hashOf(QStringView text)
+    {
+        uint64_t hash = HashOffset;
+        for (qsizetype i = 0; i < text.size(); ++i) {
+            char32_t codePoint = text[i].unicode();
+            if (QChar::isHighSurrogate(codePoint) && i + 1 < text.size() && text[i + 1].isLowSurrogate()) {
+                codePoint = QChar::surrogateToUcs4(text[i], text[i + 1]);
+                ++i;
+            }
+            hash = (hash ^ codePoint) * HashPrime;
+        }
+        return static_cast<size_t>(hash);
+    }
+
+    static size_t hashOf(std::string_view utf8)
+    {
+        uint64_t hash = HashOffset;
+        for (size_t i = 0; i < utf8.size();) {
+            const auto lead = static_cast<unsigned char>(utf8[i]);
+            char32_t codePoint = lead;
+            size_t length = 1;
+            if (lead >= 0x80) {
+                length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+                codePoint = lead & (0x7F >> length);
+                for (size_t k = 1; k < length; ++k) {
+                    const auto next = i + k < utf8.size() ? static_cast<unsigned char>(utf8[i + k]) : 0;
+                    if ((next & 0xC0) != 0x80) {
+                        length = 0;
+                        break;
+                    }
+                    codePoint = (codePoint << 6) | (next & 0x3F);
+                }
+                if (length == 0) {
+                    codePoint = 0xFFFD;
+                    length = 1;
+                }
+            }
+            hash = (hash ^ codePoint) * HashPrime;
+            i += length;
+        }
+        return static_cast<size_t>(hash);
+    }
+
+private:
+    std::array<std::atomic<QString*>, SegmentCount> m_segments{};  ///< 条目段，分配后不再移动
+    std::atomic<uint32_t> m_size{0};                                ///< 已发布的条目数
+    mutable std::shared_mutex m_indexMutex;                         ///< 保护m_index
+    std::unordered_multimap<size_t, Handle> m_index;                ///< 码点哈希 -> 句柄
+};
+
+/**
+ * @brief 为来自一个或多个驻留池的字符串分配连续的下标，相同文本只分配一个下标
+ *
+ * 写出共享字符串表或缓存文件的字符串表时使用。同一个池中的句柄只按内容查找一次，
+ * 用到的驻留池在索引器的生命周期内保持有效，句柄不会因为池被释放而失效。
+ */
+class StringIndexer
+{
+public:
+    /**
+     * @brief 驻留池中字符串的下标
+     * @param pool 句柄所属的池，为空时按空字符串处理（还没有写入过字符串的列）
+     * @return 下标，以及文本是否第一次出现
+     */
+    std::pair<uint32_t, bool> indexOf(const std::shared_ptr<StringPool>& pool, StringPool::Handle handle)
+    {
+        if (!pool) {
+            return indexOf(QString());
+        }
+        if (pool.get() != m_lastPool) {
+            auto& known = m_pools[pool.get()];
+            if (!known.pool) {
+                known.pool = pool;
+            }
+            m_lastPool = pool.get();
+            m_lastHandles = &known.handles;
+        }
+
+        const auto it = m_lastHandles->find(handle);
+        if (it != m_lastHandles->end()) {
+            return {it->second, false};
+        }
+        const auto result = indexOf(pool->string(handle));
+        m_lastHandles->emplace(handle, result.first);
+        return result;
+    }
+
+    /**
+     * @brief 文本的下标
+     * @return 下标，以及文本是否第一次出现
+     */
+    std::pair<uint32_t, bool> indexOf(const QString& text)
+    {
+        const auto it = m_indices.constFind(text);
+        if (it != m_indices.constEnd()) {
+            return {it.value(), false};
+        }
+        const auto index = static_cast<uint32_t>(m_strings.size());
+        m_indices.insert(text, index);
+        m_strings.push_back(text);
+        return {index, true};
+    }
+
+    /**
+     * @brief 按下标排列的所有文本
+     */
+    const std::vector<QString>& strings() const { return m_strings; }
+
+private:
+    struct PoolHandles
+    {
+        std::shared_ptr<const StringPool> pool;                 ///< 保持池有效
+        std::unordered_map<StringPool::Handle, uint32_t> handles;
+    };
+
+    std::unordered_map<const StringPool*, PoolHandles> m_pools;
+    const StringPool* m_lastPool = nullptr;                     ///< 上一次查找的池，连续的句柄通常来自同一列
+    std::unordered_map<StringPool::Handle, uint32_t>* m_lastHandles = nullptr;
+    QHash<QString, uint32_t> m_indices;                         ///< 文本 -> 下标
+    std::vector<QString> m_strings;                             ///< 下标 -> 文本
+};
@@ -7,15 +7,19 @@
 #include <QtNodes/NodeData>
 
 #include <XLWorkbook.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "WorkbookDocument.hpp"
 
 class WorkbookData : public QtNodes::NodeData
 {
 public:
     WorkbookData() = default;
 
-    explicit WorkbookData(OpenXLSX::XLWorkbook workbook,OpenXLSX::XLDocument* doc)
-    : m_workbook(std::make_shared<OpenXLSX::XLWorkbook>(workbook)),
-    m_document(doc)
+    explicit WorkbookData(std::shared_ptr<WorkbookDocument> document)
+    : m_document(std::move(document))
     {
     }
 
@@ -24,22 +28,32 @@ public:
         return {"workbook", "Workbook"};
     }
 
-    std::shared_ptr<OpenXLSX::XLWorkbook> workbook() const { return m_workbook; }
+    // 锁定文档的DOM，访问workbook()及由它取得的对象期间持有（见WorkbookDocument::lockDom()）
+    [[nodiscard]] std::unique_lock<std::mutex> lockDom() const
+    {
+        return m_document ? m_document->lockDom() : std::unique_lock<std::mutex>();
+    }
 
-    OpenXLSX::XLDocument* document() const { return m_document; }
-    
-    bool isValid() const { return m_workbook != nullptr && m_document != nullptr; }
+    // 每次从文档获取，不持有工作簿对象；调用方必须持有lockDom()
+    std::shared_ptr<OpenXLSX::XLWorkbook> workbook() const
+    {
+        return m_document ? std::make_shared<OpenXLSX::XLWorkbook>(m_document->workbook()) : nullptr;
+    }
 
-    ~WorkbookData() override
+    OpenXLSX::XLDocument* document() const { return m_document ? m_document->document() : nullptr; }
+
+    // 共享的文档对象，同一文件的多个WorkbookData引用同一份
+    std::shared_ptr<WorkbookDocument> sharedDocument() const { return m_document; }
+
+    bool isValid() const { return m_document != nullptr; }
+
+    // 共享字符串索引到文档驻留池中句柄的映射
+    const std::vector<StringPool::Handle>& sharedStringHandles() const
     {
-        if (m_document != nullptr)
-        {
-            m_document->close();
-            delete m_document;
-        }
+        static const std::vector<StringPool::Handle> empty;
+        return m_document ? m_document->sharedStringHandles() : empty;
     }
-    
+
 private:
-    std::shared_ptr<OpenXLSX::XLWorkbook> m_workbook;
-    OpenXLSX::XLDocument* m_document;
+    std::shared_ptr<WorkbookDocument> m_document;
 };
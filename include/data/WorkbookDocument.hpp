@@ -0,0 +1,218 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include <QString>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <XLDocument.hpp>
+#include <XLSheet.hpp>
+
+#include "StringPool.hpp"
+
+class SheetValueCache;
+
+/**
+ * @brief 已解析的Excel文档
+ *
+ * 持有OpenXLSX::XLDocument及其派生信息，由WorkbookCache按文件共享，
+ * 多个WorkbookData可以引用同一个文档。最后一个引用释放时关闭文档。
+ *
+ * sheetEntry()只登记工作表，第一次调用worksheet()时才创建工作表对象，
+ * OpenXLSX在第一次访问工作表内容时才从压缩包解析XML。releaseIdleSheets()逐个释放空闲工作表的DOM
+ * （XLXmlFile::releaseXmlData()），再次访问时从压缩包重新解析，其他工作表和文档本身不受影响。
+ *
+ * OpenXLSX文档不能被多个线程同时访问。任何线程都可以读取文档，但访问DOM期间
+ * （workbook()、worksheet()以及由它们取得的对象）必须持有lockDom()返回的锁。
+ * 锁按文档划分，不同工作簿的读取可以在多个线程中并行执行。
+ * 加锁顺序：SheetEntry::valuesMutex、DOM锁、内部的工作表状态锁，sheetValues()的build中才能获取DOM锁。
+ *
+ * 每个工作表还可以挂一份解码后的值（SheetValueCache），同一工作表的所有读取节点共用，
+ * 第一次读取时填充。文件变化后WorkbookCache会打开新的文档，旧的值随旧文档一起失效。
+ */
+class WorkbookDocument
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// 默认的工作表空闲释放时间
+    static constexpr std::chrono::seconds DefaultSheetIdleTime{60};
+
+    /**
+     * @brief 单个工作表的加载状态
+     */
+    struct SheetEntry
+    {
+        std::string name;                                   ///< 工作表名称
+        std::optional<OpenXLSX::XLWorksheet> worksheet;     ///< 已创建的工作表对象，未访问时为空
+        Clock::time_point lastAccess;                       ///< 最后一次访问时间
+        std::mutex valuesMutex;                             ///< 保证解码值只构建一次，只在构建时持有
+        std::shared_ptr<const SheetValueCache> values;      ///< 解码后的值，未构建时为空，由m_sheetsMutex保护
+    };
+
+    /**
+     * @brief 构造函数
+     * @param filePath 文件路径
+     * @param document 已打开的文档，所有权转移给本对象
+     */
+    WorkbookDocument(const QString& filePath, std::unique_ptr<OpenXLSX::XLDocument> document)
+        : m_filePath(filePath), m_document(std::move(document)), m_stringPool(std::make_shared<StringPool>())
+    {
+    }
+
+    ~WorkbookDocument()
+    {
+        m_sheets.clear();
+        if (m_document) {
+            m_document->close();
+        }
+    }
+
+    WorkbookDocument(const WorkbookDocument&) = delete;
+    WorkbookDocument& operator=(const WorkbookDocument&) = delete;
+
+    const QString& filePath() const { return m_filePath; }
+
+    OpenXLSX::XLDocument* document() const { return m_document.get(); }
+
+    OpenXLSX::XLWorkbook workbook() const { return m_document->workbook(); }
+
+    /**
+     * @brief 锁定文档DOM，访问workbook()、worksheet()及其派生对象期间持有
+     */
+    [[nodiscard]] std::unique_lock<std::mutex> lockDom() { return std::unique_lock(m_domMutex); }
+
+    // 文档的字符串驻留池，读取本文档的数据共用，最后一个持有者释放时随之释放
+    const std::shared_ptr<StringPool>& stringPool() const { return m_stringPool; }
+
+    // 共享字符串索引到stringPool()中句柄的映射，打开工作簿时填充
+    const std::vector<StringPool::Handle>& sharedStringHandles() const { return m_sharedStringHandles; }
+
+    void setSharedStringHandles(std::vector<StringPool::Handle> handles) { m_sharedStringHandles = std::move(handles); }
+
+    /**
+     * @brief 获取工作表的状态，不会解析工作表XML
+     * @param name 工作表名称
+     * @return 同名工作表共享同一个状态对象
+     */
+    std::shared_ptr<SheetEntry> sheetEntry(const std::string& name)
+    {
+        std::lock_guard lock(m_sheetsMutex);
+        auto& entry = m_sheets[name];
+        if (!entry) {
+            entry = std::make_shared<SheetEntry>();
+            entry->name = name;
+        }
+        return entry;
+    }
+
+    /**
+     * @brief 获取工作表，调用方必须持有lockDom()
+     * @param entry sheetEntry()返回的状态对象
+     * @return 工作表引用，entry仍被引用期间有效
+     */
+    OpenXLSX::XLWorksheet& worksheet(SheetEntry& entry)
+    {
+        std::lock_guard lock(m_sheetsMutex);
+        entry.lastAccess = Clock::now();
+        if (!entry.worksheet) {
+            entry.worksheet = m_document->workbook().worksheet(entry.name);
+        }
+        return *entry.worksheet;
+    }
+
+    /**
+     * @brief 获取工作表解码后的值，没有时调用build构建并保存
+     * @param entry sheetEntry()返回的状态对象
+     * @param build 构建函数，返回nullptr表示不能构建，此时不保存
+     *
+     * 同一工作表同时只有一个线程在构建，其他调用sheetValues()的线程等待并直接使用构建结果。
+     * 调用时不能持有lockDom()，build访问DOM时自己加锁。
+     */
+    std::shared_ptr<const SheetValueCache> sheetValues(SheetEntry& entry,
+                                                       const std::function<std::shared_ptr<const SheetValueCache>()>& build)
+    {
+        std::lock_guard valuesLock(entry.valuesMutex);
+        {
+            std::lock_guard lock(m_sheetsMutex);
+            entry.lastAccess = Clock::now();
+            if (entry.values) {
+                return entry.values;
+            }
+        }
+
+        auto values = build();
+        std::lock_guard lock(m_sheetsMutex);
+        entry.values = values;
+        return values;
+    }
+
+    /**
+     * @brief 已经构建的解码值，没有时返回nullptr
+     *
+     * 不会构建，也不会等待正在进行的构建，可以在GUI线程中调用。
+     */
+    std::shared_ptr<const SheetValueCache> cachedSheetValues(SheetEntry& entry)
+    {
+        std::lock_guard lock(m_sheetsMutex);
+        if (entry.values) {
+            entry.lastAccess = Clock::now();
+        }
+        return entry.values;
+    }
+
+    /**
+     * @brief 释放空闲工作表
+     * @param idleTime 超过该时间未访问的工作表才会被释放
+     * @param releaseDom 是否释放已解析的DOM。释放后从压缩包重新解析，文件已被修改时应传false，避免读到新的内容
+     * @return 释放的工作表数量
+     *
+     * 仍被SheetData引用的工作表不会释放，因为下游可能持有其中的单元格，其他空闲工作表照常释放。
+     * 只释放内存，不重新打开文档，耗时与工作表大小无关，可以在GUI线程中调用；
+     * 其他线程正在读取文档时不等待，直接跳过本次释放。已经取得的SheetValueCache不受影响。
+     */
+    int releaseIdleSheets(std::chrono::milliseconds idleTime = DefaultSheetIdleTime, bool releaseDom = true)
+    {
+        std::unique_lock domLock(m_domMutex, std::try_to_lock);
+        if (!domLock) {
+            return 0;
+        }
+        std::lock_guard lock(m_sheetsMutex);
+        const auto now = Clock::now();
+        int released = 0;
+        for (auto& [name, entry] : m_sheets) {
+            if (entry.use_count() > 1 || now - entry->lastAccess < idleTime) {
+                continue;
+            }
+            if (!entry->worksheet && !entry->values) {
+                continue;
+            }
+            // 没有SheetData引用时不会有线程在构建解码值，不需要锁valuesMutex
+            entry->values.reset();
+            if (entry->worksheet && releaseDom) {
+                entry->worksheet->releaseXmlData();
+            }
+            entry->worksheet.reset();
+            ++released;
+        }
+        return released;
+    }
+
+private:
+    QString m_filePath;
+    std::unique_ptr<OpenXLSX::XLDocument> m_document;
+    std::shared_ptr<StringPool> m_stringPool;
+    std::vector<StringPool::Handle> m_sharedStringHandles;
+    std::mutex m_domMutex;                                          ///< 串行化对文档DOM的访问
+    std::mutex m_sheetsMutex;
+    std::map<std::string, std::shared_ptr<SheetEntry>> m_sheets;    ///< 已登记的工作表
+};
@@ -10,6 +10,7 @@
 #include <QtNodes/DataFlowGraphModel>
 #include <QtNodes/DataFlowGraphicsScene>
 #include <QtNodes/ConnectionIdUtils>
+#include "TinaFlowGraphModel.hpp"
 #include "TinaFlowGraphicsView.hpp"
 #include "widget/ModernToolBar.hpp"
 #include "widget/ADSPanelManager.hpp"
@@ -137,6 +138,7 @@ private:
 
     void setGlobalExecutionState(bool running);
     void triggerDataFlow();
+    void triggerSourceNode(QtNodes::NodeId nodeId);
     
     // 端口类型描述方法
     QString getPortTypeDescription(QtNodes::NodeDelegateModel* nodeModel, QtNodes::PortType portType, QtNodes::PortIndex portIndex);
@@ -153,7 +155,7 @@ private:
     
     Ui::MainWindow *ui;
 
-    std::unique_ptr<QtNodes::DataFlowGraphModel> m_graphModel;
+    std::unique_ptr<TinaFlowGraphModel> m_graphModel;
     TinaFlowGraphicsView* m_graphicsView;
     QtNodes::DataFlowGraphicsScene* m_graphicsScene;
     
@@ -5,8 +5,13 @@
 #pragma once
 
 #include "IPropertyProvider.hpp"
+#include "ErrorHandler.hpp"
+#include "WorkStealingPool.hpp"
 #include <QtNodes/NodeDelegateModel>
+#include <QFutureWatcher>
+#include <QPromise>
 #include <QJsonObject>
+#include <QTimer>
 #include <QDebug>
 #include <QWidget>
 #include <QLineEdit>
@@ -15,6 +20,11 @@
 #include <QCheckBox>
 #include <QTextEdit>
 #include <QLabel>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
 
 // 前向声明
 class StyledLineEdit;
@@ -32,17 +42,70 @@ class StyledLineEdit;
  * 1. 调用registerProperty()注册需要保存的属性
  * 2. 重写getNodeTypeName()返回节点类型名称
  * 3. 可选择重写onSave()和onLoad()进行自定义处理
+ *
+ * 耗时的计算通过startCompute()在工作线程中执行：任务从GUI线程拿到输入和参数的快照，
+ * 通过ComputeContext报告进度、检查是否已取消，返回的ApplyResult回到GUI线程应用。
+ * 停止按钮对所有节点调用cancelExecution()。
+ *
+ * 输入框等连续变化的参数通过scheduleParameterUpdate()合并，停止输入后才重新计算一次。
  */
 class BaseNodeModel : public QtNodes::NodeDelegateModel, public PropertyProviderBase
 {
     Q_OBJECT
 
 public:
+    /**
+     * @brief 节点计算可以在哪个线程中执行
+     */
+    enum class ThreadAffinity {
+        GuiThread,  ///< 计算时访问控件或非线程安全的状态，只在GUI线程中执行（默认）
+        AnyThread   ///< 实现了createConcurrentTask()，运行时可以在工作线程中与其他节点并行计算
+    };
+
+    /// 在GUI线程中应用计算结果：保存输出、更新控件并发出dataUpdated
+    using ApplyResult = std::function<void()>;
+
+    /**
+     * @brief 工作线程中的计算上下文：报告进度、检查是否已取消
+     *
+     * 进度在GUI线程中通过onComputeProgress()送达。取消是协作式的，
+     * 任务需要在循环中检查isCancelled()，取消后返回的结果不会被应用。
+     */
+    class ComputeContext
+    {
+    public:
+        explicit ComputeContext(QPromise<ApplyResult>& promise) : m_promise(promise) {}
+
+        bool isCancelled() const { return m_promise.isCanceled(); }
+
+        void setProgressRange(int minimum, int maximum) { m_promise.setProgressRange(minimum, maximum); }
+        void setProgress(int value) { m_promise.setProgressValue(value); }
+        void setProgress(int value, const QString& text) { m_promise.setProgressValueAndText(value, text); }
+
+    private:
+        QPromise<ApplyResult>& m_promise;
+    };
+
+    /// 在工作线程中执行的计算，不能访问控件，返回应用结果的函数（已取消时可以返回空函数）
+    using ConcurrentTask = std::function<ApplyResult(ComputeContext& context)>;
+
+    /// 一次交付的输入：端口 -> 数据
+    using Inputs = std::map<QtNodes::PortIndex, std::shared_ptr<QtNodes::NodeData>>;
+
+    /// 参数编辑的合并窗口（毫秒）
+    static constexpr int ParameterEditDelayMs = 300;
+
     BaseNodeModel() = default;
     ~BaseNodeModel() override {
         // 断开所有信号连接，避免悬空指针
         disconnect();
 
+        // 工作线程中的任务只持有快照，通知它尽快结束，结果不再应用
+        if (m_computeWatcher) {
+            m_computeWatcher->disconnect();
+            m_computeWatcher->cancel();
+        }
+
         // 清理注册的属性控件
         for (auto& prop : m_properties) {
             if (prop.widget) {
@@ -93,7 +156,215 @@ public:
         onLoad(json);
     }
 
+    virtual ThreadAffinity threadAffinity() const
+    {
+        return ThreadAffinity::GuiThread;
+    }
+
+    /**
+     * @brief 在GUI线程中保存输入、读取参数，返回可以在工作线程中执行的计算
+     *
+     * 只对threadAffinity()为AnyThread的节点调用（见TinaFlowGraphModel），返回的任务通过startCompute()执行。
+     * @param inputs 本次交付的输入
+     * @return 返回空函数时改为在GUI线程中逐个调用setInData()
+     */
+    virtual ConcurrentTask createConcurrentTask(const Inputs& inputs)
+    {
+        Q_UNUSED(inputs);
+        return {};
+    }
+
+    /**
+     * @brief 参数和输入都没有变化时，运行能否复用上一次计算的输出（见TinaFlowGraphModel）
+     *
+     * 默认不复用，不可复用节点的下游也总是重新计算。只有输出完全由save()、输入和externalState()
+     * 决定的节点才应返回true；依赖分批到达的数据、已解码值缓存、脚本等其他状态的节点保持false。
+     */
+    virtual bool isMemoizable() const
+    {
+        return false;
+    }
+
+    /**
+     * @brief 节点读写的外部状态（例如文件的大小和修改时间），变化时即使参数和输入相同也重新计算
+     */
+    virtual QString externalState() const
+    {
+        return {};
+    }
+
+    /**
+     * @brief 正在进行的计算是否要等运行中的其他节点都完成后才能结束（例如等待合并写入）
+     *
+     * 运行中仍在计算的节点都是这样的节点时，TinaFlowGraphModel发出runDrained()。
+     */
+    virtual bool isDeferredToRunEnd() const
+    {
+        return false;
+    }
+
+    /**
+     * @brief 取消正在进行的计算（由停止按钮调用）
+     *
+     * 默认取消startCompute()开始的计算，自己管理后台任务的节点重写此方法。
+     */
+    virtual void cancelExecution()
+    {
+        cancelCompute();
+    }
+
+    bool isComputing() const { return m_computing; }
+
+    /**
+     * @brief 在工作线程中开始计算，之前尚未完成的计算被取消，其结果不再应用
+     *
+     * 开始时发出computingStarted，结果在GUI线程中应用后（或被取消时）发出computingFinished。
+     * 任务抛出的异常在GUI线程中通过ErrorHandler报告，之后同样发出computingFinished。
+     * @param task 计算任务，只能使用在GUI线程中捕获的快照
+     * @return 计算结果，可以用于等待或取消
+     */
+    QFuture<ApplyResult> startCompute(ConcurrentTask task)
+    {
+        auto promise = startPendingCompute();
+        WorkStealingPool::instance().submit([this, promise, task = std::move(task)]() {
+            ComputeContext context(*promise);
+            ApplyResult apply;
+            try {
+                apply = task(context);
+            } catch (...) {
+                // 异常带回GUI线程报告，this只在应用结果时访问
+                apply = [this, error = std::current_exception()]() { reportComputeError(error); };
+            }
+            if (apply && !promise->isCanceled()) {
+                promise->addResult(std::move(apply));
+            }
+            promise->finish();
+        });
+        return promise->future();
+    }
+
+    /**
+     * @brief 开始由其他对象完成的计算（例如等待WorkbookWriteSession合并写入）
+     *
+     * 与startCompute()一样取代尚未完成的计算并发出computingStarted，节点在完成前一直处于计算状态，
+     * 流程运行会等待它。可以多次调用addResult()（例如每个子任务一个结果），每个结果到达时在GUI线程中
+     * 按顺序应用；全部完成后调用finish()。释放未完成的promise等同于完成且没有更多结果。
+     * @return 本次计算的promise，已经开始
+     */
+    std::shared_ptr<QPromise<ApplyResult>> startPendingCompute()
+    {
+        if (!m_computeWatcher) {
+            m_computeWatcher = new QFutureWatcher<ApplyResult>(this);
+            connect(m_computeWatcher, &QFutureWatcher<ApplyResult>::progressValueChanged, this, [this](int value) {
+                const auto future = m_computeWatcher->future();
+                onComputeProgress(value, future.progressMinimum(), future.progressMaximum(), future.progressText());
+            });
+            // 范围变为0到0（忙碌）时不一定伴随进度值的变化，单独通知
+            connect(m_computeWatcher, &QFutureWatcher<ApplyResult>::progressRangeChanged, this, [this](int minimum, int maximum) {
+                const auto future = m_computeWatcher->future();
+                onComputeProgress(future.progressValue(), minimum, maximum, future.progressText());
+            });
+            connect(m_computeWatcher, &QFutureWatcher<ApplyResult>::resultReadyAt, this, &BaseNodeModel::onComputeResult);
+            connect(m_computeWatcher, &QFutureWatcher<ApplyResult>::finished, this, &BaseNodeModel::onComputeFinished);
+        }
+
+        // 被取代的计算只通知取消，不发出computingFinished，由新的计算接着报告
+        if (m_computing) {
+            m_computeWatcher->cancel();
+        }
+        m_computing = true;
+
+        auto promise = std::make_shared<QPromise<ApplyResult>>();
+        promise->start();
+
+        // setFuture()会丢弃上一次计算尚未送达的通知
+        m_computeWatcher->setFuture(promise->future());
+        emit computingStarted();
+        return promise;
+    }
+
+    /**
+     * @brief 取消正在进行的计算，结果不再应用
+     */
+    void cancelCompute()
+    {
+        if (!m_computing) {
+            return;
+        }
+        m_computing = false;
+        m_computeWatcher->cancel();
+        qDebug() << getNodeTypeName() << ": Compute cancelled";
+        emit computingFinished();
+    }
+
+    /**
+     * @brief 合并连续的参数编辑：窗口内多次调用时，只在最后一次之后执行一次update
+     *
+     * 正在进行的计算使用的是旧参数，立即取消，不必等它完成。
+     * @param update 重新计算，执行时从控件读取最新的参数
+     * @param delayMs 最后一次编辑之后等待的时间
+     */
+    void scheduleParameterUpdate(std::function<void()> update, int delayMs = ParameterEditDelayMs)
+    {
+        if (!m_parameterTimer) {
+            m_parameterTimer = new QTimer(this);
+            m_parameterTimer->setSingleShot(true);
+            connect(m_parameterTimer, &QTimer::timeout, this, [this]() {
+                if (auto update = std::exchange(m_pendingUpdate, {})) {
+                    update();
+                }
+            });
+        }
+
+        cancelCompute();
+        m_pendingUpdate = std::move(update);
+        m_parameterTimer->start(delayMs);
+    }
+
+    /**
+     * @brief 丢弃尚未执行的参数编辑，节点已经用最新的参数开始计算时调用
+     */
+    void cancelParameterUpdate()
+    {
+        if (m_parameterTimer) {
+            m_parameterTimer->stop();
+        }
+        m_pendingUpdate = {};
+    }
+
+    /**
+     * @brief 运行调度器一次交付多个输入端口时，在第一个setInData()之前调用
+     *
+     * 到endInputs()为止inputsPending()为true，有多个输入的节点可以在setInData()中
+     * 只保存输入，在onInputsReady()中计算一次（见TinaFlowGraphModel）。
+     */
+    void beginInputs() { m_inputsPending = true; }
+
+    /**
+     * @brief 所有端口都已交付，调用onInputsReady()
+     */
+    void endInputs()
+    {
+        m_inputsPending = false;
+        onInputsReady();
+    }
+
 protected:
+    // 是否还有端口的输入尚未交付
+    bool inputsPending() const { return m_inputsPending; }
+
+    // 一次交付的所有输入都已到达，默认不做任何处理（每次setInData()都已计算）
+    virtual void onInputsReady() {}
+
+    // 计算进度，在GUI线程中调用，默认不做任何处理
+    virtual void onComputeProgress(int value, int minimum, int maximum, const QString& text)
+    {
+        Q_UNUSED(value);
+        Q_UNUSED(minimum);
+        Q_UNUSED(maximum);
+        Q_UNUSED(text);
+    }
+
     // 属性注册系统
     struct PropertyInfo {
         QString name;
@@ -223,6 +494,40 @@ private:
         }
     }
 
+    // 在GUI线程中报告计算任务抛出的异常
+    void reportComputeError(const std::exception_ptr& error)
+    {
+        SAFE_EXECUTE({
+            std::rethrow_exception(error);
+        }, embeddedWidget(), getNodeTypeName(), "后台计算");
+    }
+
+    // 计算结果到达，在GUI线程中应用
+    void onComputeResult(int index)
+    {
+        if (!m_computing || m_computeWatcher->isCanceled()) {
+            return;
+        }
+        if (const auto apply = m_computeWatcher->resultAt(index)) {
+            apply();
+        }
+    }
+
+    // 计算结束，结果都已应用
+    void onComputeFinished()
+    {
+        if (!m_computing) {
+            return;
+        }
+        m_computing = false;
+        emit computingFinished();
+    }
+
 private:
     QList<PropertyInfo> m_properties;
+    bool m_inputsPending = false;
+    QFutureWatcher<ApplyResult>* m_computeWatcher = nullptr;
+    bool m_computing = false;
+    QTimer* m_parameterTimer = nullptr;
+    std::function<void()> m_pendingUpdate;
 };
@@ -120,6 +120,11 @@ public:
         return m_widget;
     }
 
+    // 输出只由保存的常量决定
+    bool isMemoizable() const override {
+        return true;
+    }
+
     QJsonObject save() const override {
         QJsonObject modelJson = BaseNodeModel::save();
         modelJson["valueType"] = static_cast<int>(m_valueType);
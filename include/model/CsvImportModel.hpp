@@ -0,0 +1,307 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include "BaseNodeModel.hpp"
+#include "OpenExcelModel.hpp"
+#include "CsvReader.hpp"
+#include "WorkbookCache.hpp"
+#include "data/RangeData.hpp"
+#include "widget/PropertyWidget.hpp"
+#include "ErrorHandler.hpp"
+#include "DataValidator.hpp"
+#include "PerformanceProfiler.hpp"
+
+#include <QComboBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QProgressBar>
+#include <QVBoxLayout>
+#include <QWidget>
+
+/**
+ * @brief CSV/TSV导入节点
+ *
+ * 通过startCompute()在工作线程中用CsvReader并行解析文本文件，直接输出RangeData，
+ * 下游可以像使用ReadRange的输出一样使用它。与OpenExcel一样作为源节点，
+ * 由运行按钮触发执行，停止按钮可以取消正在进行的读取。
+ */
+class CsvImportModel : public BaseNodeModel
+{
+public:
+    CsvImportModel()
+    {
+        m_widget = new QWidget();
+        auto* layout = new QVBoxLayout(m_widget);
+        layout->setContentsMargins(4, 4, 4, 4);
+        layout->setSpacing(2);
+
+        m_lineEdit = new ClickableLineEdit();
+        m_lineEdit->setPlaceholderText("未选择CSV文件");
+        m_lineEdit->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+        layout->addWidget(m_lineEdit);
+
+        m_delimiterCombo = new QComboBox();
+        m_delimiterCombo->addItems(delimiterNames());
+        m_delimiterCombo->setToolTip("自动：.tsv/.tab为制表符，其他文件根据首行判断");
+        layout->addWidget(m_delimiterCombo);
+
+        // 读取进度条，仅在后台读取时显示
+        m_progressBar = new QProgressBar();
+        m_progressBar->setRange(0, CsvReader::ProgressMax);
+        m_progressBar->setTextVisible(true);
+        m_progressBar->setFormat("读取中 %p%");
+        m_progressBar->setFixedHeight(14);
+        m_progressBar->hide();
+        layout->addWidget(m_progressBar);
+
+        connect(m_lineEdit, &ClickableLineEdit::clicked, this, &CsvImportModel::chooseFile);
+        // 读取完成或取消
+        connect(this, &CsvImportModel::computingFinished, m_progressBar, &QProgressBar::hide);
+
+        // 注册属性
+        registerComboBox("delimiter", m_delimiterCombo, "分隔符");
+    }
+
+    [[nodiscard]] QString caption() const override
+    {
+        return "导入CSV";
+    }
+
+    [[nodiscard]] QString name() const override
+    {
+        return {"ImportCsv"};
+    }
+
+    QWidget* embeddedWidget() override
+    {
+        return m_widget;
+    }
+
+    unsigned int nPorts(QtNodes::PortType portType) const override
+    {
+        return portType == QtNodes::PortType::Out ? 1 : 0;
+    }
+
+    QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        return RangeData().type();
+    }
+
+    std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex const port) override
+    {
+        return m_rangeData;
+    }
+
+    void setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex const portIndex) override
+    {
+    }
+
+public:
+    // 由运行按钮触发执行
+    void triggerExecution()
+    {
+        qDebug() << "CsvImportModel: Execution triggered";
+        compute();
+    }
+
+    // 输出只由文件路径、分隔符和文件内容决定
+    bool isMemoizable() const override
+    {
+        return true;
+    }
+
+    // 文件被修改后重新运行时需要重新读取
+    QString externalState() const override
+    {
+        return WorkbookCache::FileStamp::of(m_filePath).toString();
+    }
+
+private:
+    static QStringList delimiterNames()
+    {
+        return {"自动", "逗号", "制表符", "分号"};
+    }
+
+    char delimiter() const
+    {
+        switch (m_delimiterCombo->currentIndex()) {
+            case 1: return ',';
+            case 2: return '\t';
+            case 3: return ';';
+            default: return CsvReader::AutoDelimiter;
+        }
+    }
+
+    void compute()
+    {
+        PROFILE_NODE("CsvImportModel");
+
+        if (m_filePath.isEmpty()) {
+            m_rangeData = nullptr;
+            return;
+        }
+
+        SAFE_EXECUTE({
+            auto validation = DataValidator::validateCsvFile(m_filePath);
+            if (!validation.isValid) {
+                throw TinaFlowException::fileNotFound(m_filePath);
+            }
+
+            // 在工作线程中解析新文件，尚未完成的读取被取消；停止按钮同样取消读取
+            m_progressBar->setValue(0);
+            m_progressBar->show();
+            startCompute([this, filePath = m_filePath, delimiter = delimiter()](ComputeContext& context) -> ApplyResult {
+                context.setProgressRange(0, CsvReader::ProgressMax);
+                std::shared_ptr<RangeData> range;
+                QString errorMessage;
+                try {
+                    range = CsvReader::read(filePath, delimiter,
+                        [&context]() { return context.isCancelled(); },
+                        [&context](int value) { context.setProgress(value); });
+                } catch (const std::exception& e) {
+                    errorMessage = QString("无法读取CSV文件: %1 - %2").arg(filePath).arg(e.what());
+                }
+                if (context.isCancelled()) {
+                    return {};
+                }
+                return [this, range, errorMessage]() { applyReadResult(range, errorMessage); };
+            });
+
+            qDebug() << "CsvImportModel: Reading CSV file in background:" << m_filePath;
+
+        }, m_widget, "CsvImportModel", "导入CSV文件");
+    }
+
+    // 读取结束后在GUI线程中应用结果，下游节点在此之后才会被运行调度器执行
+    void applyReadResult(const std::shared_ptr<RangeData>& range, const QString& errorMessage)
+    {
+        SAFE_EXECUTE({
+            if (!range) {
+                TINAFLOW_THROW(FileCorrupted, errorMessage);
+            }
+
+            m_rangeData = range;
+            Q_EMIT dataUpdated(0);
+
+            qDebug() << "CsvImportModel: Imported" << m_rangeData->rowCount() << "rows from" << m_filePath;
+
+        }, m_widget, "CsvImportModel", "导入CSV文件");
+    }
+
+    void chooseFile()
+    {
+        SAFE_EXECUTE({
+            const QString path = QFileDialog::getOpenFileName(nullptr, "导入CSV文件", {}, "CSV文件 (*.csv *.tsv *.tab *.txt)");
+            if (path.isEmpty()) {
+                return; // 用户取消选择
+            }
+
+            auto validation = DataValidator::validateCsvFile(path);
+            if (!validation.isValid) {
+                SHOW_WARNING(validation.errorMessage, validation.suggestions.join("\n"), m_widget);
+                return;
+            }
+
+            setFilePath(path);
+            compute();
+
+        }, m_widget, "CsvImportModel", "选择CSV文件");
+    }
+
+    void setFilePath(const QString& path)
+    {
+        m_filePath = path;
+        m_lineEdit->setToolTip(path);
+        m_lineEdit->setText(QFileInfo(path).fileName());
+    }
+
+protected:
+    QString getNodeTypeName() const override
+    {
+        return "CsvImportModel";
+    }
+
+    void onComputeProgress(int value, int minimum, int maximum, const QString& text) override
+    {
+        Q_UNUSED(minimum);
+        Q_UNUSED(maximum);
+        Q_UNUSED(text);
+        m_progressBar->setValue(value);
+    }
+
+    QString getDisplayName() const override
+    {
+        return "导入CSV";
+    }
+
+    QString getDescription() const override
+    {
+        return "读取CSV/TSV文本文件并输出范围数据";
+    }
+
+    void onSave(QJsonObject& json) const override
+    {
+        json["file"] = m_filePath;
+    }
+
+    void onLoad(const QJsonObject& json) override
+    {
+        setFilePath(json["file"].toString());
+        // 加载时不自动执行，等待用户点击运行按钮
+        qDebug() << "CsvImportModel: File path loaded, waiting for execution trigger";
+    }
+
+    bool createPropertyPanel(PropertyWidget* propertyWidget) override
+    {
+        propertyWidget->addTitle("CSV导入设置");
+        propertyWidget->addDescription("读取CSV/TSV文件，大文件会在后台分块并行解析");
+
+        propertyWidget->addModeToggleButtons();
+
+        propertyWidget->addFilePathProperty("文件路径", m_filePath,
+            "filePath", "CSV文件 (*.csv *.tsv *.tab *.txt);;所有文件 (*)", false,
+            [this](const QString& newPath) {
+                if (!newPath.isEmpty() && newPath != m_filePath) {
+                    setFilePath(newPath);
+                    qDebug() << "CsvImportModel: File path changed to" << newPath << "(no auto execution)";
+                }
+            });
+
+        propertyWidget->addComboProperty("分隔符", delimiterNames(),
+            m_delimiterCombo->currentIndex(), "delimiter", [this](int index) {
+                m_delimiterCombo->setCurrentIndex(index);
+            });
+
+        if (m_rangeData) {
+            propertyWidget->addSeparator();
+            propertyWidget->addTitle("数据信息");
+            propertyWidget->addInfoProperty("行数", QString::number(m_rangeData->rowCount()), "color: #666;");
+            propertyWidget->addInfoProperty("列数", QString::number(m_rangeData->columnCount()), "color: #666;");
+        }
+
+        return true;
+    }
+
+    void onPropertyChanged(const QString& propertyName, const QVariant& value) override
+    {
+        if (propertyName == "filePath") {
+            QString newPath = value.toString();
+            if (!newPath.isEmpty() && newPath != m_filePath) {
+                setFilePath(newPath);
+            }
+        } else if (propertyName == "delimiter") {
+            m_delimiterCombo->setCurrentIndex(value.toInt());
+        }
+    }
+
+private:
+    QWidget* m_widget;
+    ClickableLineEdit* m_lineEdit;
+    QComboBox* m_delimiterCombo;
+    QProgressBar* m_progressBar;
+    QString m_filePath;
+    std::shared_ptr<RangeData> m_rangeData;
+};
@@ -109,29 +109,10 @@ protected:
         }
 
         try {
-            auto cell = data->cell();
-            if (!cell) {
-                return "单元格为空";
-            }
-
-            // 获取单元格地址
-            QString address = QString::fromStdString(cell->cellReference().address());
-
-            // 获取单元格值
-            QString value;
-            if (cell->value().type() == OpenXLSX::XLValueType::Empty) {
-                value = "(空)";
-            } else if (cell->value().type() == OpenXLSX::XLValueType::Boolean) {
-                value = cell->value().get<bool>() ? "TRUE" : "FALSE";
-            } else if (cell->value().type() == OpenXLSX::XLValueType::Integer) {
-                value = QString::number(cell->value().get<int64_t>());
-            } else if (cell->value().type() == OpenXLSX::XLValueType::Float) {
-                value = QString::number(cell->value().get<double>(), 'g', 6);
-            } else if (cell->value().type() == OpenXLSX::XLValueType::String) {
-                value = QString::fromStdString(cell->value().get<std::string>());
-            } else {
-                value = "未知类型";
-            }
+            // 活动单元格只读取一次，快照直接使用保存的值
+            const CellData cell = data->detached();
+            QString address = cell.address();
+            QString value = formatValue(cell.value(), 6);
 
             // 限制预览长度
             if (value.length() > 30) {
@@ -159,35 +140,14 @@ protected:
         }
 
         try {
-            auto cell = cellData->cell();
-            
-            // 获取单元格地址
-            QString address = QString::fromStdString(cell->cellReference().address());
+            // 活动单元格只读取一次，快照直接使用保存的值
+            const CellData cell = cellData->detached();
+            QString address = cell.address();
             m_addressLabel->setText(QString("地址: %1").arg(address));
             
-            // 获取单元格值
-            QString value;
-            QString type;
-            
-            if (cell->value().type() == OpenXLSX::XLValueType::Empty) {
-                value = "(空)";
-                type = "Empty";
-            } else if (cell->value().type() == OpenXLSX::XLValueType::Boolean) {
-                value = cell->value().get<bool>() ? "TRUE" : "FALSE";
-                type = "Boolean";
-            } else if (cell->value().type() == OpenXLSX::XLValueType::Integer) {
-                value = QString::number(cell->value().get<int64_t>());
-                type = "Integer";
-            } else if (cell->value().type() == OpenXLSX::XLValueType::Float) {
-                value = QString::number(cell->value().get<double>(), 'g', 10);
-                type = "Float";
-            } else if (cell->value().type() == OpenXLSX::XLValueType::String) {
-                value = QString::fromStdString(cell->value().get<std::string>());
-                type = "String";
-            } else {
-                value = "(未知类型)";
-                type = "Unknown";
-            }
+            const QVariant cellValue = cell.value();
+            QString value = formatValue(cellValue, 10);
+            QString type = valueTypeName(cellValue);
             
             m_valueLabel->setText(QString("值: %1").arg(value));
             m_typeLabel->setText(QString("类型: %1").arg(type));
@@ -256,6 +216,34 @@ protected:
     }
 
 private:
+    // 值的显示文本，浮点数按precision位有效数字显示
+    static QString formatValue(const QVariant& value, int precision)
+    {
+        switch (value.typeId()) {
+            case QMetaType::UnknownType:
+                return "(空)";
+            case QMetaType::Bool:
+                return value.toBool() ? "TRUE" : "FALSE";
+            case QMetaType::Double:
+                return QString::number(value.toDouble(), 'g', precision);
+            default:
+                return value.toString();
+        }
+    }
+
+    // 与SheetReader的值类型对应
+    static QString valueTypeName(const QVariant& value)
+    {
+        switch (value.typeId()) {
+            case QMetaType::UnknownType: return "Empty";
+            case QMetaType::Bool: return "Boolean";
+            case QMetaType::LongLong: return "Integer";
+            case QMetaType::Double: return "Float";
+            case QMetaType::QString: return "String";
+            default: return value.typeName();
+        }
+    }
+
     QWidget* m_widget;
     QLabel* m_addressLabel;
     QLabel* m_valueLabel;
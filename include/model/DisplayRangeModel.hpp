@@ -6,6 +6,7 @@
 
 #include "BaseDisplayModel.hpp"
 #include "data/RangeData.hpp"
+#include "CellReference.hpp"
 
 #include <QTableWidget>
 #include <QVBoxLayout>
@@ -141,23 +142,19 @@ protected:
             m_tableWidget->setRowCount(rows);
             m_tableWidget->setColumnCount(cols);
             
-            // 设置列标题（A, B, C, ...）
+            // 行列标题与工作表中的实际位置一致，地址无法解析时从A1开始
+            const auto range = CellReference::parseRange(rangeData->rangeAddress());
+            const CellPosition origin = range ? range->topLeft : CellPosition{1, 1};
+
             QStringList columnHeaders;
             for (int col = 0; col < cols; ++col) {
-                QString header;
-                int temp = col;
-                do {
-                    header = QChar('A' + (temp % 26)) + header;
-                    temp = temp / 26 - 1;
-                } while (temp >= 0);
-                columnHeaders << header;
+                columnHeaders << CellReference::columnName(origin.column + col).toQString();
             }
             m_tableWidget->setHorizontalHeaderLabels(columnHeaders);
             
-            // 设置行标题（1, 2, 3, ...）
             QStringList rowHeaders;
             for (int row = 0; row < rows; ++row) {
-                rowHeaders << QString::number(row + 1);
+                rowHeaders << QString::number(origin.row + row);
             }
             m_tableWidget->setVerticalHeaderLabels(rowHeaders);
             
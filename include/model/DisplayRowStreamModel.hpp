@@ -0,0 +1,180 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include "BaseDisplayModel.hpp"
+#include "data/RowBatchData.hpp"
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include <QDebug>
+
+/**
+ * @brief 显示行流的节点模型
+ *
+ * 接收分批到达的RowBatchData，表格中只保留流开头的PreviewRows行，
+ * 之后的批次只更新计数，显示任意行数的流都不会积累数据。
+ */
+class DisplayRowStreamModel : public BaseDisplayModel<RowBatchData>
+{
+    Q_OBJECT
+
+public:
+    /// 表格中最多显示的行数
+    static constexpr int PreviewRows = 1000;
+
+    DisplayRowStreamModel()
+    {
+        m_widget = new QWidget();
+        m_widget->setMinimumSize(300, 200);
+
+        auto* layout = new QVBoxLayout(m_widget);
+        layout->setContentsMargins(4, 4, 4, 4);
+        layout->setSpacing(4);
+
+        m_infoLabel = new QLabel("行流: --");
+        m_infoLabel->setStyleSheet("font-weight: bold; color: #2E86AB;");
+        layout->addWidget(m_infoLabel);
+
+        m_tableWidget = new QTableWidget();
+        m_tableWidget->setAlternatingRowColors(true);
+        m_tableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        layout->addWidget(m_tableWidget);
+
+        updateDisplay();
+    }
+
+    QString caption() const override
+    {
+        return tr("显示行流");
+    }
+
+    bool captionVisible() const override
+    {
+        return true;
+    }
+
+    QString name() const override
+    {
+        return tr("DisplayRowStream");
+    }
+
+    QWidget* embeddedWidget() override
+    {
+        return m_widget;
+    }
+
+protected:
+    QString getNodeTypeName() const override
+    {
+        return "DisplayRowStreamModel";
+    }
+
+    QString getDataTypeName() const override
+    {
+        return "RowBatchData";
+    }
+
+    void onDataReceived(std::shared_ptr<RowBatchData> data) override
+    {
+        if (data->isBegin()) {
+            m_streamId = data->streamId();
+            m_receivedRows = 0;
+            m_totalRows = data->totalRows();
+            m_finished = false;
+            m_status.clear();
+            m_tableWidget->clear();
+            m_tableWidget->setRowCount(0);
+            m_tableWidget->setColumnCount(data->columnCount());
+            return;
+        }
+
+        // 忽略已被新流替换的旧流
+        if (data->streamId() != m_streamId) {
+            return;
+        }
+
+        if (data->isBatch()) {
+            appendPreviewRows(*data);
+            m_receivedRows += data->rowCount();
+        } else if (data->isEnd()) {
+            m_finished = true;
+            if (!data->errorMessage().isEmpty()) {
+                m_status = QString("失败: %1").arg(data->errorMessage());
+            } else if (data->isCancelled()) {
+                m_status = "已取消";
+            }
+        }
+    }
+
+    void updateDisplay() override
+    {
+        if (m_streamId == 0) {
+            m_infoLabel->setText("行流: --");
+            return;
+        }
+
+        QString info = m_totalRows > 0
+            ? QString("已接收 %1 / %2 行").arg(m_receivedRows).arg(m_totalRows)
+            : QString("已接收 %1 行").arg(m_receivedRows);
+        if (m_receivedRows > PreviewRows) {
+            info += QString("（显示前%1行）").arg(PreviewRows);
+        }
+        if (m_finished) {
+            info += m_status.isEmpty() ? " - 完成" : QString(" - %1").arg(m_status);
+        }
+        m_infoLabel->setText(info);
+    }
+
+    QString getDataPreviewString(std::shared_ptr<RowBatchData> data) const override
+    {
+        return QString("%1行 x %2列").arg(m_receivedRows).arg(m_tableWidget->columnCount());
+    }
+
+    QString getDisplayName() const override
+    {
+        return "显示行流";
+    }
+
+    QString getDescription() const override
+    {
+        return "逐批显示行流，只保留开头的部分行";
+    }
+
+private:
+    void appendPreviewRows(const RowBatchData& data)
+    {
+        const int available = PreviewRows - m_tableWidget->rowCount();
+        if (available <= 0) {
+            return;
+        }
+
+        const int count = qMin(available, data.rowCount());
+        const int firstRow = m_tableWidget->rowCount();
+        m_tableWidget->setRowCount(firstRow + count);
+        for (int i = 0; i < count; ++i) {
+            const RowData& row = data.rows()[i];
+            for (int col = 0; col < row.columnCount() && col < m_tableWidget->columnCount(); ++col) {
+                const QVariant value = row.cellValue(col);
+                if (value.isValid()) {
+                    m_tableWidget->setItem(firstRow + i, col, new QTableWidgetItem(value.toString()));
+                }
+            }
+        }
+    }
+
+private:
+    QWidget* m_widget;
+    QLabel* m_infoLabel;
+    QTableWidget* m_tableWidget;
+
+    quint64 m_streamId = 0;     ///< 当前显示的流
+    int m_receivedRows = 0;
+    int m_totalRows = -1;
+    bool m_finished = false;
+    QString m_status;
+};
@@ -9,7 +9,9 @@
 #include <QWidget>
 #include <QPushButton>
 #include <QLineEdit>
-#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QProgressBar>
+#include <QTimer>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QMessageBox>
@@ -21,6 +23,8 @@
 #include "ErrorHandler.hpp"
 #include "DataValidator.hpp"
 #include "PerformanceProfiler.hpp"
+#include "WorkbookCache.hpp"
+#include "WorkbookLoader.hpp"
 
 class ClickableLineEdit : public StyledLineEdit
 {
@@ -61,15 +65,46 @@ public:
     OpenExcelModel()
     {
         m_widget = new QWidget();
-        auto* layout = new QHBoxLayout(m_widget);
+        auto* layout = new QVBoxLayout(m_widget);
         layout->setContentsMargins(4, 4, 4, 4);
-        layout->setSpacing(0);
+        layout->setSpacing(2);
 
         m_lineEdit = new ClickableLineEdit();
         m_lineEdit->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
         layout->addWidget(m_lineEdit);
 
+        // 加载进度条，仅在后台加载时显示
+        m_progressBar = new QProgressBar();
+        m_progressBar->setRange(0, WorkbookLoader::ProgressMax);
+        m_progressBar->setTextVisible(true);
+        m_progressBar->setFormat("加载中 %p%");
+        m_progressBar->setFixedHeight(14);
+        m_progressBar->hide();
+        layout->addWidget(m_progressBar);
+
         connect(m_lineEdit, &ClickableLineEdit::clicked, this, &OpenExcelModel::chooseFile);
+        // 加载完成或取消
+        connect(this, &OpenExcelModel::computingFinished, m_progressBar, &QProgressBar::hide);
+
+        // 定期释放长时间未使用的工作表DOM
+        m_idleSheetTimer = new QTimer(this);
+        m_idleSheetTimer->setInterval(30000);
+        connect(m_idleSheetTimer, &QTimer::timeout, this, [this]() {
+            if (m_workbookData && m_workbookData->sharedDocument()) {
+                auto document = m_workbookData->sharedDocument();
+                // 文件已被修改时重新解析会读到新的内容，只释放解码值
+                const bool unchanged = WorkbookCache::instance().find(WorkbookCache::FileStamp::of(document->filePath())) == document;
+                try {
+                    int released = document->releaseIdleSheets(WorkbookDocument::DefaultSheetIdleTime, unchanged);
+                    if (released > 0) {
+                        qDebug() << "OpenExcelModel: Released" << released << "idle sheet(s)";
+                    }
+                } catch (const std::exception& e) {
+                    qWarning() << "OpenExcelModel: Failed to release idle sheets:" << e.what();
+                }
+            }
+        });
+        m_idleSheetTimer->start();
 
         // 注册属性
         registerLineEdit("filePath", m_lineEdit, "Excel文件路径");
@@ -136,6 +171,18 @@ public:
         compute();
     }
 
+    // 输出只由文件路径和文件内容决定
+    bool isMemoizable() const override
+    {
+        return true;
+    }
+
+    // 文件被修改后重新运行时需要重新加载
+    QString externalState() const override
+    {
+        return WorkbookCache::FileStamp::of(QString::fromStdString(m_filePath)).toString();
+    }
+
 private:
     bool shouldExecute() const
     {
@@ -167,27 +214,47 @@ private:
                 throw TinaFlowException::fileNotFound(filePath);
             }
 
-            // 尝试打开Excel文件
-            auto* doc = new OpenXLSX::XLDocument();
-            try {
-                doc->open(m_filePath);
-            } catch (const std::exception& openError) {
-                delete doc;
-                TINAFLOW_THROW(ExcelFileInvalid, QString("无法打开Excel文件: %1 - %2").arg(filePath).arg(openError.what()));
-            }
+            // 在工作线程中打开新文件，尚未完成的加载被取消；停止按钮同样取消加载
+            m_progressBar->setRange(0, WorkbookLoader::ProgressMax);
+            m_progressBar->setValue(0);
+            m_progressBar->show();
+            startCompute([this, filePath](ComputeContext& context) -> ApplyResult {
+                context.setProgressRange(0, WorkbookLoader::ProgressMax);
+                bool busy = false;
+                auto result = WorkbookLoader::load(filePath, [&context]() { return context.isCancelled(); },
+                    [&context, &busy](int value) {
+                        if ((value == WorkbookLoader::Busy) != busy) {
+                            busy = !busy;
+                            context.setProgressRange(0, busy ? 0 : WorkbookLoader::ProgressMax);
+                        }
+                        if (!busy) {
+                            context.setProgress(value);
+                        }
+                    });
+                if (context.isCancelled()) {
+                    return {};
+                }
+                return [this, result = std::move(result)]() { applyLoadResult(result); };
+            });
+
+            qDebug() << "OpenExcelModel: Loading Excel file in background:" << filePath;
+
+        }, m_widget, "OpenExcelModel", "打开Excel文件");
+    }
 
-            // 获取工作簿
-            OpenXLSX::XLWorkbook wb = doc->workbook();
-            // 检查工作簿是否有效（通过检查是否有工作表）
-            if (wb.worksheetCount() == 0) {
-                delete doc;
-                TINAFLOW_THROW(ExcelFileInvalid, QString("Excel工作簿无效或为空: %1").arg(filePath));
+    // 加载结束后在GUI线程中应用结果，下游节点在此之后才会被运行调度器执行
+    void applyLoadResult(const WorkbookLoader::Result& result)
+    {
+        SAFE_EXECUTE({
+            if (!result.workbook) {
+                TINAFLOW_THROW(ExcelFileInvalid, result.errorMessage);
             }
 
-            m_workbookData = std::make_shared<WorkbookData>(wb, doc);
+            m_workbookData = result.workbook;
+            m_sheetCount = result.sheetCount;
             Q_EMIT dataUpdated(0);
 
-            qDebug() << "OpenExcelModel: Successfully opened Excel file:" << filePath;
+            qDebug() << "OpenExcelModel: Successfully opened Excel file:" << QString::fromStdString(m_filePath);
 
         }, m_widget, "OpenExcelModel", "打开Excel文件");
     }
@@ -223,6 +290,13 @@ protected:
         return "OpenExcelModel";
     }
 
+    void onComputeProgress(int value, int minimum, int maximum, const QString& text) override
+    {
+        Q_UNUSED(text);
+        m_progressBar->setRange(minimum, maximum);
+        m_progressBar->setValue(value);
+    }
+
 
 
     QString getDisplayName() const override
@@ -262,17 +336,8 @@ protected:
             propertyWidget->addSeparator();
             propertyWidget->addTitle("文件信息");
 
-            try {
-                auto workbook = m_workbookData->workbook();
-                if (workbook) {
-                    int sheetCount = workbook->worksheetCount();
-                    propertyWidget->addInfoProperty("工作表数量", QString::number(sheetCount), "color: #666;");
-                } else {
-                    propertyWidget->addInfoProperty("工作表信息", "无法获取", "color: #999;");
-                }
-            } catch (...) {
-                propertyWidget->addInfoProperty("文件信息", "读取失败", "color: #999;");
-            }
+            // 使用加载时读取的数量，不在GUI线程中等待文档的DOM锁
+            propertyWidget->addInfoProperty("工作表数量", QString::number(m_sheetCount), "color: #666;");
         }
 
         return true;
@@ -296,6 +361,9 @@ protected:
 private:
     QWidget* m_widget;
     ClickableLineEdit* m_lineEdit;
+    QProgressBar* m_progressBar;
+    QTimer* m_idleSheetTimer;
     std::string m_filePath;
     std::shared_ptr<WorkbookData> m_workbookData;
+    int m_sheetCount = 0;
 };
@@ -0,0 +1,406 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include "BaseNodeModel.hpp"
+#include "ParallelSheetReader.hpp"
+#include "WorkbookCache.hpp"
+#include "data/RangeData.hpp"
+#include "widget/PropertyWidget.hpp"
+#include "ErrorHandler.hpp"
+#include "DataValidator.hpp"
+#include "PerformanceProfiler.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QJsonArray>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QWidget>
+#include <atomic>
+#include <mutex>
+
+/**
+ * @brief 并行读取节点
+ *
+ * 从多个工作簿、多个工作表中读取同一个范围，每个读取任务单独提交到WorkStealingPool并行执行。
+ * 每个“工作簿 × 工作表”组合对应一个RangeData输出端口，某个任务完成后
+ * 立即更新对应端口（startPendingCompute()的每个结果到达时应用），不必等待其他任务。
+ * 作为源节点由运行按钮触发执行，停止后不再开始新的任务。
+ */
+class ParallelReadModel : public BaseNodeModel
+{
+    Q_OBJECT
+
+public:
+    ParallelReadModel()
+    {
+        m_widget = new QWidget();
+        auto* layout = new QVBoxLayout(m_widget);
+        layout->setContentsMargins(4, 4, 4, 4);
+        layout->setSpacing(2);
+
+        auto* fileLayout = new QHBoxLayout();
+        m_chooseButton = new QPushButton("选择文件...");
+        fileLayout->addWidget(m_chooseButton);
+        m_fileCountLabel = new QLabel();
+        fileLayout->addWidget(m_fileCountLabel);
+        layout->addLayout(fileLayout);
+
+        m_sheetsEdit = new QLineEdit();
+        m_sheetsEdit->setPlaceholderText("工作表，逗号分隔，留空为第一个");
+        layout->addWidget(m_sheetsEdit);
+
+        m_rangeEdit = new QLineEdit();
+        m_rangeEdit->setPlaceholderText("A1:C10");
+        m_rangeEdit->setText("A1:C10");
+        layout->addWidget(m_rangeEdit);
+
+        // 读取进度条，按已完成的任务数显示
+        m_progressBar = new QProgressBar();
+        m_progressBar->setTextVisible(true);
+        m_progressBar->setFormat("读取中 %v/%m");
+        m_progressBar->setFixedHeight(14);
+        m_progressBar->hide();
+        layout->addWidget(m_progressBar);
+
+        connect(m_chooseButton, &QPushButton::clicked, this, &ParallelReadModel::chooseFiles);
+        connect(m_sheetsEdit, &QLineEdit::editingFinished, this, &ParallelReadModel::updateTasks);
+        connect(m_rangeEdit, &QLineEdit::editingFinished, this, &ParallelReadModel::updateTasks);
+        // 所有任务完成或取消
+        connect(this, &ParallelReadModel::computingFinished, m_progressBar, &QProgressBar::hide);
+
+        // 注册属性
+        registerLineEdit("sheets", m_sheetsEdit, "工作表列表");
+        registerLineEdit("range", m_rangeEdit, "范围地址");
+
+        updateFileCountLabel();
+    }
+
+    [[nodiscard]] QString caption() const override
+    {
+        return "并行读取";
+    }
+
+    [[nodiscard]] QString name() const override
+    {
+        return {"ParallelRead"};
+    }
+
+    QWidget* embeddedWidget() override
+    {
+        return m_widget;
+    }
+
+    unsigned int nPorts(QtNodes::PortType portType) const override
+    {
+        return portType == QtNodes::PortType::Out ? static_cast<unsigned int>(m_tasks.size()) : 0;
+    }
+
+    QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        return RangeData().type();
+    }
+
+    bool portCaptionVisible(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        return portType == QtNodes::PortType::Out;
+    }
+
+    QString portCaption(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        if (portType != QtNodes::PortType::Out || portIndex >= m_tasks.size()) {
+            return {};
+        }
+        const auto& task = m_tasks[portIndex];
+        const QString sheet = task.sheetName.empty() ? QString("第一个工作表") : QString::fromStdString(task.sheetName);
+        return QString("%1 / %2").arg(QFileInfo(task.filePath).completeBaseName(), sheet);
+    }
+
+    std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex const port) override
+    {
+        return port < m_results.size() ? m_results[port] : nullptr;
+    }
+
+    void setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex const portIndex) override
+    {
+    }
+
+public:
+    // 由运行按钮触发执行
+    void triggerExecution()
+    {
+        qDebug() << "ParallelReadModel: Execution triggered";
+        compute();
+    }
+
+    // 输出只由文件列表、范围和各文件内容决定
+    bool isMemoizable() const override
+    {
+        return true;
+    }
+
+    // 任一文件被修改后重新运行时需要重新读取
+    QString externalState() const override
+    {
+        QStringList stamps;
+        for (const auto& filePath : m_filePaths) {
+            stamps << WorkbookCache::FileStamp::of(filePath).toString();
+        }
+        return stamps.join('\n');
+    }
+
+private:
+    void compute()
+    {
+        PROFILE_NODE("ParallelReadModel");
+
+        if (m_tasks.empty()) {
+            return;
+        }
+
+        SAFE_EXECUTE({
+            auto rangeValidation = DataValidator::validateRange(m_rangeEdit->text().trimmed().toUpper());
+            if (!rangeValidation.isValid) {
+                throw TinaFlowException::invalidRange(m_rangeEdit->text());
+            }
+            for (const auto& filePath : m_filePaths) {
+                if (!DataValidator::validateExcelFile(filePath).isValid) {
+                    throw TinaFlowException::fileNotFound(filePath);
+                }
+            }
+
+            m_results.assign(m_tasks.size(), nullptr);
+            m_progressBar->setRange(0, static_cast<int>(m_tasks.size()));
+            m_progressBar->setValue(0);
+            m_progressBar->show();
+            readAll();
+
+            qDebug() << "ParallelReadModel: Reading" << m_tasks.size() << "sheet(s) in parallel";
+
+        }, m_widget, "ParallelReadModel", "并行读取");
+    }
+
+    // 每个任务单独提交，完成后立即交付该端口的结果，最后完成的任务报告所有失败
+    void readAll()
+    {
+        struct ReadState
+        {
+            std::atomic<int> remaining;
+            std::atomic<int> finished{0};
+            std::mutex mutex;
+            QStringList errors;     ///< 由mutex保护
+        };
+
+        auto promise = startPendingCompute();
+        promise->setProgressRange(0, static_cast<int>(m_tasks.size()));
+        auto state = std::make_shared<ReadState>();
+        state->remaining = static_cast<int>(m_tasks.size());
+
+        for (size_t index = 0; index < m_tasks.size(); ++index) {
+            WorkStealingPool::instance().submit([this, promise, state, task = m_tasks[index], index]() {
+                // 取消后不再开始新的任务，已经开始的任务会执行完
+                if (!promise->isCanceled()) {
+                    auto result = ParallelSheetReader::read(task);
+                    if (result.range) {
+                        promise->addResult([this, index, range = std::move(result.range)]() {
+                            if (index < m_results.size()) {
+                                m_results[index] = range;
+                                Q_EMIT dataUpdated(static_cast<QtNodes::PortIndex>(index));
+                            }
+                        });
+                    } else {
+                        std::lock_guard lock(state->mutex);
+                        state->errors << result.errorMessage;
+                    }
+                    promise->setProgressValue(++state->finished);
+                }
+                if (--state->remaining > 0) {
+                    return;
+                }
+
+                // 各端口的结果都已交付，下游节点在此之后才会被运行调度器执行
+                QStringList errors;
+                {
+                    std::lock_guard lock(state->mutex);
+                    errors = state->errors;
+                }
+                const int succeeded = state->finished - static_cast<int>(errors.size());
+                promise->addResult([this, errors, succeeded]() {
+                    qDebug() << "ParallelReadModel: Finished," << succeeded << "succeeded," << errors.size() << "failed";
+                    SAFE_EXECUTE({
+                        if (!errors.isEmpty()) {
+                            TINAFLOW_THROW(ExcelFileInvalid, errors.join("\n"));
+                        }
+                    }, m_widget, "ParallelReadModel", "并行读取");
+                });
+                promise->finish();
+            });
+        }
+    }
+
+    void chooseFiles()
+    {
+        const QStringList paths = QFileDialog::getOpenFileNames(nullptr, "选择Excel文件", {}, "Excel文件 (*.xlsx)");
+        if (paths.isEmpty()) {
+            return; // 用户取消选择
+        }
+        m_filePaths = paths;
+        updateFileCountLabel();
+        updateTasks();
+    }
+
+    void updateFileCountLabel()
+    {
+        m_fileCountLabel->setText(QString("已选择 %1 个文件").arg(m_filePaths.size()));
+        m_fileCountLabel->setToolTip(m_filePaths.join("\n"));
+    }
+
+    // 根据文件、工作表和范围重建任务列表，端口数变化时只增删末尾的端口
+    void updateTasks()
+    {
+        cancelCompute();
+
+        std::vector<std::string> sheetNames;
+        for (const auto& name : m_sheetsEdit->text().split(',', Qt::SkipEmptyParts)) {
+            if (!name.trimmed().isEmpty()) {
+                sheetNames.push_back(name.trimmed().toStdString());
+            }
+        }
+        if (sheetNames.empty()) {
+            sheetNames.emplace_back();
+        }
+
+        const QString rangeAddress = m_rangeEdit->text().trimmed().toUpper();
+        std::vector<ParallelSheetReader::Task> tasks;
+        for (const auto& filePath : m_filePaths) {
+            for (const auto& sheetName : sheetNames) {
+                tasks.push_back({filePath, sheetName, rangeAddress});
+            }
+        }
+
+        const auto oldCount = static_cast<QtNodes::PortIndex>(m_tasks.size());
+        const auto newCount = static_cast<QtNodes::PortIndex>(tasks.size());
+        if (newCount < oldCount) {
+            Q_EMIT portsAboutToBeDeleted(QtNodes::PortType::Out, newCount, oldCount - 1);
+            m_tasks = std::move(tasks);
+            m_results.resize(newCount);
+            Q_EMIT portsDeleted();
+        } else if (newCount > oldCount) {
+            Q_EMIT portsAboutToBeInserted(QtNodes::PortType::Out, oldCount, newCount - 1);
+            m_tasks = std::move(tasks);
+            m_results.resize(newCount);
+            Q_EMIT portsInserted();
+        } else {
+            m_tasks = std::move(tasks);
+        }
+    }
+
+protected:
+    QString getNodeTypeName() const override
+    {
+        return "ParallelReadModel";
+    }
+
+    void onComputeProgress(int value, int minimum, int maximum, const QString& text) override
+    {
+        Q_UNUSED(minimum);
+        Q_UNUSED(maximum);
+        Q_UNUSED(text);
+        m_progressBar->setValue(value);
+    }
+
+    QString getDisplayName() const override
+    {
+        return "并行读取";
+    }
+
+    QString getDescription() const override
+    {
+        return "在多个线程中同时读取多个工作簿或工作表的同一范围";
+    }
+
+    void onSave(QJsonObject& json) const override
+    {
+        json["files"] = QJsonArray::fromStringList(m_filePaths);
+    }
+
+    void onLoad(const QJsonObject& json) override
+    {
+        m_filePaths.clear();
+        for (const auto& value : json["files"].toArray()) {
+            m_filePaths << value.toString();
+        }
+        updateFileCountLabel();
+        updateTasks();
+        // 加载时不自动执行，等待用户点击运行按钮
+        qDebug() << "ParallelReadModel: Loaded" << m_filePaths.size() << "file(s), waiting for execution trigger";
+    }
+
+    bool createPropertyPanel(PropertyWidget* propertyWidget) override
+    {
+        propertyWidget->addTitle("并行读取设置");
+        propertyWidget->addDescription("每个工作簿的每个工作表对应一个输出端口，所有读取任务并行执行");
+
+        propertyWidget->addModeToggleButtons();
+
+        propertyWidget->addTextProperty("工作表", m_sheetsEdit->text(),
+            "sheets", "多个工作表用逗号分隔，留空读取第一个工作表",
+            [this](const QString& sheets) {
+                m_sheetsEdit->setText(sheets);
+                updateTasks();
+            });
+
+        propertyWidget->addTextProperty("范围地址", m_rangeEdit->text(),
+            "range", "输入范围地址，如A1:C10",
+            [this](const QString& range) {
+                if (!range.isEmpty()) {
+                    m_rangeEdit->setText(range.toUpper());
+                    updateTasks();
+                }
+            });
+
+        propertyWidget->addSeparator();
+        propertyWidget->addTitle("任务");
+        propertyWidget->addInfoProperty("文件数量", QString::number(m_filePaths.size()), "color: #666;");
+        propertyWidget->addInfoProperty("读取任务", QString::number(m_tasks.size()), "color: #666;");
+
+        int finished = 0;
+        for (const auto& result : m_results) {
+            finished += result ? 1 : 0;
+        }
+        propertyWidget->addInfoProperty("已读取", QString::number(finished), "color: #666;");
+
+        return true;
+    }
+
+    void onPropertyChanged(const QString& propertyName, const QVariant& value) override
+    {
+        if (propertyName == "sheets") {
+            m_sheetsEdit->setText(value.toString());
+            updateTasks();
+        } else if (propertyName == "range") {
+            m_rangeEdit->setText(value.toString().toUpper());
+            updateTasks();
+        }
+    }
+
+private:
+    QWidget* m_widget;
+    QPushButton* m_chooseButton;
+    QLabel* m_fileCountLabel;
+    QLineEdit* m_sheetsEdit;
+    QLineEdit* m_rangeEdit;
+    QProgressBar* m_progressBar;
+
+    QStringList m_filePaths;
+    std::vector<ParallelSheetReader::Task> m_tasks;
+    std::vector<std::shared_ptr<RangeData>> m_results;
+};
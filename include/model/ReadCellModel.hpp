@@ -10,11 +10,16 @@
 #include "widget/PropertyWidget.hpp"
 #include "ErrorHandler.hpp"
 #include "DataValidator.hpp"
+#include "CellReference.hpp"
+#include "SheetCache.hpp"
+#include "SheetValueCache.hpp"
 
 #include <QLineEdit>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QDebug>
+#include <exception>
+#include <optional>
 
 /**
  * @brief 读取Excel单元格数据的节点模型
@@ -22,6 +27,13 @@
  * 这个节点接收一个工作表数据(SheetData)作为输入，
  * 允许用户指定单元格地址（如"A1", "B5"），
  * 然后输出该单元格的数据(CellData)。
+ *
+ * 同一工作表已经有解码后的值（SheetValueCache）时直接从内存读取；
+ * 工作表尚未解析时，如果ReadRange写入的磁盘缓存覆盖该单元格，直接从缓存读取；
+ * 否则只在DOM中查找这一个单元格，不为读取单个值解码整个工作表。
+ *
+ * 读取通过startCompute()在工作线程中执行，查找DOM时锁定所在的文档（见WorkbookDocument::lockDom()）。
+ * 输入地址时合并连续的编辑，停止输入后才读取（见BaseNodeModel::scheduleParameterUpdate()）。
  */
 class ReadCellModel : public BaseNodeModel
 {
@@ -47,9 +59,10 @@ public:
         m_cellAddressEdit->setText("A1"); // 默认值
         layout->addWidget(m_cellAddressEdit);
 
-        // 连接信号
-        connect(m_cellAddressEdit, &QLineEdit::textChanged,
-                this, &ReadCellModel::onCellAddressChanged);
+        // 连接信号：输入地址时合并连续的编辑，不为每个中间地址读取一次
+        connect(m_cellAddressEdit, &QLineEdit::textChanged, this, [this]() {
+            scheduleParameterUpdate([this]() { onCellAddressChanged(); });
+        });
     }
 
     QString caption() const override
@@ -127,6 +140,29 @@ public:
         }
     }
 
+    // 读取在工作线程中执行，见createConcurrentTask()
+    ThreadAffinity threadAffinity() const override
+    {
+        return ThreadAffinity::AnyThread;
+    }
+
+    ConcurrentTask createConcurrentTask(const Inputs& inputs) override
+    {
+        const auto input = inputs.find(0);
+        if (input != inputs.end()) {
+            m_sheetData = std::dynamic_pointer_cast<SheetData>(input->second);
+        }
+
+        const QString cellAddress = m_cellAddressEdit->text().trimmed().toUpper();
+        if (!m_sheetData || cellAddress.isEmpty()) {
+            // 没有可读取的内容，由setInData()清空输出
+            return {};
+        }
+
+        cancelParameterUpdate();
+        return readTask(m_sheetData, cellAddress);
+    }
+
 private slots:
     void onCellAddressChanged()
     {
@@ -139,6 +175,9 @@ private:
     {
         qDebug() << "ReadCellModel::updateCellData called";
 
+        // 使用的已经是最新的参数
+        cancelParameterUpdate();
+
         if (!m_sheetData) {
             qDebug() << "ReadCellModel: No sheet data available";
             m_cellData.reset();
@@ -154,31 +193,74 @@ private:
             return;
         }
 
-        SAFE_EXECUTE({
-            // 验证单元格地址
-            auto validation = DataValidator::validateCellAddress(cellAddress);
-            if (!validation.isValid) {
-                throw TinaFlowException::invalidCellAddress(cellAddress);
+        // 在工作线程中读取，之前尚未完成的读取被取消
+        startCompute(readTask(m_sheetData, cellAddress));
+    }
+
+    // 读取任务：工作线程只使用输入和地址的快照，this只在GUI线程中应用结果时访问
+    ConcurrentTask readTask(std::shared_ptr<SheetData> sheetData, const QString& cellAddress)
+    {
+        return [this, sheetData = std::move(sheetData), cellAddress](ComputeContext& context) -> ApplyResult {
+            try {
+                auto cellData = readCell(sheetData, cellAddress);
+                if (context.isCancelled()) {
+                    return {};
+                }
+                return [this, cellData = std::move(cellData)]() {
+                    m_cellData = cellData;
+                    qDebug() << "ReadCellModel: Successfully read cell data";
+                    emit dataUpdated(0);
+                };
+            } catch (...) {
+                return [this, error = std::current_exception(), cellAddress]() {
+                    m_cellData.reset();
+                    SAFE_EXECUTE({
+                        std::rethrow_exception(error);
+                    }, m_widget, "ReadCellModel", QString("读取单元格 %1").arg(cellAddress));
+                    emit dataUpdated(0);
+                };
             }
+        };
+    }
 
-            // 使用OpenXLSX读取单元格数据
-            auto& worksheet = m_sheetData->worksheet();
-            auto cell = worksheet.cell(cellAddress.toStdString());
+    // 执行读取，不访问控件，在工作线程中调用
+    static std::shared_ptr<CellData> readCell(const std::shared_ptr<SheetData>& sheetData, const QString& cellAddress)
+    {
+        // 地址只解析一次，之后直接使用行列号
+        const auto position = CellReference::parseA1(cellAddress);
+        if (!position) {
+            throw TinaFlowException::invalidCellAddress(cellAddress);
+        }
 
-            qDebug() << "ReadCellModel: Reading cell" << cellAddress;
+        // 同一工作表已经解码过时直接读内存，不等待正在进行的解码
+        std::optional<QVariant> cached;
+        auto values = sheetData->cachedValues();
+        if (values) {
+            cached = values->value(*position);
+        } else if (!sheetData->isLoaded()) {
+            // 工作表XML尚未解析且磁盘缓存覆盖该单元格时，直接使用缓存中的值
+            const QString cachePath = SheetCache::cacheableWorkbookPath(*sheetData);
+            if (!cachePath.isEmpty()) {
+                cached = SheetCache::instance().findCell(cachePath, sheetData->sheetName(), *position);
+            }
+        }
 
-            // 创建CellData
-            m_cellData = std::make_shared<CellData>(cell);
+        if (cached) {
+            qDebug() << "ReadCellModel: Reading cell" << cellAddress << "from cache";
+            return std::make_shared<CellData>(cellAddress, *cached);
+        }
 
-            qDebug() << "ReadCellModel: Successfully read cell data";
-            emit dataUpdated(0);
+        // 直接在DOM中查找单元格，不存在时不会创建新的行和单元格
+        const auto lock = sheetData->lockDom();
+        auto& worksheet = sheetData->worksheet();
+        auto cell = worksheet.findCell(position->row, position->column);
 
-        }, m_widget, "ReadCellModel", QString("读取单元格 %1").arg(cellAddress));
+        qDebug() << "ReadCellModel: Reading cell" << cellAddress;
 
-        // 如果发生错误，清除数据
-        if (!m_cellData) {
-            emit dataUpdated(0);
-        }
+        // 读取时保存值的快照，下游取值不再访问文档，也不会让文档一直保持加载；文本驻留到文档的池中
+        const auto document = sheetData->document();
+        return cell.empty() ? std::make_shared<CellData>(cellAddress, QVariant())
+                            : std::make_shared<CellData>(CellData::snapshotOf(cell, document ? document->stringPool() : nullptr));
     }
 
 protected:
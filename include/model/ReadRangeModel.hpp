@@ -9,12 +9,22 @@
 #include "data/RangeData.hpp"
 #include "widget/PropertyWidget.hpp"
 #include "ErrorHandler.hpp"
+#include "CellReference.hpp"
 #include "DataValidator.hpp"
+#include "SheetCache.hpp"
+#include "SheetReader.hpp"
+#include "SheetValueCache.hpp"
+#include "StreamingSheetReader.hpp"
+#include "WorkbookCache.hpp"
 
+#include <QCheckBox>
 #include <QLineEdit>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QDebug>
+#include <exception>
+#include <memory>
+#include <optional>
 
 /**
  * @brief 读取Excel单元格范围数据的节点模型
@@ -22,6 +32,25 @@
  * 这个节点接收一个工作表数据(SheetData)作为输入，
  * 允许用户指定单元格范围（如"A1:C10"），
  * 然后输出该范围的所有数据(RangeData)。
+ *
+ * 勾选"流式读取"后直接从文件流式解析工作表XML，不构建工作表DOM，
+ * 适合只读取数据的大工作表；读取的是磁盘上的文件内容。
+ *
+ * 勾选"自动"后忽略输入的地址，读取工作表的已使用区域：流式读取时使用
+ * <dimension>元素（没有时扫描有值的单元格），否则遍历文档中存在的行。
+ * 这样不需要为了保险输入A1:Z1000000这样的大范围，也不会为空单元格分配大量QVariant。
+ *
+ * 第一次读取时解码整个工作表的值（SheetValueCache）并挂到文档上，之后修改范围地址、
+ * 切换自动范围或其他节点读取同一工作表都直接从内存取子范围，不再访问DOM或文件。
+ * 流式读取不构建整表的值，保持内存占用不变、读到范围末尾即停止；
+ * 只有其他读取已经解码过该工作表时才直接使用内存中的值。
+ *
+ * 解码的整个工作表或流式读取的范围会写入SheetCache，工作簿文件未修改时之后的运行直接从缓存读取。
+ *
+ * 所有读取都通过startCompute()在工作线程中执行，修改参数或停止时取消尚未完成的读取。
+ * 访问工作表DOM时锁定所在的文档（见WorkbookDocument::lockDom()），同一文档的DOM读取依次执行，
+ * 不同工作簿的读取、已解码的值和流式读取之间互不等待。
+ * 输入范围地址时合并连续的编辑，停止输入后才读取（见BaseNodeModel::scheduleParameterUpdate()）。
  */
 class ReadRangeModel : public BaseNodeModel
 {
@@ -47,9 +76,26 @@ public:
         m_rangeEdit->setText("A1:C10"); // 默认值
         layout->addWidget(m_rangeEdit);
 
-        // 连接信号
-        connect(m_rangeEdit, &QLineEdit::textChanged,
+        // 流式读取开关
+        m_streamingCheckBox = new QCheckBox("流式");
+        m_streamingCheckBox->setToolTip("直接从文件流式读取，不加载工作表DOM，适合只读的大工作表");
+        layout->addWidget(m_streamingCheckBox);
+
+        // 自动范围开关
+        m_autoRangeCheckBox = new QCheckBox("自动");
+        m_autoRangeCheckBox->setToolTip("读取工作表中实际有数据的区域，忽略输入的范围地址");
+        layout->addWidget(m_autoRangeCheckBox);
+
+        // 连接信号：输入地址时合并连续的编辑，不为每个中间地址读取一次
+        connect(m_rangeEdit, &QLineEdit::textChanged, this, [this]() {
+            scheduleParameterUpdate([this]() { onRangeChanged(); });
+        });
+        connect(m_streamingCheckBox, &QCheckBox::toggled,
                 this, &ReadRangeModel::onRangeChanged);
+        connect(m_autoRangeCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+            m_rangeEdit->setEnabled(!checked);
+            onRangeChanged();
+        });
     }
 
     QString caption() const override
@@ -117,6 +163,8 @@ public:
     {
         QJsonObject modelJson = NodeDelegateModel::save(); // 调用基类方法保存model-name
         modelJson["range"] = m_rangeEdit->text();
+        modelJson["streaming"] = m_streamingCheckBox->isChecked();
+        modelJson["autoRange"] = m_autoRangeCheckBox->isChecked();
         return modelJson;
     }
 
@@ -125,6 +173,36 @@ public:
         if (json.contains("range")) {
             m_rangeEdit->setText(json["range"].toString());
         }
+        if (json.contains("streaming")) {
+            m_streamingCheckBox->setChecked(json["streaming"].toBool());
+        }
+        if (json.contains("autoRange")) {
+            m_autoRangeCheckBox->setChecked(json["autoRange"].toBool());
+        }
+    }
+
+    // 读取在工作线程中执行，见createConcurrentTask()
+    ThreadAffinity threadAffinity() const override
+    {
+        return ThreadAffinity::AnyThread;
+    }
+
+    ConcurrentTask createConcurrentTask(const Inputs& inputs) override
+    {
+        const auto input = inputs.find(0);
+        if (input != inputs.end()) {
+            m_sheetData = std::dynamic_pointer_cast<SheetData>(input->second);
+        }
+
+        const auto request = makeRequest();
+        if (!request) {
+            // 没有可读取的内容，由setInData()清空输出
+            return {};
+        }
+
+        cancelParameterUpdate();
+        m_usedRangeAddress.clear();
+        return readTask(*request);
     }
 
 private slots:
@@ -135,96 +213,222 @@ private slots:
     }
 
 private:
+    /**
+     * @brief 一次读取的全部参数，在GUI线程中从控件读取
+     */
+    struct ReadRequest
+    {
+        std::shared_ptr<SheetData> sheetData;
+        QString rangeAddress;
+        bool autoRange = false;
+        bool streaming = false;
+        std::shared_ptr<const SheetValueCache> values;  ///< 已经解码的工作表值，没有时为空
+    };
+
+    /**
+     * @brief 读取结果
+     */
+    struct ReadResult
+    {
+        std::shared_ptr<RangeData> rangeData;   ///< 工作表没有数据时为空
+        QString usedRangeAddress;               ///< 自动模式下读取的已使用区域
+    };
+
     void updateRangeData()
     {
         qDebug() << "ReadRangeModel::updateRangeData called";
-        
-        if (!m_sheetData) {
-            qDebug() << "ReadRangeModel: No sheet data available";
+
+        // 使用的已经是最新的参数
+        cancelParameterUpdate();
+        m_usedRangeAddress.clear();
+
+        const auto request = makeRequest();
+        if (!request) {
+            cancelCompute();
             m_rangeData.reset();
             emit dataUpdated(0);
             return;
         }
 
-        const QString rangeAddress = m_rangeEdit->text().trimmed().toUpper();
-        if (rangeAddress.isEmpty()) {
+        // 在工作线程中读取，之前尚未完成的读取被取消
+        startCompute(readTask(*request));
+    }
+
+    // 读取任务：工作线程只使用请求快照，this只在GUI线程中应用结果时访问
+    ConcurrentTask readTask(const ReadRequest& request)
+    {
+        return [this, request](ComputeContext& context) -> ApplyResult {
+            try {
+                ReadResult result = readRange(request);
+                if (context.isCancelled()) {
+                    return {};
+                }
+                return [this, result = std::move(result)]() { applyResult(result); };
+            } catch (...) {
+                return [this, error = std::current_exception(), address = request.rangeAddress]() {
+                    applyError(error, address);
+                };
+            }
+        };
+    }
+
+    // 从控件读取参数，没有可读取的内容时返回std::nullopt
+    std::optional<ReadRequest> makeRequest() const
+    {
+        if (!m_sheetData) {
+            qDebug() << "ReadRangeModel: No sheet data available";
+            return std::nullopt;
+        }
+
+        ReadRequest request;
+        request.sheetData = m_sheetData;
+        request.rangeAddress = m_rangeEdit->text().trimmed().toUpper();
+        request.autoRange = m_autoRangeCheckBox->isChecked();
+        request.streaming = m_streamingCheckBox->isChecked();
+        request.values = m_sheetData->cachedValues();
+        if (request.rangeAddress.isEmpty() && !request.autoRange) {
             qDebug() << "ReadRangeModel: Empty range address";
-            m_rangeData.reset();
-            emit dataUpdated(0);
-            return;
+            return std::nullopt;
         }
+        return request;
+    }
 
+    // 在GUI线程中保存结果并通知下游
+    void applyResult(const ReadResult& result)
+    {
+        m_usedRangeAddress = result.usedRangeAddress;
+        m_rangeData = result.rangeData;
+        if (m_rangeData) {
+            qDebug() << "ReadRangeModel: Successfully read range data:"
+                     << m_rangeData->rowCount() << "rows x" << m_rangeData->columnCount() << "cols";
+        }
+        emit dataUpdated(0);
+    }
+
+    // 在GUI线程中报告工作线程中的读取错误
+    void applyError(const std::exception_ptr& error, const QString& rangeAddress)
+    {
         SAFE_EXECUTE({
-            // 验证范围地址
-            auto validation = DataValidator::validateRange(rangeAddress);
-            if (!validation.isValid) {
+            std::rethrow_exception(error);
+        }, m_widget, "ReadRangeModel", QString("读取范围 %1").arg(rangeAddress));
+
+        if (!m_rangeData) {
+            emit dataUpdated(0);
+        }
+    }
+
+    // 执行读取，不访问控件，在工作线程中调用；访问DOM时锁定文档
+    static ReadResult readRange(const ReadRequest& request)
+    {
+        const auto& sheetData = request.sheetData;
+        QString rangeAddress = request.rangeAddress;
+        ReadResult result;
+
+        // 同一工作表已经解码过时，范围和已使用区域都直接从内存得到
+        auto values = request.values;
+
+        // 自动模式下读取已使用区域，否则解析输入的范围地址，后续直接使用行列号
+        std::optional<CellRange> range;
+        if (request.autoRange) {
+            range = values ? values->usedRange() : usedRange(request);
+            if (!range) {
+                qDebug() << "ReadRangeModel: Sheet has no data";
+                return result;
+            }
+            rangeAddress = CellReference::formatRange(*range).toQString();
+            result.usedRangeAddress = rangeAddress;
+            qDebug() << "ReadRangeModel: Used range is" << rangeAddress;
+        } else {
+            const auto parsed = CellReference::parseRange(rangeAddress);
+            if (!parsed) {
                 throw TinaFlowException::invalidRange(rangeAddress);
             }
+            range = *parsed;
+        }
+
+        // 工作簿文件未修改时其次使用磁盘缓存，不解析工作表XML
+        const QString cachePath = SheetCache::cacheableWorkbookPath(*sheetData);
+        std::shared_ptr<RangeData> cached;
+        if (!values && !cachePath.isEmpty()) {
+            cached = SheetCache::instance().findRange(cachePath, sheetData->sheetName(), rangeAddress);
+        }
+
+        // 都没有时解码整个工作表，之后的读取都从内存得到；流式读取只读取请求的范围
+        bool decoded = false;
+        if (!values && !cached && !request.streaming) {
+            values = sheetData->values([&sheetData, &decoded]() {
+                decoded = true;
+                qDebug() << "ReadRangeModel: Decoding sheet" << QString::fromStdString(sheetData->sheetName());
+                const auto lock = sheetData->lockDom();
+                return SheetValueCache::fromWorksheet(sheetData->worksheet(), sheetData->document()->stringPool());
+            });
+        }
 
+        qDebug() << "ReadRangeModel: Reading range" << rangeAddress;
+        qDebug() << "ReadRangeModel: Range size:" << range->rowCount() << "x" << range->columnCount();
+
+        if (cached) {
+            result.rangeData = cached;
+        } else if (values) {
+            result.rangeData = values->readRange(*range, rangeAddress);
+        } else if (request.streaming && sheetData->document()) {
+            result.rangeData = readRangeStreaming(request, rangeAddress);
+        } else {
             // 使用OpenXLSX读取范围数据
-            auto& worksheet = m_sheetData->worksheet();
-            auto range = worksheet.range(rangeAddress.toStdString());
-
-            qDebug() << "ReadRangeModel: Reading range" << rangeAddress;
-            
-            // 获取范围的行列数
-            int rowCount = range.numRows();
-            int colCount = range.numColumns();
-
-            qDebug() << "ReadRangeModel: Range size:" << rowCount << "x" << colCount;
-
-            // 读取数据到二维数组
-            std::vector<std::vector<QVariant>> data;
-            data.reserve(rowCount);
-
-            // 使用迭代器遍历范围中的所有单元格
-            auto topLeft = range.topLeft();
-            int startRow = topLeft.row();
-            int startCol = topLeft.column();
-
-            for (int row = 0; row < rowCount; ++row) {
-                std::vector<QVariant> rowData;
-                rowData.reserve(colCount);
-
-                for (int col = 0; col < colCount; ++col) {
-                    // 计算实际的单元格引用
-                    OpenXLSX::XLCellReference cellRef(startRow + row, startCol + col);
-                    auto cell = worksheet.cell(cellRef);
-
-                    QVariant cellValue;
-                    if (cell.value().type() == OpenXLSX::XLValueType::Empty) {
-                        cellValue = QVariant();
-                    } else if (cell.value().type() == OpenXLSX::XLValueType::Boolean) {
-                        cellValue = cell.value().get<bool>();
-                    } else if (cell.value().type() == OpenXLSX::XLValueType::Integer) {
-                        cellValue = static_cast<qint64>(cell.value().get<int64_t>());
-                    } else if (cell.value().type() == OpenXLSX::XLValueType::Float) {
-                        cellValue = cell.value().get<double>();
-                    } else if (cell.value().type() == OpenXLSX::XLValueType::String) {
-                        cellValue = QString::fromUtf8(cell.value().get<std::string>().c_str());
-                    } else {
-                        cellValue = QString("(未知类型)");
-                    }
+            const auto lock = sheetData->lockDom();
+            auto& worksheet = sheetData->worksheet();
 
-                    rowData.push_back(cellValue);
-                }
+            // 按行顺序批量读取，每个单元格只解码一次，文本驻留到文档的池中
+            auto pool = sheetData->document() ? sheetData->document()->stringPool() : std::make_shared<StringPool>();
+            auto data = SheetReader::readRange(worksheet,
+                OpenXLSX::XLCellReference(range->topLeft.row, range->topLeft.column),
+                OpenXLSX::XLCellReference(range->bottomRight.row, range->bottomRight.column),
+                pool.get());
 
-                data.push_back(rowData);
-            }
-            
             // 创建RangeData
-            m_rangeData = std::make_shared<RangeData>(rangeAddress, data);
-            
-            qDebug() << "ReadRangeModel: Successfully read range data:"
-                     << rowCount << "rows x" << colCount << "cols";
-            emit dataUpdated(0);
+            result.rangeData = std::make_shared<RangeData>(rangeAddress, data, std::move(pool));
+        }
 
-        }, m_widget, "ReadRangeModel", QString("读取范围 %1").arg(rangeAddress));
+        // 解码了整个工作表时保存其已使用区域，之后任意范围都可以从磁盘缓存读取；
+        // 数据来自内存中已有的值或磁盘缓存时不再写入。下游节点不会修改输出数据，可以直接交给后台线程
+        if (!cachePath.isEmpty()) {
+            if (decoded) {
+                SheetCache::instance().storeSheetAsync(cachePath, sheetData->sheetName(), values);
+            } else if (!cached && !values) {
+                SheetCache::instance().storeAsync(cachePath, sheetData->sheetName(), result.rangeData);
+            }
+        }
+        return result;
+    }
 
-        // 如果发生错误，清除数据
-        if (!m_rangeData) {
-            emit dataUpdated(0);
+    // 从工作簿文件流式读取，不解析工作表DOM
+    static std::shared_ptr<RangeData> readRangeStreaming(const ReadRequest& request, const QString& rangeAddress)
+    {
+        qDebug() << "ReadRangeModel: Streaming range" << rangeAddress << "from" << request.sheetData->document()->filePath();
+        return createStreamingReader(*request.sheetData)->readRange(request.sheetData->sheetName(), rangeAddress);
+    }
+
+    // 已使用区域，与读取数据使用相同的来源（文件或已加载的文档）
+    static std::optional<CellRange> usedRange(const ReadRequest& request)
+    {
+        if (request.streaming && request.sheetData->document()) {
+            return createStreamingReader(*request.sheetData)->usedRange(request.sheetData->sheetName());
         }
+        const auto lock = request.sheetData->lockDom();
+        return SheetReader::usedRange(request.sheetData->worksheet());
+    }
+
+    static std::unique_ptr<StreamingSheetReader> createStreamingReader(const SheetData& sheetData)
+    {
+        auto document = sheetData.document();
+        const QString& filePath = document->filePath();
+
+        // 文件未变化时复用已打开文档的共享字符串句柄，否则重新流式加载
+        const auto cached = WorkbookCache::instance().find(WorkbookCache::FileStamp::of(filePath));
+        if (cached == document) {
+            return std::make_unique<StreamingSheetReader>(filePath, document->stringPool(), document->sharedStringHandles());
+        }
+        return std::make_unique<StreamingSheetReader>(filePath);
     }
 
 protected:
@@ -253,6 +457,18 @@ protected:
                 }
             });
 
+        propertyWidget->addCheckBoxProperty("流式读取", m_streamingCheckBox->isChecked(),
+            "streaming", [this](bool checked) {
+                m_streamingCheckBox->setChecked(checked);
+                qDebug() << "ReadRangeModel: Streaming read" << checked;
+            });
+
+        propertyWidget->addCheckBoxProperty("自动范围", m_autoRangeCheckBox->isChecked(),
+            "autoRange", [this](bool checked) {
+                m_autoRangeCheckBox->setChecked(checked);
+                qDebug() << "ReadRangeModel: Auto range" << checked;
+            });
+
         // 工作表连接状态
         propertyWidget->addSeparator();
         propertyWidget->addTitle("连接状态");
@@ -273,7 +489,8 @@ protected:
                 int rows = m_rangeData->rowCount();
                 int cols = m_rangeData->columnCount();
 
-                propertyWidget->addInfoProperty("读取范围", m_rangeEdit->text(), "color: #2E86AB; font-weight: bold;");
+                const QString readRange = m_autoRangeCheckBox->isChecked() ? m_usedRangeAddress : m_rangeEdit->text();
+                propertyWidget->addInfoProperty("读取范围", readRange, "color: #2E86AB; font-weight: bold;");
                 propertyWidget->addInfoProperty("数据大小", QString("%1行 x %2列").arg(rows).arg(cols), "color: #333; font-weight: bold;");
                 propertyWidget->addInfoProperty("总单元格数", QString::number(rows * cols), "color: #666;");
 
@@ -332,6 +549,9 @@ protected:
 private:
     QWidget* m_widget;
     QLineEdit* m_rangeEdit;
+    QCheckBox* m_streamingCheckBox;
+    QCheckBox* m_autoRangeCheckBox;
+    QString m_usedRangeAddress;     ///< 自动模式下最近一次读取的已使用区域
 
     std::shared_ptr<SheetData> m_sheetData;
     std::shared_ptr<RangeData> m_rangeData;
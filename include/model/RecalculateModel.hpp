@@ -0,0 +1,388 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include "BaseNodeModel.hpp"
+#include "CellReference.hpp"
+#include "FormulaEngine.hpp"
+#include "StreamingSheetReader.hpp"
+#include "WorkbookCache.hpp"
+#include "data/RangeData.hpp"
+#include "data/SheetData.hpp"
+#include "widget/PropertyWidget.hpp"
+#include "ErrorHandler.hpp"
+
+#include <QFormLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QVBoxLayout>
+#include <QWidget>
+#include <QDebug>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <utility>
+
+/**
+ * @brief 公式计算节点
+ *
+ * 加载工作表中的值和公式（FormulaEngine），把输入的范围数据写入"写入位置"开始的单元格，
+ * 重算公式后输出指定范围的计算结果，不需要经过Excel：
+ * - 工作表第一次连接时重算所有公式，公式单元格不再依赖文件中的缓存值
+ * - 之后输入数据变化时只写入变化的单元格，只重算受影响的公式
+ * - 输入区域缩小或写入位置改变时，从文件重新加载工作表，被覆盖过的单元格恢复原值
+ *
+ * 公式从磁盘上的工作簿文件流式读取，不访问工作表DOM。加载和重算通过startCompute()在工作线程中执行：
+ * 计算期间引擎交给任务独占，结果应用时再放回节点；计算被取消或失败时丢弃引擎，下次从文件重新加载。
+ */
+class RecalculateModel : public BaseNodeModel
+{
+    Q_OBJECT
+
+public:
+    RecalculateModel()
+    {
+        m_widget = new QWidget();
+        auto* layout = new QVBoxLayout(m_widget);
+        layout->setContentsMargins(4, 4, 4, 4);
+        layout->setSpacing(2);
+
+        auto* form = new QFormLayout();
+        form->setContentsMargins(0, 0, 0, 0);
+
+        m_inputCellEdit = new QLineEdit("A1");
+        m_inputCellEdit->setPlaceholderText("A1");
+        m_inputCellEdit->setToolTip("输入数据写入的左上角单元格");
+        form->addRow("写入:", m_inputCellEdit);
+
+        m_outputRangeEdit = new QLineEdit();
+        m_outputRangeEdit->setPlaceholderText("留空输出已使用区域");
+        m_outputRangeEdit->setMinimumWidth(100);
+        form->addRow("输出:", m_outputRangeEdit);
+        layout->addLayout(form);
+
+        m_statusLabel = new QLabel("等待工作表...");
+        m_statusLabel->setStyleSheet("color: #666; font-size: 11px;");
+        layout->addWidget(m_statusLabel);
+
+        connect(m_inputCellEdit, &QLineEdit::editingFinished, this, &RecalculateModel::recalculate);
+        connect(m_outputRangeEdit, &QLineEdit::editingFinished, this, &RecalculateModel::recalculate);
+
+        registerLineEdit("inputCell", m_inputCellEdit, "写入位置");
+        registerLineEdit("outputRange", m_outputRangeEdit, "输出范围");
+    }
+
+    QString caption() const override
+    {
+        return "公式计算";
+    }
+
+    bool captionVisible() const override
+    {
+        return true;
+    }
+
+    QString name() const override
+    {
+        return "Recalculate";
+    }
+
+    QWidget* embeddedWidget() override
+    {
+        return m_widget;
+    }
+
+    unsigned int nPorts(QtNodes::PortType portType) const override
+    {
+        return portType == QtNodes::PortType::In ? 2 : 1;
+    }
+
+    QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        if (portType == QtNodes::PortType::In && portIndex == 0) {
+            return SheetData().type();
+        }
+        return RangeData().type();
+    }
+
+    bool portCaptionVisible(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        return portType == QtNodes::PortType::In;
+    }
+
+    QString portCaption(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        if (portType != QtNodes::PortType::In) {
+            return {};
+        }
+        return portIndex == 0 ? "工作表" : "输入值";
+    }
+
+    std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex const port) override
+    {
+        return m_rangeData;
+    }
+
+    void setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex const portIndex) override
+    {
+        applyInput(nodeData, portIndex);
+
+        // 工作表和输入值一起到达时只在最后计算一次
+        if (!inputsPending()) {
+            recalculate();
+        }
+    }
+
+    // 重算不访问DOM，在工作线程中执行，见createConcurrentTask()
+    ThreadAffinity threadAffinity() const override
+    {
+        return ThreadAffinity::AnyThread;
+    }
+
+    ConcurrentTask createConcurrentTask(const Inputs& inputs) override
+    {
+        for (const auto& [portIndex, nodeData] : inputs) {
+            applyInput(nodeData, portIndex);
+        }
+        if (!m_sheetData || !m_sheetData->document()) {
+            // 没有工作表，由setInData()清空输出
+            return {};
+        }
+        return recalcTask();
+    }
+
+private:
+    void applyInput(const std::shared_ptr<QtNodes::NodeData>& nodeData, QtNodes::PortIndex portIndex)
+    {
+        if (portIndex == 0) {
+            // 换了工作表，公式需要重新加载
+            m_sheetData = std::dynamic_pointer_cast<SheetData>(nodeData);
+            m_engine.reset();
+            m_writtenArea.reset();
+        } else {
+            m_inputData = std::dynamic_pointer_cast<RangeData>(nodeData);
+        }
+    }
+
+    void recalculate()
+    {
+        if (!m_sheetData || !m_sheetData->document()) {
+            cancelCompute();
+            m_engine.reset();
+            m_writtenArea.reset();
+            m_rangeData.reset();
+            m_statusLabel->setText("等待工作表...");
+            emit dataUpdated(0);
+            return;
+        }
+
+        // 在工作线程中计算，之前尚未完成的计算被取消
+        startCompute(recalcTask());
+    }
+
+    /**
+     * @brief 一次计算使用的全部状态
+     *
+     * 由GUI线程创建，计算期间只由工作线程访问，计算结束后在GUI线程中应用。
+     */
+    struct Evaluation
+    {
+        std::shared_ptr<SheetData> sheetData;
+        std::shared_ptr<RangeData> inputData;
+        QString inputCell;
+        QString outputAddress;
+
+        std::shared_ptr<FormulaEngine> engine;      ///< 为空时从文件加载
+        std::optional<CellRange> writtenArea;
+
+        std::shared_ptr<RangeData> rangeData;       ///< 计算结果
+        QString status;
+    };
+
+    // 引擎交给任务独占，计算期间节点中不保留引擎
+    ConcurrentTask recalcTask()
+    {
+        auto evaluation = std::make_shared<Evaluation>();
+        evaluation->sheetData = m_sheetData;
+        evaluation->inputData = m_inputData;
+        evaluation->inputCell = m_inputCellEdit->text().trimmed().toUpper();
+        evaluation->outputAddress = m_outputRangeEdit->text().trimmed().toUpper();
+        evaluation->engine = std::move(m_engine);
+        evaluation->writtenArea = std::exchange(m_writtenArea, std::nullopt);
+
+        return [this, evaluation](ComputeContext& context) -> ApplyResult {
+            try {
+                evaluateSheet(*evaluation);
+                if (context.isCancelled()) {
+                    return {};
+                }
+                return [this, evaluation]() {
+                    m_engine = std::move(evaluation->engine);
+                    m_writtenArea = evaluation->writtenArea;
+                    m_rangeData = evaluation->rangeData;
+                    m_statusLabel->setText(evaluation->status);
+                    emit dataUpdated(0);
+                };
+            } catch (...) {
+                // 引擎可能只写入了部分输入，丢弃后下次从文件重新加载
+                return [this, error = std::current_exception()]() {
+                    m_rangeData.reset();
+                    SAFE_EXECUTE({
+                        std::rethrow_exception(error);
+                    }, m_widget, "RecalculateModel", "公式计算");
+                    emit dataUpdated(0);
+                };
+            }
+        };
+    }
+
+    // 在工作线程中调用，只访问evaluation
+    static void evaluateSheet(Evaluation& evaluation)
+    {
+        const QString& inputCell = evaluation.inputCell;
+        const auto& inputData = evaluation.inputData;
+        const auto anchor = CellReference::parseA1(inputCell.isEmpty() ? QString("A1") : inputCell);
+        if (!anchor) {
+            throw TinaFlowException::invalidCellAddress(inputCell);
+        }
+
+        std::optional<CellRange> inputArea;
+        if (inputData && !inputData->isEmpty()) {
+            const uint64_t lastRow = anchor->row + static_cast<uint64_t>(inputData->rowCount()) - 1;
+            const uint64_t lastColumn = anchor->column + static_cast<uint64_t>(inputData->columnCount()) - 1;
+            if (lastRow > CellReference::MaxRows || lastColumn > CellReference::MaxColumns) {
+                throw TinaFlowException::invalidRange(QString("%1 (%2行 x %3列)")
+                    .arg(inputCell).arg(inputData->rowCount()).arg(inputData->columnCount()));
+            }
+            inputArea = CellRange{*anchor, {static_cast<uint32_t>(lastRow), static_cast<uint16_t>(lastColumn)}};
+        }
+
+        // 之前写入的单元格不在新的输入区域内时无法逐个恢复，从文件重新加载
+        auto& engine = evaluation.engine;
+        const auto& writtenArea = evaluation.writtenArea;
+        const bool reload = !engine || (writtenArea && (!inputArea || !inputArea->contains(*writtenArea)));
+        if (reload) {
+            qDebug() << "RecalculateModel: Loading formulas from" << QString::fromStdString(evaluation.sheetData->sheetName());
+            engine = FormulaEngine::fromSheet(*createStreamingReader(*evaluation.sheetData), evaluation.sheetData->sheetName());
+            evaluation.writtenArea.reset();
+        }
+
+        // 只写入与当前值不同的单元格，未变化的单元格不会触发重算
+        int written = 0;
+        if (inputArea) {
+            for (int row = 0; row < inputData->rowCount(); ++row) {
+                for (int col = 0; col < inputData->columnCount(); ++col) {
+                    const CellPosition cell{anchor->row + row, static_cast<uint16_t>(anchor->column + col)};
+                    const QVariant value = inputData->cellValue(row, col);
+                    if (reload || engine->hasFormula(cell) || engine->value(cell) != value) {
+                        engine->setValue(cell, value);
+                        ++written;
+                    }
+                }
+            }
+            evaluation.writtenArea = inputArea;
+        }
+
+        const FormulaEngine::RecalcStats stats = reload ? engine->recalculateAll() : engine->recalculate();
+
+        std::optional<CellRange> outputRange;
+        if (evaluation.outputAddress.isEmpty()) {
+            outputRange = engine->usedRange();
+        } else {
+            const auto parsed = CellReference::parseRange(evaluation.outputAddress);
+            if (!parsed) {
+                throw TinaFlowException::invalidRange(evaluation.outputAddress);
+            }
+            outputRange = *parsed;
+        }
+        if (outputRange) {
+            evaluation.rangeData = engine->readRange(*outputRange);
+        }
+
+        QString status = QString("%1个公式，重算%2个").arg(engine->formulaCount()).arg(stats.recalculated);
+        if (stats.circular > 0) {
+            status += QString("，%1个循环引用").arg(stats.circular);
+        }
+        evaluation.status = status;
+        qDebug() << "RecalculateModel: Wrote" << written << "cells, recalculated" << stats.recalculated
+                 << "formulas in" << stats.levels << "levels";
+    }
+
+    static std::unique_ptr<StreamingSheetReader> createStreamingReader(const SheetData& sheetData)
+    {
+        auto document = sheetData.document();
+        const QString& filePath = document->filePath();
+
+        // 文件未变化时复用已打开文档的共享字符串句柄，否则重新流式加载
+        const auto cached = WorkbookCache::instance().find(WorkbookCache::FileStamp::of(filePath));
+        if (cached == document) {
+            return std::make_unique<StreamingSheetReader>(filePath, document->stringPool(), document->sharedStringHandles());
+        }
+        return std::make_unique<StreamingSheetReader>(filePath);
+    }
+
+protected:
+    QString getNodeTypeName() const override
+    {
+        return "RecalculateModel";
+    }
+
+    void onInputsReady() override
+    {
+        recalculate();
+    }
+
+    QString getDisplayName() const override
+    {
+        return "公式计算";
+    }
+
+    QString getDescription() const override
+    {
+        return "写入输入值并重算工作表中的公式";
+    }
+
+    bool createPropertyPanel(PropertyWidget* propertyWidget) override
+    {
+        propertyWidget->addTitle("公式计算设置");
+        propertyWidget->addDescription("输入值写入工作表后重算公式，只重算受影响的单元格");
+
+        propertyWidget->addModeToggleButtons();
+
+        propertyWidget->addTextProperty("写入位置", m_inputCellEdit->text(),
+            "inputCell", "输入数据的左上角单元格，如B2",
+            [this](const QString& cell) {
+                m_inputCellEdit->setText(cell.toUpper());
+                recalculate();
+            });
+
+        propertyWidget->addTextProperty("输出范围", m_outputRangeEdit->text(),
+            "outputRange", "留空输出已使用区域",
+            [this](const QString& range) {
+                m_outputRangeEdit->setText(range.toUpper());
+                recalculate();
+            });
+
+        propertyWidget->addSeparator();
+        if (m_engine) {
+            propertyWidget->addInfoProperty("公式数", QString::number(m_engine->formulaCount()), "color: #2E86AB; font-weight: bold;");
+        }
+        propertyWidget->addInfoProperty("状态", m_statusLabel->text(), "color: #666;");
+        return true;
+    }
+
+private:
+    QWidget* m_widget;
+    QLineEdit* m_inputCellEdit;
+    QLineEdit* m_outputRangeEdit;
+    QLabel* m_statusLabel;
+
+    std::shared_ptr<SheetData> m_sheetData;
+    std::shared_ptr<RangeData> m_inputData;
+    std::shared_ptr<RangeData> m_rangeData;
+
+    std::shared_ptr<FormulaEngine> m_engine;    ///< 计算期间由任务持有，见recalcTask()
+    std::optional<CellRange> m_writtenArea;     ///< 已写入引擎的输入区域
+};
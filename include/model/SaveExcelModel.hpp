@@ -7,9 +7,14 @@
 #include "BaseNodeModel.hpp"
 #include "data/RangeData.hpp"
 #include "data/BooleanData.hpp"
+#include "data/RowBatchData.hpp"
 #include "widget/PropertyWidget.hpp"
 #include "ErrorHandler.hpp"
 #include "DataValidator.hpp"
+#include "SheetWriter.hpp"
+#include "StreamingSheetWriter.hpp"
+#include "WorkbookCache.hpp"
+#include "WorkbookWriteSession.hpp"
 
 #include <QWidget>
 #include <QVBoxLayout>
@@ -21,10 +26,15 @@
 #include <QMessageBox>
 #include <QProgressBar>
 #include <QGroupBox>
+#include <QCheckBox>
+#include <QComboBox>
 #include <QtNodes/NodeDelegateModel>
 #include <QDebug>
 
 #include <OpenXLSX.hpp>
+#include <functional>
+#include <iterator>
+#include <memory>
 
 /**
  * @brief 保存Excel文件的节点模型
@@ -34,9 +44,19 @@
  * - 支持自定义文件路径和sheet名称
  * - 支持创建新文件或追加到现有文件
  * - 提供保存进度反馈
+ * - 先写入同目录下的临时文件，完成后原子替换目标文件
+ * - 后台保存模式下在工作线程中写入数据快照，编辑器保持可用，停止按钮可以中途取消
+ * - 流式导出模式不构建工作表DOM，按行直接生成XML，适合超大结果集；
+ *   该模式生成只包含一个工作表的新文件
+ * - 流程运行期间，写往同一文件的多个保存节点经WorkbookWriteSession合并，
+ *   运行中其他节点都完成后所有工作表一次写出（流式导出时得到包含这些工作表的新文件）；
+ *   停止运行时尚未写出的工作表不再写出
+ * - 压缩级别可选，仅存储模式打包最快（标准写入模式由OpenXLSX决定压缩级别）
  * 
  * 输入端口：
  * - 0: RangeData - 要保存的数据
+ * - 1: RowBatchData - 分批到达的行流，每批到达时立即写入临时文件，
+ *   流结束后在后台打包为xlsx；总是按流式导出写入（标准写入模式按共享字符串处理），不参与合并写入
  * 
  * 输出端口：
  * - 0: BooleanData - 保存成功/失败状态
@@ -84,6 +104,35 @@ public:
         sheetLayout->addWidget(m_sheetNameEdit);
         
         fileLayout->addLayout(sheetLayout);
+
+        // 后台保存
+        m_asyncCheckBox = new QCheckBox("后台保存");
+        m_asyncCheckBox->setChecked(true);
+        m_asyncCheckBox->setToolTip("在后台线程中保存数据快照，保存期间编辑器保持可用");
+        fileLayout->addWidget(m_asyncCheckBox);
+
+        // 写入模式
+        auto* modeLayout = new QHBoxLayout();
+        modeLayout->addWidget(new QLabel("写入模式:"));
+
+        m_exportModeCombo = new QComboBox();
+        m_exportModeCombo->addItems(exportModeNames());
+        m_exportModeCombo->setToolTip("流式导出不构建工作表DOM，内存占用与行数无关，但会覆盖整个文件");
+        modeLayout->addWidget(m_exportModeCombo);
+
+        fileLayout->addLayout(modeLayout);
+
+        // 压缩级别
+        auto* compressionLayout = new QHBoxLayout();
+        compressionLayout->addWidget(new QLabel("压缩级别:"));
+
+        m_compressionCombo = new QComboBox();
+        m_compressionCombo->addItems(compressionLevelNames());
+        m_compressionCombo->setCurrentIndex(2);
+        m_compressionCombo->setToolTip("仅存储不压缩，打包最快但文件最大；标准写入模式不受此设置影响");
+        compressionLayout->addWidget(m_compressionCombo);
+
+        fileLayout->addLayout(compressionLayout);
         
         mainLayout->addWidget(fileGroup);
 
@@ -116,16 +165,28 @@ public:
         connect(m_filePathEdit, &QLineEdit::textChanged, this, &SaveExcelModel::onFilePathChanged);
         connect(m_sheetNameEdit, &QLineEdit::textChanged, this, &SaveExcelModel::onSheetNameChanged);
 
+        connect(&WorkbookWriteSession::instance(), &WorkbookWriteSession::workbookWritten,
+                this, &SaveExcelModel::onWorkbookWritten);
+
         // 初始化输出数据
         m_saveResult = std::make_shared<BooleanData>(false, "未开始保存");
 
         // 注册需要保存的属性
         registerLineEdit("filePath", m_filePathEdit, "文件路径");
         registerLineEdit("sheetName", m_sheetNameEdit, "Sheet名称");
+        registerCheckBox("asyncSave", m_asyncCheckBox, "后台保存");
+        registerComboBox("exportMode", m_exportModeCombo, "写入模式");
+        registerComboBox("compressionLevel", m_compressionCombo, "压缩级别");
 
         qDebug() << "SaveExcelModel: Created";
     }
 
+    ~SaveExcelModel() override
+    {
+        // 节点被删除后，登记的工作表不再写出
+        WorkbookWriteSession::instance().withdraw(this);
+    }
+
     QString caption() const override
     {
         return "保存Excel";
@@ -149,7 +210,7 @@ public:
     unsigned int nPorts(QtNodes::PortType portType) const override
     {
         if (portType == QtNodes::PortType::In) {
-            return 1; // RangeData输入
+            return 2; // RangeData输入和行流输入
         } else {
             return 1; // BooleanData输出
         }
@@ -158,12 +219,25 @@ public:
     QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
     {
         if (portType == QtNodes::PortType::In) {
-            return RangeData().type();
+            return portIndex == 1 ? RowBatchData().type() : RangeData().type();
         } else {
             return BooleanData().type();
         }
     }
 
+    bool portCaptionVisible(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        return portType == QtNodes::PortType::In;
+    }
+
+    QString portCaption(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        if (portType != QtNodes::PortType::In) {
+            return {};
+        }
+        return portIndex == 1 ? "行流" : "范围";
+    }
+
     std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex const port) override
     {
         return m_saveResult;
@@ -171,6 +245,11 @@ public:
 
     void setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex const portIndex) override
     {
+        if (portIndex == 1) {
+            onRowBatch(std::dynamic_pointer_cast<RowBatchData>(nodeData));
+            return;
+        }
+
         qDebug() << "SaveExcelModel::setInData called, portIndex:" << portIndex;
         
         if (!nodeData) {
@@ -180,7 +259,7 @@ public:
             return;
         }
         
-        m_rangeData = std::dynamic_pointer_cast<RangeData>(nodeData);
+        m_rangeData = std::dynamic_pointer_cast<const RangeData>(nodeData);
         if (m_rangeData) {
             qDebug() << "SaveExcelModel: Successfully received RangeData with"
                      << m_rangeData->rowCount() << "rows and"
@@ -195,6 +274,40 @@ public:
         updateUI();
     }
 
+    // 上一次保存失败时总是重新保存
+    bool isMemoizable() const override
+    {
+        return m_saveResult && m_saveResult->value();
+    }
+
+    // 目标文件被修改或删除后重新运行时需要重新保存
+    QString externalState() const override
+    {
+        return WorkbookCache::FileStamp::of(m_filePathEdit->text().trimmed()).toString();
+    }
+
+    // 合并写入在运行中其他节点都完成后才写出
+    bool isDeferredToRunEnd() const override
+    {
+        return m_sessionTicket != 0;
+    }
+
+    // 取消正在进行的后台保存（由停止按钮调用），临时文件被丢弃，目标文件保持不变
+    void cancelExecution() override
+    {
+        if (!isComputing()) {
+            return;
+        }
+        const bool waitingForSession = m_sessionTicket != 0;
+        cancelCompute();
+        abandonSessionSave();
+        m_progressBar->setVisible(false);
+        m_saveButton->setText("已取消");
+        m_saveButton->setStyleSheet("QPushButton { background-color: #fff3cd; color: #856404; }");
+        // 登记的工作表从会话中移除，不会再写出
+        m_statusLabel->setText(waitingForSession ? "已停止，合并写入的工作表未写出" : "保存已取消，未写入文件");
+    }
+
 protected:
     // 实现基类的虚函数
     QString getNodeTypeName() const override
@@ -202,6 +315,14 @@ protected:
         return "SaveExcelModel";
     }
 
+    void onComputeProgress(int value, int minimum, int maximum, const QString& text) override
+    {
+        Q_UNUSED(minimum);
+        Q_UNUSED(maximum);
+        Q_UNUSED(text);
+        m_progressBar->setValue(value);
+    }
+
     // 自定义加载后处理
     void onLoad(const QJsonObject& json) override
     {
@@ -243,6 +364,11 @@ private slots:
 private:
     void updateUI()
     {
+        // 后台保存、等待合并写入或接收行流期间保持"保存中"状态，结束后由finishSave更新
+        if (isComputing() || m_rowWriter) {
+            return;
+        }
+
         bool hasData = m_rangeData && !m_rangeData->isEmpty();
         bool hasPath = !m_filePathEdit->text().trimmed().isEmpty();
         bool hasSheetName = !m_sheetNameEdit->text().trimmed().isEmpty();
@@ -282,11 +408,87 @@ private:
             return;
         }
 
-        // 自动保存
-        saveDataToExcel(filePath, sheetName);
+        // 运行期间与写往同一文件的其他节点合并写入
+        if (WorkbookWriteSession::instance().isActive()) {
+            queueSessionSave(filePath, sheetName);
+        } else if (m_asyncCheckBox->isChecked()) {
+            saveDataToExcelAsync(filePath, sheetName);
+        } else {
+            saveDataToExcel(filePath, sheetName);
+        }
+    }
+
+    /**
+     * @brief 写入模式，与写入模式下拉框的索引一致
+     */
+    enum class ExportMode
+    {
+        Document = 0,               ///< 通过OpenXLSX写入，保留文件中的其他工作表
+        StreamingSharedStrings,     ///< 流式导出，字符串写入共享字符串表
+        StreamingInlineStrings      ///< 流式导出，字符串内联写入单元格
+    };
+
+    static QStringList exportModeNames()
+    {
+        return {"标准写入", "流式导出（共享字符串）", "流式导出（内联字符串）"};
     }
 
+    ExportMode exportMode() const
+    {
+        return static_cast<ExportMode>(m_exportModeCombo->currentIndex());
+    }
+
+    StreamingSheetWriter::StringMode stringMode() const
+    {
+        return exportMode() == ExportMode::StreamingInlineStrings ? StreamingSheetWriter::StringMode::InlineStrings
+                                                                  : StreamingSheetWriter::StringMode::SharedStrings;
+    }
+
+    /**
+     * @brief 压缩级别下拉框的选项，与CompressionLevels一一对应
+     */
+    static QStringList compressionLevelNames()
+    {
+        return {"仅存储（最快）", "快速", "标准", "最高"};
+    }
+
+    static constexpr int CompressionLevels[] = {StreamingSheetWriter::StoreOnly, 1,
+                                                StreamingSheetWriter::DefaultCompressionLevel, 9};
+
+    int compressionLevel() const
+    {
+        const int index = qBound(0, m_compressionCombo->currentIndex(), static_cast<int>(std::size(CompressionLevels)) - 1);
+        return CompressionLevels[index];
+    }
+
+    /**
+     * @brief 保存结果，由同步保存或后台任务产生
+     */
+    struct SaveResult
+    {
+        bool success = false;
+        QString message;
+        QString filePath;
+        QString sheetName;
+        int rows = 0;
+        int cols = 0;
+    };
+
     void saveDataToExcel(const QString& filePath, const QString& sheetName);
+    void onRowBatch(const std::shared_ptr<RowBatchData>& data);
+    void finishRowStream(const RowBatchData& end);
+    void saveDataToExcelAsync(const QString& filePath, const QString& sheetName);
+    void queueSessionSave(const QString& filePath, const QString& sheetName);
+    void onWorkbookWritten(const QString& filePath, const QList<quint64>& tickets, int sheetCount,
+                           bool success, const QString& message);
+    void abandonSessionSave();
+    void beginSaveUI(int totalRows, bool showProgress = true);
+    void finishSave(const SaveResult& result);
+
+    /**
+     * @brief 按当前的写入模式和压缩级别生成待写入的工作表
+     */
+    WorkbookWriteSession::SheetEntry sheetEntry(const QString& sheetName, std::shared_ptr<const RangeData> data) const;
 
     // 新的属性面板实现
     bool createPropertyPanel(PropertyWidget* propertyWidget) override
@@ -317,6 +519,24 @@ private:
                 }
             });
 
+        propertyWidget->addCheckBoxProperty("后台保存", m_asyncCheckBox->isChecked(),
+            "asyncSave", [this](bool checked) {
+                m_asyncCheckBox->setChecked(checked);
+                qDebug() << "SaveExcelModel: Async save" << checked;
+            });
+
+        propertyWidget->addComboProperty("写入模式", exportModeNames(),
+            m_exportModeCombo->currentIndex(), "exportMode", [this](int index) {
+                m_exportModeCombo->setCurrentIndex(index);
+                qDebug() << "SaveExcelModel: Export mode" << index;
+            });
+
+        propertyWidget->addComboProperty("压缩级别", compressionLevelNames(),
+            m_compressionCombo->currentIndex(), "compressionLevel", [this](int index) {
+                m_compressionCombo->setCurrentIndex(index);
+                qDebug() << "SaveExcelModel: Compression level" << compressionLevel();
+            });
+
         // 数据信息
         if (m_rangeData && !m_rangeData->isEmpty()) {
             propertyWidget->addSeparator();
@@ -366,6 +586,12 @@ private:
                 m_sheetNameEdit->setText(newSheetName);
                 qDebug() << "SaveExcelModel: Sheet name changed to" << newSheetName;
             }
+        } else if (propertyName == "asyncSave") {
+            m_asyncCheckBox->setChecked(value.toBool());
+        } else if (propertyName == "exportMode") {
+            m_exportModeCombo->setCurrentIndex(value.toInt());
+        } else if (propertyName == "compressionLevel") {
+            m_compressionCombo->setCurrentIndex(value.toInt());
         }
     }
 
@@ -387,7 +613,22 @@ private:
     QPushButton* m_saveButton;
     QProgressBar* m_progressBar;
     QLabel* m_statusLabel;
+    QCheckBox* m_asyncCheckBox;
+    QComboBox* m_exportModeCombo;
+    QComboBox* m_compressionCombo;
+
+    // 等待合并写入的工作表
+    quint64 m_sessionTicket = 0;
+    SaveResult m_sessionSave;
+    std::shared_ptr<QPromise<ApplyResult>> m_sessionPromise;    ///< 合并写入完成时应用结果
+
+    // 正在接收的行流
+    std::unique_ptr<StreamingSheetWriter::RowWriter> m_rowWriter;
+    quint64 m_rowStreamId = 0;
+    int m_rowStreamColumns = 0;
+    QString m_rowStreamPath;
+    QString m_rowStreamSheet;
     
-    std::shared_ptr<RangeData> m_rangeData;
+    std::shared_ptr<const RangeData> m_rangeData;   ///< 上游输出，之后不会再被修改，工作线程可以直接共享
     std::shared_ptr<BooleanData> m_saveResult;
 };
@@ -13,9 +13,18 @@
 #include <QComboBox>
 #include <qgraphicsproxywidget.h>
 #include <QHBoxLayout>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #include "QtNodes/internal/ConnectionGraphicsObject.hpp"
 
+/**
+ * @brief 从工作簿中选择工作表的节点模型
+ *
+ * 工作表名称通过startCompute()在工作线程中读取，读取时锁定所在的文档（见WorkbookDocument::lockDom()），
+ * 不会因为同一文档上正在进行的DOM读取阻塞GUI线程。选择工作表时只检查读取到的名称，不再访问DOM。
+ */
 class SelectSheetModel : public BaseNodeModel
 {
     Q_OBJECT
@@ -95,6 +104,43 @@ public:
         refreshCombo();
     }
 
+    // 名称在工作线程中读取，见createConcurrentTask()
+    ThreadAffinity threadAffinity() const override
+    {
+        return ThreadAffinity::AnyThread;
+    }
+
+    ConcurrentTask createConcurrentTask(const Inputs& inputs) override
+    {
+        const auto input = inputs.find(0);
+        if (input != inputs.end()) {
+            m_workbook = std::dynamic_pointer_cast<WorkbookData>(input->second);
+            m_dataAlreadyCreated = false; // 重置标记，允许重新创建数据
+        }
+        if (!m_workbook || !m_workbook->isValid()) {
+            // 没有可读取的工作簿，由setInData()显示提示
+            return {};
+        }
+
+        return [this, workbook = m_workbook](ComputeContext& context) -> ApplyResult {
+            try {
+                auto sheetNames = readSheetNames(*workbook);
+                if (context.isCancelled()) {
+                    return {};
+                }
+                return [this, sheetNames = std::move(sheetNames)]() { populateCombo(sheetNames); };
+            } catch (const std::exception& e) {
+                return [this, error = QString::fromUtf8(e.what())]() { showReadError(error); };
+            }
+        };
+    }
+
+    // 输出只由输入的工作簿和选中的工作表名称决定
+    bool isMemoizable() const override
+    {
+        return true;
+    }
+
     [[nodiscard]] QJsonObject save() const override
     {
         QJsonObject modelJson = NodeDelegateModel::save(); // 调用基类方法保存model-name
@@ -124,87 +170,113 @@ private:
         const QString sheetName = m_comboBox->itemText(index);
         qDebug() << "SelectSheetModel: Selected sheet:" << sheetName;
 
-        try {
-            // 确保使用UTF-8编码转换回std::string
-            std::string sheetNameUtf8 = sheetName.toUtf8().toStdString();
-            auto ws = m_workbook->workbook()->worksheet(sheetNameUtf8);
-            m_selectedSheet = sheetNameUtf8;
-            m_sheetData = std::make_shared<SheetData>(m_selectedSheet, ws);
-            qDebug() << "SelectSheetModel: Created SheetData for:" << sheetName;
-            emit dataUpdated(0);
-        } catch (const std::exception& e) {
-            qDebug() << "SelectSheetModel: Error creating worksheet:" << e.what();
+        // 确保使用UTF-8编码转换回std::string
+        std::string sheetNameUtf8 = sheetName.toUtf8().toStdString();
+        if (std::find(m_sheetNames.begin(), m_sheetNames.end(), sheetNameUtf8) == m_sheetNames.end()) {
+            qDebug() << "SelectSheetModel: Error creating worksheet: worksheet does not exist:" << sheetName;
+            return;
         }
+        m_selectedSheet = sheetNameUtf8;
+        // 只登记工作表，XML在下游第一次读取时才解析
+        m_sheetData = std::make_shared<SheetData>(m_workbook->sharedDocument(), m_selectedSheet);
+        qDebug() << "SelectSheetModel: Created SheetData for:" << sheetName;
+        emit dataUpdated(0);
+    }
+
+    // 读取工作表名称，在工作线程中调用时也只通过文档的DOM锁访问工作簿
+    static std::vector<std::string> readSheetNames(const WorkbookData& workbook)
+    {
+        const auto lock = workbook.lockDom();
+        return workbook.workbook()->sheetNames();
     }
 
     void refreshCombo()
     {
         qDebug() << "SelectSheetModel::refreshCombo called";
 
+        if (!m_workbook || !m_workbook->isValid())
+        {
+            qDebug() << "SelectSheetModel: No valid workbook";
+            showPlaceholder("请选择工作表");
+            return;
+        }
+
+        try {
+            populateCombo(readSheetNames(*m_workbook));
+        } catch (const std::exception& e) {
+            showReadError(QString::fromUtf8(e.what()));
+        }
+    }
+
+    void populateCombo(const std::vector<std::string>& sheetNames)
+    {
+        qDebug() << "SelectSheetModel: sheet count" << sheetNames.size();
+
         m_comboBox->blockSignals(true);
         m_comboBox->clear();
         m_sheetData.reset();
+        m_sheetNames = sheetNames;
 
-        if (m_workbook && m_workbook->isValid())
+        for (const auto& name : sheetNames)
         {
-            try {
-                const auto sheetNames = m_workbook->workbook()->sheetNames();
-                qDebug() << "SelectSheetModel: sheet count" << sheetNames.size();
-
-                for (const auto& name : sheetNames)
-                {
-                    // OpenXLSX使用UTF-8编码，确保正确转换为QString
-                    QString sheetName = QString::fromUtf8(name.c_str());
-                    qDebug() << "SelectSheetModel: Adding sheet:" << sheetName;
-                    qDebug() << "SelectSheetModel: Raw name bytes:" << QByteArray(name.c_str(), name.length()).toHex();
-                    m_comboBox->addItem(sheetName);
-                }
-
-                // 如果有之前选择的sheet，设置为当前选择
-                if (!m_selectedSheet.empty())
-                {
-                    QString selectedSheetName = QString::fromUtf8(m_selectedSheet.c_str());
-                    int index = m_comboBox->findText(selectedSheetName);
-                    if (index != -1) {
-                        m_comboBox->setCurrentIndex(index);
-                        qDebug() << "SelectSheetModel: Restored selected sheet:" << selectedSheetName;
-                    }
-                }
-                else if (sheetNames.size() > 0)
-                {
-                    // 如果没有之前的选择，自动选择第一个工作表
-                    m_comboBox->setCurrentIndex(0);
-                    qDebug() << "SelectSheetModel: Auto-selected first sheet";
-                    // 手动触发选择事件
-                    onIndexChanged(0);
-                }
-
-                // 重要：如果有恢复的选择，也要手动触发数据创建
-                if (!m_selectedSheet.empty() && !m_dataAlreadyCreated) {
-                    int currentIndex = m_comboBox->currentIndex();
-                    if (currentIndex >= 0) {
-                        qDebug() << "SelectSheetModel: Manually triggering data creation for restored sheet";
-                        m_dataAlreadyCreated = true; // 标记已经创建过数据
-                        onIndexChanged(currentIndex);
-                    }
-                }
+            // OpenXLSX使用UTF-8编码，确保正确转换为QString
+            QString sheetName = QString::fromUtf8(name.c_str());
+            qDebug() << "SelectSheetModel: Adding sheet:" << sheetName;
+            qDebug() << "SelectSheetModel: Raw name bytes:" << QByteArray(name.c_str(), name.length()).toHex();
+            m_comboBox->addItem(sheetName);
+        }
 
-                // 启用ComboBox
-                m_comboBox->setEnabled(true);
-                qDebug() << "SelectSheetModel: ComboBox enabled with" << m_comboBox->count() << "items";
-            } catch (const std::exception& e) {
-                qDebug() << "SelectSheetModel: Error in refreshCombo:" << e.what();
-                m_comboBox->addItem("错误：无法读取工作表");
-                m_comboBox->setEnabled(false);
+        // 如果有之前选择的sheet，设置为当前选择
+        if (!m_selectedSheet.empty())
+        {
+            QString selectedSheetName = QString::fromUtf8(m_selectedSheet.c_str());
+            int index = m_comboBox->findText(selectedSheetName);
+            if (index != -1) {
+                m_comboBox->setCurrentIndex(index);
+                qDebug() << "SelectSheetModel: Restored selected sheet:" << selectedSheetName;
             }
         }
-        else
+        else if (sheetNames.size() > 0)
         {
-            qDebug() << "SelectSheetModel: No valid workbook";
-            m_comboBox->addItem("请选择工作表");
-            m_comboBox->setEnabled(false);
+            // 如果没有之前的选择，自动选择第一个工作表
+            m_comboBox->setCurrentIndex(0);
+            qDebug() << "SelectSheetModel: Auto-selected first sheet";
+            // 手动触发选择事件
+            onIndexChanged(0);
         }
 
+        // 重要：如果有恢复的选择，也要手动触发数据创建
+        if (!m_selectedSheet.empty() && !m_dataAlreadyCreated) {
+            int currentIndex = m_comboBox->currentIndex();
+            if (currentIndex >= 0) {
+                qDebug() << "SelectSheetModel: Manually triggering data creation for restored sheet";
+                m_dataAlreadyCreated = true; // 标记已经创建过数据
+                onIndexChanged(currentIndex);
+            }
+        }
+
+        // 启用ComboBox
+        m_comboBox->setEnabled(true);
+        qDebug() << "SelectSheetModel: ComboBox enabled with" << m_comboBox->count() << "items";
+
+        m_comboBox->blockSignals(false);
+    }
+
+    void showReadError(const QString& error)
+    {
+        qDebug() << "SelectSheetModel: Error in refreshCombo:" << error;
+        showPlaceholder("错误：无法读取工作表");
+    }
+
+    // 清空选择，只显示一条不可选的提示
+    void showPlaceholder(const QString& text)
+    {
+        m_comboBox->blockSignals(true);
+        m_comboBox->clear();
+        m_sheetData.reset();
+        m_sheetNames.clear();
+        m_comboBox->addItem(text);
+        m_comboBox->setEnabled(false);
         m_comboBox->blockSignals(false);
     }
 
@@ -250,13 +322,10 @@ protected:
             propertyWidget->addSeparator();
             propertyWidget->addTitle("工作簿信息");
 
-            try {
-                auto workbook = m_workbook->workbook();
-                if (workbook) {
-                    int totalSheets = workbook->worksheetCount();
-                    propertyWidget->addInfoProperty("总工作表数", QString::number(totalSheets), "color: #666;");
-                }
-            } catch (...) {
+            // 使用已经读取的名称，不在GUI线程中等待文档的DOM锁
+            if (m_comboBox->isEnabled()) {
+                propertyWidget->addInfoProperty("总工作表数", QString::number(m_sheetNames.size()), "color: #666;");
+            } else {
                 propertyWidget->addInfoProperty("工作簿状态", "读取失败", "color: #999;");
             }
         } else {
@@ -285,5 +354,6 @@ private:
     std::shared_ptr<WorkbookData> m_workbook;
     std::shared_ptr<SheetData> m_sheetData;
     std::string m_selectedSheet;
+    std::vector<std::string> m_sheetNames; // 最近一次读取到的工作表名称
     bool m_dataAlreadyCreated = false;
 };
@@ -0,0 +1,239 @@
+//
+// Created by TinaFlow Team
+//
+
+#pragma once
+
+#include "BaseNodeModel.hpp"
+#include "CellReference.hpp"
+#include "RowBatchStream.hpp"
+#include "StreamingSheetReader.hpp"
+#include "WorkbookCache.hpp"
+#include "data/RowBatchData.hpp"
+#include "data/SheetData.hpp"
+#include "widget/PropertyWidget.hpp"
+#include "ErrorHandler.hpp"
+
+#include <QLabel>
+#include <QLineEdit>
+#include <QVBoxLayout>
+#include <QWidget>
+#include <memory>
+#include <optional>
+
+/**
+ * @brief 流式读取行节点
+ *
+ * 在后台线程中用StreamingSheetReader逐行解析工作表，按批次输出RowBatchData，
+ * 整个工作表不会同时出现在内存中。下游节点处理当前批次时，
+ * 读取线程已经在解析下一批；下游积压时读取线程暂停（见RowBatchStream）。
+ *
+ * 范围地址留空时读取工作表的已使用区域。读取的是磁盘上的工作簿文件。
+ */
+class StreamRowsModel : public BaseNodeModel
+{
+    Q_OBJECT
+
+public:
+    StreamRowsModel()
+    {
+        m_widget = new QWidget();
+        auto* layout = new QVBoxLayout(m_widget);
+        layout->setContentsMargins(4, 4, 4, 4);
+        layout->setSpacing(2);
+
+        m_rangeEdit = new QLineEdit();
+        m_rangeEdit->setPlaceholderText("留空读取已使用区域");
+        m_rangeEdit->setMinimumWidth(120);
+        layout->addWidget(m_rangeEdit);
+
+        m_statusLabel = new QLabel("等待工作表...");
+        m_statusLabel->setStyleSheet("color: #666; font-size: 11px;");
+        layout->addWidget(m_statusLabel);
+
+        m_stream = new RowBatchStream(this);
+        connect(m_stream, &RowBatchStream::dataReady, this, &StreamRowsModel::onDataReady);
+        connect(m_rangeEdit, &QLineEdit::editingFinished, this, &StreamRowsModel::startStream);
+
+        registerLineEdit("range", m_rangeEdit, "范围地址");
+    }
+
+    QString caption() const override
+    {
+        return "流式读取行";
+    }
+
+    bool captionVisible() const override
+    {
+        return true;
+    }
+
+    QString name() const override
+    {
+        return "StreamRows";
+    }
+
+    QWidget* embeddedWidget() override
+    {
+        return m_widget;
+    }
+
+    unsigned int nPorts(QtNodes::PortType portType) const override
+    {
+        return 1;
+    }
+
+    QtNodes::NodeDataType dataType(QtNodes::PortType portType, QtNodes::PortIndex portIndex) const override
+    {
+        if (portType == QtNodes::PortType::In) {
+            return SheetData().type();
+        }
+        return RowBatchData().type();
+    }
+
+    std::shared_ptr<QtNodes::NodeData> outData(QtNodes::PortIndex const port) override
+    {
+        return m_batch;
+    }
+
+    void setInData(std::shared_ptr<QtNodes::NodeData> nodeData, QtNodes::PortIndex const portIndex) override
+    {
+        m_sheetData = std::dynamic_pointer_cast<SheetData>(nodeData);
+        startStream();
+    }
+
+    // 取消正在进行的读取（由停止按钮调用）
+    void cancelExecution() override
+    {
+        if (m_stream->isRunning()) {
+            m_stream->cancel();
+            m_statusLabel->setText("已取消");
+        }
+    }
+
+private:
+    void startStream()
+    {
+        m_stream->cancel();
+
+        if (!m_sheetData || !m_sheetData->document()) {
+            m_statusLabel->setText("等待工作表...");
+            return;
+        }
+
+        const QString rangeAddress = m_rangeEdit->text().trimmed().toUpper();
+        std::optional<CellRange> range;
+        if (!rangeAddress.isEmpty()) {
+            const auto parsed = CellReference::parseRange(rangeAddress);
+            if (!parsed) {
+                SHOW_WARNING(QString("范围地址格式不正确: %1").arg(rangeAddress), "请输入如A1:C10的范围", m_widget);
+                return;
+            }
+            range = *parsed;
+        }
+
+        // 文件未变化时复用已打开文档的共享字符串句柄
+        auto document = m_sheetData->document();
+        const QString filePath = document->filePath();
+        std::shared_ptr<StringPool> pool;
+        std::vector<StringPool::Handle> sharedStrings;
+        const bool reuseStrings = WorkbookCache::instance().find(WorkbookCache::FileStamp::of(filePath)) == document;
+        if (reuseStrings) {
+            pool = document->stringPool();
+            sharedStrings = document->sharedStringHandles();
+        }
+        const std::string sheetName = m_sheetData->sheetName();
+
+        m_statusLabel->setText("读取中...");
+        qDebug() << "StreamRowsModel: Streaming" << (rangeAddress.isEmpty() ? QString("used range") : rangeAddress)
+                 << "of" << QString::fromStdString(sheetName) << "from" << filePath;
+
+        m_stream->start([filePath, reuseStrings, pool, sharedStrings, sheetName, range](RowBatchStream::Writer& writer) {
+            auto reader = reuseStrings ? std::make_unique<StreamingSheetReader>(filePath, pool, sharedStrings)
+                                       : std::make_unique<StreamingSheetReader>(filePath);
+
+            const std::optional<CellRange> cells = range ? range : reader->usedRange(sheetName);
+            if (!cells) {
+                writer.begin(0, 0);
+                return;
+            }
+
+            writer.begin(cells->columnCount(), static_cast<int>(cells->rowCount()));
+            reader->readRows(sheetName,
+                OpenXLSX::XLCellReference(cells->topLeft.row, cells->topLeft.column),
+                OpenXLSX::XLCellReference(cells->bottomRight.row, cells->bottomRight.column),
+                [&writer](uint32_t, const std::vector<QVariant>& values) {
+                    return writer.addRow(values);
+                });
+        });
+    }
+
+    void onDataReady(std::shared_ptr<RowBatchData> data)
+    {
+        if (data->isBatch()) {
+            const int received = data->firstRowIndex() + data->rowCount();
+            m_statusLabel->setText(data->totalRows() > 0
+                ? QString("已读取 %1 / %2 行").arg(received).arg(data->totalRows())
+                : QString("已读取 %1 行").arg(received));
+        } else if (data->isEnd()) {
+            if (!data->errorMessage().isEmpty()) {
+                m_statusLabel->setText("读取失败");
+                SHOW_WARNING(QString("流式读取失败: %1").arg(data->errorMessage()), "请检查工作簿文件和范围地址", m_widget);
+            } else if (!data->isCancelled()) {
+                m_statusLabel->setText(QString("完成，共 %1 行").arg(data->totalRows()));
+            }
+        }
+
+        m_batch = data;
+        Q_EMIT dataUpdated(0);
+
+        // 批次交给下游后不再保留，两批之间不占用数据内存
+        if (data->isBatch()) {
+            m_batch.reset();
+        }
+    }
+
+protected:
+    QString getNodeTypeName() const override
+    {
+        return "StreamRowsModel";
+    }
+
+    QString getDisplayName() const override
+    {
+        return "流式读取行";
+    }
+
+    QString getDescription() const override
+    {
+        return "分批读取工作表的行，内存占用与行数无关";
+    }
+
+    bool createPropertyPanel(PropertyWidget* propertyWidget) override
+    {
+        propertyWidget->addTitle("流式读取设置");
+        propertyWidget->addDescription("按批次输出工作表的行，下游节点逐批处理");
+
+        propertyWidget->addModeToggleButtons();
+
+        propertyWidget->addTextProperty("范围地址", m_rangeEdit->text(),
+            "range", "留空读取已使用区域",
+            [this](const QString& newRange) {
+                m_rangeEdit->setText(newRange.toUpper());
+                startStream();
+            });
+
+        propertyWidget->addSeparator();
+        propertyWidget->addInfoProperty("状态", m_statusLabel->text(), "color: #666;");
+        return true;
+    }
+
+private:
+    QWidget* m_widget;
+    QLineEdit* m_rangeEdit;
+    QLabel* m_statusLabel;
+    RowBatchStream* m_stream;
+
+    std::shared_ptr<SheetData> m_sheetData;
+    std::shared_ptr<RowBatchData> m_batch;
+};
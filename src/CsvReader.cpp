@@ -0,0 +1,387 @@
+#include "CsvReader.hpp"
+#include "CellReference.hpp"
+#include "PerformanceProfiler.hpp"
+#include "data/StringPool.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TINAFLOW_CSV_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 每解析多少行检查一次取消
+constexpr int CancelCheckInterval = 65536;
+
+// 查找下一个分隔符、引号或换行符，找不到时返回end
+const char* findSpecial(const char* p, const char* end, char delimiter)
+{
+#ifdef TINAFLOW_CSV_SSE2
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    const __m128i quotes = _mm_set1_epi8('"');
+    const __m128i lineFeeds = _mm_set1_epi8('\n');
+    const __m128i carriageReturns = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, delimiters), _mm_cmpeq_epi8(block, quotes)),
+            _mm_or_si128(_mm_cmpeq_epi8(block, lineFeeds), _mm_cmpeq_epi8(block, carriageReturns)));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (mask != 0) {
+            return p + std::countr_zero(mask);
+        }
+        p += 16;
+    }
+#endif
+    for (; p < end; ++p) {
+        const char ch = *p;
+        if (ch == delimiter || ch == '"' || ch == '\n' || ch == '\r') {
+            return p;
+        }
+    }
+    return end;
+}
+
+// 统计区间内的引号数量，用于确定块边界处是否位于引号内
+size_t countQuotes(const char* p, const char* end)
+{
+    size_t count = 0;
+#ifdef TINAFLOW_CSV_SSE2
+    const __m128i quotes = _mm_set1_epi8('"');
+    while (end - p >= 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        count += std::popcount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, quotes))));
+        p += 16;
+    }
+#endif
+    return count + static_cast<size_t>(std::count(p, end, '"'));
+}
+
+// 从p开始查找引号外的下一个换行，返回下一条记录的起点
+const char* nextRecordStart(const char* p, const char* end, bool insideQuotes)
+{
+    for (; p < end; ++p) {
+        if (*p == '"') {
+            insideQuotes = !insideQuotes;
+        } else if (*p == '\n' && !insideQuotes) {
+            return p + 1;
+        }
+    }
+    return end;
+}
+
+// 第一条记录的字段数
+int countFields(const char* p, const char* end, char delimiter)
+{
+    int fields = 1;
+    bool insideQuotes = false;
+    for (; p < end; ++p) {
+        const char ch = *p;
+        if (ch == '"') {
+            insideQuotes = !insideQuotes;
+        } else if (!insideQuotes) {
+            if (ch == delimiter) {
+                ++fields;
+            } else if (ch == '\n' || ch == '\r') {
+                break;
+            }
+        }
+    }
+    return fields;
+}
+
+/**
+ * 解析一个数据块，每个字段直接追加到对应列，文本驻留到所有块共用的池中
+ */
+class ChunkParser
+{
+public:
+    ChunkParser(char delimiter, int columnCount, const std::shared_ptr<StringPool>& pool)
+        : m_delimiter(delimiter), m_columns(columnCount, RangeColumn(RangeColumn::Type::Empty, 0, pool))
+    {
+    }
+
+    // 返回false表示被取消
+    bool parse(const char* p, const char* end, const std::function<bool()>& isCanceled)
+    {
+        const int columnCount = static_cast<int>(m_columns.size());
+        while (p < end) {
+            int col = 0;
+            while (true) {
+                if (p < end && *p == '"') {
+                    p = parseQuoted(p + 1, end);
+                    if (col < columnCount) {
+                        m_columns[col].appendUtf8(m_text);
+                    }
+                } else {
+                    const char* fieldEnd = findSpecial(p, end, m_delimiter);
+                    // 未加引号字段中间的引号按普通字符处理
+                    while (fieldEnd < end && *fieldEnd == '"') {
+                        fieldEnd = findSpecial(fieldEnd + 1, end, m_delimiter);
+                    }
+                    if (col < columnCount) {
+                        appendUnquoted(m_columns[col], p, fieldEnd);
+                    }
+                    p = fieldEnd;
+                }
+                ++col;
+
+                if (p >= end) {
+                    break;
+                }
+                if (*p == m_delimiter) {
+                    ++p;
+                    continue;
+                }
+                // 换行：\n、\r\n或\r
+                if (*p == '\r' && p + 1 < end && p[1] == '\n') {
+                    ++p;
+                }
+                ++p;
+                break;
+            }
+
+            for (; col < columnCount; ++col) {
+                m_columns[col].appendNull();
+            }
+
+            if (++m_rows % CancelCheckInterval == 0 && isCanceled && isCanceled()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<RangeColumn>& columns() { return m_columns; }
+
+private:
+    // 解析引号内的内容到m_text，返回引号字段之后的位置
+    const char* parseQuoted(const char* p, const char* end)
+    {
+        m_text.clear();
+        while (p < end) {
+            const char* quote = static_cast<const char*>(std::memchr(p, '"', static_cast<size_t>(end - p)));
+            if (!quote) {
+                // 引号未闭合，剩余内容都属于该字段
+                m_text.append(p, end);
+                return end;
+            }
+            m_text.append(p, quote);
+            p = quote + 1;
+            if (p < end && *p == '"') {
+                m_text += '"';
+                ++p;
+                continue;
+            }
+            break;
+        }
+
+        // 闭合引号之后到分隔符之前的内容原样保留
+        const char* fieldEnd = findSpecial(p, end, m_delimiter);
+        while (fieldEnd < end && *fieldEnd == '"') {
+            fieldEnd = findSpecial(fieldEnd + 1, end, m_delimiter);
+        }
+        m_text.append(p, fieldEnd);
+        return fieldEnd;
+    }
+
+    // 空字段为空值，完整匹配整数或浮点数的字段为数值，其余为文本
+    static void appendUnquoted(RangeColumn& column, const char* begin, const char* end)
+    {
+        if (begin == end) {
+            column.appendNull();
+            return;
+        }
+
+        const char first = *begin;
+        if ((first >= '0' && first <= '9') || first == '-' || first == '+' || first == '.') {
+            // from_chars不接受前导加号
+            const char* digits = (first == '+' && end - begin > 1) ? begin + 1 : begin;
+
+            int64_t integer = 0;
+            auto [intEnd, intError] = std::from_chars(digits, end, integer);
+            if (intError == std::errc() && intEnd == end) {
+                column.appendInt64(integer);
+                return;
+            }
+
+            double number = 0.0;
+            auto [doubleEnd, doubleError] = std::from_chars(digits, end, number);
+            if (doubleError == std::errc() && doubleEnd == end) {
+                column.appendDouble(number);
+                return;
+            }
+        }
+
+        column.appendUtf8(std::string_view(begin, static_cast<size_t>(end - begin)));
+    }
+
+private:
+    const char m_delimiter;
+    std::vector<RangeColumn> m_columns;
+    std::string m_text;         ///< 复用的引号字段缓冲区
+    int m_rows = 0;
+};
+
+} // namespace
+
+std::shared_ptr<RangeData> CsvReader::read(const QString& filePath,
+                                           char delimiter,
+                                           const std::function<bool()>& isCanceled,
+                                           const std::function<void(int)>& progress)
+{
+    PROFILE_SCOPE("CsvReader::read");
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+
+    auto range = std::make_shared<RangeData>();
+    const qint64 fileSize = file.size();
+    if (fileSize == 0) {
+        return range;
+    }
+
+    // 映射整个文件，页面由系统按需换入
+    const uchar* mapped = file.map(0, fileSize);
+    if (!mapped) {
+        throw std::runtime_error("无法映射文件: " + file.errorString().toStdString());
+    }
+
+    const char* begin = reinterpret_cast<const char*>(mapped);
+    const char* end = begin + fileSize;
+
+    // 跳过UTF-8 BOM
+    if (fileSize >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+        begin += 3;
+    }
+    if (begin == end) {
+        return range;
+    }
+
+    if (delimiter == AutoDelimiter) {
+        delimiter = detectDelimiter(filePath, begin, end - begin);
+    }
+    const int columnCount = countFields(begin, end, delimiter);
+
+    // 首行单独解析，表头文本不会决定数据块中各列的存储类型
+    const char* bodyBegin = nextRecordStart(begin, end, false);
+    // 所有块共用一个驻留池，拼接时直接合并句柄数组
+    const auto pool = std::make_shared<StringPool>();
+    ChunkParser header(delimiter, columnCount, pool);
+    header.parse(begin, bodyBegin, {});
+
+    // 按字节均分出候选边界，再根据之前所有引号的奇偶性移动到下一条记录的起点
+    const qint64 bodySize = end - bodyBegin;
+    const int chunkCount = static_cast<int>(std::clamp<qint64>(bodySize / MinChunkSize, 1,
+                                                               QThread::idealThreadCount() * 4));
+    std::vector<int> chunkIndices(chunkCount);
+    std::iota(chunkIndices.begin(), chunkIndices.end(), 0);
+
+    std::vector<const char*> bounds(chunkCount + 1);
+    for (int i = 0; i <= chunkCount; ++i) {
+        bounds[i] = bodyBegin + bodySize * i / chunkCount;
+    }
+
+    std::vector<size_t> quoteCounts(chunkCount);
+    QtConcurrent::blockingMap(chunkIndices, [&](int index) {
+        quoteCounts[index] = countQuotes(bounds[index], bounds[index + 1]);
+    });
+
+    std::vector<const char*> starts(chunkCount + 1);
+    starts[0] = bodyBegin;
+    starts[chunkCount] = end;
+    bool insideQuotes = false;
+    for (int i = 1; i < chunkCount; ++i) {
+        insideQuotes ^= (quoteCounts[i - 1] & 1) != 0;
+        starts[i] = std::max(starts[i - 1], nextRecordStart(bounds[i], end, insideQuotes));
+    }
+
+    // 并行解析各块
+    std::vector<std::unique_ptr<ChunkParser>> parsers(chunkCount);
+    std::atomic<int> finishedChunks{0};
+    std::atomic<bool> canceled{false};
+    QtConcurrent::blockingMap(chunkIndices, [&](int index) {
+        auto parser = std::make_unique<ChunkParser>(delimiter, columnCount, pool);
+        if (!parser->parse(starts[index], starts[index + 1], isCanceled)) {
+            canceled = true;
+            return;
+        }
+        parsers[index] = std::move(parser);
+        if (progress) {
+            progress(++finishedChunks * ProgressMax / chunkCount);
+        }
+    });
+
+    if (canceled || (isCanceled && isCanceled())) {
+        return nullptr;
+    }
+
+    // 按文件顺序拼接各块的列，拼接后立即释放该块
+    std::vector<RangeColumn> columns = std::move(header.columns());
+    for (int i = 0; i < chunkCount; ++i) {
+        auto& chunkColumns = parsers[i]->columns();
+        for (int col = 0; col < columnCount; ++col) {
+            columns[col].appendColumn(chunkColumns[col]);
+        }
+        parsers[i].reset();
+    }
+
+    const int rowCount = columns.empty() ? 0 : columns.front().size();
+    const QString address = CellReference::formatRange({1, 1}, std::max(rowCount, 1), std::max(columnCount, 1)).toQString();
+    range = std::make_shared<RangeData>(address, std::move(columns));
+
+    qDebug() << "CsvReader: Read" << rowCount << "rows x" << columnCount << "cols from"
+             << filePath << "in" << chunkCount << "chunk(s)";
+    return range;
+}
+
+char CsvReader::detectDelimiter(const QString& filePath, const char* data, qint64 size)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "tsv" || suffix == "tab") {
+        return '\t';
+    }
+
+    // 只统计首行引号外的字符
+    int commas = 0;
+    int tabs = 0;
+    int semicolons = 0;
+    bool insideQuotes = false;
+    for (qint64 i = 0; i < size; ++i) {
+        const char ch = data[i];
+        if (ch == '"') {
+            insideQuotes = !insideQuotes;
+        } else if (!insideQuotes) {
+            if (ch == '\n' || ch == '\r') {
+                break;
+            }
+            commas += ch == ',';
+            tabs += ch == '\t';
+            semicolons += ch == ';';
+        }
+    }
+
+    if (tabs > commas && tabs >= semicolons) {
+        return '\t';
+    }
+    if (semicolons > commas) {
+        return ';';
+    }
+    return ',';
+}
@@ -1,73 +1,63 @@
 #include "DataValidator.hpp"
+#include "CellReference.hpp"
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
 
 // Excel文件扩展名
 const QStringList DataValidator::EXCEL_EXTENSIONS = {".xlsx", ".xls", ".xlsm", ".xlsb"};
+const QStringList DataValidator::CSV_EXTENSIONS = {".csv", ".tsv", ".tab", ".txt"};
 
 ValidationResult DataValidator::validateCellAddress(const QString& address)
 {
-    if (address.isEmpty()) {
-        return ValidationResult::error("单元格地址不能为空", 
-            {"请输入有效的单元格地址，如A1、B5等"});
-    }
-    
-    // 使用正则表达式验证单元格地址格式
-    QRegularExpression regex("^[A-Z]+[1-9][0-9]*$");
-    if (!regex.match(address.toUpper()).hasMatch()) {
-        return ValidationResult::error(
-            QString("单元格地址格式不正确: %1").arg(address),
-            {"单元格地址应由字母和数字组成，如A1、B5、AA100",
-             "字母部分表示列，数字部分表示行",
-             "行号必须大于0"});
-    }
-    
-    // 解析单元格地址
-    auto parsed = parseCellAddress(address.toUpper());
-    QString column = parsed.first;
-    int row = parsed.second;
-    
-    // 验证列引用
-    if (!isValidColumnReference(column)) {
-        return ValidationResult::error(
-            QString("列引用超出Excel限制: %1").arg(column),
-            {"Excel最大支持XFD列（第16384列）",
-             "请使用有效的列引用"});
-    }
-    
-    // 验证行号
-    if (!isValidRowNumber(row)) {
-        return ValidationResult::error(
-            QString("行号超出Excel限制: %1").arg(row),
-            {"Excel最大支持1048576行",
-             "请使用有效的行号"});
+    const auto parsed = CellReference::parseA1(address);
+    switch (parsed.error) {
+        case CellReference::Error::None:
+            return ValidationResult::success();
+        case CellReference::Error::Empty:
+            return ValidationResult::error("单元格地址不能为空", 
+                {"请输入有效的单元格地址，如A1、B5等"});
+        case CellReference::Error::ColumnOutOfRange:
+            return ValidationResult::error(
+                QString("列引用超出Excel限制: %1").arg(address),
+                {"Excel最大支持XFD列（第16384列）",
+                 "请使用有效的列引用"});
+        case CellReference::Error::RowOutOfRange:
+            return ValidationResult::error(
+                QString("行号超出Excel限制: %1").arg(address),
+                {"Excel最大支持1048576行",
+                 "请使用有效的行号"});
+        default:
+            return ValidationResult::error(
+                QString("单元格地址格式不正确: %1").arg(address),
+                {"单元格地址应由字母和数字组成，如A1、B5、AA100",
+                 "字母部分表示列，数字部分表示行",
+                 "行号必须大于0"});
     }
-    
-    return ValidationResult::success();
 }
 
 ValidationResult DataValidator::validateRange(const QString& range)
 {
-    if (range.isEmpty()) {
+    if (range.trimmed().isEmpty()) {
         return ValidationResult::error("范围地址不能为空",
             {"请输入有效的范围地址，如A1:C10"});
     }
     
-    // 分割范围
-    QStringList parts = range.split(":");
-    if (parts.size() != 2) {
+    // 范围必须由两个单元格组成
+    const qsizetype colon = range.indexOf(':');
+    if (colon < 0 || range.indexOf(':', colon + 1) >= 0) {
         return ValidationResult::error(
             QString("范围格式不正确: %1").arg(range),
             {"范围格式应为 起始单元格:结束单元格",
              "例如: A1:C10, B2:E20"});
     }
     
-    QString startCell = parts[0].trimmed().toUpper();
-    QString endCell = parts[1].trimmed().toUpper();
+    const QStringView text(range);
+    const QStringView startCell = text.left(colon).trimmed();
+    const QStringView endCell = text.mid(colon + 1).trimmed();
     
     // 验证起始单元格
-    auto startResult = validateCellAddress(startCell);
+    auto startResult = validateCellAddress(startCell.toString());
     if (!startResult.isValid) {
         return ValidationResult::error(
             QString("起始单元格地址无效: %1").arg(startCell),
@@ -75,24 +65,15 @@ ValidationResult DataValidator::validateRange(const QString& range)
     }
     
     // 验证结束单元格
-    auto endResult = validateCellAddress(endCell);
+    auto endResult = validateCellAddress(endCell.toString());
     if (!endResult.isValid) {
         return ValidationResult::error(
             QString("结束单元格地址无效: %1").arg(endCell),
             endResult.suggestions);
     }
     
-    // 解析单元格地址
-    auto startParsed = parseCellAddress(startCell);
-    auto endParsed = parseCellAddress(endCell);
-    
-    int startCol = columnToNumber(startParsed.first);
-    int startRow = startParsed.second;
-    int endCol = columnToNumber(endParsed.first);
-    int endRow = endParsed.second;
-    
     // 验证范围逻辑
-    if (startCol > endCol || startRow > endRow) {
+    if (CellReference::parseRange(text).error == CellReference::Error::Order) {
         return ValidationResult::error(
             QString("范围逻辑错误: %1").arg(range),
             {"起始单元格应在结束单元格的左上方",
@@ -166,6 +147,11 @@ ValidationResult DataValidator::validateExcelFile(const QString& filePath)
     return validateFilePath(filePath, true, EXCEL_EXTENSIONS);
 }
 
+ValidationResult DataValidator::validateCsvFile(const QString& filePath)
+{
+    return validateFilePath(filePath, true, CSV_EXTENSIONS);
+}
+
 ValidationResult DataValidator::validateSheetName(const QString& sheetName)
 {
     if (sheetName.isEmpty()) {
@@ -282,49 +268,3 @@ ValidationResult DataValidator::validateRegex(const QString& text,
     
     return ValidationResult::success();
 }
-
-// 私有辅助方法实现
-bool DataValidator::isValidColumnReference(const QString& column)
-{
-    int colNumber = columnToNumber(column);
-    return colNumber > 0 && colNumber <= MAX_EXCEL_COLUMNS;
-}
-
-int DataValidator::columnToNumber(const QString& column)
-{
-    int result = 0;
-    for (int i = 0; i < column.length(); ++i) {
-        result = result * 26 + (column[i].toLatin1() - 'A' + 1);
-    }
-    return result;
-}
-
-QString DataValidator::numberToColumn(int number)
-{
-    QString result;
-    while (number > 0) {
-        number--; // 调整为0基索引
-        result = QChar('A' + number % 26) + result;
-        number /= 26;
-    }
-    return result;
-}
-
-bool DataValidator::isValidRowNumber(int row)
-{
-    return row > 0 && row <= MAX_EXCEL_ROWS;
-}
-
-QPair<QString, int> DataValidator::parseCellAddress(const QString& address)
-{
-    QRegularExpression regex("^([A-Z]+)([1-9][0-9]*)$");
-    QRegularExpressionMatch match = regex.match(address);
-    
-    if (match.hasMatch()) {
-        QString column = match.captured(1);
-        int row = match.captured(2).toInt();
-        return qMakePair(column, row);
-    }
-    
-    return qMakePair(QString(), 0);
-}
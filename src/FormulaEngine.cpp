@@ -0,0 +1,2004 @@
+#include "FormulaEngine.hpp"
+#include "PerformanceProfiler.hpp"
+#include "StreamingSheetReader.hpp"
+
+#include <QDebug>
+#include <QRegularExpression>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// ===== 值 =====
+
+enum class ErrorCode : uint8_t
+{
+    Null,
+    Div0,
+    Value,
+    Ref,
+    Name,
+    Num,
+    NA,
+    Circular
+};
+
+struct ErrorName
+{
+    std::string_view text;
+    ErrorCode code;
+};
+
+constexpr ErrorName ErrorNames[] = {
+    {"#NULL!", ErrorCode::Null},
+    {"#DIV/0!", ErrorCode::Div0},
+    {"#VALUE!", ErrorCode::Value},
+    {"#REF!", ErrorCode::Ref},
+    {"#NAME?", ErrorCode::Name},
+    {"#NUM!", ErrorCode::Num},
+    {"#N/A", ErrorCode::NA},
+    {"#CIRC!", ErrorCode::Circular},
+};
+
+QString errorText(ErrorCode code)
+{
+    for (const auto& name : ErrorNames) {
+        if (name.code == code) {
+            return QString::fromLatin1(name.text.data(), static_cast<qsizetype>(name.text.size()));
+        }
+    }
+    return QStringLiteral("#VALUE!");
+}
+
+struct Value
+{
+    enum class Type : uint8_t
+    {
+        Empty,
+        Number,
+        Text,
+        Boolean,
+        Error
+    };
+
+    Type type = Type::Empty;
+    bool boolean = false;
+    ErrorCode error = ErrorCode::Value;
+    double number = 0.0;
+    QString text;
+
+    static Value fromNumber(double number)
+    {
+        Value value;
+        if (!std::isfinite(number)) {
+            return fromError(ErrorCode::Num);
+        }
+        value.type = Type::Number;
+        value.number = number;
+        return value;
+    }
+
+    static Value fromText(QString text)
+    {
+        Value value;
+        value.type = Type::Text;
+        value.text = std::move(text);
+        return value;
+    }
+
+    static Value fromBoolean(bool boolean)
+    {
+        Value value;
+        value.type = Type::Boolean;
+        value.boolean = boolean;
+        return value;
+    }
+
+    static Value fromError(ErrorCode error)
+    {
+        Value value;
+        value.type = Type::Error;
+        value.error = error;
+        return value;
+    }
+
+    // 错误单元格读出的是错误文本，这里还原为错误值
+    static Value fromVariant(const QVariant& variant)
+    {
+        if (!variant.isValid() || variant.isNull()) {
+            return Value();
+        }
+        switch (variant.typeId()) {
+            case QMetaType::Bool:
+                return fromBoolean(variant.toBool());
+            case QMetaType::Int:
+            case QMetaType::UInt:
+            case QMetaType::LongLong:
+            case QMetaType::ULongLong:
+            case QMetaType::Double:
+            case QMetaType::Float:
+                return fromNumber(variant.toDouble());
+            default:
+                break;
+        }
+        const QString text = variant.toString();
+        if (text.startsWith('#')) {
+            for (const auto& name : ErrorNames) {
+                if (text == QLatin1String(name.text.data(), static_cast<qsizetype>(name.text.size()))) {
+                    return fromError(name.code);
+                }
+            }
+        }
+        return fromText(text);
+    }
+
+    QVariant toVariant() const
+    {
+        switch (type) {
+            case Type::Empty:
+                return QVariant();
+            case Type::Number:
+                // 整数结果与读取整数单元格的类型保持一致
+                if (number == std::trunc(number) && std::abs(number) < 9007199254740992.0) {
+                    return static_cast<qint64>(number);
+                }
+                return number;
+            case Type::Text:
+                return text;
+            case Type::Boolean:
+                return boolean;
+            case Type::Error:
+                return errorText(error);
+        }
+        return QVariant();
+    }
+
+    bool isError() const { return type == Type::Error; }
+    bool isEmpty() const { return type == Type::Empty; }
+};
+
+// Excel的数值有效位数为15位，取整前先舍入到15位有效数字，避免2.675这类二进制误差
+double toSignificantDigits(double number)
+{
+    if (number == 0.0 || !std::isfinite(number)) {
+        return number;
+    }
+    char buffer[32];
+    const auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), number, std::chars_format::scientific, 14);
+    double result = number;
+    std::from_chars(buffer, end, result);
+    return result;
+}
+
+QString numberText(double number)
+{
+    return QString::number(number, 'g', 15);
+}
+
+// 文本转数值，允许首尾空格
+std::optional<double> parseNumber(const QString& text)
+{
+    const QByteArray bytes = text.trimmed().toLatin1();
+    if (bytes.isEmpty()) {
+        return std::nullopt;
+    }
+    double number = 0.0;
+    const char* begin = bytes.constData();
+    const char* end = begin + bytes.size();
+    if (*begin == '+') {
+        ++begin;
+    }
+    const auto [ptr, error] = std::from_chars(begin, end, number);
+    if (error != std::errc() || ptr != end) {
+        return std::nullopt;
+    }
+    return number;
+}
+
+// ===== 语法树 =====
+
+enum class Function : uint8_t
+{
+    Unknown,
+    Sum,
+    Average,
+    Min,
+    Max,
+    Count,
+    CountA,
+    Product,
+    SumIf,
+    CountIf,
+    If,
+    IfError,
+    And,
+    Or,
+    Not,
+    Abs,
+    Round,
+    RoundUp,
+    RoundDown,
+    Int,
+    Mod,
+    Sqrt,
+    Power,
+    Pi,
+    Len,
+    Upper,
+    Lower,
+    Trim,
+    Left,
+    Right,
+    Mid,
+    Concatenate,
+    Concat,
+    IsBlank,
+    IsNumber,
+    IsText,
+    IsError,
+    NA
+};
+
+struct FunctionInfo
+{
+    std::string_view name;
+    Function function;
+    int minArgs;
+    int maxArgs;    ///< -1表示不限
+};
+
+constexpr FunctionInfo Functions[] = {
+    {"SUM", Function::Sum, 1, -1},
+    {"AVERAGE", Function::Average, 1, -1},
+    {"MIN", Function::Min, 1, -1},
+    {"MAX", Function::Max, 1, -1},
+    {"COUNT", Function::Count, 1, -1},
+    {"COUNTA", Function::CountA, 1, -1},
+    {"PRODUCT", Function::Product, 1, -1},
+    {"SUMIF", Function::SumIf, 2, 3},
+    {"COUNTIF", Function::CountIf, 2, 2},
+    {"IF", Function::If, 2, 3},
+    {"IFERROR", Function::IfError, 2, 2},
+    {"AND", Function::And, 1, -1},
+    {"OR", Function::Or, 1, -1},
+    {"NOT", Function::Not, 1, 1},
+    {"ABS", Function::Abs, 1, 1},
+    {"ROUND", Function::Round, 2, 2},
+    {"ROUNDUP", Function::RoundUp, 2, 2},
+    {"ROUNDDOWN", Function::RoundDown, 2, 2},
+    {"INT", Function::Int, 1, 1},
+    {"MOD", Function::Mod, 2, 2},
+    {"SQRT", Function::Sqrt, 1, 1},
+    {"POWER", Function::Power, 2, 2},
+    {"PI", Function::Pi, 0, 0},
+    {"LEN", Function::Len, 1, 1},
+    {"UPPER", Function::Upper, 1, 1},
+    {"LOWER", Function::Lower, 1, 1},
+    {"TRIM", Function::Trim, 1, 1},
+    {"LEFT", Function::Left, 1, 2},
+    {"RIGHT", Function::Right, 1, 2},
+    {"MID", Function::Mid, 3, 3},
+    {"CONCATENATE", Function::Concatenate, 1, -1},
+    {"CONCAT", Function::Concat, 1, -1},
+    {"ISBLANK", Function::IsBlank, 1, 1},
+    {"ISNUMBER", Function::IsNumber, 1, 1},
+    {"ISTEXT", Function::IsText, 1, 1},
+    {"ISERROR", Function::IsError, 1, 1},
+    {"NA", Function::NA, 0, 0},
+};
+
+enum class BinaryOp : uint8_t
+{
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Power,
+    Concat,
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual
+};
+
+struct Node
+{
+    enum class Kind : uint8_t
+    {
+        Constant,
+        Reference,
+        Negate,
+        Percent,
+        Binary,
+        Call
+    };
+
+    Kind kind = Kind::Constant;
+    Value constant;
+
+    // Reference：单个单元格时isRange为false；绝对标记用于展开共享公式
+    CellRange range;
+    bool isRange = false;
+    bool rowAbsolute[2] = {false, false};
+    bool columnAbsolute[2] = {false, false};
+
+    BinaryOp op = BinaryOp::Add;
+    Function function = Function::Unknown;
+    std::vector<std::unique_ptr<Node>> children;
+
+    static std::unique_ptr<Node> makeConstant(Value value)
+    {
+        auto node = std::make_unique<Node>();
+        node->kind = Kind::Constant;
+        node->constant = std::move(value);
+        return node;
+    }
+
+    static std::unique_ptr<Node> makeUnary(Kind kind, std::unique_ptr<Node> operand)
+    {
+        auto node = std::make_unique<Node>();
+        node->kind = kind;
+        node->children.push_back(std::move(operand));
+        return node;
+    }
+
+    static std::unique_ptr<Node> makeBinary(BinaryOp op, std::unique_ptr<Node> left, std::unique_ptr<Node> right)
+    {
+        auto node = std::make_unique<Node>();
+        node->kind = Kind::Binary;
+        node->op = op;
+        node->children.push_back(std::move(left));
+        node->children.push_back(std::move(right));
+        return node;
+    }
+};
+
+// 按行列偏移复制语法树，相对引用随之移动，移出工作表的引用变为#REF!
+std::unique_ptr<Node> shifted(const Node& node, int64_t rowOffset, int64_t columnOffset)
+{
+    auto copy = std::make_unique<Node>();
+    copy->kind = node.kind;
+    copy->constant = node.constant;
+    copy->range = node.range;
+    copy->isRange = node.isRange;
+    std::copy(std::begin(node.rowAbsolute), std::end(node.rowAbsolute), std::begin(copy->rowAbsolute));
+    std::copy(std::begin(node.columnAbsolute), std::end(node.columnAbsolute), std::begin(copy->columnAbsolute));
+    copy->op = node.op;
+    copy->function = node.function;
+
+    if (node.kind == Node::Kind::Reference) {
+        CellPosition* corners[2] = {&copy->range.topLeft, &copy->range.bottomRight};
+        for (int i = 0; i < 2; ++i) {
+            const int64_t row = corners[i]->row + (node.rowAbsolute[i] ? 0 : rowOffset);
+            const int64_t column = corners[i]->column + (node.columnAbsolute[i] ? 0 : columnOffset);
+            if (row < 1 || row > CellReference::MaxRows || column < 1 || column > CellReference::MaxColumns) {
+                return Node::makeConstant(Value::fromError(ErrorCode::Ref));
+            }
+            *corners[i] = {static_cast<uint32_t>(row), static_cast<uint16_t>(column)};
+        }
+    }
+
+    copy->children.reserve(node.children.size());
+    for (const auto& child : node.children) {
+        copy->children.push_back(shifted(*child, rowOffset, columnOffset));
+    }
+    return copy;
+}
+
+void collectReferences(const Node& node, std::vector<CellRange>& references)
+{
+    if (node.kind == Node::Kind::Reference) {
+        references.push_back(node.range);
+    }
+    for (const auto& child : node.children) {
+        collectReferences(*child, references);
+    }
+}
+
+// ===== 解析 =====
+
+/**
+ * 递归下降解析器，运算符优先级与Excel一致（从低到高）：
+ * 比较 < 连接(&) < 加减 < 乘除 < 乘方(^) < 百分号 < 负号
+ */
+class Parser
+{
+public:
+    Parser(std::string_view text, const std::string& sheetName) : m_text(text), m_sheetName(sheetName) {}
+
+    std::unique_ptr<Node> parse()
+    {
+        skipSpaces();
+        if (peek() == '=') {
+            ++m_pos;
+        }
+        auto root = parseComparison();
+        skipSpaces();
+        if (m_pos != m_text.size()) {
+            fail("无法识别的内容");
+        }
+        return root;
+    }
+
+private:
+    [[noreturn]] void fail(const char* message) const
+    {
+        throw std::runtime_error(std::string(message) + "（位置 " + std::to_string(m_pos + 1) + "）");
+    }
+
+    char peek(size_t offset = 0) const
+    {
+        return m_pos + offset < m_text.size() ? m_text[m_pos + offset] : '\0';
+    }
+
+    void skipSpaces()
+    {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r')) {
+            ++m_pos;
+        }
+    }
+
+    bool accept(char ch)
+    {
+        skipSpaces();
+        if (peek() == ch) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char ch)
+    {
+        if (!accept(ch)) {
+            fail("缺少符号");
+        }
+    }
+
+    std::unique_ptr<Node> parseComparison()
+    {
+        auto left = parseConcat();
+        while (true) {
+            skipSpaces();
+            BinaryOp op;
+            if (peek() == '=') {
+                op = BinaryOp::Equal;
+                m_pos += 1;
+            } else if (peek() == '<' && peek(1) == '>') {
+                op = BinaryOp::NotEqual;
+                m_pos += 2;
+            } else if (peek() == '<' && peek(1) == '=') {
+                op = BinaryOp::LessEqual;
+                m_pos += 2;
+            } else if (peek() == '>' && peek(1) == '=') {
+                op = BinaryOp::GreaterEqual;
+                m_pos += 2;
+            } else if (peek() == '<') {
+                op = BinaryOp::Less;
+                m_pos += 1;
+            } else if (peek() == '>') {
+                op = BinaryOp::Greater;
+                m_pos += 1;
+            } else {
+                return left;
+            }
+            left = Node::makeBinary(op, std::move(left), parseConcat());
+        }
+    }
+
+    std::unique_ptr<Node> parseConcat()
+    {
+        auto left = parseAdditive();
+        while (accept('&')) {
+            left = Node::makeBinary(BinaryOp::Concat, std::move(left), parseAdditive());
+        }
+        return left;
+    }
+
+    std::unique_ptr<Node> parseAdditive()
+    {
+        auto left = parseMultiplicative();
+        while (true) {
+            if (accept('+')) {
+                left = Node::makeBinary(BinaryOp::Add, std::move(left), parseMultiplicative());
+            } else if (accept('-')) {
+                left = Node::makeBinary(BinaryOp::Subtract, std::move(left), parseMultiplicative());
+            } else {
+                return left;
+            }
+        }
+    }
+
+    std::unique_ptr<Node> parseMultiplicative()
+    {
+        auto left = parsePower();
+        while (true) {
+            if (accept('*')) {
+                left = Node::makeBinary(BinaryOp::Multiply, std::move(left), parsePower());
+            } else if (accept('/')) {
+                left = Node::makeBinary(BinaryOp::Divide, std::move(left), parsePower());
+            } else {
+                return left;
+            }
+        }
+    }
+
+    std::unique_ptr<Node> parsePower()
+    {
+        auto left = parsePercent();
+        while (accept('^')) {
+            left = Node::makeBinary(BinaryOp::Power, std::move(left), parsePercent());
+        }
+        return left;
+    }
+
+    std::unique_ptr<Node> parsePercent()
+    {
+        auto operand = parseUnary();
+        while (accept('%')) {
+            operand = Node::makeUnary(Node::Kind::Percent, std::move(operand));
+        }
+        return operand;
+    }
+
+    // Excel中负号优先于乘方：=-2^2 结果为4
+    std::unique_ptr<Node> parseUnary()
+    {
+        if (accept('-')) {
+            return Node::makeUnary(Node::Kind::Negate, parseUnary());
+        }
+        if (accept('+')) {
+            return parseUnary();
+        }
+        return parsePrimary();
+    }
+
+    std::unique_ptr<Node> parsePrimary()
+    {
+        skipSpaces();
+        const char ch = peek();
+        if (ch == '\0') {
+            fail("公式不完整");
+        }
+        if (ch == '(') {
+            ++m_pos;
+            auto inner = parseComparison();
+            expect(')');
+            return inner;
+        }
+        if (ch == '"') {
+            return Node::makeConstant(Value::fromText(parseString()));
+        }
+        if (ch == '#') {
+            return Node::makeConstant(Value::fromError(parseErrorLiteral()));
+        }
+        if ((ch >= '0' && ch <= '9') || ch == '.') {
+            return parseNumberLiteral();
+        }
+        if (ch == '\'') {
+            const std::string sheet = parseQuotedSheet();
+            return parseQualifiedReference(sheet);
+        }
+        if (ch == '$' || ch == '_' || isLetter(ch)) {
+            return parseIdentifier();
+        }
+        fail("无法识别的符号");
+    }
+
+    static bool isLetter(char ch)
+    {
+        return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z');
+    }
+
+    static bool isDigit(char ch)
+    {
+        return ch >= '0' && ch <= '9';
+    }
+
+    QString parseString()
+    {
+        ++m_pos;    // 开头的引号
+        std::string text;
+        while (true) {
+            if (m_pos >= m_text.size()) {
+                fail("字符串缺少结束引号");
+            }
+            const char ch = m_text[m_pos++];
+            if (ch == '"') {
+                if (peek() == '"') {
+                    text += '"';
+                    ++m_pos;
+                    continue;
+                }
+                break;
+            }
+            text += ch;
+        }
+        return QString::fromStdString(text);
+    }
+
+    ErrorCode parseErrorLiteral()
+    {
+        const std::string_view rest = m_text.substr(m_pos);
+        for (const auto& name : ErrorNames) {
+            if (rest.size() >= name.text.size()) {
+                bool matches = true;
+                for (size_t i = 0; i < name.text.size(); ++i) {
+                    if (std::toupper(static_cast<unsigned char>(rest[i])) != name.text[i]) {
+                        matches = false;
+                        break;
+                    }
+                }
+                if (matches) {
+                    m_pos += name.text.size();
+                    return name.code;
+                }
+            }
+        }
+        fail("无法识别的错误值");
+    }
+
+    std::unique_ptr<Node> parseNumberLiteral()
+    {
+        const size_t begin = m_pos;
+        while (isDigit(peek()) || peek() == '.') {
+            ++m_pos;
+        }
+        if ((peek() == 'e' || peek() == 'E') && (isDigit(peek(1)) || ((peek(1) == '+' || peek(1) == '-') && isDigit(peek(2))))) {
+            m_pos += 2;
+            while (isDigit(peek())) {
+                ++m_pos;
+            }
+        }
+        double number = 0.0;
+        const auto [end, error] = std::from_chars(m_text.data() + begin, m_text.data() + m_pos, number);
+        if (error != std::errc() || end != m_text.data() + m_pos) {
+            fail("数字格式不正确");
+        }
+        return Node::makeConstant(Value::fromNumber(number));
+    }
+
+    std::string parseQuotedSheet()
+    {
+        ++m_pos;    // 开头的单引号
+        std::string sheet;
+        while (true) {
+            if (m_pos >= m_text.size()) {
+                fail("工作表名称缺少结束引号");
+            }
+            const char ch = m_text[m_pos++];
+            if (ch == '\'') {
+                if (peek() == '\'') {
+                    sheet += '\'';
+                    ++m_pos;
+                    continue;
+                }
+                break;
+            }
+            sheet += ch;
+        }
+        if (peek() != '!') {
+            fail("工作表名称后缺少!");
+        }
+        ++m_pos;
+        return sheet;
+    }
+
+    // 标识符：函数名、TRUE/FALSE、单元格引用、整列区域或工作表名称
+    std::unique_ptr<Node> parseIdentifier()
+    {
+        const size_t begin = m_pos;
+        while (isLetter(peek()) || isDigit(peek()) || peek() == '_' || peek() == '.' || peek() == '$') {
+            ++m_pos;
+        }
+        const std::string_view token = m_text.substr(begin, m_pos - begin);
+
+        if (peek() == '!') {
+            ++m_pos;
+            return parseQualifiedReference(std::string(token));
+        }
+        if (peek() == '(') {
+            return parseCall(token);
+        }
+
+        std::string upper(token);
+        std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char ch) {
+            return static_cast<char>(std::toupper(ch));
+        });
+        if (upper == "TRUE" || upper == "FALSE") {
+            return Node::makeConstant(Value::fromBoolean(upper == "TRUE"));
+        }
+
+        m_pos = begin;
+        return parseReference();
+    }
+
+    std::unique_ptr<Node> parseQualifiedReference(const std::string& sheet)
+    {
+        auto reference = parseReference();
+        // 暂不支持跨工作表引用
+        if (sheet != m_sheetName) {
+            return Node::makeConstant(Value::fromError(ErrorCode::Ref));
+        }
+        return reference;
+    }
+
+    struct ReferencePart
+    {
+        uint32_t row = 0;           ///< 0表示整列
+        uint16_t column = 0;
+        bool rowAbsolute = false;
+        bool columnAbsolute = false;
+    };
+
+    // 解析"$A$1"、"A1"或整列引用中的"A"
+    bool parseReferencePart(ReferencePart& part)
+    {
+        const size_t begin = m_pos;
+        if (peek() == '$') {
+            part.columnAbsolute = true;
+            ++m_pos;
+        }
+        const size_t lettersBegin = m_pos;
+        while (isLetter(peek())) {
+            ++m_pos;
+        }
+        part.column = CellReference::columnNumber(m_text.substr(lettersBegin, m_pos - lettersBegin));
+        if (part.column == 0) {
+            m_pos = begin;
+            return false;
+        }
+
+        const size_t rowBegin = m_pos;
+        if (peek() == '$') {
+            part.rowAbsolute = true;
+            ++m_pos;
+        }
+        if (!isDigit(peek())) {
+            // 整列引用只允许出现在区域中
+            m_pos = rowBegin;
+            part.rowAbsolute = false;
+            part.row = 0;
+            return true;
+        }
+        const size_t digitsBegin = m_pos;
+        while (isDigit(peek())) {
+            ++m_pos;
+        }
+        uint32_t row = 0;
+        const auto [end, error] = std::from_chars(m_text.data() + digitsBegin, m_text.data() + m_pos, row);
+        if (error != std::errc() || row == 0 || row > CellReference::MaxRows) {
+            fail("行号超出范围");
+        }
+        part.row = row;
+        return true;
+    }
+
+    std::unique_ptr<Node> parseReference()
+    {
+        ReferencePart first;
+        if (!parseReferencePart(first)) {
+            const size_t begin = m_pos;
+            while (isLetter(peek()) || isDigit(peek()) || peek() == '_' || peek() == '.') {
+                ++m_pos;
+            }
+            // 定义的名称等无法识别的标识符
+            if (m_pos == begin) {
+                fail("无法识别的引用");
+            }
+            return Node::makeConstant(Value::fromError(ErrorCode::Name));
+        }
+        if (isLetter(peek()) || peek() == '_' || peek() == '.') {
+            // 形如"ABC_1"的名称
+            while (isLetter(peek()) || isDigit(peek()) || peek() == '_' || peek() == '.') {
+                ++m_pos;
+            }
+            return Node::makeConstant(Value::fromError(ErrorCode::Name));
+        }
+
+        auto node = std::make_unique<Node>();
+        node->kind = Node::Kind::Reference;
+
+        ReferencePart last = first;
+        if (peek() == ':') {
+            ++m_pos;
+            last = ReferencePart();
+            if (!parseReferencePart(last)) {
+                fail("区域引用不完整");
+            }
+            node->isRange = true;
+        }
+        if ((first.row == 0) != (last.row == 0)) {
+            fail("区域引用不完整");
+        }
+        if (first.row == 0 && !node->isRange) {
+            // 单独的列字母是定义的名称
+            return Node::makeConstant(Value::fromError(ErrorCode::Name));
+        }
+
+        // 整列区域覆盖所有行
+        if (first.row == 0) {
+            first.row = 1;
+            last.row = CellReference::MaxRows;
+            first.rowAbsolute = last.rowAbsolute = true;
+            node->isRange = true;
+        }
+
+        node->range.topLeft = {std::min(first.row, last.row), std::min(first.column, last.column)};
+        node->range.bottomRight = {std::max(first.row, last.row), std::max(first.column, last.column)};
+        node->rowAbsolute[0] = first.rowAbsolute;
+        node->rowAbsolute[1] = last.rowAbsolute;
+        node->columnAbsolute[0] = first.columnAbsolute;
+        node->columnAbsolute[1] = last.columnAbsolute;
+        return node;
+    }
+
+    std::unique_ptr<Node> parseCall(std::string_view token)
+    {
+        std::string name(token);
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char ch) {
+            return static_cast<char>(std::toupper(ch));
+        });
+        // 新版本函数在文件中带有前缀
+        for (std::string_view prefix : {"_XLFN.", "_XLWS."}) {
+            if (std::string_view(name).starts_with(prefix)) {
+                name.erase(0, prefix.size());
+            }
+        }
+
+        auto node = std::make_unique<Node>();
+        node->kind = Node::Kind::Call;
+
+        ++m_pos;    // 左括号
+        if (!accept(')')) {
+            do {
+                skipSpaces();
+                if (peek() == ',' || peek() == ')') {
+                    // 省略的参数，如IF(A1,,1)
+                    node->children.push_back(Node::makeConstant(Value()));
+                } else {
+                    node->children.push_back(parseComparison());
+                }
+            } while (accept(','));
+            expect(')');
+        }
+
+        const auto info = std::find_if(std::begin(Functions), std::end(Functions), [&name](const FunctionInfo& f) {
+            return f.name == name;
+        });
+        if (info == std::end(Functions)) {
+            // 不支持的函数求值为#NAME?，参数中的引用仍然计入依赖关系
+            node->function = Function::Unknown;
+            return node;
+        }
+        const int argc = static_cast<int>(node->children.size());
+        if (argc < info->minArgs || (info->maxArgs >= 0 && argc > info->maxArgs)) {
+            fail("函数参数个数不正确");
+        }
+        node->function = info->function;
+        return node;
+    }
+
+private:
+    std::string_view m_text;
+    const std::string& m_sheetName;
+    size_t m_pos = 0;
+};
+
+// ===== 单元格存储 =====
+
+uint64_t keyOf(CellPosition cell)
+{
+    return (static_cast<uint64_t>(cell.row) << 16) | cell.column;
+}
+
+CellPosition positionOf(uint64_t key)
+{
+    return {static_cast<uint32_t>(key >> 16), static_cast<uint16_t>(key & 0xFFFF)};
+}
+
+struct Cell
+{
+    Value value;
+    std::unique_ptr<Node> formula;
+    std::vector<CellRange> references;  ///< 公式引用的单元格和区域
+};
+
+/// 引用了某一列中部分行的公式
+struct RangeDependent
+{
+    uint32_t firstRow;
+    uint32_t lastRow;
+    uint64_t formula;
+};
+
+using CellMap = std::unordered_map<uint64_t, Cell>;
+
+// ===== 求值 =====
+
+/**
+ * 公式求值
+ *
+ * 只读取单元格表，同一层的公式可以在多个线程中同时求值。
+ */
+class Evaluator
+{
+public:
+    explicit Evaluator(const CellMap& cells) : m_cells(cells) {}
+
+    Value evaluate(const Node& node) const
+    {
+        switch (node.kind) {
+            case Node::Kind::Constant:
+                return node.constant;
+            case Node::Kind::Reference:
+                // 标量上下文中的区域：不支持隐式交集
+                return node.isRange ? Value::fromError(ErrorCode::Value) : cellValue(node.range.topLeft);
+            case Node::Kind::Negate: {
+                const Value operand = toNumber(evaluate(*node.children[0]));
+                return operand.isError() ? operand : Value::fromNumber(-operand.number);
+            }
+            case Node::Kind::Percent: {
+                const Value operand = toNumber(evaluate(*node.children[0]));
+                return operand.isError() ? operand : Value::fromNumber(operand.number / 100.0);
+            }
+            case Node::Kind::Binary:
+                return evaluateBinary(node);
+            case Node::Kind::Call:
+                return evaluateCall(node);
+        }
+        return Value::fromError(ErrorCode::Value);
+    }
+
+private:
+    Value cellValue(CellPosition position) const
+    {
+        const auto it = m_cells.find(keyOf(position));
+        return it == m_cells.end() ? Value() : it->second.value;
+    }
+
+    // 遍历区域中存在的单元格；区域较大时改为遍历所有单元格，整列区域不会逐格查找
+    template<typename F>
+    void forEachCell(const CellRange& range, F&& visit) const
+    {
+        const uint64_t area = static_cast<uint64_t>(range.rowCount()) * range.columnCount();
+        if (area <= m_cells.size()) {
+            for (uint32_t row = range.topLeft.row; row <= range.bottomRight.row; ++row) {
+                for (uint32_t column = range.topLeft.column; column <= range.bottomRight.column; ++column) {
+                    const CellPosition position{row, static_cast<uint16_t>(column)};
+                    const auto it = m_cells.find(keyOf(position));
+                    if (it != m_cells.end()) {
+                        visit(position, it->second.value);
+                    }
+                }
+            }
+            return;
+        }
+
+        // 需要按行列顺序时（如CONCAT）先排序
+        std::vector<std::pair<uint64_t, const Value*>> found;
+        for (const auto& [key, cell] : m_cells) {
+            if (range.contains(positionOf(key))) {
+                found.emplace_back(key, &cell.value);
+            }
+        }
+        std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+        for (const auto& [key, value] : found) {
+            visit(positionOf(key), *value);
+        }
+    }
+
+    // 聚合函数的参数：区域中的每个单元格以fromReference=true交出
+    template<typename F>
+    void forEachArgument(const Node& node, F&& visit) const
+    {
+        for (const auto& child : node.children) {
+            if (child->kind == Node::Kind::Reference) {
+                forEachCell(child->range, [&visit](CellPosition, const Value& value) {
+                    visit(value, true);
+                });
+            } else {
+                visit(evaluate(*child), false);
+            }
+        }
+    }
+
+    static Value toNumber(const Value& value)
+    {
+        switch (value.type) {
+            case Value::Type::Number:
+                return value;
+            case Value::Type::Empty:
+                return Value::fromNumber(0.0);
+            case Value::Type::Boolean:
+                return Value::fromNumber(value.boolean ? 1.0 : 0.0);
+            case Value::Type::Text: {
+                const auto number = parseNumber(value.text);
+                return number ? Value::fromNumber(*number) : Value::fromError(ErrorCode::Value);
+            }
+            case Value::Type::Error:
+                return value;
+        }
+        return Value::fromError(ErrorCode::Value);
+    }
+
+    static QString toText(const Value& value)
+    {
+        switch (value.type) {
+            case Value::Type::Number:
+                return numberText(value.number);
+            case Value::Type::Text:
+                return value.text;
+            case Value::Type::Boolean:
+                return value.boolean ? QStringLiteral("TRUE") : QStringLiteral("FALSE");
+            default:
+                return QString();
+        }
+    }
+
+    static Value toBoolean(const Value& value)
+    {
+        switch (value.type) {
+            case Value::Type::Boolean:
+                return value;
+            case Value::Type::Empty:
+                return Value::fromBoolean(false);
+            case Value::Type::Number:
+                return Value::fromBoolean(value.number != 0.0);
+            case Value::Type::Text:
+                if (value.text.compare(QLatin1String("TRUE"), Qt::CaseInsensitive) == 0) {
+                    return Value::fromBoolean(true);
+                }
+                if (value.text.compare(QLatin1String("FALSE"), Qt::CaseInsensitive) == 0) {
+                    return Value::fromBoolean(false);
+                }
+                return Value::fromError(ErrorCode::Value);
+            case Value::Type::Error:
+                return value;
+        }
+        return Value::fromError(ErrorCode::Value);
+    }
+
+    // Excel的比较规则：数值 < 文本 < 逻辑值，文本不区分大小写，空值按另一侧的类型取默认值
+    static int compare(const Value& left, const Value& right)
+    {
+        const auto rank = [](Value::Type type) {
+            return type == Value::Type::Number ? 0 : type == Value::Type::Text ? 1 : 2;
+        };
+        Value a = left;
+        Value b = right;
+        if (a.isEmpty() && b.isEmpty()) {
+            return 0;
+        }
+        if (a.isEmpty()) {
+            a = b.type == Value::Type::Text ? Value::fromText(QString())
+              : b.type == Value::Type::Boolean ? Value::fromBoolean(false) : Value::fromNumber(0.0);
+        }
+        if (b.isEmpty()) {
+            b = a.type == Value::Type::Text ? Value::fromText(QString())
+              : a.type == Value::Type::Boolean ? Value::fromBoolean(false) : Value::fromNumber(0.0);
+        }
+        if (a.type != b.type) {
+            return rank(a.type) < rank(b.type) ? -1 : 1;
+        }
+        switch (a.type) {
+            case Value::Type::Number:
+                return a.number < b.number ? -1 : a.number > b.number ? 1 : 0;
+            case Value::Type::Text:
+                return a.text.compare(b.text, Qt::CaseInsensitive);
+            case Value::Type::Boolean:
+                return static_cast<int>(a.boolean) - static_cast<int>(b.boolean);
+            default:
+                return 0;
+        }
+    }
+
+    Value evaluateBinary(const Node& node) const
+    {
+        const Value left = evaluate(*node.children[0]);
+        const Value right = evaluate(*node.children[1]);
+        if (left.isError()) {
+            return left;
+        }
+        if (right.isError()) {
+            return right;
+        }
+
+        switch (node.op) {
+            case BinaryOp::Concat:
+                return Value::fromText(toText(left) + toText(right));
+            case BinaryOp::Equal:
+                return Value::fromBoolean(compare(left, right) == 0);
+            case BinaryOp::NotEqual:
+                return Value::fromBoolean(compare(left, right) != 0);
+            case BinaryOp::Less:
+                return Value::fromBoolean(compare(left, right) < 0);
+            case BinaryOp::LessEqual:
+                return Value::fromBoolean(compare(left, right) <= 0);
+            case BinaryOp::Greater:
+                return Value::fromBoolean(compare(left, right) > 0);
+            case BinaryOp::GreaterEqual:
+                return Value::fromBoolean(compare(left, right) >= 0);
+            default:
+                break;
+        }
+
+        const Value a = toNumber(left);
+        if (a.isError()) {
+            return a;
+        }
+        const Value b = toNumber(right);
+        if (b.isError()) {
+            return b;
+        }
+        switch (node.op) {
+            case BinaryOp::Add:
+                return Value::fromNumber(a.number + b.number);
+            case BinaryOp::Subtract:
+                return Value::fromNumber(a.number - b.number);
+            case BinaryOp::Multiply:
+                return Value::fromNumber(a.number * b.number);
+            case BinaryOp::Divide:
+                return b.number == 0.0 ? Value::fromError(ErrorCode::Div0) : Value::fromNumber(a.number / b.number);
+            case BinaryOp::Power:
+                if (a.number == 0.0 && b.number == 0.0) {
+                    return Value::fromError(ErrorCode::Num);
+                }
+                return Value::fromNumber(std::pow(a.number, b.number));
+            default:
+                return Value::fromError(ErrorCode::Value);
+        }
+    }
+
+    Value argument(const Node& node, size_t index) const
+    {
+        return evaluate(*node.children[index]);
+    }
+
+    Value numberArgument(const Node& node, size_t index) const
+    {
+        return toNumber(argument(node, index));
+    }
+
+    // SUM/AVERAGE/MIN/MAX/COUNT/PRODUCT共用：区域中只计数值，直接参数按数值转换
+    Value aggregate(const Node& node, std::vector<double>& numbers) const
+    {
+        std::optional<Value> error;
+        forEachArgument(node, [&](const Value& value, bool fromReference) {
+            if (error) {
+                return;
+            }
+            if (value.isError()) {
+                error = value;
+            } else if (fromReference) {
+                if (value.type == Value::Type::Number) {
+                    numbers.push_back(value.number);
+                }
+            } else if (!value.isEmpty()) {
+                const Value number = toNumber(value);
+                if (number.isError()) {
+                    error = number;
+                } else {
+                    numbers.push_back(number.number);
+                }
+            }
+        });
+        return error ? *error : Value();
+    }
+
+    // 条件函数的条件，如">=10"、"<>完成"、"张*"
+    struct Criteria
+    {
+        BinaryOp op = BinaryOp::Equal;
+        Value operand;
+        std::optional<QRegularExpression> pattern;     ///< 含通配符的文本相等比较
+
+        explicit Criteria(const Value& criteria)
+        {
+            if (criteria.type != Value::Type::Text) {
+                operand = criteria;
+                return;
+            }
+
+            QString text = criteria.text;
+            static const std::pair<const char*, BinaryOp> operators[] = {
+                {">=", BinaryOp::GreaterEqual}, {"<=", BinaryOp::LessEqual}, {"<>", BinaryOp::NotEqual},
+                {">", BinaryOp::Greater}, {"<", BinaryOp::Less}, {"=", BinaryOp::Equal},
+            };
+            for (const auto& [prefix, prefixOp] : operators) {
+                if (text.startsWith(QLatin1String(prefix))) {
+                    op = prefixOp;
+                    text = text.mid(static_cast<qsizetype>(std::strlen(prefix)));
+                    break;
+                }
+            }
+
+            if (const auto number = parseNumber(text)) {
+                operand = Value::fromNumber(*number);
+            } else {
+                operand = Value::fromText(text);
+                if ((op == BinaryOp::Equal || op == BinaryOp::NotEqual)
+                    && (text.contains('*') || text.contains('?'))) {
+                    pattern = wildcardPattern(text);
+                }
+            }
+        }
+
+        // Excel通配符：*任意多个字符，?单个字符，~转义
+        static QRegularExpression wildcardPattern(const QString& text)
+        {
+            QString regex = "^";
+            for (qsizetype i = 0; i < text.size(); ++i) {
+                const QChar ch = text[i];
+                if (ch == '~' && i + 1 < text.size()) {
+                    regex += QRegularExpression::escape(QString(text[++i]));
+                } else if (ch == '*') {
+                    regex += ".*";
+                } else if (ch == '?') {
+                    regex += '.';
+                } else {
+                    regex += QRegularExpression::escape(QString(ch));
+                }
+            }
+            regex += '$';
+            return QRegularExpression(regex, QRegularExpression::CaseInsensitiveOption
+                                           | QRegularExpression::DotMatchesEverythingOption);
+        }
+
+        bool matches(const Value& value) const
+        {
+            if (value.isError()) {
+                return false;
+            }
+            if (pattern) {
+                const bool matched = value.type == Value::Type::Text && pattern->match(value.text).hasMatch();
+                return op == BinaryOp::Equal ? matched : !matched;
+            }
+            // 数值条件只与数值比较，文本条件只与文本比较（不等于除外）
+            const bool sameKind = (operand.type == Value::Type::Number && value.type == Value::Type::Number)
+                               || (operand.type != Value::Type::Number && value.type == operand.type);
+            if (!sameKind) {
+                return op == BinaryOp::NotEqual;
+            }
+            const int result = compare(value, operand);
+            switch (op) {
+                case BinaryOp::Equal: return result == 0;
+                case BinaryOp::NotEqual: return result != 0;
+                case BinaryOp::Less: return result < 0;
+                case BinaryOp::LessEqual: return result <= 0;
+                case BinaryOp::Greater: return result > 0;
+                case BinaryOp::GreaterEqual: return result >= 0;
+                default: return false;
+            }
+        }
+    };
+
+    Value conditional(const Node& node, bool sum) const
+    {
+        const Node& rangeNode = *node.children[0];
+        if (rangeNode.kind != Node::Kind::Reference) {
+            return Value::fromError(ErrorCode::Value);
+        }
+        const Value criteriaValue = argument(node, 1);
+        if (criteriaValue.isError()) {
+            return criteriaValue;
+        }
+        const Criteria criteria(criteriaValue);
+
+        // 求和区域与条件区域左上角对齐
+        std::optional<CellPosition> sumOrigin;
+        if (sum && node.children.size() > 2) {
+            if (node.children[2]->kind != Node::Kind::Reference) {
+                return Value::fromError(ErrorCode::Value);
+            }
+            sumOrigin = node.children[2]->range.topLeft;
+        }
+
+        double total = 0.0;
+        int count = 0;
+        forEachCell(rangeNode.range, [&](CellPosition position, const Value& value) {
+            if (!criteria.matches(value)) {
+                return;
+            }
+            ++count;
+            if (!sum) {
+                return;
+            }
+            Value target = value;
+            if (sumOrigin) {
+                const int64_t row = sumOrigin->row + (position.row - rangeNode.range.topLeft.row);
+                const int64_t column = sumOrigin->column + (position.column - rangeNode.range.topLeft.column);
+                target = (row <= CellReference::MaxRows && column <= CellReference::MaxColumns)
+                    ? cellValue({static_cast<uint32_t>(row), static_cast<uint16_t>(column)}) : Value();
+            }
+            if (target.type == Value::Type::Number) {
+                total += target.number;
+            }
+        });
+        return sum ? Value::fromNumber(total) : Value::fromNumber(count);
+    }
+
+    Value round(const Node& node, Function function) const
+    {
+        const Value number = numberArgument(node, 0);
+        if (number.isError()) {
+            return number;
+        }
+        const Value digits = numberArgument(node, 1);
+        if (digits.isError()) {
+            return digits;
+        }
+        const double factor = std::pow(10.0, std::trunc(digits.number));
+        const double scaled = toSignificantDigits(number.number * factor);
+        double rounded;
+        if (function == Function::RoundUp) {
+            rounded = scaled < 0 ? std::floor(scaled) : std::ceil(scaled);
+        } else if (function == Function::RoundDown) {
+            rounded = std::trunc(scaled);
+        } else {
+            rounded = std::round(scaled);
+        }
+        return Value::fromNumber(rounded / factor);
+    }
+
+    Value evaluateCall(const Node& node) const
+    {
+        switch (node.function) {
+            case Function::Unknown:
+                return Value::fromError(ErrorCode::Name);
+
+            case Function::Sum:
+            case Function::Average:
+            case Function::Min:
+            case Function::Max:
+            case Function::Count:
+            case Function::Product: {
+                std::vector<double> numbers;
+                const Value error = aggregate(node, numbers);
+                if (error.isError() && node.function != Function::Count) {
+                    return error;
+                }
+                switch (node.function) {
+                    case Function::Sum: {
+                        double total = 0.0;
+                        for (double number : numbers) {
+                            total += number;
+                        }
+                        return Value::fromNumber(total);
+                    }
+                    case Function::Average: {
+                        if (numbers.empty()) {
+                            return Value::fromError(ErrorCode::Div0);
+                        }
+                        double total = 0.0;
+                        for (double number : numbers) {
+                            total += number;
+                        }
+                        return Value::fromNumber(total / static_cast<double>(numbers.size()));
+                    }
+                    case Function::Min:
+                        return Value::fromNumber(numbers.empty() ? 0.0 : *std::min_element(numbers.begin(), numbers.end()));
+                    case Function::Max:
+                        return Value::fromNumber(numbers.empty() ? 0.0 : *std::max_element(numbers.begin(), numbers.end()));
+                    case Function::Count:
+                        return Value::fromNumber(static_cast<double>(numbers.size()));
+                    default: {
+                        double product = 1.0;
+                        for (double number : numbers) {
+                            product *= number;
+                        }
+                        return Value::fromNumber(numbers.empty() ? 0.0 : product);
+                    }
+                }
+            }
+
+            case Function::CountA: {
+                int count = 0;
+                forEachArgument(node, [&count](const Value& value, bool) {
+                    if (!value.isEmpty()) {
+                        ++count;
+                    }
+                });
+                return Value::fromNumber(count);
+            }
+
+            case Function::SumIf:
+                return conditional(node, true);
+            case Function::CountIf:
+                return conditional(node, false);
+
+            case Function::If: {
+                const Value condition = toBoolean(argument(node, 0));
+                if (condition.isError()) {
+                    return condition;
+                }
+                if (condition.boolean) {
+                    return argument(node, 1);
+                }
+                return node.children.size() > 2 ? argument(node, 2) : Value::fromBoolean(false);
+            }
+
+            case Function::IfError: {
+                const Value value = argument(node, 0);
+                return value.isError() ? argument(node, 1) : value;
+            }
+
+            case Function::And:
+            case Function::Or: {
+                const bool isAnd = node.function == Function::And;
+                bool result = isAnd;
+                bool any = false;
+                std::optional<Value> error;
+                forEachArgument(node, [&](const Value& value, bool fromReference) {
+                    if (error) {
+                        return;
+                    }
+                    if (value.isError()) {
+                        error = value;
+                        return;
+                    }
+                    // 区域中的文本和空单元格被忽略
+                    if (value.isEmpty() || (fromReference && value.type == Value::Type::Text)) {
+                        return;
+                    }
+                    const Value boolean = toBoolean(value);
+                    if (boolean.isError()) {
+                        error = boolean;
+                        return;
+                    }
+                    any = true;
+                    result = isAnd ? (result && boolean.boolean) : (result || boolean.boolean);
+                });
+                if (error) {
+                    return *error;
+                }
+                return any ? Value::fromBoolean(result) : Value::fromError(ErrorCode::Value);
+            }
+
+            case Function::Not: {
+                const Value value = toBoolean(argument(node, 0));
+                return value.isError() ? value : Value::fromBoolean(!value.boolean);
+            }
+
+            case Function::Abs:
+            case Function::Int:
+            case Function::Sqrt: {
+                const Value number = numberArgument(node, 0);
+                if (number.isError()) {
+                    return number;
+                }
+                if (node.function == Function::Abs) {
+                    return Value::fromNumber(std::abs(number.number));
+                }
+                if (node.function == Function::Int) {
+                    return Value::fromNumber(std::floor(number.number));
+                }
+                return number.number < 0 ? Value::fromError(ErrorCode::Num) : Value::fromNumber(std::sqrt(number.number));
+            }
+
+            case Function::Round:
+            case Function::RoundUp:
+            case Function::RoundDown:
+                return round(node, node.function);
+
+            case Function::Mod:
+            case Function::Power: {
+                const Value a = numberArgument(node, 0);
+                if (a.isError()) {
+                    return a;
+                }
+                const Value b = numberArgument(node, 1);
+                if (b.isError()) {
+                    return b;
+                }
+                if (node.function == Function::Power) {
+                    return Value::fromNumber(std::pow(a.number, b.number));
+                }
+                if (b.number == 0.0) {
+                    return Value::fromError(ErrorCode::Div0);
+                }
+                return Value::fromNumber(a.number - b.number * std::floor(a.number / b.number));
+            }
+
+            case Function::Pi:
+                return Value::fromNumber(3.14159265358979323846);
+
+            case Function::Len:
+            case Function::Upper:
+            case Function::Lower:
+            case Function::Trim: {
+                const Value value = argument(node, 0);
+                if (value.isError()) {
+                    return value;
+                }
+                const QString text = toText(value);
+                if (node.function == Function::Len) {
+                    return Value::fromNumber(static_cast<double>(text.size()));
+                }
+                if (node.function == Function::Upper) {
+                    return Value::fromText(text.toUpper());
+                }
+                if (node.function == Function::Lower) {
+                    return Value::fromText(text.toLower());
+                }
+                // TRIM只去除空格，单词之间保留一个空格
+                return Value::fromText(text.split(' ', Qt::SkipEmptyParts).join(' '));
+            }
+
+            case Function::Left:
+            case Function::Right:
+            case Function::Mid: {
+                const Value value = argument(node, 0);
+                if (value.isError()) {
+                    return value;
+                }
+                const QString text = toText(value);
+                if (node.function == Function::Mid) {
+                    const Value start = numberArgument(node, 1);
+                    const Value length = numberArgument(node, 2);
+                    if (start.isError()) {
+                        return start;
+                    }
+                    if (length.isError()) {
+                        return length;
+                    }
+                    if (start.number < 1 || length.number < 0) {
+                        return Value::fromError(ErrorCode::Value);
+                    }
+                    return Value::fromText(text.mid(static_cast<qsizetype>(start.number) - 1,
+                                                    static_cast<qsizetype>(length.number)));
+                }
+                double count = 1.0;
+                if (node.children.size() > 1) {
+                    const Value length = numberArgument(node, 1);
+                    if (length.isError()) {
+                        return length;
+                    }
+                    count = length.number;
+                }
+                if (count < 0) {
+                    return Value::fromError(ErrorCode::Value);
+                }
+                const auto n = static_cast<qsizetype>(count);
+                return Value::fromText(node.function == Function::Left ? text.left(n) : text.right(n));
+            }
+
+            case Function::Concatenate:
+            case Function::Concat: {
+                QString text;
+                std::optional<Value> error;
+                const bool allowRanges = node.function == Function::Concat;
+                for (const auto& child : node.children) {
+                    if (child->kind == Node::Kind::Reference && child->isRange) {
+                        if (!allowRanges) {
+                            return Value::fromError(ErrorCode::Value);
+                        }
+                        forEachCell(child->range, [&](CellPosition, const Value& value) {
+                            if (value.isError() && !error) {
+                                error = value;
+                            }
+                            text += toText(value);
+                        });
+                    } else {
+                        const Value value = evaluate(*child);
+                        if (value.isError()) {
+                            return value;
+                        }
+                        text += toText(value);
+                    }
+                }
+                return error ? *error : Value::fromText(text);
+            }
+
+            case Function::IsBlank:
+            case Function::IsNumber:
+            case Function::IsText:
+            case Function::IsError: {
+                const Value value = argument(node, 0);
+                switch (node.function) {
+                    case Function::IsBlank: return Value::fromBoolean(value.isEmpty());
+                    case Function::IsNumber: return Value::fromBoolean(value.type == Value::Type::Number);
+                    case Function::IsText: return Value::fromBoolean(value.type == Value::Type::Text);
+                    default: return Value::fromBoolean(value.isError());
+                }
+            }
+
+            case Function::NA:
+                return Value::fromError(ErrorCode::NA);
+        }
+        return Value::fromError(ErrorCode::Name);
+    }
+
+private:
+    const CellMap& m_cells;
+};
+
+} // namespace
+
+// ===== 引擎 =====
+
+struct FormulaEngine::Impl
+{
+    std::string sheetName;
+    CellMap cells;
+    int formulaCount = 0;
+
+    /// 单元格 -> 直接引用它的公式
+    std::unordered_map<uint64_t, std::vector<uint64_t>> cellDependents;
+    /// 列 -> 引用了该列中多行区域的公式
+    std::unordered_map<uint16_t, std::vector<RangeDependent>> columnDependents;
+    /// 上次重算之后修改过的单元格
+    std::unordered_set<uint64_t> changed;
+
+    void index(uint64_t formula, const std::vector<CellRange>& references)
+    {
+        for (const auto& range : references) {
+            if (range.topLeft == range.bottomRight) {
+                cellDependents[keyOf(range.topLeft)].push_back(formula);
+                continue;
+            }
+            for (uint32_t column = range.topLeft.column; column <= range.bottomRight.column; ++column) {
+                columnDependents[static_cast<uint16_t>(column)].push_back(
+                    {range.topLeft.row, range.bottomRight.row, formula});
+            }
+        }
+    }
+
+    void unindex(uint64_t formula, const std::vector<CellRange>& references)
+    {
+        for (const auto& range : references) {
+            if (range.topLeft == range.bottomRight) {
+                auto it = cellDependents.find(keyOf(range.topLeft));
+                if (it != cellDependents.end()) {
+                    std::erase(it->second, formula);
+                    if (it->second.empty()) {
+                        cellDependents.erase(it);
+                    }
+                }
+                continue;
+            }
+            for (uint32_t column = range.topLeft.column; column <= range.bottomRight.column; ++column) {
+                auto it = columnDependents.find(static_cast<uint16_t>(column));
+                if (it != columnDependents.end()) {
+                    std::erase_if(it->second, [formula](const RangeDependent& dependent) {
+                        return dependent.formula == formula;
+                    });
+                }
+            }
+        }
+    }
+
+    // 直接引用该单元格的公式，引用多次的公式会出现多次
+    template<typename F>
+    void forEachDependent(uint64_t key, F&& visit) const
+    {
+        if (const auto it = cellDependents.find(key); it != cellDependents.end()) {
+            for (uint64_t formula : it->second) {
+                visit(formula);
+            }
+        }
+        const CellPosition position = positionOf(key);
+        if (const auto it = columnDependents.find(position.column); it != columnDependents.end()) {
+            for (const auto& dependent : it->second) {
+                if (position.row >= dependent.firstRow && position.row <= dependent.lastRow) {
+                    visit(dependent.formula);
+                }
+            }
+        }
+    }
+
+    void clearFormula(uint64_t key, Cell& cell)
+    {
+        if (!cell.formula) {
+            return;
+        }
+        unindex(key, cell.references);
+        cell.formula.reset();
+        cell.references.clear();
+        --formulaCount;
+    }
+
+    void assignFormula(uint64_t key, std::unique_ptr<Node> formula)
+    {
+        Cell& cell = cells[key];
+        clearFormula(key, cell);
+        collectReferences(*formula, cell.references);
+        cell.formula = std::move(formula);
+        index(key, cell.references);
+        ++formulaCount;
+        changed.insert(key);
+    }
+
+    RecalcStats recalculate(const std::vector<uint64_t>& seeds);
+};
+
+FormulaEngine::RecalcStats FormulaEngine::Impl::recalculate(const std::vector<uint64_t>& seeds)
+{
+    RecalcStats stats;
+
+    // 由修改过的单元格出发找出所有受影响的公式，同时记录它们之间的依赖边
+    std::unordered_set<uint64_t> dirty;
+    std::unordered_map<uint64_t, std::vector<uint64_t>> edges;
+    std::unordered_map<uint64_t, int> pending;
+    std::vector<uint64_t> queue;
+    queue.reserve(seeds.size());
+
+    for (uint64_t key : seeds) {
+        const auto it = cells.find(key);
+        if (it != cells.end() && it->second.formula && dirty.insert(key).second) {
+            pending.emplace(key, 0);
+        }
+        queue.push_back(key);
+    }
+    std::unordered_set<uint64_t> expanded;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const uint64_t key = queue[i];
+        if (!expanded.insert(key).second) {
+            continue;
+        }
+        const bool isFormula = dirty.contains(key);
+        forEachDependent(key, [&](uint64_t dependent) {
+            if (dirty.insert(dependent).second) {
+                pending.emplace(dependent, 0);
+                queue.push_back(dependent);
+            }
+            // 只有需要重算的公式之间才有先后顺序
+            if (isFormula) {
+                edges[key].push_back(dependent);
+                ++pending[dependent];
+            }
+        });
+    }
+
+    // 按依赖关系分层，同一层的公式只依赖之前各层，可以并行求值
+    std::vector<Cell*> level;
+    std::vector<uint64_t> levelKeys;
+    for (const auto& [key, count] : pending) {
+        if (count == 0) {
+            levelKeys.push_back(key);
+        }
+    }
+
+    const Evaluator evaluator(cells);
+    while (!levelKeys.empty()) {
+        level.clear();
+        for (uint64_t key : levelKeys) {
+            level.push_back(&cells.at(key));
+        }
+
+        const auto evaluate = [&evaluator](Cell* cell) {
+            cell->value = evaluator.evaluate(*cell->formula);
+        };
+        if (static_cast<int>(level.size()) >= ParallelThreshold) {
+            QtConcurrent::blockingMap(level, evaluate);
+        } else {
+            std::for_each(level.begin(), level.end(), evaluate);
+        }
+        stats.recalculated += static_cast<int>(level.size());
+        ++stats.levels;
+
+        std::vector<uint64_t> next;
+        for (uint64_t key : levelKeys) {
+            const auto it = edges.find(key);
+            if (it == edges.end()) {
+                continue;
+            }
+            for (uint64_t dependent : it->second) {
+                if (--pending[dependent] == 0) {
+                    next.push_back(dependent);
+                }
+            }
+        }
+        levelKeys.swap(next);
+    }
+
+    // 剩下的公式处于循环引用中或依赖循环引用
+    for (const auto& [key, count] : pending) {
+        if (count > 0) {
+            cells.at(key).value = Value::fromError(ErrorCode::Circular);
+            ++stats.circular;
+        }
+    }
+    return stats;
+}
+
+FormulaEngine::FormulaEngine(std::string sheetName)
+    : d(std::make_unique<Impl>())
+{
+    d->sheetName = std::move(sheetName);
+}
+
+FormulaEngine::~FormulaEngine() = default;
+
+std::unique_ptr<FormulaEngine> FormulaEngine::fromSheet(const StreamingSheetReader& reader, const std::string& sheetName)
+{
+    PROFILE_SCOPE("FormulaEngine::fromSheet");
+
+    auto engine = std::make_unique<FormulaEngine>(sheetName);
+    Impl& impl = *engine->d;
+
+    struct SharedFormula
+    {
+        CellPosition origin;
+        std::shared_ptr<const Node> root;
+    };
+    std::unordered_map<int, SharedFormula> sharedFormulas;
+    int unsupported = 0;
+
+    reader.readCells(sheetName, [&](const StreamingSheetReader::CellContent& content) {
+        const uint64_t key = keyOf(content.position);
+        impl.cells[key].value = Value::fromVariant(content.value);
+
+        std::unique_ptr<Node> formula;
+        if (!content.formula.empty()) {
+            try {
+                formula = Parser(content.formula, sheetName).parse();
+            } catch (const std::exception& e) {
+                // 无法解析的公式保留缓存值
+                if (unsupported++ == 0) {
+                    qDebug() << "FormulaEngine: Unsupported formula" << QString::fromStdString(content.formula)
+                             << "-" << e.what();
+                }
+                return;
+            }
+            if (content.sharedIndex >= 0) {
+                sharedFormulas[content.sharedIndex] = {content.position, std::shared_ptr<const Node>(shifted(*formula, 0, 0))};
+            }
+        } else if (content.sharedIndex >= 0) {
+            // 共享公式的从属单元格：主单元格公式按偏移展开
+            const auto it = sharedFormulas.find(content.sharedIndex);
+            if (it == sharedFormulas.end()) {
+                return;
+            }
+            formula = shifted(*it->second.root,
+                              static_cast<int64_t>(content.position.row) - it->second.origin.row,
+                              static_cast<int64_t>(content.position.column) - it->second.origin.column);
+        }
+
+        if (formula) {
+            impl.assignFormula(key, std::move(formula));
+        }
+    });
+
+    // 加载时不把公式视为修改，由调用方决定是否重算
+    impl.changed.clear();
+    qDebug() << "FormulaEngine: Loaded" << impl.cells.size() << "cells," << impl.formulaCount << "formulas from"
+             << QString::fromStdString(sheetName) << (unsupported > 0 ? QString("(%1 unsupported)").arg(unsupported) : QString());
+    return engine;
+}
+
+void FormulaEngine::setValue(CellPosition cell, const QVariant& value)
+{
+    const uint64_t key = keyOf(cell);
+    Cell& target = d->cells[key];
+    d->clearFormula(key, target);
+    target.value = Value::fromVariant(value);
+    d->changed.insert(key);
+}
+
+bool FormulaEngine::setFormula(CellPosition cell, std::string_view formula, QString* errorMessage)
+{
+    std::unique_ptr<Node> root;
+    try {
+        root = Parser(formula, d->sheetName).parse();
+    } catch (const std::exception& e) {
+        if (errorMessage) {
+            *errorMessage = QString::fromUtf8(e.what());
+        }
+        return false;
+    }
+    d->assignFormula(keyOf(cell), std::move(root));
+    return true;
+}
+
+bool FormulaEngine::setFormula(CellPosition cell, const OpenXLSX::XLFormula& formula, QString* errorMessage)
+{
+    return setFormula(cell, formula.get(), errorMessage);
+}
+
+QVariant FormulaEngine::value(CellPosition cell) const
+{
+    const auto it = d->cells.find(keyOf(cell));
+    return it == d->cells.end() ? QVariant() : it->second.value.toVariant();
+}
+
+bool FormulaEngine::hasFormula(CellPosition cell) const
+{
+    const auto it = d->cells.find(keyOf(cell));
+    return it != d->cells.end() && it->second.formula;
+}
+
+int FormulaEngine::formulaCount() const
+{
+    return d->formulaCount;
+}
+
+bool FormulaEngine::hasPendingChanges() const
+{
+    return !d->changed.empty();
+}
+
+FormulaEngine::RecalcStats FormulaEngine::recalculate()
+{
+    PROFILE_SCOPE("FormulaEngine::recalculate");
+
+    const std::vector<uint64_t> seeds(d->changed.begin(), d->changed.end());
+    d->changed.clear();
+    return d->recalculate(seeds);
+}
+
+FormulaEngine::RecalcStats FormulaEngine::recalculateAll()
+{
+    PROFILE_SCOPE("FormulaEngine::recalculateAll");
+
+    std::vector<uint64_t> seeds;
+    seeds.reserve(d->formulaCount);
+    for (const auto& [key, cell] : d->cells) {
+        if (cell.formula) {
+            seeds.push_back(key);
+        }
+    }
+    d->changed.clear();
+    return d->recalculate(seeds);
+}
+
+std::shared_ptr<RangeData> FormulaEngine::readRange(const CellRange& range) const
+{
+    std::vector<std::vector<QVariant>> data(range.rowCount(), std::vector<QVariant>(range.columnCount()));
+    const auto store = [&](CellPosition position, const Cell& cell) {
+        data[position.row - range.topLeft.row][position.column - range.topLeft.column] = cell.value.toVariant();
+    };
+
+    // 小范围逐格查找，大范围遍历所有单元格
+    const uint64_t area = static_cast<uint64_t>(range.rowCount()) * range.columnCount();
+    if (area <= d->cells.size()) {
+        for (uint32_t row = range.topLeft.row; row <= range.bottomRight.row; ++row) {
+            for (uint32_t column = range.topLeft.column; column <= range.bottomRight.column; ++column) {
+                const CellPosition position{row, static_cast<uint16_t>(column)};
+                if (const auto it = d->cells.find(keyOf(position)); it != d->cells.end()) {
+                    store(position, it->second);
+                }
+            }
+        }
+    } else {
+        for (const auto& [key, cell] : d->cells) {
+            const CellPosition position = positionOf(key);
+            if (range.contains(position)) {
+                store(position, cell);
+            }
+        }
+    }
+    return std::make_shared<RangeData>(CellReference::formatRange(range).toQString(), data);
+}
+
+std::optional<CellRange> FormulaEngine::usedRange() const
+{
+    std::optional<CellRange> used;
+    for (const auto& [key, cell] : d->cells) {
+        if (cell.value.isEmpty()) {
+            continue;
+        }
+        const CellPosition position = positionOf(key);
+        if (!used) {
+            used = CellRange{position, position};
+            continue;
+        }
+        used->topLeft.row = std::min(used->topLeft.row, position.row);
+        used->topLeft.column = std::min(used->topLeft.column, position.column);
+        used->bottomRight.row = std::max(used->bottomRight.row, position.row);
+        used->bottomRight.column = std::max(used->bottomRight.column, position.column);
+    }
+    return used;
+}
@@ -60,6 +60,24 @@ void NodeCatalog::initializeNodeCatalog()
         true  // 常用节点
     );
     
+    s_nodeMap["ImportCsv"] = NodeInfo(
+        "ImportCsv",
+        "导入CSV",
+        categoryToDisplayName(DataSource),
+        "读取CSV/TSV文本文件并输出范围数据",
+        categoryToIcon(DataSource),
+        false
+    );
+
+    s_nodeMap["ParallelRead"] = NodeInfo(
+        "ParallelRead",
+        "并行读取",
+        categoryToDisplayName(DataSource),
+        "在多个线程中同时读取多个工作簿或工作表的同一范围",
+        categoryToIcon(DataSource),
+        false
+    );
+
     s_nodeMap["SelectSheet"] = NodeInfo(
         "SelectSheet", 
         "选择工作表", 
@@ -87,6 +105,15 @@ void NodeCatalog::initializeNodeCatalog()
         true  // 常用节点
     );
     
+    s_nodeMap["StreamRows"] = NodeInfo(
+        "StreamRows",
+        "流式读取行",
+        categoryToDisplayName(DataSource),
+        "分批读取工作表的行，下游节点逐批处理，适合大表",
+        categoryToIcon(DataSource),
+        false
+    );
+
     s_nodeMap["SaveExcel"] = NodeInfo(
         "SaveExcel", 
         "保存Excel", 
@@ -116,6 +143,15 @@ void NodeCatalog::initializeNodeCatalog()
         categoryToIcon(Display),
         false
     );
+
+    s_nodeMap["DisplayRowStream"] = NodeInfo(
+        "DisplayRowStream",
+        "显示行流",
+        categoryToDisplayName(Display),
+        "逐批显示行流，只保留开头的部分行",
+        categoryToIcon(Display),
+        false
+    );
     
 
 
@@ -139,6 +175,15 @@ void NodeCatalog::initializeNodeCatalog()
         true  // 常用节点
     );
 
+    s_nodeMap["Recalculate"] = NodeInfo(
+        "Recalculate",
+        "公式计算",
+        categoryToDisplayName(Processing),
+        "写入输入值并重算工作表中的公式，只重算受影响的单元格",
+        categoryToIcon(Processing),
+        false
+    );
+
 
 
     s_initialized = true;
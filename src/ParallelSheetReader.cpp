@@ -0,0 +1,64 @@
+#include "ParallelSheetReader.hpp"
+#include "CellReference.hpp"
+#include "PerformanceProfiler.hpp"
+#include "SheetCache.hpp"
+#include "SheetReader.hpp"
+
+#include <QDebug>
+#include <XLDocument.hpp>
+
+ParallelSheetReader::Result ParallelSheetReader::read(const Task& task)
+{
+    PROFILE_SCOPE("ParallelSheetReader::read");
+
+    const auto cellRange = CellReference::parseRange(task.rangeAddress);
+    if (!cellRange) {
+        return Result{nullptr, QString("范围地址格式不正确: %1").arg(task.rangeAddress)};
+    }
+
+    try {
+        // 已在工作线程中，先计算内容哈希，第一次读取时也能命中其他节点写入的缓存
+        if (!task.sheetName.empty() && SheetCache::instance().prepareContentHash(task.filePath)) {
+            if (auto cached = SheetCache::instance().findRange(task.filePath, task.sheetName, task.rangeAddress)) {
+                return Result{std::move(cached), QString()};
+            }
+        }
+
+        // 文档只在当前工作线程中使用，函数返回时关闭
+        OpenXLSX::XLDocument document;
+        document.open(task.filePath.toStdString());
+        auto workbook = document.workbook();
+
+        std::string sheetName = task.sheetName;
+        if (sheetName.empty()) {
+            const auto names = workbook.worksheetNames();
+            if (names.empty()) {
+                return Result{nullptr, QString("工作簿中没有工作表: %1").arg(task.filePath)};
+            }
+            sheetName = names.front();
+        }
+        if (!workbook.worksheetExists(sheetName)) {
+            return Result{nullptr, QString("工作表不存在: %1 [%2]").arg(task.filePath, QString::fromStdString(sheetName))};
+        }
+
+        // 每个文件一个驻留池，随读取结果一起释放
+        auto worksheet = workbook.worksheet(sheetName);
+        auto pool = std::make_shared<StringPool>();
+        auto range = std::make_shared<RangeData>(task.rangeAddress,
+            SheetReader::readRange(worksheet,
+                OpenXLSX::XLCellReference(cellRange->topLeft.row, cellRange->topLeft.column),
+                OpenXLSX::XLCellReference(cellRange->bottomRight.row, cellRange->bottomRight.column),
+                pool.get()),
+            pool);
+
+        SheetCache::instance().store(task.filePath, sheetName, *range);
+
+        qDebug() << "ParallelSheetReader: Read" << task.rangeAddress << "of"
+                 << QString::fromStdString(sheetName) << "from" << task.filePath;
+        return Result{std::move(range), QString()};
+
+    } catch (const std::exception& e) {
+        return Result{nullptr, QString("读取失败: %1 [%2] - %3")
+            .arg(task.filePath, QString::fromStdString(task.sheetName), QString::fromUtf8(e.what()))};
+    }
+}
@@ -0,0 +1,158 @@
+#include "RowBatchStream.hpp"
+
+#include <QDebug>
+#include <QSemaphore>
+#include <QtConcurrent/QtConcurrent>
+#include <atomic>
+#include <exception>
+
+struct RowBatchStream::State
+{
+    quint64 streamId = RowBatchData::nextStreamId();
+    QSemaphore freeSlots{MaxPendingBatches};
+    std::atomic<bool> canceled{false};
+};
+
+RowBatchStream::Writer::Writer(RowBatchStream* stream, std::shared_ptr<State> state, int batchSize)
+    : m_stream(stream), m_state(std::move(state)), m_batchSize(qMax(1, batchSize))
+{
+    m_rows.reserve(m_batchSize);
+}
+
+void RowBatchStream::Writer::begin(int columnCount, int totalRows)
+{
+    m_columnCount = columnCount;
+    m_totalRows = totalRows;
+    m_begun = true;
+    post(RowBatchData::begin(m_state->streamId, columnCount, totalRows));
+}
+
+bool RowBatchStream::Writer::addRow(const std::vector<QVariant>& values)
+{
+    if (m_state->canceled) {
+        return false;
+    }
+    m_rows.emplace_back(m_rowIndex++, values, m_totalRows);
+    if (static_cast<int>(m_rows.size()) >= m_batchSize) {
+        return flush();
+    }
+    return true;
+}
+
+bool RowBatchStream::Writer::isCanceled() const
+{
+    return m_state->canceled;
+}
+
+bool RowBatchStream::Writer::flush()
+{
+    if (m_rows.empty()) {
+        return !m_state->canceled;
+    }
+    std::vector<RowData> rows;
+    rows.swap(m_rows);
+    m_rows.reserve(m_batchSize);
+    return post(RowBatchData::batch(m_state->streamId, std::move(rows), m_columnCount, m_totalRows));
+}
+
+bool RowBatchStream::Writer::post(std::shared_ptr<RowBatchData> data)
+{
+    // 等待GUI线程处理完之前的批次；取消后不再等待，避免与析构互相等待
+    while (!m_state->freeSlots.tryAcquire(1, 50)) {
+        if (m_state->canceled) {
+            return false;
+        }
+    }
+    if (m_state->canceled) {
+        m_state->freeSlots.release();
+        return false;
+    }
+
+    QMetaObject::invokeMethod(m_stream, [stream = m_stream, state = m_state, data = std::move(data)]() {
+        stream->deliver(state, data);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+RowBatchStream::RowBatchStream(QObject* parent)
+    : QObject(parent)
+{
+}
+
+RowBatchStream::~RowBatchStream()
+{
+    // 析构时不再补发End；生产者在取消后不会再等待GUI线程，这里可以安全地等待其结束
+    m_open = false;
+    cancel();
+    for (auto& future : m_futures) {
+        future.waitForFinished();
+    }
+}
+
+void RowBatchStream::start(Producer producer, int batchSize)
+{
+    cancel();
+
+    auto state = std::make_shared<State>();
+    m_state = state;
+    m_deliveredRows = 0;
+
+    // 被取消的生产者可能还在运行，析构时需要等待所有生产者结束
+    m_futures.removeIf([](const QFuture<void>& future) {
+        return future.isFinished();
+    });
+    m_futures.append(QtConcurrent::run([this, state, producer = std::move(producer), batchSize]() {
+        Writer writer(this, state, batchSize);
+        QString errorMessage;
+        try {
+            producer(writer);
+            writer.flush();
+        } catch (const std::exception& e) {
+            errorMessage = QString::fromUtf8(e.what());
+        } catch (...) {
+            errorMessage = "未知错误";
+        }
+        if (!writer.m_begun && errorMessage.isEmpty() && !state->canceled) {
+            writer.begin(0, 0);
+        }
+        writer.post(RowBatchData::end(state->streamId, writer.rowCount(), errorMessage));
+    }));
+}
+
+void RowBatchStream::cancel()
+{
+    if (!m_state) {
+        return;
+    }
+    m_state->canceled = true;
+
+    // 已经交付了Begin的流补发End，已排队的旧批次在deliver中丢弃
+    if (m_open) {
+        m_open = false;
+        qDebug() << "RowBatchStream: Stream" << m_state->streamId << "cancelled after" << m_deliveredRows << "rows";
+        Q_EMIT dataReady(RowBatchData::end(m_state->streamId, m_deliveredRows, QString(), true));
+    }
+}
+
+bool RowBatchStream::isRunning() const
+{
+    return m_state && !m_state->canceled && (m_open || (!m_futures.isEmpty() && m_futures.last().isRunning()));
+}
+
+void RowBatchStream::deliver(const std::shared_ptr<State>& state, const std::shared_ptr<RowBatchData>& data)
+{
+    if (state == m_state && !state->canceled) {
+        if (data->isBegin()) {
+            m_open = true;
+        } else if (data->isBatch()) {
+            m_deliveredRows += data->rowCount();
+        } else if (data->isEnd()) {
+            m_open = false;
+        }
+        // 下游在此同步处理批次
+        Q_EMIT dataReady(data);
+    }
+
+    // 处理完后才释放名额，在途批次数量因此有上界
+    state->freeSlots.release();
+}
@@ -0,0 +1,797 @@
+#include "SheetCache.hpp"
+#include "PerformanceProfiler.hpp"
+#include "data/SheetData.hpp"
+#include "SheetValueCache.hpp"
+#include "data/StringPool.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr char Magic[4] = {'T', 'F', 'S', 'C'};
+constexpr uint32_t ByteOrderMark = 0x01020304;
+constexpr int ContentHashSize = 16;
+constexpr qint64 HashChunkSize = 1 << 20;   ///< 计算内容哈希时每次读取的字节数
+constexpr uint32_t CompleteSheetFlag = 1;   ///< 数据是整个工作表的已使用区域，区域外都是空单元格
+const QString CacheSuffix = QStringLiteral(".tfsc");
+
+/**
+ * 缓存文件头，之后依次是工作表名称、列目录、各列数据和字符串表，
+ * 所有偏移量都相对文件开头并按8字节对齐
+ */
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t sheetNameSize;
+    uint8_t contentHash[ContentHashSize];
+    uint32_t firstRow;          ///< 数据左上角的行号（1开始）
+    uint32_t firstColumn;       ///< 数据左上角的列号（1开始）
+    uint32_t rowCount;
+    uint32_t columnCount;
+    uint32_t flags;             ///< CompleteSheetFlag
+    uint32_t reserved;
+    uint64_t columnsOffset;
+    uint64_t stringCount;
+    uint64_t stringOffsetsOffset;   ///< stringCount + 1个uint64，字符串在字符串数据中的起止位置
+    uint64_t stringDataOffset;
+    uint64_t fileSize;
+};
+
+/**
+ * 列目录项，各数组长度都由rowCount决定
+ */
+struct ColumnEntry
+{
+    uint32_t type;              ///< RangeColumn::Type
+    uint32_t reserved;
+    uint64_t nullBitsOffset;    ///< (rowCount + 63) / 64个uint64
+    uint64_t dataOffset;        ///< 类型化数组，字符串列为字符串表下标（uint32）
+    uint64_t exceptionsOffset;  ///< QDataStream序列化的例外表
+    uint64_t exceptionsSize;
+};
+
+static_assert(std::is_trivially_copyable_v<FileHeader> && std::is_trivially_copyable_v<ColumnEntry>);
+
+constexpr uint64_t align8(uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t(7);
+}
+
+size_t elementSize(RangeColumn::Type type)
+{
+    switch (type) {
+        case RangeColumn::Type::Boolean: return sizeof(uint8_t);
+        case RangeColumn::Type::Integer: return sizeof(int64_t);
+        case RangeColumn::Type::Double: return sizeof(double);
+        case RangeColumn::Type::String: return sizeof(uint32_t);
+        default: return 0;
+    }
+}
+
+QDataStream::Version streamVersion()
+{
+    return QDataStream::Qt_6_0;
+}
+
+/**
+ * 内存映射的缓存文件，校验通过后按需读取列数据
+ */
+class MappedSheet
+{
+public:
+    bool open(const QString& path, const QByteArray& contentHash, const std::string& sheetName)
+    {
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        const qint64 size = m_file.size();
+        if (size < static_cast<qint64>(sizeof(FileHeader))) {
+            return false;
+        }
+        m_data = reinterpret_cast<const char*>(m_file.map(0, size));
+        if (!m_data) {
+            return false;
+        }
+        m_size = static_cast<uint64_t>(size);
+
+        std::memcpy(&m_header, m_data, sizeof(FileHeader));
+        if (std::memcmp(m_header.magic, Magic, sizeof(Magic)) != 0
+            || m_header.version != SheetCache::FormatVersion
+            || m_header.byteOrder != ByteOrderMark
+            || m_header.fileSize != m_size
+            || contentHash.size() != ContentHashSize
+            || std::memcmp(m_header.contentHash, contentHash.constData(), ContentHashSize) != 0) {
+            return false;
+        }
+
+        if (!inBounds(sizeof(FileHeader), m_header.sheetNameSize)
+            || std::string_view(m_data + sizeof(FileHeader), m_header.sheetNameSize) != sheetName) {
+            return false;
+        }
+
+        return validateLayout();
+    }
+
+    bool isCompleteSheet() const
+    {
+        return (m_header.flags & CompleteSheetFlag) != 0;
+    }
+
+    // 是否能提供该范围的全部数据
+    bool covers(const CellRange& requested) const
+    {
+        return isCompleteSheet() || range().contains(requested);
+    }
+
+    CellRange range() const
+    {
+        return CellRange{{m_header.firstRow, static_cast<uint16_t>(m_header.firstColumn)},
+                         {m_header.firstRow + m_header.rowCount - 1,
+                          static_cast<uint16_t>(m_header.firstColumn + m_header.columnCount - 1)}};
+    }
+
+    /**
+     * 读取一列中从firstRow开始的rowCount行（相对缓存数据的下标），
+     * 前后分别补充leadingNulls和trailingNulls个空值
+     */
+    RangeColumn readColumn(int col, int firstRow, int rowCount, int leadingNulls = 0, int trailingNulls = 0)
+    {
+        const ColumnEntry entry = columnEntry(col);
+        const auto type = static_cast<RangeColumn::Type>(entry.type);
+        const auto* nullBits = array<uint64_t>(entry.nullBitsOffset);
+        const auto exceptions = readExceptions(entry);
+
+        RangeColumn column(type, leadingNulls + rowCount + trailingNulls, m_pool);
+        for (int i = 0; i < leadingNulls; ++i) {
+            column.appendNull();
+        }
+        for (int i = 0; i < rowCount; ++i) {
+            const int row = firstRow + i;
+            if (nullBits[row >> 6] & (uint64_t(1) << (row & 63))) {
+                auto it = exceptions.find(row);
+                if (it != exceptions.end()) {
+                    column.append(it->second);
+                } else {
+                    column.appendNull();
+                }
+                continue;
+            }
+
+            switch (type) {
+                case RangeColumn::Type::Boolean: column.appendBool(array<uint8_t>(entry.dataOffset)[row] != 0); break;
+                case RangeColumn::Type::Integer: column.appendInt64(array<int64_t>(entry.dataOffset)[row]); break;
+                case RangeColumn::Type::Double: column.appendDouble(array<double>(entry.dataOffset)[row]); break;
+                case RangeColumn::Type::String: column.appendString(stringHandle(array<uint32_t>(entry.dataOffset)[row])); break;
+                default: column.appendNull(); break;
+            }
+        }
+        for (int i = 0; i < trailingNulls; ++i) {
+            column.appendNull();
+        }
+        return column;
+    }
+
+    QVariant cellValue(int col, int row)
+    {
+        const ColumnEntry entry = columnEntry(col);
+        if (array<uint64_t>(entry.nullBitsOffset)[row >> 6] & (uint64_t(1) << (row & 63))) {
+            const auto exceptions = readExceptions(entry);
+            auto it = exceptions.find(row);
+            return it != exceptions.end() ? it->second : QVariant();
+        }
+
+        switch (static_cast<RangeColumn::Type>(entry.type)) {
+            case RangeColumn::Type::Boolean: return QVariant(array<uint8_t>(entry.dataOffset)[row] != 0);
+            case RangeColumn::Type::Integer: return QVariant(static_cast<qint64>(array<int64_t>(entry.dataOffset)[row]));
+            case RangeColumn::Type::Double: return QVariant(array<double>(entry.dataOffset)[row]);
+            case RangeColumn::Type::String: return QVariant(m_pool->string(stringHandle(array<uint32_t>(entry.dataOffset)[row])));
+            default: return QVariant();
+        }
+    }
+
+private:
+    bool inBounds(uint64_t offset, uint64_t size) const
+    {
+        return offset <= m_size && size <= m_size - offset;
+    }
+
+    template<typename T>
+    const T* array(uint64_t offset) const
+    {
+        return reinterpret_cast<const T*>(m_data + offset);
+    }
+
+    ColumnEntry columnEntry(int col) const
+    {
+        ColumnEntry entry;
+        std::memcpy(&entry, m_data + m_header.columnsOffset + col * sizeof(ColumnEntry), sizeof(ColumnEntry));
+        return entry;
+    }
+
+    // 校验所有偏移量，损坏或截断的文件不会导致越界读取
+    bool validateLayout() const
+    {
+        if (m_header.rowCount == 0 || m_header.columnCount == 0
+            || m_header.columnsOffset % 8 != 0
+            || !inBounds(m_header.columnsOffset, uint64_t(m_header.columnCount) * sizeof(ColumnEntry))) {
+            return false;
+        }
+
+        const uint64_t nullBytes = (uint64_t(m_header.rowCount) + 63) / 64 * sizeof(uint64_t);
+        for (uint32_t col = 0; col < m_header.columnCount; ++col) {
+            const ColumnEntry entry = columnEntry(static_cast<int>(col));
+            if (entry.type > static_cast<uint32_t>(RangeColumn::Type::String)) {
+                return false;
+            }
+            const size_t element = elementSize(static_cast<RangeColumn::Type>(entry.type));
+            if (entry.nullBitsOffset % 8 != 0 || entry.dataOffset % 8 != 0
+                || !inBounds(entry.nullBitsOffset, nullBytes)
+                || !inBounds(entry.dataOffset, uint64_t(m_header.rowCount) * element)
+                || !inBounds(entry.exceptionsOffset, entry.exceptionsSize)) {
+                return false;
+            }
+        }
+
+        return m_header.stringOffsetsOffset % 8 == 0
+            && m_header.stringCount < m_size
+            && inBounds(m_header.stringOffsetsOffset, (m_header.stringCount + 1) * sizeof(uint64_t))
+            && inBounds(m_header.stringDataOffset, 0);
+    }
+
+    std::unordered_map<int, QVariant> readExceptions(const ColumnEntry& entry) const
+    {
+        std::unordered_map<int, QVariant> exceptions;
+        if (entry.exceptionsSize == 0) {
+            return exceptions;
+        }
+
+        const QByteArray blob = QByteArray::fromRawData(m_data + entry.exceptionsOffset,
+                                                        static_cast<qsizetype>(entry.exceptionsSize));
+        QDataStream in(blob);
+        in.setVersion(streamVersion());
+        qint32 count = 0;
+        in >> count;
+        for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            qint32 row = 0;
+            QVariant value;
+            in >> row >> value;
+            exceptions.emplace(row, value);
+        }
+        return exceptions;
+    }
+
+    // 字符串表下标 -> m_pool中的句柄，每个字符串只驻留一次
+    StringPool::Handle stringHandle(uint32_t index)
+    {
+        if (index >= m_header.stringCount) {
+            return StringPool::EmptyHandle;
+        }
+        if (m_handles.empty()) {
+            m_handles.assign(m_header.stringCount, InvalidHandle);
+        }
+        if (m_handles[index] == InvalidHandle) {
+            const auto* offsets = array<uint64_t>(m_header.stringOffsetsOffset);
+            const uint64_t begin = offsets[index];
+            const uint64_t end = offsets[index + 1];
+            const uint64_t dataSize = m_size - m_header.stringDataOffset;
+            m_handles[index] = (begin <= end && end <= dataSize)
+                ? m_pool->intern(std::string_view(m_data + m_header.stringDataOffset + begin, end - begin))
+                : StringPool::EmptyHandle;
+        }
+        return m_handles[index];
+    }
+
+    static constexpr StringPool::Handle InvalidHandle = ~StringPool::Handle(0);
+
+    QFile m_file;
+    const char* m_data = nullptr;
+    uint64_t m_size = 0;
+    FileHeader m_header{};
+    std::shared_ptr<StringPool> m_pool = std::make_shared<StringPool>();   ///< 读出的列共用，随列一起释放
+    std::vector<StringPool::Handle> m_handles;
+};
+
+/**
+ * 把范围数据写成缓存文件，先确定布局再顺序写入
+ */
+bool writeCacheFile(const QString& path, const QByteArray& contentHash, const std::string& sheetName,
+                    const CellRange& range, const RangeData& data, bool completeSheet)
+{
+    const auto& columns = data.columns();
+    const int rowCount = data.rowCount();
+    const int columnCount = data.columnCount();
+
+    FileHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = SheetCache::FormatVersion;
+    header.byteOrder = ByteOrderMark;
+    header.sheetNameSize = static_cast<uint32_t>(sheetName.size());
+    std::memcpy(header.contentHash, contentHash.constData(), ContentHashSize);
+    header.firstRow = range.topLeft.row;
+    header.firstColumn = range.topLeft.column;
+    header.rowCount = static_cast<uint32_t>(rowCount);
+    header.columnCount = static_cast<uint32_t>(columnCount);
+    header.flags = completeSheet ? CompleteSheetFlag : 0;
+
+    uint64_t offset = align8(sizeof(FileHeader) + sheetName.size());
+    header.columnsOffset = offset;
+    offset += uint64_t(columnCount) * sizeof(ColumnEntry);
+
+    // 各列的字符串 -> 文件内字符串表下标，列可能来自不同的驻留池
+    StringIndexer strings;
+
+    const uint64_t nullBytes = (uint64_t(rowCount) + 63) / 64 * sizeof(uint64_t);
+    std::vector<ColumnEntry> entries(columnCount);
+    std::vector<QByteArray> exceptionBlobs(columnCount);
+    std::vector<std::vector<uint32_t>> stringColumns(columnCount);
+    for (int col = 0; col < columnCount; ++col) {
+        const RangeColumn& column = columns[col];
+        if (column.size() != rowCount) {
+            return false;
+        }
+
+        ColumnEntry& entry = entries[col];
+        entry.type = static_cast<uint32_t>(column.type());
+        entry.nullBitsOffset = offset = align8(offset);
+        offset += nullBytes;
+
+        const size_t element = elementSize(column.type());
+        if (element > 0) {
+            entry.dataOffset = offset = align8(offset);
+            offset += uint64_t(rowCount) * element;
+        }
+
+        if (column.type() == RangeColumn::Type::String) {
+            auto& indices = stringColumns[col];
+            indices.reserve(rowCount);
+            for (StringPool::Handle handle : column.stringHandles()) {
+                indices.push_back(strings.indexOf(column.stringPool(), handle).first);
+            }
+        }
+
+        if (!column.exceptions().empty()) {
+            QDataStream out(&exceptionBlobs[col], QIODevice::WriteOnly);
+            out.setVersion(streamVersion());
+            out << static_cast<qint32>(column.exceptions().size());
+            for (const auto& [row, value] : column.exceptions()) {
+                out << static_cast<qint32>(row) << value;
+            }
+            entry.exceptionsOffset = offset = align8(offset);
+            entry.exceptionsSize = static_cast<uint64_t>(exceptionBlobs[col].size());
+            offset += entry.exceptionsSize;
+        }
+    }
+
+    std::vector<QByteArray> stringData;
+    std::vector<uint64_t> stringOffsets;
+    stringData.reserve(strings.strings().size());
+    stringOffsets.reserve(strings.strings().size() + 1);
+    uint64_t stringBytes = 0;
+    for (const QString& text : strings.strings()) {
+        stringOffsets.push_back(stringBytes);
+        stringData.push_back(text.toUtf8());
+        stringBytes += static_cast<uint64_t>(stringData.back().size());
+    }
+    stringOffsets.push_back(stringBytes);
+
+    header.stringCount = stringData.size();
+    header.stringOffsetsOffset = offset = align8(offset);
+    offset += stringOffsets.size() * sizeof(uint64_t);
+    header.stringDataOffset = offset;
+    offset += stringBytes;
+    header.fileSize = offset;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    uint64_t position = 0;
+    bool ok = true;
+    auto writeAt = [&](uint64_t target, const void* bytes, uint64_t size) {
+        static const char padding[8] = {};
+        if (target > position) {
+            ok = ok && file.write(padding, static_cast<qint64>(target - position)) == static_cast<qint64>(target - position);
+            position = target;
+        }
+        if (size > 0) {
+            ok = ok && file.write(static_cast<const char*>(bytes), static_cast<qint64>(size)) == static_cast<qint64>(size);
+            position += size;
+        }
+    };
+
+    writeAt(0, &header, sizeof(FileHeader));
+    writeAt(sizeof(FileHeader), sheetName.data(), sheetName.size());
+    writeAt(header.columnsOffset, entries.data(), entries.size() * sizeof(ColumnEntry));
+
+    for (int col = 0; col < columnCount && ok; ++col) {
+        const RangeColumn& column = columns[col];
+        const ColumnEntry& entry = entries[col];
+        writeAt(entry.nullBitsOffset, column.nullBitmap().data(), column.nullBitmap().size_bytes());
+        switch (column.type()) {
+            case RangeColumn::Type::Boolean: writeAt(entry.dataOffset, column.boolValues().data(), column.boolValues().size_bytes()); break;
+            case RangeColumn::Type::Integer: writeAt(entry.dataOffset, column.int64Values().data(), column.int64Values().size_bytes()); break;
+            case RangeColumn::Type::Double: writeAt(entry.dataOffset, column.doubleValues().data(), column.doubleValues().size_bytes()); break;
+            case RangeColumn::Type::String: writeAt(entry.dataOffset, stringColumns[col].data(), stringColumns[col].size() * sizeof(uint32_t)); break;
+            default: break;
+        }
+        if (entry.exceptionsSize > 0) {
+            writeAt(entry.exceptionsOffset, exceptionBlobs[col].constData(), entry.exceptionsSize);
+        }
+    }
+
+    writeAt(header.stringOffsetsOffset, stringOffsets.data(), stringOffsets.size() * sizeof(uint64_t));
+    for (const QByteArray& text : stringData) {
+        writeAt(position, text.constData(), static_cast<uint64_t>(text.size()));
+    }
+
+    if (!ok || position != header.fileSize) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+// 更新修改时间，作为清理时的最近使用时间
+void touch(const QString& path)
+{
+    QFile file(path);
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+}
+
+} // namespace
+
+SheetCache& SheetCache::instance()
+{
+    static SheetCache instance;
+    return instance;
+}
+
+SheetCache::SheetCache()
+    : m_directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/sheets")
+{
+}
+
+QString SheetCache::cacheableWorkbookPath(const SheetData& sheet)
+{
+    auto document = sheet.document();
+    if (!document) {
+        return {};
+    }
+
+    const QString& filePath = document->filePath();
+    if (WorkbookCache::instance().find(WorkbookCache::FileStamp::of(filePath)) != document) {
+        return {};
+    }
+    return filePath;
+}
+
+std::shared_ptr<RangeData> SheetCache::findRange(const QString& workbookPath,
+                                                 const std::string& sheetName,
+                                                 const QString& rangeAddress)
+{
+    PROFILE_SCOPE("SheetCache::findRange");
+
+    const auto requested = CellReference::parseRange(rangeAddress);
+    if (!requested) {
+        return nullptr;
+    }
+    // 查找可能在GUI线程上，只使用已计算的哈希
+    const QByteArray hash = knownContentHash(WorkbookCache::FileStamp::of(workbookPath));
+    if (hash.isEmpty()) {
+        return nullptr;
+    }
+
+    const QString cachePath = cacheFilePath(hash, sheetName);
+    std::shared_ptr<RangeData> range;
+    {
+        MappedSheet sheet;
+        if (!sheet.open(cachePath, hash, sheetName) || !sheet.covers(*requested)) {
+            return nullptr;
+        }
+
+        // 只有完整工作表的缓存会超出保存的区域，区域外的行列都是空单元格
+        const CellRange stored = sheet.range();
+        const uint32_t firstRow = std::max(requested->topLeft.row, stored.topLeft.row);
+        const uint32_t lastRow = std::min(requested->bottomRight.row, stored.bottomRight.row);
+        const int rowCount = static_cast<int>(requested->rowCount());
+        const int storedRows = firstRow <= lastRow ? static_cast<int>(lastRow - firstRow + 1) : 0;
+        const int leadingNulls = storedRows > 0 ? static_cast<int>(firstRow - requested->topLeft.row) : rowCount;
+
+        std::vector<RangeColumn> columns;
+        columns.reserve(requested->columnCount());
+        for (uint32_t col = requested->topLeft.column; col <= requested->bottomRight.column; ++col) {
+            if (storedRows == 0 || col < stored.topLeft.column || col > stored.bottomRight.column) {
+                RangeColumn empty(RangeColumn::Type::Empty, rowCount);
+                for (int row = 0; row < rowCount; ++row) {
+                    empty.appendNull();
+                }
+                columns.push_back(std::move(empty));
+                continue;
+            }
+            columns.push_back(sheet.readColumn(static_cast<int>(col - stored.topLeft.column),
+                                               static_cast<int>(firstRow - stored.topLeft.row), storedRows,
+                                               leadingNulls, rowCount - leadingNulls - storedRows));
+        }
+        range = std::make_shared<RangeData>(rangeAddress, std::move(columns));
+    }
+
+    touch(cachePath);
+    qDebug() << "SheetCache: Loaded" << rangeAddress << "of" << QString::fromStdString(sheetName) << "from cache";
+    return range;
+}
+
+std::optional<QVariant> SheetCache::findCell(const QString& workbookPath,
+                                             const std::string& sheetName,
+                                             const CellPosition& cell)
+{
+    if (!cell.isValid()) {
+        return std::nullopt;
+    }
+    const QByteArray hash = knownContentHash(WorkbookCache::FileStamp::of(workbookPath));
+    if (hash.isEmpty()) {
+        return std::nullopt;
+    }
+
+    MappedSheet sheet;
+    if (!sheet.open(cacheFilePath(hash, sheetName), hash, sheetName)) {
+        return std::nullopt;
+    }
+    if (!sheet.range().contains(cell)) {
+        if (sheet.isCompleteSheet()) {
+            return QVariant();
+        }
+        return std::nullopt;
+    }
+    const CellPosition origin = sheet.range().topLeft;
+    return sheet.cellValue(static_cast<int>(cell.column - origin.column), static_cast<int>(cell.row - origin.row));
+}
+
+bool SheetCache::store(const QString& workbookPath, const std::string& sheetName, const RangeData& data,
+                       bool completeSheet)
+{
+    PROFILE_SCOPE("SheetCache::store");
+
+    if (data.rowCount() == 0 || data.columnCount() == 0) {
+        return false;
+    }
+    const auto address = CellReference::parseRange(data.rangeAddress());
+    if (!address) {
+        return false;
+    }
+    const CellPosition topLeft = address->topLeft;
+    const CellRange range{topLeft, {topLeft.row + static_cast<uint32_t>(data.rowCount()) - 1,
+                                    static_cast<uint16_t>(topLeft.column + data.columnCount() - 1)}};
+
+    const QByteArray hash = contentHash(workbookPath);
+    if (hash.isEmpty()) {
+        return false;
+    }
+
+    const QString cachePath = cacheFilePath(hash, sheetName);
+    {
+        // 已有完整工作表的缓存时不再写入；部分范围只在新范围包含旧范围时替换，
+        // 交替读取不同范围时不会反复重写同一个文件
+        MappedSheet existing;
+        if (existing.open(cachePath, hash, sheetName)
+            && (existing.isCompleteSheet()
+                || (!completeSheet && (existing.range().contains(range) || !range.contains(existing.range()))))) {
+            return false;
+        }
+    }
+
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    if (!writeCacheFile(cachePath, hash, sheetName, range, data, completeSheet)) {
+        qDebug() << "SheetCache: Failed to write" << cachePath;
+        return false;
+    }
+
+    qDebug() << "SheetCache: Stored" << data.rangeAddress() << "of" << QString::fromStdString(sheetName)
+             << "(" << QFileInfo(cachePath).size() << "bytes)";
+    prune();
+    return true;
+}
+
+void SheetCache::storeAsync(const QString& workbookPath, const std::string& sheetName, std::shared_ptr<const RangeData> data)
+{
+    if (!data) {
+        return;
+    }
+    QThreadPool::globalInstance()->start([this, workbookPath, sheetName, data = std::move(data)]() {
+        store(workbookPath, sheetName, *data);
+    });
+}
+
+void SheetCache::storeSheetAsync(const QString& workbookPath, const std::string& sheetName,
+                                 std::shared_ptr<const SheetValueCache> values)
+{
+    if (!values || !values->usedRange()) {
+        return;
+    }
+    QThreadPool::globalInstance()->start([this, workbookPath, sheetName, values = std::move(values)]() {
+        const CellRange range = *values->usedRange();
+        const auto data = values->readRange(range, CellReference::formatRange(range).toQString());
+        store(workbookPath, sheetName, *data, true);
+    });
+}
+
+void SheetCache::rememberContentHash(const WorkbookCache::FileStamp& stamp, const QByteArray& contentHash)
+{
+    if (!stamp.isValid() || contentHash.size() != ContentHashSize) {
+        return;
+    }
+
+    const qint64 lastModified = stamp.lastModified.toMSecsSinceEpoch();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_hashes.insert(stamp.canonicalPath, HashEntry{stamp.size, lastModified, contentHash});
+    }
+
+    // 同时写入磁盘，下次启动时不需要重新计算
+    const QString path = stampFilePath(stamp.canonicalPath);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        QDataStream out(&file);
+        out.setVersion(streamVersion());
+        out << stamp.size << lastModified << contentHash;
+        file.commit();
+    }
+}
+
+QByteArray SheetCache::knownContentHash(const WorkbookCache::FileStamp& stamp)
+{
+    if (!stamp.isValid()) {
+        return {};
+    }
+    const qint64 lastModified = stamp.lastModified.toMSecsSinceEpoch();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_hashes.constFind(stamp.canonicalPath);
+        if (it != m_hashes.constEnd() && it->size == stamp.size && it->lastModified == lastModified) {
+            return it->contentHash;
+        }
+    }
+
+    // 上次运行记录的哈希
+    QFile stampFile(stampFilePath(stamp.canonicalPath));
+    if (stampFile.open(QIODevice::ReadOnly)) {
+        QDataStream in(&stampFile);
+        in.setVersion(streamVersion());
+        qint64 size = -1;
+        qint64 modified = 0;
+        QByteArray hash;
+        in >> size >> modified >> hash;
+        if (in.status() == QDataStream::Ok && size == stamp.size && modified == lastModified
+            && hash.size() == ContentHashSize) {
+            QMutexLocker locker(&m_mutex);
+            m_hashes.insert(stamp.canonicalPath, HashEntry{size, modified, hash});
+            return hash;
+        }
+    }
+    return {};
+}
+
+QByteArray SheetCache::contentHash(const QString& workbookPath, const ReadProgress& progress)
+{
+    const auto stamp = WorkbookCache::FileStamp::of(workbookPath);
+    const QByteArray known = knownContentHash(stamp);
+    if (!known.isEmpty() || !stamp.isValid()) {
+        return known;
+    }
+
+    // 大小或修改时间变化，重新计算内容哈希
+    PROFILE_SCOPE("SheetCache::contentHash");
+    QFile file(stamp.canonicalPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QCryptographicHash hasher(QCryptographicHash::Md5);
+    QByteArray buffer(HashChunkSize, Qt::Uninitialized);
+    qint64 bytesRead = 0;
+    while (true) {
+        const qint64 read = file.read(buffer.data(), buffer.size());
+        if (read < 0) {
+            return {};
+        }
+        if (read == 0) {
+            break;
+        }
+        hasher.addData(QByteArrayView(buffer.constData(), read));
+        bytesRead += read;
+        if (progress && !progress(bytesRead, stamp.size)) {
+            return {};
+        }
+    }
+    const QByteArray hash = hasher.result();
+    rememberContentHash(stamp, hash);
+    return hash;
+}
+
+bool SheetCache::prepareContentHash(const QString& workbookPath, const ReadProgress& progress)
+{
+    return !contentHash(workbookPath, progress).isEmpty();
+}
+
+void SheetCache::clear()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_hashes.clear();
+    }
+    QDir(directory()).removeRecursively();
+    qDebug() << "SheetCache: Cleared";
+}
+
+QString SheetCache::directory() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_directory;
+}
+
+void SheetCache::setDirectory(const QString& directory)
+{
+    QMutexLocker locker(&m_mutex);
+    m_directory = directory;
+    m_hashes.clear();
+}
+
+void SheetCache::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxBytes = maxBytes;
+}
+
+QString SheetCache::cacheFilePath(const QByteArray& contentHash, const std::string& sheetName) const
+{
+    const QByteArray sheetHash = QCryptographicHash::hash(QByteArray::fromStdString(sheetName), QCryptographicHash::Md5);
+    return QString("%1/%2-%3%4").arg(directory(), QString::fromLatin1(contentHash.toHex()),
+                                     QString::fromLatin1(sheetHash.toHex().left(16)), CacheSuffix);
+}
+
+QString SheetCache::stampFilePath(const QString& canonicalPath) const
+{
+    const QByteArray pathHash = QCryptographicHash::hash(canonicalPath.toUtf8(), QCryptographicHash::Md5);
+    return QString("%1/stamps/%2.stamp").arg(directory(), QString::fromLatin1(pathHash.toHex()));
+}
+
+void SheetCache::prune()
+{
+    qint64 maxBytes;
+    {
+        QMutexLocker locker(&m_mutex);
+        maxBytes = m_maxBytes;
+    }
+
+    // 按修改时间从新到旧排列，超出上限的部分全部删除
+    const auto files = QDir(directory()).entryInfoList({"*" + CacheSuffix}, QDir::Files, QDir::Time);
+    qint64 totalBytes = 0;
+    for (const auto& info : files) {
+        totalBytes += info.size();
+        if (totalBytes > maxBytes) {
+            QFile::remove(info.absoluteFilePath());
+            qDebug() << "SheetCache: Pruned" << info.fileName();
+        }
+    }
+}
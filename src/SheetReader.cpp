@@ -0,0 +1,102 @@
+#include "SheetReader.hpp"
+#include "PerformanceProfiler.hpp"
+#include "data/StringPool.hpp"
+
+#include <XLRow.hpp>
+#include <algorithm>
+
+std::vector<std::vector<QVariant>> SheetReader::readRange(const OpenXLSX::XLWorksheet& worksheet,
+                                                          const OpenXLSX::XLCellReference& topLeft,
+                                                          const OpenXLSX::XLCellReference& bottomRight,
+                                                          StringPool* pool)
+{
+    PROFILE_SCOPE("SheetReader::readRange");
+
+    const uint32_t firstRow = topLeft.row();
+    const uint32_t lastRow = bottomRight.row();
+    const uint16_t firstCol = topLeft.column();
+    const uint16_t lastCol = bottomRight.column();
+    const int colCount = static_cast<int>(lastCol) - firstCol + 1;
+
+    std::vector<std::vector<QVariant>> data;
+    data.reserve(lastRow - firstRow + 1);
+
+    // 行迭代器按文档顺序前进，并以上一次找到的行作为查找起点
+    auto rows = worksheet.rows(firstRow, lastRow);
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        std::vector<QVariant> rowData(colCount);
+
+        // rowExists()不会创建缺失的行，只有存在的行才解引用
+        if (it.rowExists()) {
+            // 一次取出整行的值，每个单元格只解码一次
+            const std::vector<OpenXLSX::XLCellValue> values = it->values();
+            const int lastAvailable = std::min<int>(static_cast<int>(values.size()), lastCol);
+            for (int col = firstCol; col <= lastAvailable; ++col) {
+                rowData[col - firstCol] = toVariant(values[col - 1], pool);
+            }
+        }
+
+        data.push_back(std::move(rowData));
+    }
+
+    return data;
+}
+
+std::optional<CellRange> SheetReader::usedRange(const OpenXLSX::XLWorksheet& worksheet)
+{
+    PROFILE_SCOPE("SheetReader::usedRange");
+
+    std::optional<CellRange> used;
+    auto rows = worksheet.rows();
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        if (!it.rowExists()) {
+            continue;
+        }
+
+        const std::vector<OpenXLSX::XLCellValue> values = it->values();
+        const auto isEmpty = [](const OpenXLSX::XLCellValue& value) {
+            return value.type() == OpenXLSX::XLValueType::Empty;
+        };
+        const auto first = std::find_if_not(values.begin(), values.end(), isEmpty);
+        if (first == values.end()) {
+            continue;
+        }
+        const auto last = std::find_if_not(values.rbegin(), values.rend(), isEmpty);
+
+        const uint32_t row = it->rowNumber();
+        const auto firstCol = static_cast<uint16_t>(first - values.begin() + 1);
+        const auto lastCol = static_cast<uint16_t>(values.rend() - last);
+        if (!used) {
+            used = CellRange{{row, firstCol}, {row, lastCol}};
+        } else {
+            used->topLeft.column = std::min(used->topLeft.column, firstCol);
+            used->bottomRight.row = row;
+            used->bottomRight.column = std::max(used->bottomRight.column, lastCol);
+        }
+    }
+    return used;
+}
+
+QVariant SheetReader::toVariant(const OpenXLSX::XLCellValue& value, StringPool* pool)
+{
+    switch (value.type()) {
+        case OpenXLSX::XLValueType::Empty:
+            return QVariant();
+        case OpenXLSX::XLValueType::Boolean:
+            return value.get<bool>();
+        case OpenXLSX::XLValueType::Integer:
+            return static_cast<qint64>(value.get<int64_t>());
+        case OpenXLSX::XLValueType::Float:
+            return value.get<double>();
+        case OpenXLSX::XLValueType::String:
+            // 重复文本共享驻留池中的同一份QString
+            return pool ? pool->pooled(value.get<std::string>()) : QString::fromStdString(value.get<std::string>());
+        case OpenXLSX::XLValueType::Error: {
+            // 公式的错误结果，如"#DIV/0!"，与流式读取的结果一致
+            const std::string text = OpenXLSX::XLCellValue(value).getString();
+            return pool ? pool->pooled(text) : QString::fromStdString(text);
+        }
+        default:
+            return QString("(未知类型)");
+    }
+}
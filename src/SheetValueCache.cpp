@@ -0,0 +1,255 @@
+#include "SheetValueCache.hpp"
+#include "PerformanceProfiler.hpp"
+#include "SheetReader.hpp"
+
+#include <XLCellValue.hpp>
+#include <XLRow.hpp>
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <tuple>
+
+/**
+ * 按任意顺序追加单元格，finish()时整理为按行、列排序的稀疏存储
+ */
+class SheetValueCache::Builder
+{
+public:
+    void add(uint32_t row, uint16_t column, const Cell& cell)
+    {
+        // 文档中的单元格通常已经有序，只有出现逆序时才需要排序
+        if (!m_cells.empty() && (row < m_cellRows.back() || (row == m_cellRows.back() && column <= m_cells.back().column))) {
+            m_sorted = false;
+        }
+        Cell stored = cell;
+        stored.column = column;
+        m_cellRows.push_back(row);
+        m_cells.push_back(stored);
+    }
+
+    std::shared_ptr<SheetValueCache> finish(std::shared_ptr<StringPool> pool)
+    {
+        if (!m_sorted) {
+            sortCells();
+        }
+
+        auto cache = std::make_shared<SheetValueCache>();
+        cache->m_cells = std::move(m_cells);
+        cache->m_cells.shrink_to_fit();
+        cache->m_pool = std::move(pool);
+
+        uint16_t firstColumn = CellReference::MaxColumns;
+        uint16_t lastColumn = 0;
+        for (size_t i = 0; i < m_cellRows.size(); ++i) {
+            if (cache->m_rows.empty() || cache->m_rows.back() != m_cellRows[i]) {
+                cache->m_rows.push_back(m_cellRows[i]);
+                cache->m_rowStarts.push_back(static_cast<uint32_t>(i));
+            }
+            firstColumn = std::min(firstColumn, cache->m_cells[i].column);
+            lastColumn = std::max(lastColumn, cache->m_cells[i].column);
+        }
+        cache->m_rowStarts.push_back(static_cast<uint32_t>(cache->m_cells.size()));
+
+        if (!cache->m_rows.empty()) {
+            cache->m_usedRange = CellRange{{cache->m_rows.front(), firstColumn}, {cache->m_rows.back(), lastColumn}};
+        }
+        return cache;
+    }
+
+private:
+    // 按行、列排序，同一位置出现多次时保留最后一次
+    void sortCells()
+    {
+        std::vector<uint32_t> order(m_cells.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+            return m_cellRows[a] != m_cellRows[b] ? m_cellRows[a] < m_cellRows[b]
+                                                  : m_cells[a].column < m_cells[b].column;
+        });
+
+        std::vector<uint32_t> rows;
+        std::vector<Cell> cells;
+        rows.reserve(order.size());
+        cells.reserve(order.size());
+        for (const uint32_t index : order) {
+            if (!cells.empty() && rows.back() == m_cellRows[index] && cells.back().column == m_cells[index].column) {
+                cells.back() = m_cells[index];
+                continue;
+            }
+            rows.push_back(m_cellRows[index]);
+            cells.push_back(m_cells[index]);
+        }
+        m_cellRows = std::move(rows);
+        m_cells = std::move(cells);
+    }
+
+    std::vector<uint32_t> m_cellRows;
+    std::vector<Cell> m_cells;
+    bool m_sorted = true;
+};
+
+std::shared_ptr<const SheetValueCache> SheetValueCache::fromWorksheet(const OpenXLSX::XLWorksheet& worksheet,
+                                                                      std::shared_ptr<StringPool> pool)
+{
+    PROFILE_SCOPE("SheetValueCache::fromWorksheet");
+
+    Builder builder;
+    auto rows = worksheet.rows();
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        // rowExists()不会创建缺失的行，只有存在的行才解引用
+        if (!it.rowExists()) {
+            continue;
+        }
+        const uint32_t row = it->rowNumber();
+        const std::vector<OpenXLSX::XLCellValue> values = it->values();
+        for (size_t col = 0; col < values.size(); ++col) {
+            Cell cell;
+            switch (values[col].type()) {
+                case OpenXLSX::XLValueType::Empty:
+                    continue;
+                case OpenXLSX::XLValueType::Boolean:
+                    cell.type = Type::Boolean;
+                    cell.boolValue = values[col].get<bool>();
+                    break;
+                case OpenXLSX::XLValueType::Integer:
+                    cell.type = Type::Integer;
+                    cell.intValue = values[col].get<int64_t>();
+                    break;
+                case OpenXLSX::XLValueType::Float:
+                    cell.type = Type::Double;
+                    cell.doubleValue = values[col].get<double>();
+                    break;
+                case OpenXLSX::XLValueType::String:
+                    cell.type = Type::String;
+                    cell.stringValue = pool->intern(std::string_view(values[col].get<std::string>()));
+                    break;
+                default:
+                    // 错误值等与SheetReader::toVariant()的结果一致
+                    cell.type = Type::String;
+                    cell.stringValue = pool->intern(SheetReader::toVariant(values[col]).toString());
+                    break;
+            }
+            builder.add(row, static_cast<uint16_t>(col + 1), cell);
+        }
+    }
+    return builder.finish(std::move(pool));
+}
+
+QVariant SheetValueCache::value(CellPosition cell) const
+{
+    const auto [begin, end] = rowCells(cell.row);
+    const Cell* found = std::lower_bound(begin, end, cell.column, [](const Cell& item, uint16_t column) {
+        return item.column < column;
+    });
+    return found != end && found->column == cell.column ? found->toVariant(*m_pool) : QVariant();
+}
+
+std::shared_ptr<RangeData> SheetValueCache::readRange(const CellRange& range, const QString& rangeAddress) const
+{
+    PROFILE_SCOPE("SheetValueCache::readRange");
+
+    const int rowCount = static_cast<int>(range.rowCount());
+    const int columnCount = range.columnCount();
+    const uint16_t firstColumn = range.topLeft.column;
+
+    // 范围内有值的行：行号有序，只需定位一次起点
+    const auto firstRow = std::lower_bound(m_rows.begin(), m_rows.end(), range.topLeft.row);
+    const auto lastRow = std::upper_bound(firstRow, m_rows.end(), range.bottomRight.row);
+
+    // 范围内某一行的单元格
+    const auto cellsInRange = [&](std::vector<uint32_t>::const_iterator row) {
+        const size_t index = static_cast<size_t>(row - m_rows.begin());
+        const Cell* begin = m_cells.data() + m_rowStarts[index];
+        const Cell* end = m_cells.data() + m_rowStarts[index + 1];
+        begin = std::lower_bound(begin, end, firstColumn, [](const Cell& item, uint16_t column) {
+            return item.column < column;
+        });
+        end = std::upper_bound(begin, end, range.bottomRight.column, [](uint16_t column, const Cell& item) {
+            return column < item.column;
+        });
+        return std::make_pair(begin, end);
+    };
+
+    // 第一遍统计每列各类型的数量，列按出现最多的类型存储，其余值进入例外表
+    std::vector<std::array<int, static_cast<int>(Type::Variant) + 1>> counts(columnCount);
+    for (auto row = firstRow; row != lastRow; ++row) {
+        const auto [begin, end] = cellsInRange(row);
+        for (const Cell* cell = begin; cell != end; ++cell) {
+            counts[cell->column - firstColumn][static_cast<int>(cell->type)]++;
+        }
+    }
+
+    std::vector<RangeColumn> columns;
+    columns.reserve(columnCount);
+    for (int col = 0; col < columnCount; ++col) {
+        Type dominant = Type::Empty;
+        int best = 0;
+        for (Type type : {Type::Boolean, Type::Integer, Type::Double, Type::String}) {
+            if (counts[col][static_cast<int>(type)] > best) {
+                best = counts[col][static_cast<int>(type)];
+                dominant = type;
+            }
+        }
+        columns.emplace_back(dominant, rowCount, m_pool);
+    }
+
+    // 第二遍按行追加，空单元格和不存在的行补空值
+    auto row = firstRow;
+    for (uint32_t rowNumber = range.topLeft.row; rowNumber <= range.bottomRight.row; ++rowNumber) {
+        const Cell* begin = nullptr;
+        const Cell* end = nullptr;
+        if (row != lastRow && *row == rowNumber) {
+            std::tie(begin, end) = cellsInRange(row);
+            ++row;
+        }
+
+        int nextColumn = 0;
+        for (const Cell* cell = begin; cell != end; ++cell) {
+            const int col = cell->column - firstColumn;
+            for (; nextColumn < col; ++nextColumn) {
+                columns[nextColumn].appendNull();
+            }
+            switch (cell->type) {
+                case Type::Boolean: columns[col].appendBool(cell->boolValue); break;
+                case Type::Integer: columns[col].appendInt64(cell->intValue); break;
+                case Type::Double: columns[col].appendDouble(cell->doubleValue); break;
+                case Type::String: columns[col].appendString(cell->stringValue); break;
+                default: columns[col].appendNull(); break;
+            }
+            nextColumn = col + 1;
+        }
+        for (; nextColumn < columnCount; ++nextColumn) {
+            columns[nextColumn].appendNull();
+        }
+    }
+
+    return std::make_shared<RangeData>(rangeAddress, std::move(columns));
+}
+
+size_t SheetValueCache::memoryUsage() const
+{
+    return m_rows.capacity() * sizeof(uint32_t)
+         + m_rowStarts.capacity() * sizeof(uint32_t)
+         + m_cells.capacity() * sizeof(Cell);
+}
+
+std::pair<const SheetValueCache::Cell*, const SheetValueCache::Cell*> SheetValueCache::rowCells(uint32_t row) const
+{
+    const auto it = std::lower_bound(m_rows.begin(), m_rows.end(), row);
+    if (it == m_rows.end() || *it != row) {
+        return {nullptr, nullptr};
+    }
+    const size_t index = static_cast<size_t>(it - m_rows.begin());
+    return {m_cells.data() + m_rowStarts[index], m_cells.data() + m_rowStarts[index + 1]};
+}
+
+QVariant SheetValueCache::Cell::toVariant(const StringPool& pool) const
+{
+    switch (type) {
+        case Type::Boolean: return QVariant(boolValue);
+        case Type::Integer: return QVariant(static_cast<qint64>(intValue));
+        case Type::Double: return QVariant(doubleValue);
+        case Type::String: return QVariant(pool.string(stringValue));
+        default: return QVariant();
+    }
+}
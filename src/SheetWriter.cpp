@@ -0,0 +1,79 @@
+#include "SheetWriter.hpp"
+#include "PerformanceProfiler.hpp"
+#include "data/StringPool.hpp"
+
+#include <XLRow.hpp>
+#include <vector>
+
+void SheetWriter::writeRange(OpenXLSX::XLWorksheet& worksheet,
+                             const RangeData& data,
+                             const ProgressCallback& progress)
+{
+    PROFILE_SCOPE("SheetWriter::writeRange");
+
+    const int rows = data.rowCount();
+    const int cols = data.columnCount();
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+
+    const auto& columns = data.columns();
+
+    std::vector<OpenXLSX::XLCellValue> rowValues(cols);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            const RangeColumn& column = columns[col];
+
+            // 类型化的值直接从列数组读取，其余的（空值和例外值）走通用转换
+            if (!column.hasTypedValue(row)) {
+                rowValues[col] = toCellValue(column.value(row));
+                continue;
+            }
+
+            switch (column.type()) {
+                case RangeColumn::Type::Boolean:
+                    rowValues[col] = column.boolValues()[row] != 0;
+                    break;
+                case RangeColumn::Type::Integer:
+                    rowValues[col] = column.int64Values()[row];
+                    break;
+                case RangeColumn::Type::Double:
+                    rowValues[col] = column.doubleValues()[row];
+                    break;
+                case RangeColumn::Type::String:
+                    rowValues[col] = column.stringPool()->view(column.stringHandles()[row]).toUtf8().toStdString();
+                    break;
+                default:
+                    rowValues[col] = OpenXLSX::XLCellValue();
+                    break;
+            }
+        }
+
+        // 整行一次写入，替换该行前cols列的已有单元格
+        worksheet.row(static_cast<uint32_t>(row + 1)).values() = rowValues;
+
+        if (progress && ((row + 1) % ProgressInterval == 0 || row + 1 == rows)) {
+            progress(row + 1, rows);
+        }
+    }
+}
+
+OpenXLSX::XLCellValue SheetWriter::toCellValue(const QVariant& value)
+{
+    if (value.isNull() || !value.isValid()) {
+        return OpenXLSX::XLCellValue();
+    }
+
+    switch (value.typeId()) {
+        case QMetaType::Bool:
+            return value.toBool();
+        case QMetaType::Int:
+        case QMetaType::LongLong:
+            return static_cast<int64_t>(value.toLongLong());
+        case QMetaType::Double:
+            return value.toDouble();
+        default:
+            // 字符串或其他类型
+            return value.toString().toStdString();
+    }
+}
@@ -0,0 +1,996 @@
+#include "StreamingSheetReader.hpp"
+#include "CellReference.hpp"
+#include "PerformanceProfiler.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+struct XmlAttribute
+{
+    std::string_view name;
+    std::string_view value;     ///< 原始值，未解码实体
+};
+
+bool isSpace(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+// 去掉命名空间前缀，如"x:row" -> "row"
+std::string_view localName(std::string_view name)
+{
+    const size_t colon = name.find(':');
+    return colon == std::string_view::npos ? name : name.substr(colon + 1);
+}
+
+std::string_view attribute(const std::vector<XmlAttribute>& attributes, std::string_view name)
+{
+    for (const auto& attr : attributes) {
+        if (localName(attr.name) == name) {
+            return attr.value;
+        }
+    }
+    return {};
+}
+
+void appendUtf8(std::string& out, uint32_t code)
+{
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// 解码XML实体后追加到out，无法识别的实体原样保留
+void appendDecoded(std::string& out, std::string_view raw)
+{
+    size_t pos = 0;
+    while (pos < raw.size()) {
+        const size_t amp = raw.find('&', pos);
+        if (amp == std::string_view::npos) {
+            out.append(raw.substr(pos));
+            return;
+        }
+        out.append(raw.substr(pos, amp - pos));
+
+        const size_t semicolon = raw.find(';', amp);
+        if (semicolon == std::string_view::npos) {
+            out.append(raw.substr(amp));
+            return;
+        }
+
+        const std::string_view entity = raw.substr(amp + 1, semicolon - amp - 1);
+        if (entity == "amp") {
+            out += '&';
+        } else if (entity == "lt") {
+            out += '<';
+        } else if (entity == "gt") {
+            out += '>';
+        } else if (entity == "quot") {
+            out += '"';
+        } else if (entity == "apos") {
+            out += '\'';
+        } else if (entity.size() > 1 && entity[0] == '#') {
+            const bool hex = entity[1] == 'x' || entity[1] == 'X';
+            const std::string_view digits = entity.substr(hex ? 2 : 1);
+            uint32_t code = 0;
+            const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), code, hex ? 16 : 10);
+            if (error == std::errc() && end == digits.data() + digits.size() && code <= 0x10FFFF) {
+                appendUtf8(out, code);
+            } else {
+                out.append(raw.substr(amp, semicolon - amp + 1));
+            }
+        } else {
+            out.append(raw.substr(amp, semicolon - amp + 1));
+        }
+        pos = semicolon + 1;
+    }
+}
+
+std::string decoded(std::string_view raw)
+{
+    std::string result;
+    appendDecoded(result, raw);
+    return result;
+}
+
+/**
+ * 增量式XML解析器
+ *
+ * 数据可以按任意边界分块送入，不完整的标签留在缓冲区等待下一块。
+ * 只支持工作簿各部件用到的XML子集：元素、属性、文本、CDATA、注释和处理指令。
+ */
+class XmlSaxParser
+{
+public:
+    class Handler
+    {
+    public:
+        virtual ~Handler() = default;
+        virtual void startElement(std::string_view name, const std::vector<XmlAttribute>& attributes) = 0;
+        virtual void endElement(std::string_view name) = 0;
+        /// 原始文本，实体未解码
+        virtual void characters(std::string_view) {}
+        /// CDATA内容，不需要解码
+        virtual void cdata(std::string_view) {}
+
+        bool stopRequested = false;     ///< 置为true后解析器不再产生事件
+    };
+
+    explicit XmlSaxParser(Handler& handler) : m_handler(handler) {}
+
+    // 返回false表示处理器要求停止
+    bool feed(const char* data, size_t size)
+    {
+        m_buffer.append(data, size);
+        const std::string_view buffer(m_buffer);
+
+        size_t pos = 0;
+        while (!m_handler.stopRequested) {
+            const size_t lt = buffer.find('<', pos);
+            if (lt == std::string_view::npos) {
+                break;
+            }
+            if (lt > pos) {
+                m_handler.characters(buffer.substr(pos, lt - pos));
+                pos = lt;
+                continue;
+            }
+
+            const std::string_view rest = buffer.substr(pos);
+            size_t end;
+            size_t next;
+            if (rest.starts_with("<!--")) {
+                end = buffer.find("-->", pos + 4);
+                if (end == std::string_view::npos) {
+                    break;
+                }
+                next = end + 3;
+            } else if (rest.starts_with("<![CDATA[")) {
+                end = buffer.find("]]>", pos + 9);
+                if (end == std::string_view::npos) {
+                    break;
+                }
+                m_handler.cdata(buffer.substr(pos + 9, end - pos - 9));
+                next = end + 3;
+            } else if (rest.starts_with("<?")) {
+                end = buffer.find("?>", pos + 2);
+                if (end == std::string_view::npos) {
+                    break;
+                }
+                next = end + 2;
+            } else if (rest.starts_with("<!")) {
+                end = buffer.find('>', pos + 2);
+                if (end == std::string_view::npos) {
+                    break;
+                }
+                next = end + 1;
+            } else {
+                end = findTagEnd(buffer, pos + 1);
+                if (end == std::string_view::npos) {
+                    break;
+                }
+                parseTag(buffer.substr(pos + 1, end - pos - 1));
+                next = end + 1;
+            }
+            pos = next;
+        }
+
+        m_buffer.erase(0, pos);
+        return !m_handler.stopRequested;
+    }
+
+private:
+    // 查找标签结尾的'>'，跳过属性值中的'>'
+    static size_t findTagEnd(std::string_view buffer, size_t pos)
+    {
+        char quote = 0;
+        for (; pos < buffer.size(); ++pos) {
+            const char ch = buffer[pos];
+            if (quote) {
+                if (ch == quote) {
+                    quote = 0;
+                }
+            } else if (ch == '"' || ch == '\'') {
+                quote = ch;
+            } else if (ch == '>') {
+                return pos;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    void parseTag(std::string_view tag)
+    {
+        if (tag.empty()) {
+            return;
+        }
+
+        if (tag[0] == '/') {
+            size_t end = 1;
+            while (end < tag.size() && !isSpace(tag[end])) {
+                ++end;
+            }
+            m_handler.endElement(localName(tag.substr(1, end - 1)));
+            return;
+        }
+
+        size_t end = tag.size();
+        while (end > 0 && isSpace(tag[end - 1])) {
+            --end;
+        }
+        const bool selfClosing = end > 0 && tag[end - 1] == '/';
+        tag = tag.substr(0, selfClosing ? end - 1 : end);
+
+        size_t nameEnd = 0;
+        while (nameEnd < tag.size() && !isSpace(tag[nameEnd])) {
+            ++nameEnd;
+        }
+        const std::string_view name = localName(tag.substr(0, nameEnd));
+
+        m_attributes.clear();
+        size_t pos = nameEnd;
+        while (true) {
+            while (pos < tag.size() && isSpace(tag[pos])) {
+                ++pos;
+            }
+            const size_t equals = tag.find('=', pos);
+            if (pos >= tag.size() || equals == std::string_view::npos) {
+                break;
+            }
+
+            size_t attrNameEnd = equals;
+            while (attrNameEnd > pos && isSpace(tag[attrNameEnd - 1])) {
+                --attrNameEnd;
+            }
+            const std::string_view attrName = tag.substr(pos, attrNameEnd - pos);
+
+            pos = equals + 1;
+            while (pos < tag.size() && isSpace(tag[pos])) {
+                ++pos;
+            }
+            if (pos >= tag.size() || (tag[pos] != '"' && tag[pos] != '\'')) {
+                break;
+            }
+            const size_t close = tag.find(tag[pos], pos + 1);
+            if (close == std::string_view::npos) {
+                break;
+            }
+            m_attributes.push_back({attrName, tag.substr(pos + 1, close - pos - 1)});
+            pos = close + 1;
+        }
+
+        m_handler.startElement(name, m_attributes);
+        if (selfClosing && !m_handler.stopRequested) {
+            m_handler.endElement(name);
+        }
+    }
+
+private:
+    Handler& m_handler;
+    std::string m_buffer;                       ///< 尚未处理完的数据
+    std::vector<XmlAttribute> m_attributes;     ///< 复用的属性数组
+};
+
+// 将压缩包中的条目流式送入处理器
+void parseEntry(const XlsxArchive& archive, const std::string& name, XmlSaxParser::Handler& handler)
+{
+    XmlSaxParser parser(handler);
+    archive.streamEntry(name, [&parser](const char* data, size_t size) {
+        return parser.feed(data, size);
+    });
+}
+
+// 关系文件中的目标路径相对于源部件所在目录
+std::string resolvePartPath(const std::string& baseDir, std::string_view target)
+{
+    std::string path = target.starts_with('/') ? std::string(target.substr(1)) : baseDir + std::string(target);
+
+    // 规范化"./"和"../"
+    std::vector<std::string_view> segments;
+    std::string_view remaining(path);
+    while (!remaining.empty()) {
+        const size_t slash = remaining.find('/');
+        const std::string_view segment = remaining.substr(0, slash);
+        if (segment == "..") {
+            if (!segments.empty()) {
+                segments.pop_back();
+            }
+        } else if (!segment.empty() && segment != ".") {
+            segments.push_back(segment);
+        }
+        remaining = slash == std::string_view::npos ? std::string_view() : remaining.substr(slash + 1);
+    }
+
+    std::string result;
+    for (const auto& segment : segments) {
+        if (!result.empty()) {
+            result += '/';
+        }
+        result.append(segment);
+    }
+    return result;
+}
+
+std::string relationshipsPath(const std::string& partPath)
+{
+    const size_t slash = partPath.rfind('/');
+    const std::string dir = slash == std::string::npos ? std::string() : partPath.substr(0, slash + 1);
+    const std::string file = slash == std::string::npos ? partPath : partPath.substr(slash + 1);
+    return dir + "_rels/" + file + ".rels";
+}
+
+std::string directoryOf(const std::string& partPath)
+{
+    const size_t slash = partPath.rfind('/');
+    return slash == std::string::npos ? std::string() : partPath.substr(0, slash + 1);
+}
+
+struct Relationship
+{
+    std::string type;
+    std::string target;
+};
+
+class RelationshipsHandler : public XmlSaxParser::Handler
+{
+public:
+    void startElement(std::string_view name, const std::vector<XmlAttribute>& attributes) override
+    {
+        if (name == "Relationship") {
+            relationships[decoded(attribute(attributes, "Id"))] =
+                {decoded(attribute(attributes, "Type")), decoded(attribute(attributes, "Target"))};
+        }
+    }
+
+    void endElement(std::string_view) override {}
+
+    // 按类型后缀查找，如"/officeDocument"
+    const Relationship* findByType(std::string_view suffix) const
+    {
+        for (const auto& [id, relationship] : relationships) {
+            if (std::string_view(relationship.type).ends_with(suffix)) {
+                return &relationship;
+            }
+        }
+        return nullptr;
+    }
+
+    std::unordered_map<std::string, Relationship> relationships;
+};
+
+class WorkbookHandler : public XmlSaxParser::Handler
+{
+public:
+    void startElement(std::string_view name, const std::vector<XmlAttribute>& attributes) override
+    {
+        if (name == "sheet") {
+            sheets.emplace_back(decoded(attribute(attributes, "name")), decoded(attribute(attributes, "id")));
+        }
+    }
+
+    void endElement(std::string_view name) override
+    {
+        if (name == "sheets") {
+            stopRequested = true;
+        }
+    }
+
+    std::vector<std::pair<std::string, std::string>> sheets;    ///< 名称 -> 关系ID
+};
+
+class SharedStringsHandler : public XmlSaxParser::Handler
+{
+public:
+    explicit SharedStringsHandler(StringPool& pool) : m_pool(pool) {}
+
+    void startElement(std::string_view name, const std::vector<XmlAttribute>&) override
+    {
+        if (name == "si") {
+            m_text.clear();
+        } else if (name == "rPh") {
+            m_inPhonetic = true;
+        } else if (name == "t" && !m_inPhonetic) {
+            m_capture = true;
+        }
+    }
+
+    void endElement(std::string_view name) override
+    {
+        if (name == "t") {
+            m_capture = false;
+        } else if (name == "rPh") {
+            m_inPhonetic = false;
+        } else if (name == "si") {
+            handles.push_back(m_pool.intern(std::string_view(m_text)));
+        }
+    }
+
+    void characters(std::string_view raw) override
+    {
+        if (m_capture) {
+            appendDecoded(m_text, raw);
+        }
+    }
+
+    void cdata(std::string_view text) override
+    {
+        if (m_capture) {
+            m_text.append(text);
+        }
+    }
+
+    std::vector<StringPool::Handle> handles;
+
+private:
+    StringPool& m_pool;
+    std::string m_text;
+    bool m_capture = false;
+    bool m_inPhonetic = false;     ///< 注音文本不属于单元格内容
+};
+
+// 与OpenXLSX的XLCellValueProxy保持相同的类型规则
+QVariant decodeCellValue(std::string_view cellType, std::string_view text,
+                         StringPool& pool, const std::vector<StringPool::Handle>& sharedStrings)
+{
+    if (cellType == "s") {
+        size_t index = 0;
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), index);
+        if (error != std::errc() || index >= sharedStrings.size()) {
+            return QVariant();
+        }
+        return pool.string(sharedStrings[index]);
+    }
+    if (cellType == "str" || cellType == "inlineStr" || cellType == "e" || cellType == "d") {
+        return pool.pooled(text);
+    }
+    if (cellType == "b") {
+        return text == "1" || text == "true";
+    }
+
+    if (text.empty()) {
+        return QVariant();
+    }
+
+    // 含小数点或指数的按浮点数处理，其余按整数处理，整数溢出时退回浮点数
+    if (text.find_first_of(".eE") == std::string_view::npos) {
+        int64_t integer = 0;
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), integer);
+        if (error == std::errc() && end == text.data() + text.size()) {
+            return static_cast<qint64>(integer);
+        }
+    }
+    double number = 0.0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+    if (error != std::errc()) {
+        return pool.pooled(text);
+    }
+    return number;
+}
+
+/**
+ * 工作表行解码
+ *
+ * 只保留当前行范围内的值，行结束时交给回调。读到范围之后的行或
+ * </sheetData>时停止解析，剩余的压缩数据不再解压。
+ */
+class SheetRowHandler : public XmlSaxParser::Handler
+{
+public:
+    SheetRowHandler(uint32_t firstRow, uint32_t lastRow, uint16_t firstCol, uint16_t lastCol,
+                    StringPool& pool, const std::vector<StringPool::Handle>& sharedStrings,
+                    const StreamingSheetReader::RowCallback& callback)
+        : m_firstRow(firstRow), m_lastRow(lastRow), m_firstCol(firstCol), m_lastCol(lastCol),
+          m_pool(pool), m_sharedStrings(sharedStrings), m_callback(callback),
+          m_values(lastCol - firstCol + 1), m_emptyRow(lastCol - firstCol + 1), m_nextRow(firstRow)
+    {
+    }
+
+    void startElement(std::string_view name, const std::vector<XmlAttribute>& attributes) override
+    {
+        if (name == "row") {
+            beginRow(attributes);
+        } else if (name == "c") {
+            if (!m_inRow) {
+                return;
+            }
+            const std::string_view reference = attribute(attributes, "r");
+            m_cellCol = reference.empty() ? m_nextCol : CellReference::leadingColumn(reference);
+            m_cellType.assign(attribute(attributes, "t"));
+            m_cellWanted = m_rowWanted && m_cellCol >= m_firstCol && m_cellCol <= m_lastCol;
+            m_text.clear();
+            m_hasText = false;
+        } else if (!m_cellWanted) {
+            return;
+        } else if (name == "v") {
+            m_capture = true;
+            m_hasText = true;
+        } else if (name == "is") {
+            m_inInlineString = true;
+        } else if (name == "rPh") {
+            m_inPhonetic = true;
+        } else if (name == "t" && m_inInlineString && !m_inPhonetic) {
+            m_capture = true;
+            m_hasText = true;
+        }
+    }
+
+    void endElement(std::string_view name) override
+    {
+        if (name == "v" || name == "t") {
+            m_capture = false;
+        } else if (name == "rPh") {
+            m_inPhonetic = false;
+        } else if (name == "is") {
+            m_inInlineString = false;
+        } else if (name == "c") {
+            if (m_cellWanted && m_hasText) {
+                m_values[m_cellCol - m_firstCol] = decodeCellValue(m_cellType, m_text, m_pool, m_sharedStrings);
+            }
+            m_cellWanted = false;
+            m_nextCol = m_cellCol + 1;
+        } else if (name == "row") {
+            endRow();
+        } else if (name == "sheetData") {
+            stopRequested = true;
+        }
+    }
+
+    void characters(std::string_view raw) override
+    {
+        if (m_capture) {
+            appendDecoded(m_text, raw);
+        }
+    }
+
+    void cdata(std::string_view text) override
+    {
+        if (m_capture) {
+            m_text.append(text);
+        }
+    }
+
+    // 解析结束后补齐范围末尾不存在的行
+    void finish()
+    {
+        if (m_aborted) {
+            return;
+        }
+        while (m_nextRow <= m_lastRow && !m_aborted) {
+            deliver(m_nextRow++, m_emptyRow);
+        }
+    }
+
+    uint32_t deliveredRows() const { return m_delivered; }
+
+private:
+    void beginRow(const std::vector<XmlAttribute>& attributes)
+    {
+        uint32_t row = m_previousRow + 1;
+        const std::string_view reference = attribute(attributes, "r");
+        if (!reference.empty()) {
+            std::from_chars(reference.data(), reference.data() + reference.size(), row);
+        }
+
+        if (row > m_lastRow) {
+            stopRequested = true;
+            return;
+        }
+
+        m_inRow = true;
+        m_rowNumber = row;
+        m_rowWanted = row >= m_firstRow;
+        m_nextCol = 1;
+        if (!m_rowWanted) {
+            return;
+        }
+
+        // 范围内缺失的行以空行补齐
+        while (m_nextRow < row && !m_aborted) {
+            deliver(m_nextRow++, m_emptyRow);
+        }
+        std::fill(m_values.begin(), m_values.end(), QVariant());
+    }
+
+    void endRow()
+    {
+        if (!m_inRow) {
+            return;
+        }
+        m_inRow = false;
+        m_previousRow = m_rowNumber;
+        if (m_rowWanted && m_rowNumber >= m_nextRow) {
+            deliver(m_rowNumber, m_values);
+            m_nextRow = m_rowNumber + 1;
+        }
+    }
+
+    void deliver(uint32_t row, const std::vector<QVariant>& values)
+    {
+        ++m_delivered;
+        if (!m_callback(row, values)) {
+            m_aborted = true;
+            stopRequested = true;
+        }
+    }
+
+private:
+    const uint32_t m_firstRow;
+    const uint32_t m_lastRow;
+    const uint16_t m_firstCol;
+    const uint16_t m_lastCol;
+    StringPool& m_pool;
+    const std::vector<StringPool::Handle>& m_sharedStrings;
+    const StreamingSheetReader::RowCallback& m_callback;
+
+    std::vector<QVariant> m_values;         ///< 当前行范围内的值
+    const std::vector<QVariant> m_emptyRow;
+    uint32_t m_nextRow;                     ///< 下一个应交付的行号
+    uint32_t m_previousRow = 0;             ///< 上一个<row>的行号，用于推断缺省的r属性
+    uint32_t m_rowNumber = 0;
+    uint32_t m_delivered = 0;
+    bool m_inRow = false;
+    bool m_rowWanted = false;
+    bool m_aborted = false;
+
+    uint16_t m_nextCol = 1;                 ///< 缺省r属性时的列号
+    uint16_t m_cellCol = 0;
+    std::string m_cellType;
+    std::string m_text;
+    bool m_cellWanted = false;
+    bool m_hasText = false;
+    bool m_capture = false;
+    bool m_inInlineString = false;
+    bool m_inPhonetic = false;
+};
+
+/**
+ * 工作表单元格及公式
+ *
+ * 按文档顺序交付每个有值或有公式的单元格。<f>的文本和共享公式的si/ref属性原样交出，
+ * 由调用方解析；共享公式中只有主单元格带有公式文本。
+ */
+class SheetCellsHandler : public XmlSaxParser::Handler
+{
+public:
+    SheetCellsHandler(StringPool& pool, const std::vector<StringPool::Handle>& sharedStrings,
+                      const StreamingSheetReader::CellCallback& callback)
+        : m_pool(pool), m_sharedStrings(sharedStrings), m_callback(callback)
+    {
+    }
+
+    void startElement(std::string_view name, const std::vector<XmlAttribute>& attributes) override
+    {
+        if (name == "row") {
+            uint32_t row = m_row + 1;
+            const std::string_view reference = attribute(attributes, "r");
+            if (!reference.empty()) {
+                std::from_chars(reference.data(), reference.data() + reference.size(), row);
+            }
+            m_row = row;
+            m_nextCol = 1;
+        } else if (name == "c") {
+            const std::string_view reference = attribute(attributes, "r");
+            m_cell = StreamingSheetReader::CellContent();
+            m_cell.position = {m_row, reference.empty() ? m_nextCol : CellReference::leadingColumn(reference)};
+            m_cellType.assign(attribute(attributes, "t"));
+            m_text.clear();
+            m_hasText = false;
+            m_hasFormula = false;
+        } else if (name == "v") {
+            m_capture = Capture::Value;
+            m_hasText = true;
+        } else if (name == "f") {
+            m_capture = Capture::Formula;
+            m_hasFormula = true;
+            const std::string_view shared = attribute(attributes, "si");
+            if (attribute(attributes, "t") == "shared" && !shared.empty()) {
+                std::from_chars(shared.data(), shared.data() + shared.size(), m_cell.sharedIndex);
+            }
+        } else if (name == "is") {
+            m_inInlineString = true;
+        } else if (name == "rPh") {
+            m_inPhonetic = true;
+        } else if (name == "t" && m_inInlineString && !m_inPhonetic) {
+            m_capture = Capture::Value;
+            m_hasText = true;
+        }
+    }
+
+    void endElement(std::string_view name) override
+    {
+        if (name == "v" || name == "t" || name == "f") {
+            m_capture = Capture::None;
+        } else if (name == "rPh") {
+            m_inPhonetic = false;
+        } else if (name == "is") {
+            m_inInlineString = false;
+        } else if (name == "c") {
+            if (m_hasText) {
+                m_cell.value = decodeCellValue(m_cellType, m_text, m_pool, m_sharedStrings);
+            }
+            if ((m_hasText || m_hasFormula) && m_cell.position.column > 0) {
+                m_callback(m_cell);
+            }
+            m_nextCol = m_cell.position.column + 1;
+        } else if (name == "sheetData") {
+            stopRequested = true;
+        }
+    }
+
+    void characters(std::string_view raw) override
+    {
+        if (m_capture == Capture::Value) {
+            appendDecoded(m_text, raw);
+        } else if (m_capture == Capture::Formula) {
+            appendDecoded(m_cell.formula, raw);
+        }
+    }
+
+    void cdata(std::string_view text) override
+    {
+        if (m_capture == Capture::Value) {
+            m_text.append(text);
+        } else if (m_capture == Capture::Formula) {
+            m_cell.formula.append(text);
+        }
+    }
+
+private:
+    enum class Capture
+    {
+        None,
+        Value,
+        Formula
+    };
+
+    StringPool& m_pool;
+    const std::vector<StringPool::Handle>& m_sharedStrings;
+    const StreamingSheetReader::CellCallback& m_callback;
+
+    StreamingSheetReader::CellContent m_cell;
+    uint32_t m_row = 0;
+    uint16_t m_nextCol = 1;
+    std::string m_cellType;
+    std::string m_text;
+    Capture m_capture = Capture::None;
+    bool m_hasText = false;
+    bool m_hasFormula = false;
+    bool m_inInlineString = false;
+    bool m_inPhonetic = false;
+};
+
+/**
+ * 工作表已使用区域
+ *
+ * 优先使用<sheetData>之前的<dimension>元素，读到后立即停止解压；
+ * 没有该元素或只有"A1"（部分程序写出的占位值）时，扫描所有有值的单元格，
+ * 不解码单元格内容。
+ */
+class UsedRangeHandler : public XmlSaxParser::Handler
+{
+public:
+    void startElement(std::string_view name, const std::vector<XmlAttribute>& attributes) override
+    {
+        if (name == "dimension") {
+            const auto range = CellReference::parseRange(attribute(attributes, "ref"));
+            if (range && *range != CellRange{{1, 1}, {1, 1}}) {
+                m_dimension = *range;
+            }
+        } else if (name == "sheetData") {
+            if (m_dimension) {
+                stopRequested = true;
+            }
+        } else if (name == "row") {
+            uint32_t row = m_row + 1;
+            const std::string_view reference = attribute(attributes, "r");
+            if (!reference.empty()) {
+                std::from_chars(reference.data(), reference.data() + reference.size(), row);
+            }
+            m_row = row;
+            m_nextCol = 1;
+        } else if (name == "c") {
+            const std::string_view reference = attribute(attributes, "r");
+            m_cellCol = reference.empty() ? m_nextCol : CellReference::leadingColumn(reference);
+            m_cellHasValue = false;
+        } else if (name == "v" || name == "is") {
+            m_cellHasValue = true;
+        }
+    }
+
+    void endElement(std::string_view name) override
+    {
+        if (name == "c") {
+            if (m_cellHasValue && m_cellCol > 0) {
+                include({m_row, m_cellCol});
+            }
+            m_nextCol = m_cellCol + 1;
+        } else if (name == "sheetData") {
+            stopRequested = true;
+        }
+    }
+
+    std::optional<CellRange> result() const
+    {
+        return m_dimension ? m_dimension : m_used;
+    }
+
+private:
+    void include(CellPosition cell)
+    {
+        if (!m_used) {
+            m_used = CellRange{cell, cell};
+            return;
+        }
+        m_used->topLeft.row = std::min(m_used->topLeft.row, cell.row);
+        m_used->topLeft.column = std::min(m_used->topLeft.column, cell.column);
+        m_used->bottomRight.row = std::max(m_used->bottomRight.row, cell.row);
+        m_used->bottomRight.column = std::max(m_used->bottomRight.column, cell.column);
+    }
+
+    std::optional<CellRange> m_dimension;
+    std::optional<CellRange> m_used;
+    uint32_t m_row = 0;
+    uint16_t m_nextCol = 1;
+    uint16_t m_cellCol = 0;
+    bool m_cellHasValue = false;
+};
+
+} // namespace
+
+StreamingSheetReader::StreamingSheetReader(const QString& filePath)
+    : m_pool(std::make_shared<StringPool>())
+{
+    m_archive.open(filePath);
+    loadWorkbook();
+    loadSharedStrings();
+}
+
+StreamingSheetReader::StreamingSheetReader(const QString& filePath, std::shared_ptr<StringPool> pool,
+                                           std::vector<StringPool::Handle> sharedStrings)
+    : m_pool(std::move(pool)), m_sharedStrings(std::move(sharedStrings))
+{
+    m_archive.open(filePath);
+    loadWorkbook();
+}
+
+std::vector<std::string> StreamingSheetReader::sheetNames() const
+{
+    std::vector<std::string> names;
+    names.reserve(m_sheets.size());
+    for (const auto& [name, path] : m_sheets) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+bool StreamingSheetReader::hasSheet(const std::string& sheetName) const
+{
+    return std::any_of(m_sheets.begin(), m_sheets.end(), [&sheetName](const auto& sheet) {
+        return sheet.first == sheetName;
+    });
+}
+
+uint32_t StreamingSheetReader::readRows(const std::string& sheetName,
+                                        const OpenXLSX::XLCellReference& topLeft,
+                                        const OpenXLSX::XLCellReference& bottomRight,
+                                        const RowCallback& callback) const
+{
+    PROFILE_SCOPE("StreamingSheetReader::readRows");
+
+    SheetRowHandler handler(topLeft.row(), bottomRight.row(), topLeft.column(), bottomRight.column(),
+                            *m_pool, m_sharedStrings, callback);
+    parseEntry(m_archive, sheetPath(sheetName), handler);
+    handler.finish();
+    return handler.deliveredRows();
+}
+
+std::optional<CellRange> StreamingSheetReader::usedRange(const std::string& sheetName) const
+{
+    PROFILE_SCOPE("StreamingSheetReader::usedRange");
+
+    UsedRangeHandler handler;
+    parseEntry(m_archive, sheetPath(sheetName), handler);
+    return handler.result();
+}
+
+void StreamingSheetReader::readCells(const std::string& sheetName, const CellCallback& callback) const
+{
+    PROFILE_SCOPE("StreamingSheetReader::readCells");
+
+    SheetCellsHandler handler(*m_pool, m_sharedStrings, callback);
+    parseEntry(m_archive, sheetPath(sheetName), handler);
+}
+
+std::shared_ptr<RangeData> StreamingSheetReader::readRange(const std::string& sheetName, const QString& rangeAddress) const
+{
+    const auto cells = CellReference::parseRange(rangeAddress);
+    if (!cells) {
+        throw std::runtime_error("范围地址格式不正确: " + rangeAddress.toStdString());
+    }
+    const OpenXLSX::XLCellReference topLeft(cells->topLeft.row, cells->topLeft.column);
+    const OpenXLSX::XLCellReference bottomRight(cells->bottomRight.row, cells->bottomRight.column);
+
+    auto range = std::make_shared<RangeData>();
+    range->setRangeAddress(rangeAddress);
+    // 列与读取器共用驻留池，追加字符串时直接命中已有条目，不再复制
+    readRows(sheetName, topLeft, bottomRight, [this, &range](uint32_t, const std::vector<QVariant>& values) {
+        range->addRow(values, m_pool);
+        return true;
+    });
+    return range;
+}
+
+void StreamingSheetReader::loadWorkbook()
+{
+    // 根关系指向工作簿部件，通常为xl/workbook.xml
+    std::string workbookPath = "xl/workbook.xml";
+    if (m_archive.hasEntry("_rels/.rels")) {
+        RelationshipsHandler rootRelationships;
+        parseEntry(m_archive, "_rels/.rels", rootRelationships);
+        if (const auto* office = rootRelationships.findByType("/officeDocument")) {
+            workbookPath = resolvePartPath(std::string(), office->target);
+        }
+    }
+
+    WorkbookHandler workbook;
+    parseEntry(m_archive, workbookPath, workbook);
+
+    RelationshipsHandler relationships;
+    const std::string relsPath = relationshipsPath(workbookPath);
+    if (m_archive.hasEntry(relsPath)) {
+        parseEntry(m_archive, relsPath, relationships);
+    }
+
+    const std::string baseDir = directoryOf(workbookPath);
+    for (const auto& [name, id] : workbook.sheets) {
+        auto it = relationships.relationships.find(id);
+        if (it == relationships.relationships.end() || !std::string_view(it->second.type).ends_with("/worksheet")) {
+            continue;   // 图表工作表等非普通工作表
+        }
+        m_sheets.emplace_back(name, resolvePartPath(baseDir, it->second.target));
+    }
+
+    if (const auto* sharedStrings = relationships.findByType("/sharedStrings")) {
+        m_sharedStringsPath = resolvePartPath(baseDir, sharedStrings->target);
+    }
+}
+
+void StreamingSheetReader::loadSharedStrings()
+{
+    if (m_sharedStringsPath.empty() || !m_archive.hasEntry(m_sharedStringsPath)) {
+        return;
+    }
+
+    PROFILE_SCOPE("StreamingSheetReader::loadSharedStrings");
+    SharedStringsHandler handler(*m_pool);
+    parseEntry(m_archive, m_sharedStringsPath, handler);
+    m_sharedStrings = std::move(handler.handles);
+}
+
+const std::string& StreamingSheetReader::sheetPath(const std::string& sheetName) const
+{
+    for (const auto& [name, path] : m_sheets) {
+        if (name == sheetName) {
+            return path;
+        }
+    }
+    throw std::runtime_error("工作表不存在: " + sheetName);
+}
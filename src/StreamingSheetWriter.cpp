@@ -0,0 +1,850 @@
+#include "StreamingSheetWriter.hpp"
+#include "CellReference.hpp"
+#include "PerformanceProfiler.hpp"
+#include "data/StringPool.hpp"
+
+#include <QFile>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <zippy.hpp>
+
+namespace {
+
+constexpr std::string_view XmlHeader = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)";
+
+constexpr std::string_view ContentTypesXml =
+    R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+    R"(<Types xmlns="http://schemas.openxmlformats.org/package/2006/content-types">)"
+    R"(<Default Extension="rels" ContentType="application/vnd.openxmlformats-package.relationships+xml"/>)"
+    R"(<Default Extension="xml" ContentType="application/xml"/>)"
+    R"(<Override PartName="/xl/workbook.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml"/>)"
+    R"(<Override PartName="/xl/styles.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml"/>)";
+
+constexpr std::string_view WorksheetContentType =
+    R"(" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml"/>)";
+
+constexpr std::string_view SharedStringsContentType =
+    R"(<Override PartName="/xl/sharedStrings.xml" ContentType="application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml"/>)";
+
+constexpr std::string_view RootRelationshipsXml =
+    R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+    R"(<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">)"
+    R"(<Relationship Id="rId1" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument" Target="xl/workbook.xml"/>)"
+    R"(</Relationships>)";
+
+constexpr std::string_view WorkbookRelationshipsOpen =
+    R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+    R"(<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">)";
+
+constexpr std::string_view WorksheetRelationshipType =
+    R"(" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet" Target="worksheets/sheet)";
+
+constexpr std::string_view StylesRelationshipType =
+    R"(" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles" Target="styles.xml"/>)";
+
+constexpr std::string_view SharedStringsRelationshipType =
+    R"(" Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/sharedStrings" Target="sharedStrings.xml"/>)";
+
+constexpr std::string_view StylesXml =
+    R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)"
+    R"(<styleSheet xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main">)"
+    R"(<fonts count="1"><font><sz val="11"/><name val="Calibri"/></font></fonts>)"
+    R"(<fills count="2"><fill><patternFill patternType="none"/></fill><fill><patternFill patternType="gray125"/></fill></fills>)"
+    R"(<borders count="1"><border><left/><right/><top/><bottom/><diagonal/></border></borders>)"
+    R"(<cellStyleXfs count="1"><xf numFmtId="0" fontId="0" fillId="0" borderId="0"/></cellStyleXfs>)"
+    R"(<cellXfs count="1"><xf numFmtId="0" fontId="0" fillId="0" borderId="0" xfId="0"/></cellXfs>)"
+    R"(<cellStyles count="1"><cellStyle name="Normal" xfId="0" builtinId="0"/></cellStyles>)"
+    R"(</styleSheet>)";
+
+constexpr std::string_view WorksheetOpen =
+    R"(<worksheet xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main" )"
+    R"(xmlns:r="http://schemas.openxmlformats.org/officeDocument/2006/relationships">)";
+
+constexpr std::string_view SharedStringsOpen =
+    R"(<sst xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main">)";
+
+char16_t codeUnit(char ch) { return static_cast<unsigned char>(ch); }
+char16_t codeUnit(QChar ch) { return ch.unicode(); }
+
+// _xHHHH_是OOXML的字符转义，原文中出现时把开头的下划线转义为_x005F_，读取时才能还原
+template<typename Text>
+bool isEscapeSequence(Text text, size_t pos)
+{
+    if (pos + 7 > static_cast<size_t>(text.size()) || codeUnit(text[pos + 1]) != u'x' || codeUnit(text[pos + 6]) != u'_') {
+        return false;
+    }
+    for (size_t i = pos + 2; i < pos + 6; ++i) {
+        const char16_t ch = codeUnit(text[i]);
+        if (ch >= 0x80 || !std::isxdigit(static_cast<unsigned char>(ch))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Excel的工作表名称规则：1到31个字符，不能包含[]:*?/\，不能以单引号开头或结尾
+void checkSheetName(const std::string& sheetName)
+{
+    const QString name = QString::fromStdString(sheetName);
+    if (name.isEmpty() || name.size() > 31) {
+        throw std::runtime_error("工作表名称长度必须为1到31个字符: " + sheetName);
+    }
+    for (const QChar ch : name) {
+        if (QStringView(u"[]:*?/\\").contains(ch)) {
+            throw std::runtime_error("工作表名称不能包含[]:*?/\\字符: " + sheetName);
+        }
+    }
+    if (name.startsWith('\'') || name.endsWith('\'')) {
+        throw std::runtime_error("工作表名称不能以单引号开头或结尾: " + sheetName);
+    }
+}
+
+// 转义一个单字节字符，XML 1.0不允许的控制字符按Excel的_xHHHH_形式写出
+template<typename Text>
+void appendEscapedByte(std::string& out, Text text, size_t pos)
+{
+    const char ch = static_cast<char>(codeUnit(text[pos]));
+    switch (ch) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        case '_':
+            out += isEscapeSequence(text, pos) ? "_x005F_" : "_";
+            break;
+        case '\t':
+        case '\n':
+        case '\r':
+            out += ch;
+            break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "_x%04X_", static_cast<unsigned>(ch));
+                out += escaped;
+            } else {
+                out += ch;
+            }
+            break;
+    }
+}
+
+// 转义XML文本和属性值
+void appendEscaped(std::string& out, std::string_view text)
+{
+    for (size_t pos = 0; pos < text.size(); ++pos) {
+        appendEscapedByte(out, text, pos);
+    }
+}
+
+// 转义UTF-16文本并直接编码为UTF-8，不经过临时的QByteArray；不成对的代理项写为U+FFFD
+void appendEscaped(std::string& out, QStringView text)
+{
+    const auto size = static_cast<size_t>(text.size());
+    for (size_t pos = 0; pos < size; ++pos) {
+        char32_t ch = text[pos].unicode();
+        if (ch < 0x80) {
+            appendEscapedByte(out, text, pos);
+            continue;
+        }
+        if (QChar::isSurrogate(ch)) {
+            if (QChar::isHighSurrogate(ch) && pos + 1 < size && text[pos + 1].isLowSurrogate()) {
+                ch = QChar::surrogateToUcs4(text[pos], text[pos + 1]);
+                ++pos;
+            } else {
+                ch = 0xFFFD;
+            }
+        }
+        if (ch < 0x800) {
+            out += static_cast<char>(0xC0 | (ch >> 6));
+        } else if (ch < 0x10000) {
+            out += static_cast<char>(0xE0 | (ch >> 12));
+            out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (ch >> 18));
+            out += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        }
+        out += static_cast<char>(0x80 | (ch & 0x3F));
+    }
+}
+
+template<typename T>
+void appendNumber(std::string& out, T value)
+{
+    char buffer[32];
+    const auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, error == std::errc() ? end : buffer);
+}
+
+/**
+ * 带缓冲的临时文件，攒够一个块再写盘
+ *
+ * 使用std::tmpfile()，关闭后由系统删除；压缩时直接作为FILE*交给miniz。
+ */
+class TempXmlFile
+{
+public:
+    static constexpr size_t BufferSize = 256 * 1024;
+
+    TempXmlFile() : m_file(std::tmpfile())
+    {
+        if (!m_file) {
+            throw std::runtime_error("无法创建临时文件");
+        }
+        m_buffer.reserve(BufferSize + 1024);
+    }
+
+    ~TempXmlFile()
+    {
+        std::fclose(m_file);
+    }
+
+    TempXmlFile(const TempXmlFile&) = delete;
+    TempXmlFile& operator=(const TempXmlFile&) = delete;
+
+    // 直接追加到缓冲区，调用方在合适的位置调用flushIfFull()
+    std::string& buffer() { return m_buffer; }
+
+    void flushIfFull()
+    {
+        if (m_buffer.size() >= BufferSize) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (m_buffer.empty()) {
+            return;
+        }
+        if (std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) {
+            throw std::runtime_error("写入临时文件失败，磁盘空间可能不足");
+        }
+        m_size += m_buffer.size();
+        m_buffer.clear();
+    }
+
+    // 写完后回到文件开头，供压缩读取
+    FILE* rewind()
+    {
+        flush();
+        std::fflush(m_file);
+        std::rewind(m_file);
+        return m_file;
+    }
+
+    uint64_t size() const { return m_size; }
+
+    // 覆盖已写入的内容，用于回填预留的位置
+    void overwrite(uint64_t offset, std::string_view text)
+    {
+        flush();
+        if (!seek(static_cast<int64_t>(offset), SEEK_SET)
+            || std::fwrite(text.data(), 1, text.size(), m_file) != text.size()
+            || !seek(0, SEEK_END)) {
+            throw std::runtime_error("写入临时文件失败，磁盘空间可能不足");
+        }
+    }
+
+private:
+    // long在Windows上只有32位，超过2GB的临时文件需要64位偏移
+    bool seek(int64_t offset, int origin)
+    {
+#ifdef _WIN32
+        return _fseeki64(m_file, offset, origin) == 0;
+#else
+        return fseeko(m_file, static_cast<off_t>(offset), origin) == 0;
+#endif
+    }
+
+    FILE* m_file;
+    std::string m_buffer;
+    uint64_t m_size = 0;
+};
+
+/**
+ * 共享字符串表，按首次出现的顺序分配索引，相同文本只写一次，条目同步写入临时文件
+ */
+class SharedStringTable
+{
+public:
+    SharedStringTable()
+    {
+        m_file.buffer().append(XmlHeader);
+        m_file.buffer().append(SharedStringsOpen);
+    }
+
+    uint32_t indexOf(const std::shared_ptr<StringPool>& pool, StringPool::Handle handle)
+    {
+        return added(m_indexer.indexOf(pool, handle));
+    }
+
+    uint32_t indexOf(const QString& text)
+    {
+        return added(m_indexer.indexOf(text));
+    }
+
+    TempXmlFile& finish()
+    {
+        m_file.buffer().append("</sst>");
+        return m_file;
+    }
+
+private:
+    // 第一次出现的文本追加到表中
+    uint32_t added(std::pair<uint32_t, bool> result)
+    {
+        if (result.second) {
+            std::string& out = m_file.buffer();
+            out += R"(<si><t xml:space="preserve">)";
+            appendEscaped(out, QStringView(m_indexer.strings()[result.first]));
+            out += "</t></si>";
+            m_file.flushIfFull();
+        }
+        return result.first;
+    }
+
+    TempXmlFile m_file;
+    StringIndexer m_indexer;    ///< 文本 -> 共享字符串索引
+};
+
+/**
+ * 基于miniz的xlsx输出，通过QFile写入以支持非ASCII路径
+ */
+class ZipOutput
+{
+public:
+    ZipOutput(const QString& filePath, int compressionLevel)
+        : m_file(filePath), m_level(static_cast<ns_miniz::mz_uint>(qBound(0, compressionLevel, 9)))
+    {
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            throw std::runtime_error("无法写入文件: " + m_file.errorString().toStdString());
+        }
+        m_zip.m_pWrite = &ZipOutput::write;
+        m_zip.m_pIO_opaque = this;
+        if (!ns_miniz::mz_zip_writer_init_v2(&m_zip, 0, 0)) {
+            throw std::runtime_error("无法初始化压缩包");
+        }
+        m_initialized = true;
+    }
+
+    ~ZipOutput()
+    {
+        if (m_initialized) {
+            ns_miniz::mz_zip_writer_end(&m_zip);
+        }
+    }
+
+    // compressionLevel小于0时使用整个压缩包的压缩级别
+    void addEntry(const char* name, std::string_view content, int compressionLevel = -1)
+    {
+        if (!ns_miniz::mz_zip_writer_add_mem(&m_zip, name, content.data(), content.size(), level(compressionLevel))) {
+            throw std::runtime_error(std::string("无法写入压缩包条目: ") + name);
+        }
+    }
+
+    // 从临时文件流式压缩，miniz按固定大小的块读取
+    void addEntry(const char* name, TempXmlFile& file, int compressionLevel = -1)
+    {
+        FILE* source = file.rewind();
+        if (!ns_miniz::mz_zip_writer_add_cfile(&m_zip, name, source, file.size(), nullptr,
+                                               nullptr, 0, level(compressionLevel), nullptr, 0, nullptr, 0)) {
+            throw std::runtime_error(std::string("无法写入压缩包条目: ") + name);
+        }
+    }
+
+    void finish()
+    {
+        const bool finalized = ns_miniz::mz_zip_writer_finalize_archive(&m_zip);
+        ns_miniz::mz_zip_writer_end(&m_zip);
+        m_initialized = false;
+        m_file.close();
+        if (!finalized || m_failed) {
+            throw std::runtime_error("写入压缩包失败");
+        }
+    }
+
+private:
+    ns_miniz::mz_uint level(int compressionLevel) const
+    {
+        return compressionLevel < 0 ? m_level : static_cast<ns_miniz::mz_uint>(qMin(compressionLevel, 9));
+    }
+
+    static size_t write(void* opaque, ns_miniz::mz_uint64 offset, const void* buffer, size_t size)
+    {
+        auto* self = static_cast<ZipOutput*>(opaque);
+        if (self->m_file.pos() != static_cast<qint64>(offset) && !self->m_file.seek(static_cast<qint64>(offset))) {
+            self->m_failed = true;
+            return 0;
+        }
+        const qint64 written = self->m_file.write(static_cast<const char*>(buffer), static_cast<qint64>(size));
+        if (written != static_cast<qint64>(size)) {
+            self->m_failed = true;
+            return 0;
+        }
+        return size;
+    }
+
+private:
+    QFile m_file;
+    ns_miniz::mz_zip_archive m_zip{};
+    ns_miniz::mz_uint m_level;
+    bool m_initialized = false;
+    bool m_failed = false;
+};
+
+/**
+ * 工作表XML生成
+ *
+ * 按行追加单元格，数据写入临时文件，行数事先未知时也可以使用：
+ * <dimension>的位置先预留固定宽度的空白，结束时回填实际范围。
+ * 行号从1开始依次递增，单元格按列顺序写入，空值不写出。
+ * 共享字符串表由工作簿中的所有工作表共用，为空时字符串内联写出。
+ */
+class SheetXmlBuilder
+{
+public:
+    /// 预留给<dimension ref="A1:XFD1048576"/>的宽度
+    static constexpr size_t DimensionReserve = 32;
+
+    explicit SheetXmlBuilder(SharedStringTable* sharedStrings)
+        : m_sharedStrings(sharedStrings)
+    {
+        std::string& out = m_sheet.buffer();
+        out += XmlHeader;
+        out += WorksheetOpen;
+        m_dimensionOffset = out.size();
+        out.append(DimensionReserve, ' ');
+        out += "<sheetData>";
+    }
+
+    // 开始新的一行，返回行号
+    uint32_t beginRow()
+    {
+        if (m_rows >= CellReference::MaxRows) {
+            throw std::runtime_error("超出Excel最大行数");
+        }
+        ++m_rows;
+        std::string& out = m_sheet.buffer();
+        out += R"(<row r=")";
+        appendNumber(out, m_rows);
+        out += R"(">)";
+        return m_rows;
+    }
+
+    void endRow()
+    {
+        m_sheet.buffer() += "</row>";
+        m_sheet.flushIfFull();
+    }
+
+    void writeString(int column, const std::shared_ptr<StringPool>& pool, StringPool::Handle handle)
+    {
+        if (m_sharedStrings) {
+            writeSharedString(column, m_sharedStrings->indexOf(pool, handle));
+        } else {
+            writeInlineString(column, pool->view(handle));
+        }
+    }
+
+    void writeString(int column, const QString& text)
+    {
+        if (m_sharedStrings) {
+            writeSharedString(column, m_sharedStrings->indexOf(text));
+        } else {
+            writeInlineString(column, text);
+        }
+    }
+
+    template<typename T>
+    void writeNumber(int column, T value)
+    {
+        std::string& out = m_sheet.buffer();
+        out += R"(<c r=")";
+        out += reference(column);
+        if constexpr (std::is_floating_point_v<T>) {
+            // Excel不能保存无穷大和NaN，按#NUM!错误写出
+            if (!std::isfinite(value)) {
+                out += R"(" t="e"><v>#NUM!</v></c>)";
+                return;
+            }
+        }
+        out += R"("><v>)";
+        appendNumber(out, value);
+        out += "</v></c>";
+    }
+
+    void writeBool(int column, bool value)
+    {
+        std::string& out = m_sheet.buffer();
+        out += R"(<c r=")";
+        out += reference(column);
+        out += value ? R"(" t="b"><v>1</v></c>)" : R"(" t="b"><v>0</v></c>)";
+    }
+
+    // 按QVariant类型写出，空值跳过
+    void writeVariant(int column, const QVariant& value)
+    {
+        if (value.isNull() || !value.isValid()) {
+            return;
+        }
+        switch (value.typeId()) {
+            case QMetaType::Bool:
+                writeBool(column, value.toBool());
+                break;
+            case QMetaType::Int:
+            case QMetaType::LongLong:
+                writeNumber(column, static_cast<int64_t>(value.toLongLong()));
+                break;
+            case QMetaType::Double:
+                writeNumber(column, value.toDouble());
+                break;
+            default:
+                writeString(column, value.toString());
+                break;
+        }
+    }
+
+    uint32_t rowCount() const { return m_rows; }
+
+    TempXmlFile& xml() { return m_sheet; }
+
+    // 结束工作表，回填<dimension>，返回待压缩的临时文件
+    TempXmlFile& finish()
+    {
+        m_sheet.buffer() += "</sheetData></worksheet>";
+        if (m_rows > 0 && m_columnCount > 0) {
+            std::string dimension(R"(<dimension ref="A1:)");
+            dimension += m_columnNames[m_columnCount - 1].view();
+            appendNumber(dimension, m_rows);
+            dimension += R"("/>)";
+            m_sheet.overwrite(m_dimensionOffset, dimension);
+        }
+        return m_sheet;
+    }
+
+private:
+    void writeSharedString(int column, uint32_t index)
+    {
+        std::string& out = m_sheet.buffer();
+        out += R"(<c r=")";
+        out += reference(column);
+        out += R"(" t="s"><v>)";
+        appendNumber(out, index);
+        out += "</v></c>";
+    }
+
+    void writeInlineString(int column, QStringView text)
+    {
+        std::string& out = m_sheet.buffer();
+        out += R"(<c r=")";
+        out += reference(column);
+        out += R"(" t="inlineStr"><is><t xml:space="preserve">)";
+        appendEscaped(out, text);
+        out += "</t></is></c>";
+    }
+
+    // 当前行中某列的单元格引用，每列的列名只计算一次
+    const std::string& reference(int column)
+    {
+        if (column >= m_columnCount) {
+            if (column >= CellReference::MaxColumns) {
+                throw std::runtime_error("超出Excel最大列数");
+            }
+            for (int col = static_cast<int>(m_columnNames.size()); col <= column; ++col) {
+                m_columnNames.push_back(CellReference::columnName(col + 1));
+            }
+            m_columnCount = column + 1;
+        }
+        m_reference.assign(m_columnNames[column].view());
+        appendNumber(m_reference, m_rows);
+        return m_reference;
+    }
+
+private:
+    TempXmlFile m_sheet;
+    SharedStringTable* m_sharedStrings;
+    std::vector<CellReference::Text> m_columnNames;
+    std::string m_reference;
+    uint64_t m_dimensionOffset = 0;
+    uint32_t m_rows = 0;
+    int m_columnCount = 0;      ///< 已写出单元格的最大列数
+};
+
+/**
+ * 待打包的工作表，按添加顺序编号为sheet1.xml、sheet2.xml...
+ */
+struct PackageSheet
+{
+    std::string name;
+    TempXmlFile* xml;
+    int compressionLevel;
+};
+
+// 把所有工作表打包为一个xlsx，整个压缩包只写一次
+void writePackage(const QString& filePath,
+                  const std::vector<PackageSheet>& sheets,
+                  SharedStringTable* sharedStrings,
+                  int compressionLevel)
+{
+    std::string workbookXml(XmlHeader);
+    workbookXml += R"(<workbook xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main" )"
+                   R"(xmlns:r="http://schemas.openxmlformats.org/officeDocument/2006/relationships"><sheets>)";
+
+    std::string contentTypes(ContentTypesXml);
+    std::string workbookRelationships(WorkbookRelationshipsOpen);
+    for (size_t i = 0; i < sheets.size(); ++i) {
+        const size_t number = i + 1;
+
+        workbookXml += R"(<sheet name=")";
+        appendEscaped(workbookXml, sheets[i].name);
+        workbookXml += R"(" sheetId=")";
+        appendNumber(workbookXml, number);
+        workbookXml += R"(" r:id="rId)";
+        appendNumber(workbookXml, number);
+        workbookXml += R"("/>)";
+
+        contentTypes += R"(<Override PartName="/xl/worksheets/sheet)";
+        appendNumber(contentTypes, number);
+        contentTypes += ".xml";
+        contentTypes += WorksheetContentType;
+
+        workbookRelationships += R"(<Relationship Id="rId)";
+        appendNumber(workbookRelationships, number);
+        workbookRelationships += WorksheetRelationshipType;
+        appendNumber(workbookRelationships, number);
+        workbookRelationships += R"(.xml"/>)";
+    }
+    workbookXml += "</sheets></workbook>";
+
+    // 样式和共享字符串的关系编号排在工作表之后
+    workbookRelationships += R"(<Relationship Id="rId)";
+    appendNumber(workbookRelationships, sheets.size() + 1);
+    workbookRelationships += StylesRelationshipType;
+    if (sharedStrings) {
+        contentTypes += SharedStringsContentType;
+        workbookRelationships += R"(<Relationship Id="rId)";
+        appendNumber(workbookRelationships, sheets.size() + 2);
+        workbookRelationships += SharedStringsRelationshipType;
+    }
+    contentTypes += "</Types>";
+    workbookRelationships += "</Relationships>";
+
+    ZipOutput zip(filePath, compressionLevel);
+    zip.addEntry("[Content_Types].xml", contentTypes);
+    zip.addEntry("_rels/.rels", RootRelationshipsXml);
+    zip.addEntry("xl/workbook.xml", workbookXml);
+    zip.addEntry("xl/_rels/workbook.xml.rels", workbookRelationships);
+    zip.addEntry("xl/styles.xml", StylesXml);
+    for (size_t i = 0; i < sheets.size(); ++i) {
+        const std::string entryName = "xl/worksheets/sheet" + std::to_string(i + 1) + ".xml";
+        zip.addEntry(entryName.c_str(), *sheets[i].xml, sheets[i].compressionLevel);
+    }
+    if (sharedStrings) {
+        zip.addEntry("xl/sharedStrings.xml", sharedStrings->finish());
+    }
+    zip.finish();
+}
+
+// 按行写入RangeData，类型化的值直接从列数组读取
+void writeRangeRows(SheetXmlBuilder& sheet,
+                    const RangeData& data,
+                    const SheetWriter::ProgressCallback& progress,
+                    const std::function<bool()>& isCanceled)
+{
+    const int rows = data.rowCount();
+    const int cols = data.columnCount();
+    const auto& columns = data.columns();
+
+    for (int row = 0; row < rows; ++row) {
+        sheet.beginRow();
+
+        for (int col = 0; col < cols; ++col) {
+            const RangeColumn& column = columns[col];
+
+            // 类型化的值直接从列数组读取，其余的（空值和例外值）按QVariant类型写出
+            if (!column.hasTypedValue(row)) {
+                sheet.writeVariant(col, column.value(row));
+                continue;
+            }
+
+            switch (column.type()) {
+                case RangeColumn::Type::Boolean:
+                    sheet.writeBool(col, column.boolValues()[row] != 0);
+                    break;
+                case RangeColumn::Type::Integer:
+                    sheet.writeNumber(col, column.int64Values()[row]);
+                    break;
+                case RangeColumn::Type::Double:
+                    sheet.writeNumber(col, column.doubleValues()[row]);
+                    break;
+                case RangeColumn::Type::String:
+                    sheet.writeString(col, column.stringPool(), column.stringHandles()[row]);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        sheet.endRow();
+
+        if ((row + 1) % SheetWriter::ProgressInterval == 0 || row + 1 == rows) {
+            if (isCanceled && isCanceled()) {
+                throw std::runtime_error("保存已取消");
+            }
+            if (progress) {
+                progress(row + 1, rows);
+            }
+        }
+    }
+}
+
+} // namespace
+
+struct StreamingSheetWriter::RowWriter::Impl
+{
+    explicit Impl(StringMode stringMode)
+        : sharedStrings(stringMode == StringMode::SharedStrings ? std::make_unique<SharedStringTable>() : nullptr),
+          builder(sharedStrings.get())
+    {
+    }
+
+    std::unique_ptr<SharedStringTable> sharedStrings;
+    SheetXmlBuilder builder;
+};
+
+StreamingSheetWriter::RowWriter::RowWriter(StringMode stringMode)
+    : d(std::make_unique<Impl>(stringMode))
+{
+}
+
+StreamingSheetWriter::RowWriter::~RowWriter() = default;
+
+void StreamingSheetWriter::RowWriter::appendRow(const std::vector<QVariant>& values)
+{
+    d->builder.beginRow();
+    for (size_t col = 0; col < values.size(); ++col) {
+        d->builder.writeVariant(static_cast<int>(col), values[col]);
+    }
+    d->builder.endRow();
+}
+
+int StreamingSheetWriter::RowWriter::rowCount() const
+{
+    return static_cast<int>(d->builder.rowCount());
+}
+
+void StreamingSheetWriter::RowWriter::finish(const QString& filePath, const std::string& sheetName, int compressionLevel)
+{
+    PROFILE_SCOPE("StreamingSheetWriter::RowWriter::finish");
+    checkSheetName(sheetName);
+    TempXmlFile& xml = d->builder.finish();
+    writePackage(filePath, {PackageSheet{sheetName, &xml, compressionLevel}},
+                 d->sharedStrings.get(), compressionLevel);
+}
+
+struct StreamingSheetWriter::WorkbookWriter::Impl
+{
+    struct Sheet
+    {
+        std::string name;
+        std::unique_ptr<SheetXmlBuilder> builder;
+        int compressionLevel;
+    };
+
+    explicit Impl(StringMode stringMode)
+        : defaultStringMode(stringMode)
+    {
+    }
+
+    StringMode defaultStringMode;
+    std::unique_ptr<SharedStringTable> sharedStrings;   ///< 第一个使用共享字符串的工作表创建
+    std::vector<Sheet> sheets;
+};
+
+StreamingSheetWriter::WorkbookWriter::WorkbookWriter(StringMode stringMode)
+    : d(std::make_unique<Impl>(stringMode))
+{
+}
+
+StreamingSheetWriter::WorkbookWriter::~WorkbookWriter() = default;
+
+void StreamingSheetWriter::WorkbookWriter::addSheet(const std::string& sheetName,
+                                                    const RangeData& data,
+                                                    int compressionLevel,
+                                                    const SheetWriter::ProgressCallback& progress,
+                                                    const std::function<bool()>& isCanceled)
+{
+    addSheet(sheetName, data, d->defaultStringMode, compressionLevel, progress, isCanceled);
+}
+
+void StreamingSheetWriter::WorkbookWriter::addSheet(const std::string& sheetName,
+                                                    const RangeData& data,
+                                                    StringMode stringMode,
+                                                    int compressionLevel,
+                                                    const SheetWriter::ProgressCallback& progress,
+                                                    const std::function<bool()>& isCanceled)
+{
+    PROFILE_SCOPE("StreamingSheetWriter::WorkbookWriter::addSheet");
+
+    checkSheetName(sheetName);
+
+    // Excel的工作表名称不区分大小写
+    const QString name = QString::fromStdString(sheetName);
+    for (const auto& sheet : d->sheets) {
+        if (QString::fromStdString(sheet.name).compare(name, Qt::CaseInsensitive) == 0) {
+            throw std::runtime_error("工作表名称重复: " + sheetName);
+        }
+    }
+
+    if (stringMode == StringMode::SharedStrings && !d->sharedStrings) {
+        d->sharedStrings = std::make_unique<SharedStringTable>();
+    }
+    auto builder = std::make_unique<SheetXmlBuilder>(stringMode == StringMode::SharedStrings ? d->sharedStrings.get() : nullptr);
+    writeRangeRows(*builder, data, progress, isCanceled);
+    builder->finish();
+    d->sheets.push_back(Impl::Sheet{sheetName, std::move(builder), compressionLevel});
+}
+
+int StreamingSheetWriter::WorkbookWriter::sheetCount() const
+{
+    return static_cast<int>(d->sheets.size());
+}
+
+void StreamingSheetWriter::WorkbookWriter::finish(const QString& filePath, int compressionLevel)
+{
+    PROFILE_SCOPE("StreamingSheetWriter::WorkbookWriter::finish");
+    if (d->sheets.empty()) {
+        throw std::runtime_error("工作簿中没有工作表");
+    }
+
+    std::vector<PackageSheet> sheets;
+    sheets.reserve(d->sheets.size());
+    for (auto& sheet : d->sheets) {
+        sheets.push_back(PackageSheet{sheet.name, &sheet.builder->xml(), sheet.compressionLevel});
+    }
+    writePackage(filePath, sheets, d->sharedStrings.get(), compressionLevel);
+}
+
+void StreamingSheetWriter::writeWorkbook(const QString& filePath,
+                                         const std::string& sheetName,
+                                         const RangeData& data,
+                                         StringMode stringMode,
+                                         const SheetWriter::ProgressCallback& progress,
+                                         const std::function<bool()>& isCanceled,
+                                         int compressionLevel)
+{
+    PROFILE_SCOPE("StreamingSheetWriter::writeWorkbook");
+
+    WorkbookWriter workbook(stringMode);
+    workbook.addSheet(sheetName, data, compressionLevel, progress, isCanceled);
+    workbook.finish(filePath, compressionLevel);
+}
@@ -0,0 +1,410 @@
+#include "TinaFlowGraphModel.hpp"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QtNodes/NodeDelegateModel>
+#include <algorithm>
+#include <tuple>
+
+TinaFlowGraphModel::TinaFlowGraphModel(std::shared_ptr<QtNodes::NodeDelegateModelRegistry> registry)
+    : QtNodes::DataFlowGraphModel(std::move(registry))
+{
+    connect(this, &QtNodes::DataFlowGraphModel::nodeDeleted, this, &TinaFlowGraphModel::onNodeDeleted);
+}
+
+void TinaFlowGraphModel::startRun(const SourceTrigger& triggerSource)
+{
+    if (m_run) {
+        stopRun();
+    }
+
+    RunState& run = m_run.emplace();
+    run.triggerSource = triggerSource;
+    run.timer.start();
+
+    const auto nodeIds = allNodeIds();
+    run.order.assign(nodeIds.begin(), nodeIds.end());
+    std::sort(run.order.begin(), run.order.end());
+
+    for (const auto nodeId : run.order) {
+        // 上游按节点计数，同一上游连到多个端口时只等待一次
+        std::unordered_set<QtNodes::NodeId> upstream;
+        for (const auto& connectionId : allConnectionIds(nodeId)) {
+            if (connectionId.inNodeId == nodeId && connectionId.outNodeId != nodeId) {
+                upstream.insert(connectionId.outNodeId);
+            }
+        }
+        for (const auto upstreamId : upstream) {
+            run.downstream[upstreamId].push_back(nodeId);
+        }
+        run.pendingUpstream[nodeId] = static_cast<int>(upstream.size());
+        if (upstream.empty()) {
+            run.sources.insert(nodeId);
+            run.ready.push_back(nodeId);
+        }
+
+        if (auto* model = delegateModel<QtNodes::NodeDelegateModel>(nodeId)) {
+            run.connections.push_back(connect(model, &QtNodes::NodeDelegateModel::computingStarted, this,
+                [this, nodeId]() { onComputingStarted(nodeId); }));
+            run.connections.push_back(connect(model, &QtNodes::NodeDelegateModel::computingFinished, this,
+                [this, nodeId]() { onComputingFinished(nodeId); }));
+        }
+    }
+
+    qDebug() << "TinaFlowGraphModel: Run started with" << run.order.size() << "nodes," << run.sources.size() << "sources";
+    pump();
+}
+
+void TinaFlowGraphModel::stopRun()
+{
+    if (!m_run) {
+        return;
+    }
+    for (const auto& connection : m_run->connections) {
+        disconnect(connection);
+    }
+
+    // 仍在计算的节点随后会被取消，取消前已经产生的结果属于这次运行，送达时丢弃
+    for (const auto nodeId : m_run->busy) {
+        auto* model = delegateModel<QtNodes::NodeDelegateModel>(nodeId);
+        if (!model || m_stoppedNodes.contains(nodeId)) {
+            continue;
+        }
+        m_stoppedNodes[nodeId] = connect(model, &QtNodes::NodeDelegateModel::computingStarted, this,
+            [this, nodeId]() { resumeStoppedNode(nodeId); });
+    }
+
+    qDebug() << "TinaFlowGraphModel: Run stopped," << m_run->computed << "nodes computed,"
+             << m_run->busy.size() << "still computing";
+    m_run.reset();
+}
+
+bool TinaFlowGraphModel::setPortData(QtNodes::NodeId nodeId,
+                                     QtNodes::PortType portType,
+                                     QtNodes::PortIndex portIndex,
+                                     QVariant const& value,
+                                     QtNodes::PortRole role)
+{
+    if (role == QtNodes::PortRole::Data && portType == QtNodes::PortType::In && fromStoppedNode(nodeId, portIndex)) {
+        qDebug() << "TinaFlowGraphModel: Dropped result of a stopped run for node" << nodeId << "port" << portIndex;
+        return false;
+    }
+
+    // 上游尚未全部完成的节点先暂存输入，同一端口只保留最后一次
+    if (m_run && role == QtNodes::PortRole::Data && portType == QtNodes::PortType::In
+        && !m_run->released.contains(nodeId) && m_run->pendingUpstream.contains(nodeId)) {
+        m_run->bufferedInputs[nodeId][portIndex] = value;
+        return false;
+    }
+    return QtNodes::DataFlowGraphModel::setPortData(nodeId, portType, portIndex, value, role);
+}
+
+void TinaFlowGraphModel::pump()
+{
+    // 节点在计算中同步完成时会回到这里，由外层循环继续执行
+    if (m_pumping) {
+        return;
+    }
+    m_pumping = true;
+
+    while (m_run) {
+        while (m_run && !m_run->ready.empty()) {
+            const QtNodes::NodeId nodeId = m_run->ready.front();
+            m_run->ready.pop_front();
+            execute(nodeId);
+            if (m_run && !m_run->busy.contains(nodeId)) {
+                settle(nodeId);
+            }
+        }
+        if (!m_run) {
+            break;
+        }
+        if (!m_run->busy.empty()) {
+            if (isDrained()) {
+                emit runDrained();
+            }
+            break;
+        }
+
+        // 没有可执行的节点也没有后台计算：剩下的节点在环上，按编号顺序逐个执行
+        const auto pending = std::find_if(m_run->order.begin(), m_run->order.end(), [this](QtNodes::NodeId nodeId) {
+            return !m_run->released.contains(nodeId);
+        });
+        if (pending == m_run->order.end()) {
+            finishRun();
+            break;
+        }
+        qDebug() << "TinaFlowGraphModel: Breaking cycle at node" << *pending;
+        m_run->ready.push_back(*pending);
+    }
+
+    m_pumping = false;
+}
+
+void TinaFlowGraphModel::execute(QtNodes::NodeId nodeId)
+{
+    if (m_run->released.contains(nodeId)) {
+        return;
+    }
+    m_run->released.insert(nodeId);
+
+    auto* model = delegateModel<QtNodes::NodeDelegateModel>(nodeId);
+    if (!model) {
+        return;
+    }
+
+    // 参数、外部状态和上游都与上一次运行相同时直接复用节点当前的输出
+    const QByteArray nodeFingerprint = fingerprint(nodeId);
+    m_run->fingerprints[nodeId] = nodeFingerprint;
+    if (canReuse(nodeId, *model, nodeFingerprint)) {
+        m_run->reused.insert(nodeId);
+        m_run->bufferedInputs.erase(nodeId);
+        return;
+    }
+
+    if (m_run->sources.contains(nodeId)) {
+        ++m_run->computed;
+        m_run->triggerSource(nodeId);
+        return;
+    }
+
+    auto buffered = m_run->bufferedInputs.extract(nodeId);
+    std::map<QtNodes::PortIndex, QVariant> inputs;
+    if (!buffered.empty()) {
+        inputs = std::move(buffered.mapped());
+    }
+
+    // 复用结果的上游不会再发出数据，从它当前的输出补齐
+    for (const auto& connectionId : allConnectionIds(nodeId)) {
+        if (connectionId.inNodeId == nodeId && m_run->reused.contains(connectionId.outNodeId)
+            && !inputs.contains(connectionId.inPortIndex)) {
+            inputs[connectionId.inPortIndex] = portData(connectionId.outNodeId, QtNodes::PortType::Out,
+                                                        connectionId.outPortIndex, QtNodes::PortRole::Data);
+        }
+    }
+
+    if (inputs.empty()) {
+        qDebug() << "TinaFlowGraphModel: Node" << nodeId << "received no input, skipped";
+        m_run->skipped.insert(nodeId);
+        m_run->fingerprints.erase(nodeId);
+        m_memo.erase(nodeId);
+        return;
+    }
+    ++m_run->computed;
+    auto* baseModel = dynamic_cast<BaseNodeModel*>(model);
+
+    // 线程安全的节点在线程池中计算，不阻塞GUI线程和其他分支
+    if (baseModel && baseModel->threadAffinity() == BaseNodeModel::ThreadAffinity::AnyThread) {
+        BaseNodeModel::Inputs snapshot;
+        std::vector<QtNodes::PortIndex> ports;
+        for (const auto& [portIndex, value] : inputs) {
+            snapshot[portIndex] = value.value<std::shared_ptr<QtNodes::NodeData>>();
+            ports.push_back(portIndex);
+        }
+        if (auto task = baseModel->createConcurrentTask(snapshot)) {
+            // 节点发出computingStarted进入后台计算，结果应用后发出computingFinished
+            baseModel->startCompute(std::move(task));
+            for (const auto portIndex : ports) {
+                Q_EMIT inPortDataWasSet(nodeId, QtNodes::PortType::In, portIndex);
+            }
+            return;
+        }
+    }
+
+    // 多个端口一起交付，支持的节点只在全部交付后计算一次
+    if (inputs.size() < 2) {
+        baseModel = nullptr;
+    }
+    if (baseModel) {
+        baseModel->beginInputs();
+    }
+    for (const auto& [portIndex, value] : inputs) {
+        QtNodes::DataFlowGraphModel::setPortData(nodeId, QtNodes::PortType::In, portIndex, value, QtNodes::PortRole::Data);
+    }
+    if (baseModel) {
+        baseModel->endInputs();
+    }
+}
+
+QByteArray TinaFlowGraphModel::fingerprint(QtNodes::NodeId nodeId)
+{
+    auto* model = delegateModel<BaseNodeModel>(nodeId);
+    if (!model || !model->isMemoizable()) {
+        return {};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QJsonDocument(model->save()).toJson(QJsonDocument::Compact));
+    hash.addData(model->externalState().toUtf8());
+
+    // 输入按端口排序，使用上游节点本次运行的指纹；上游不能复用时本节点也不能复用
+    std::vector<QtNodes::ConnectionId> inputs;
+    for (const auto& connectionId : allConnectionIds(nodeId)) {
+        if (connectionId.inNodeId == nodeId) {
+            inputs.push_back(connectionId);
+        }
+    }
+    std::sort(inputs.begin(), inputs.end(), [](const QtNodes::ConnectionId& a, const QtNodes::ConnectionId& b) {
+        return std::tie(a.inPortIndex, a.outNodeId, a.outPortIndex) < std::tie(b.inPortIndex, b.outNodeId, b.outPortIndex);
+    });
+    for (const auto& connectionId : inputs) {
+        const auto it = m_run->fingerprints.find(connectionId.outNodeId);
+        if (it == m_run->fingerprints.end() || it->second.isEmpty()) {
+            return {};
+        }
+        hash.addData(QByteArray::number(connectionId.inPortIndex));
+        hash.addData(it->second);
+        hash.addData(QByteArray::number(connectionId.outPortIndex));
+    }
+    return hash.result();
+}
+
+bool TinaFlowGraphModel::canReuse(QtNodes::NodeId nodeId, QtNodes::NodeDelegateModel& model,
+                                  const QByteArray& fingerprint) const
+{
+    const auto it = m_memo.find(nodeId);
+    if (fingerprint.isEmpty() || it == m_memo.end() || it->second.fingerprint != fingerprint) {
+        return false;
+    }
+
+    // 运行之外修改过的节点输出已经不是当时的结果
+    const auto& outputs = it->second.outputs;
+    if (outputs.size() != model.nPorts(QtNodes::PortType::Out)) {
+        return false;
+    }
+    for (unsigned int port = 0; port < outputs.size(); ++port) {
+        if (outputs[port].lock() != model.outData(port)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TinaFlowGraphModel::memoize(QtNodes::NodeId nodeId)
+{
+    // 重新计算指纹：计算可能改变了外部状态（例如写入了文件）
+    QByteArray nodeFingerprint = fingerprint(nodeId);
+    m_run->fingerprints[nodeId] = nodeFingerprint;
+
+    auto* model = delegateModel<QtNodes::NodeDelegateModel>(nodeId);
+    if (!model || nodeFingerprint.isEmpty()) {
+        m_memo.erase(nodeId);
+        return;
+    }
+
+    // 没有输出（通常是计算失败）的节点下次重新计算
+    MemoEntry entry;
+    entry.fingerprint = std::move(nodeFingerprint);
+    for (unsigned int port = 0; port < model->nPorts(QtNodes::PortType::Out); ++port) {
+        auto output = model->outData(port);
+        if (!output) {
+            m_memo.erase(nodeId);
+            return;
+        }
+        entry.outputs.push_back(output);
+    }
+    m_memo[nodeId] = std::move(entry);
+}
+
+void TinaFlowGraphModel::settle(QtNodes::NodeId nodeId)
+{
+    if (!m_run->settled.insert(nodeId).second) {
+        return;
+    }
+    if (!m_run->reused.contains(nodeId) && m_run->fingerprints.contains(nodeId)) {
+        memoize(nodeId);
+    }
+    const auto it = m_run->downstream.find(nodeId);
+    if (it == m_run->downstream.end()) {
+        return;
+    }
+    for (const auto downstreamId : it->second) {
+        if (--m_run->pendingUpstream[downstreamId] == 0 && !m_run->released.contains(downstreamId)) {
+            m_run->ready.push_back(downstreamId);
+        }
+    }
+}
+
+bool TinaFlowGraphModel::isDrained()
+{
+    return std::all_of(m_run->busy.begin(), m_run->busy.end(), [this](QtNodes::NodeId nodeId) {
+        const auto* model = delegateModel<BaseNodeModel>(nodeId);
+        return model && model->isDeferredToRunEnd();
+    });
+}
+
+void TinaFlowGraphModel::finishRun()
+{
+    const int computed = m_run->computed;
+    const int reused = static_cast<int>(m_run->reused.size());
+    const int skipped = static_cast<int>(m_run->skipped.size());
+    const qint64 elapsed = m_run->timer.elapsed();
+    for (const auto& connection : m_run->connections) {
+        disconnect(connection);
+    }
+    m_run.reset();
+
+    qDebug() << "TinaFlowGraphModel: Run finished," << computed << "nodes computed," << reused << "reused,"
+             << skipped << "skipped in" << elapsed << "ms";
+    emit runFinished(computed, reused, skipped, elapsed);
+}
+
+void TinaFlowGraphModel::onComputingStarted(QtNodes::NodeId nodeId)
+{
+    if (m_run && !m_run->settled.contains(nodeId)) {
+        m_run->busy.insert(nodeId);
+    }
+}
+
+void TinaFlowGraphModel::onComputingFinished(QtNodes::NodeId nodeId)
+{
+    if (!m_run || m_run->busy.erase(nodeId) == 0) {
+        return;
+    }
+    // 在其他节点计算期间（例如错误对话框的事件循环中）完成时，由外层的pump()继续执行下游
+    if (m_run->released.contains(nodeId)) {
+        settle(nodeId);
+        pump();
+    }
+}
+
+void TinaFlowGraphModel::onNodeDeleted(QtNodes::NodeId nodeId)
+{
+    m_memo.erase(nodeId);
+    resumeStoppedNode(nodeId);
+    if (!m_run || !m_run->pendingUpstream.contains(nodeId)) {
+        return;
+    }
+
+    // 被删除的节点视为已完成，不再阻塞下游
+    m_run->busy.erase(nodeId);
+    m_run->bufferedInputs.erase(nodeId);
+    m_run->released.insert(nodeId);
+    m_run->order.erase(std::remove(m_run->order.begin(), m_run->order.end(), nodeId), m_run->order.end());
+    settle(nodeId);
+    pump();
+}
+
+bool TinaFlowGraphModel::fromStoppedNode(QtNodes::NodeId nodeId, QtNodes::PortIndex portIndex) const
+{
+    if (m_stoppedNodes.empty()) {
+        return false;
+    }
+    for (const auto& connectionId : connections(nodeId, QtNodes::PortType::In, portIndex)) {
+        if (m_stoppedNodes.contains(connectionId.outNodeId)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TinaFlowGraphModel::resumeStoppedNode(QtNodes::NodeId nodeId)
+{
+    const auto it = m_stoppedNodes.find(nodeId);
+    if (it == m_stoppedNodes.end()) {
+        return;
+    }
+    disconnect(it->second);
+    m_stoppedNodes.erase(it);
+}
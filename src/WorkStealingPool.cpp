@@ -0,0 +1,123 @@
+#include "WorkStealingPool.hpp"
+
+#include <QDebug>
+#include <algorithm>
+#include <exception>
+
+namespace {
+
+// 当前线程所属的线程池和队列编号，不是工作线程时为空
+thread_local WorkStealingPool* t_pool = nullptr;
+thread_local int t_workerIndex = -1;
+
+} // namespace
+
+WorkStealingPool& WorkStealingPool::instance()
+{
+    static WorkStealingPool instance;
+    return instance;
+}
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+{
+    if (threadCount < 1) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    m_workers.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    m_threads.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&WorkStealingPool::run, this, i);
+    }
+    qDebug() << "WorkStealingPool: Started" << threadCount << "worker threads";
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    // 先计数再入队：被唤醒的线程最多空转到任务入队，不会错过唤醒
+    {
+        std::lock_guard lock(m_wakeMutex);
+        ++m_pending;
+    }
+
+    const int index = t_pool == this ? t_workerIndex
+                                     : static_cast<int>(m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_workers.size());
+    {
+        Worker& worker = *m_workers[index];
+        std::lock_guard lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    m_wake.notify_one();
+}
+
+void WorkStealingPool::run(int index)
+{
+    t_pool = this;
+    t_workerIndex = index;
+
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            {
+                std::lock_guard lock(m_wakeMutex);
+                --m_pending;
+            }
+            try {
+                task();
+            } catch (const std::exception& e) {
+                qDebug() << "WorkStealingPool: Task threw:" << e.what();
+            } catch (...) {
+                qDebug() << "WorkStealingPool: Task threw an unknown exception";
+            }
+            continue;
+        }
+
+        std::unique_lock lock(m_wakeMutex);
+        m_wake.wait(lock, [this]() { return m_stopping || m_pending > 0; });
+        if (m_stopping && m_pending == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(int index, Task& task)
+{
+    Worker& worker = *m_workers[index];
+    std::lock_guard lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int index, Task& task)
+{
+    const int count = static_cast<int>(m_workers.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Worker& victim = *m_workers[(index + offset) % count];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,110 @@
+#include "WorkbookCache.hpp"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+WorkbookCache::FileStamp WorkbookCache::FileStamp::of(const QString& filePath)
+{
+    FileStamp stamp;
+    QFileInfo info(filePath);
+    if (!info.exists()) {
+        return stamp;
+    }
+
+    stamp.canonicalPath = info.canonicalFilePath();
+    stamp.size = info.size();
+    stamp.lastModified = info.lastModified();
+    return stamp;
+}
+
+WorkbookCache& WorkbookCache::instance()
+{
+    static WorkbookCache instance;
+    return instance;
+}
+
+std::shared_ptr<WorkbookDocument> WorkbookCache::find(const FileStamp& stamp)
+{
+    if (!stamp.isValid()) {
+        return nullptr;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.find(stamp.canonicalPath);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+
+    if (!it->stamp.sameContentAs(stamp)) {
+        qDebug() << "WorkbookCache: File changed, invalidating" << stamp.canonicalPath;
+        m_entries.erase(it);
+        return nullptr;
+    }
+
+    auto document = it->document.lock();
+    if (!document) {
+        m_entries.erase(it);
+        return nullptr;
+    }
+
+    qDebug() << "WorkbookCache: Reusing parsed document for" << stamp.canonicalPath;
+    return document;
+}
+
+std::shared_ptr<WorkbookDocument> WorkbookCache::insert(const FileStamp& stamp, std::shared_ptr<WorkbookDocument> document)
+{
+    if (!stamp.isValid() || !document) {
+        return document;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    pruneExpired();
+
+    auto it = m_entries.find(stamp.canonicalPath);
+    if (it != m_entries.end() && it->stamp.sameContentAs(stamp)) {
+        if (auto existing = it->document.lock()) {
+            // 另一个加载任务已经解析了同一个文件
+            return existing;
+        }
+    }
+
+    m_entries.insert(stamp.canonicalPath, Entry{stamp, document});
+    return document;
+}
+
+void WorkbookCache::invalidate(const QString& filePath)
+{
+    const QString canonicalPath = QFileInfo(filePath).canonicalFilePath();
+    QMutexLocker locker(&m_mutex);
+    m_entries.remove(canonicalPath.isEmpty() ? filePath : canonicalPath);
+}
+
+void WorkbookCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+int WorkbookCache::liveCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    int count = 0;
+    for (const auto& entry : m_entries) {
+        if (!entry.document.expired()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void WorkbookCache::pruneExpired()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->document.expired()) {
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#include "WorkbookLoader.hpp"
+#include "PerformanceProfiler.hpp"
+#include "SheetCache.hpp"
+#include "WorkbookCache.hpp"
+#include "data/StringPool.hpp"
+
+#include <XLDocument.hpp>
+#include <algorithm>
+
+namespace {
+    // 读取完整个文件（计算内容哈希）后的进度
+    constexpr int ReadPhaseProgress = WorkbookLoader::ProgressMax * 2 / 5;
+    // 解压并解析完文档后的进度，剩余部分用于检查工作表和解码共享字符串
+    constexpr int OpenPhaseProgress = WorkbookLoader::ProgressMax * 4 / 5;
+}
+
+WorkbookLoader::Result WorkbookLoader::load(const QString& filePath,
+                                            const std::function<bool()>& isCanceled,
+                                            const std::function<void(int)>& progress)
+{
+    PROFILE_SCOPE("WorkbookLoader::load");
+
+    const auto canceled = [&isCanceled]() { return isCanceled && isCanceled(); };
+    const auto report = [&progress](int value) {
+        if (progress) {
+            progress(value);
+        }
+    };
+
+    report(0);
+
+    // 文件未修改时直接复用已解析的文档。标识在读取前获取，
+    // 这样加载期间被修改的文件不会以旧内容登记到缓存中
+    const auto stamp = WorkbookCache::FileStamp::of(filePath);
+    if (auto cached = WorkbookCache::instance().find(stamp)) {
+        // 其他节点可能正在读取同一文档的DOM
+        int sheetCount = 0;
+        {
+            const auto lock = cached->lockDom();
+            sheetCount = static_cast<int>(cached->workbook().worksheetCount());
+        }
+        report(ProgressMax);
+        return Result{std::make_shared<WorkbookData>(std::move(cached)), QString(), sheetCount};
+    }
+
+    if (canceled()) {
+        return {};
+    }
+
+    // 先按块读取整个文件，计算工作表缓存使用的内容哈希（GUI线程上的查找不会计算）。
+    // 这一步按字节上报进度、可以随时取消，同时把文件读入系统缓存，随后的打开主要是解压和解析
+    SheetCache::instance().prepareContentHash(filePath, [&](qint64 bytesRead, qint64 totalBytes) {
+        if (totalBytes > 0) {
+            report(static_cast<int>(std::min(bytesRead, totalBytes) * ReadPhaseProgress / totalBytes));
+        }
+        return !canceled();
+    });
+    if (canceled()) {
+        return {};
+    }
+    report(ReadPhaseProgress);
+
+    // XLDocument::open()一次完成解压和解析，OpenXLSX既不上报进度也不能中途取消，期间进度显示为忙碌
+    report(Busy);
+    auto doc = std::make_unique<OpenXLSX::XLDocument>();
+    try {
+        doc->open(filePath.toStdString());
+    } catch (const std::exception& e) {
+        return Result{nullptr, QString("无法打开Excel文件: %1 - %2").arg(filePath).arg(e.what())};
+    }
+
+    if (canceled()) {
+        doc->close();
+        return {};
+    }
+    report(OpenPhaseProgress);
+
+    // 检查工作簿是否有效（通过检查是否有工作表）
+    OpenXLSX::XLWorkbook wb = doc->workbook();
+    const int sheetCount = static_cast<int>(wb.worksheetCount());
+    if (sheetCount == 0) {
+        doc->close();
+        return Result{nullptr, QString("Excel工作簿无效或为空: %1").arg(filePath)};
+    }
+
+    // 每个共享字符串只解码一次，后续读取直接命中文档的驻留池
+    auto document = std::make_shared<WorkbookDocument>(filePath, std::move(doc));
+    document->setSharedStringHandles(document->stringPool()->seed(document->document()->sharedStrings()));
+
+    if (canceled()) {
+        return {};
+    }
+
+    document = WorkbookCache::instance().insert(stamp, std::move(document));
+
+    report(ProgressMax);
+    return Result{std::make_shared<WorkbookData>(std::move(document)), QString(), sheetCount};
+}
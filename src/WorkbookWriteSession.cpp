@@ -0,0 +1,384 @@
+#include "WorkbookWriteSession.hpp"
+#include "PerformanceProfiler.hpp"
+#include "WorkbookCache.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QTemporaryFile>
+#include <QtConcurrent/QtConcurrent>
+#include <OpenXLSX.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace {
+
+/**
+ * 通过OpenXLSX写入：打开已有文件或新建文件，依次写入各工作表后另存为临时文件
+ */
+void writeDocument(const QString& filePath,
+                   const QString& tempPath,
+                   const std::vector<WorkbookWriteSession::SheetEntry>& sheets,
+                   const std::function<void(int sheetIndex, int rowsWritten)>& progress,
+                   const std::function<bool()>& isCanceled)
+{
+    // 创建或打开Excel文档，所有写入都落在临时文件上
+    OpenXLSX::XLDocument doc;
+    const bool fileExists = QFileInfo::exists(filePath);
+
+    if (fileExists) {
+        qDebug() << "WorkbookWriteSession: Opening existing file";
+        doc.open(filePath.toStdString());
+    } else {
+        qDebug() << "WorkbookWriteSession: Creating new file";
+        doc.create(tempPath.toStdString(), OpenXLSX::XLForceOverwrite);
+    }
+
+    // 新文件自带的默认工作表只给第一个工作表使用
+    bool renameDefaultSheet = !fileExists;
+    for (size_t i = 0; i < sheets.size(); ++i) {
+        const auto& sheet = sheets[i];
+        const std::string sheetName = sheet.sheetName.toStdString();
+
+        // 获取或创建工作表
+        OpenXLSX::XLWorksheet worksheet;
+        if (doc.workbook().worksheetExists(sheetName)) {
+            qDebug() << "WorkbookWriteSession: Using existing worksheet:" << sheet.sheetName;
+            worksheet = doc.workbook().worksheet(sheetName);
+        } else if (renameDefaultSheet && doc.workbook().worksheetCount() > 0) {
+            qDebug() << "WorkbookWriteSession: Renaming default worksheet to:" << sheet.sheetName;
+            worksheet = doc.workbook().worksheet(1);
+            worksheet.setName(sheetName);
+        } else {
+            qDebug() << "WorkbookWriteSession: Creating new worksheet:" << sheet.sheetName;
+            doc.workbook().addWorksheet(sheetName);
+            worksheet = doc.workbook().worksheet(sheetName);
+        }
+        renameDefaultSheet = false;
+
+        qDebug() << "WorkbookWriteSession: Writing" << sheet.data->rowCount() << "x" << sheet.data->columnCount() << "data";
+        // 进度回调每写入一批行调用一次，在这里检查取消，不必等到整个工作表写完
+        SheetWriter::writeRange(worksheet, *sheet.data, [&progress, &isCanceled, i](int rowsWritten, int) {
+            if (isCanceled && isCanceled()) {
+                throw std::runtime_error("保存已取消");
+            }
+            progress(static_cast<int>(i), rowsWritten);
+        });
+
+        if (isCanceled && isCanceled()) {
+            throw std::runtime_error("保存已取消");
+        }
+    }
+
+    // 保存到临时文件
+    doc.saveAs(tempPath.toStdString(), OpenXLSX::XLForceOverwrite);
+    doc.close();
+}
+
+/**
+ * 后台写入的结果
+ */
+struct WriteResult
+{
+    bool success = false;
+    QString message;
+};
+
+} // namespace
+
+WorkbookWriteSession& WorkbookWriteSession::instance()
+{
+    static WorkbookWriteSession instance;
+    return instance;
+}
+
+void WorkbookWriteSession::begin()
+{
+    if (m_active) {
+        return;
+    }
+    m_active = true;
+    qDebug() << "WorkbookWriteSession: Coalescing workbook writes";
+}
+
+void WorkbookWriteSession::end()
+{
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+
+    // 正常情况下等待写出的节点都已完成，这里只写出没有节点等待的剩余登记
+    flush();
+
+    // 本次运行登记的工作表不再需要，正在写出的工作簿在写完后释放
+    for (auto it = m_workbooks.begin(); it != m_workbooks.end();) {
+        if (!it->writing && it->pendingTickets.isEmpty()) {
+            it = m_workbooks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    qDebug() << "WorkbookWriteSession: Session ended";
+}
+
+void WorkbookWriteSession::abort()
+{
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+
+    // 尚未写出的登记直接以失败结束；正在写出的工作簿取消写入，完成时同样报告失败，目标文件保持不变
+    std::vector<std::pair<QString, QList<quint64>>> dropped;
+    for (auto it = m_workbooks.begin(); it != m_workbooks.end();) {
+        if (!it->pendingTickets.isEmpty()) {
+            dropped.emplace_back(it->filePath, std::exchange(it->pendingTickets, {}));
+        }
+        if (it->writing) {
+            it->canceled->store(true);
+            it->sheets.clear();
+            ++it;
+        } else {
+            it = m_workbooks.erase(it);
+        }
+    }
+    qDebug() << "WorkbookWriteSession: Session aborted," << dropped.size() << "workbook(s) not written";
+
+    for (const auto& [filePath, tickets] : dropped) {
+        emit workbookWritten(filePath, tickets, 0, false, "运行已停止，未写入文件");
+    }
+}
+
+quint64 WorkbookWriteSession::addSheet(const QObject* owner, const QString& filePath, SheetEntry entry)
+{
+    // 同一节点之前登记的工作表被替换，包括改名或改了路径之前的工作表
+    withdraw(owner);
+
+    PendingWorkbook& workbook = m_workbooks[pathKey(filePath)];
+    workbook.filePath = filePath;
+
+    // Excel的工作表名称不区分大小写，同名工作表以最后登记的为准；被替换的登记仍然等待这次写出
+    removeSheets(workbook, [&entry](const OwnedSheet& sheet) {
+        return sheet.entry.sheetName.compare(entry.sheetName, Qt::CaseInsensitive) == 0;
+    });
+
+    const quint64 ticket = m_nextTicket++;
+    workbook.sheets.push_back(OwnedSheet{owner, ticket, std::move(entry)});
+    workbook.pendingTickets.append(ticket);
+    qDebug() << "WorkbookWriteSession: Queued sheet" << workbook.sheets.size() << "for" << filePath;
+
+    // 运行期间等到flush()再写出
+    if (!m_active) {
+        flush();
+    }
+    return ticket;
+}
+
+void WorkbookWriteSession::withdraw(const QObject* owner)
+{
+    for (auto it = m_workbooks.begin(); it != m_workbooks.end();) {
+        PendingWorkbook& workbook = *it;
+        removeSheets(workbook, [owner, &workbook](const OwnedSheet& sheet) {
+            if (sheet.owner != owner) {
+                return false;
+            }
+            workbook.pendingTickets.removeOne(sheet.ticket);
+            return true;
+        });
+        if (it->sheets.empty() && it->pendingTickets.isEmpty() && !it->writing) {
+            it = m_workbooks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void WorkbookWriteSession::removeSheets(PendingWorkbook& workbook, const std::function<bool(const OwnedSheet&)>& match)
+{
+    workbook.sheets.erase(std::remove_if(workbook.sheets.begin(), workbook.sheets.end(), match), workbook.sheets.end());
+}
+
+void WorkbookWriteSession::flush()
+{
+    for (auto it = m_workbooks.begin(); it != m_workbooks.end(); ++it) {
+        // 正在写出的工作簿在写完后再写入新的修改
+        if (!it->writing && !it->pendingTickets.isEmpty()) {
+            startWrite(it.key());
+        }
+    }
+}
+
+void WorkbookWriteSession::startWrite(const QString& key)
+{
+    PendingWorkbook& workbook = m_workbooks[key];
+    workbook.writing = true;
+    workbook.canceled = std::make_shared<std::atomic_bool>(false);
+
+    // 工作线程只访问工作表列表的副本，数据本身是共享的只读快照
+    const QList<quint64> tickets = std::exchange(workbook.pendingTickets, {});
+    std::vector<SheetEntry> sheets;
+    sheets.reserve(workbook.sheets.size());
+    for (const auto& sheet : workbook.sheets) {
+        sheets.push_back(sheet.entry);
+    }
+    const QString filePath = workbook.filePath;
+    const int sheetCount = static_cast<int>(sheets.size());
+
+    qDebug() << "WorkbookWriteSession: Writing" << sheetCount << "sheets to" << filePath;
+
+    auto* watcher = new QFutureWatcher<WriteResult>(this);
+    connect(watcher, &QFutureWatcher<WriteResult>::finished, this, [this, watcher, key, tickets, sheetCount]() {
+        const WriteResult result = watcher->result();
+        watcher->deleteLater();
+        onWriteFinished(key, tickets, sheetCount, result.success, result.message);
+    });
+    watcher->setFuture(QtConcurrent::run([filePath, sheets, canceled = workbook.canceled]() {
+        WriteResult result;
+        try {
+            writeWorkbook(filePath, sheets, {}, [&canceled]() { return canceled->load(); });
+            result.success = true;
+        } catch (const std::exception& e) {
+            result.message = QString("保存失败: %1").arg(e.what());
+        }
+        return result;
+    }));
+}
+
+void WorkbookWriteSession::onWriteFinished(const QString& key, const QList<quint64>& tickets, int sheetCount,
+                                           bool success, const QString& message)
+{
+    auto it = m_workbooks.find(key);
+    if (it == m_workbooks.end()) {
+        return;
+    }
+    it->writing = false;
+    it->canceled.reset();
+    const QString filePath = it->filePath;
+
+    // 写出期间登记的工作表错过了那次flush()，接着写出；会话已结束且没有待写内容时释放工作表
+    if (!it->pendingTickets.isEmpty()) {
+        startWrite(key);
+    } else if (!m_active) {
+        m_workbooks.erase(it);
+    }
+
+    if (success) {
+        qDebug() << "WorkbookWriteSession: Wrote" << sheetCount << "sheets to" << filePath;
+    } else {
+        qDebug() << "WorkbookWriteSession: Failed to write" << filePath << ":" << message;
+    }
+    emit workbookWritten(filePath, tickets, sheetCount, success, message);
+}
+
+void WorkbookWriteSession::writeWorkbook(const QString& filePath,
+                                         const std::vector<SheetEntry>& sheets,
+                                         const SheetWriter::ProgressCallback& progress,
+                                         const std::function<bool()>& isCanceled)
+{
+    PROFILE_SCOPE("WorkbookWriteSession::writeWorkbook");
+
+    if (sheets.empty()) {
+        throw std::runtime_error("没有要写入的工作表");
+    }
+
+    // 标准写入保留文件中的其他工作表，流式导出生成只包含这些工作表的新文件，两者不能同时满足，
+    // 同一文件的工作表使用不同的写入模式时报错，不静默改变其中一部分工作表的写入方式
+    const bool keepOtherSheets = sheets.front().keepOtherSheets;
+    for (const auto& sheet : sheets) {
+        if (sheet.keepOtherSheets != keepOtherSheets) {
+            const auto& documentSheet = keepOtherSheets ? sheets.front() : sheet;
+            const auto& streamingSheet = keepOtherSheets ? sheet : sheets.front();
+            throw std::runtime_error(QString("同一文件中的工作表写入模式不一致：%1 使用标准写入，%2 使用流式导出，请统一写入模式")
+                .arg(documentSheet.sheetName, streamingSheet.sheetName).toStdString());
+        }
+    }
+
+    // 流式导出时每个工作表按自己的字符串方式和压缩级别写入，工作簿结构等其他条目取最高的压缩级别
+    int compressionLevel = StreamingSheetWriter::StoreOnly;
+    std::vector<int> firstRows;
+    int totalRows = 0;
+    for (const auto& sheet : sheets) {
+        compressionLevel = std::max(compressionLevel, sheet.compressionLevel);
+        firstRows.push_back(totalRows);
+        totalRows += sheet.data->rowCount();
+    }
+
+    // 进度按所有工作表的总行数上报
+    const auto sheetProgress = [&](int sheetIndex, int rowsWritten) {
+        if (progress) {
+            progress(firstRows[sheetIndex] + rowsWritten, totalRows);
+        }
+    };
+
+    replaceFileAtomically(filePath, [&](const QString& tempPath) {
+        if (keepOtherSheets) {
+            writeDocument(filePath, tempPath, sheets, sheetProgress, isCanceled);
+            return;
+        }
+
+        // 流式导出直接生成新文件，不经过OpenXLSX的DOM
+        StreamingSheetWriter::WorkbookWriter workbook(StreamingSheetWriter::StringMode::SharedStrings);
+        for (size_t i = 0; i < sheets.size(); ++i) {
+            const auto& sheet = sheets[i];
+            qDebug() << "WorkbookWriteSession: Streaming" << sheet.data->rowCount() << "x" << sheet.data->columnCount() << "data";
+            workbook.addSheet(sheet.sheetName.toStdString(), *sheet.data, sheet.stringMode, sheet.compressionLevel,
+                [&sheetProgress, i](int rowsWritten, int) {
+                    sheetProgress(static_cast<int>(i), rowsWritten);
+                }, isCanceled);
+        }
+        workbook.finish(tempPath, compressionLevel);
+    });
+}
+
+void WorkbookWriteSession::replaceFileAtomically(const QString& filePath, const std::function<void(const QString& tempPath)>& write)
+{
+    // 确保目录存在
+    QFileInfo fileInfo(filePath);
+    QDir dir = fileInfo.absoluteDir();
+    if (!dir.exists()) {
+        if (!dir.mkpath(".")) {
+            throw std::runtime_error("无法创建目录: " + dir.absolutePath().toStdString());
+        }
+    }
+
+    // 在目标目录中预留临时文件，保证最后的重命名不跨文件系统
+    QString tempPath;
+    {
+        QTemporaryFile tempFile(dir.filePath(QString(".%1.XXXXXX.tmp").arg(fileInfo.fileName())));
+        tempFile.setAutoRemove(false);
+        if (!tempFile.open()) {
+            throw std::runtime_error("无法创建临时文件: " + tempFile.errorString().toStdString());
+        }
+        tempPath = tempFile.fileName();
+    }
+
+    try {
+        write(tempPath);
+
+        // 原子替换目标文件，中途崩溃时目标文件保持原样
+        std::error_code error;
+        std::filesystem::rename(std::filesystem::path(tempPath.toStdU16String()),
+                                std::filesystem::path(filePath.toStdU16String()), error);
+        if (error) {
+            throw std::runtime_error("无法替换目标文件: " + error.message());
+        }
+    } catch (...) {
+        QFile::remove(tempPath);
+        throw;
+    }
+
+    // 文件内容已变化，缓存中的旧文档不能再被复用
+    WorkbookCache::instance().invalidate(filePath);
+}
+
+QString WorkbookWriteSession::pathKey(const QString& filePath)
+{
+    // 新文件还不存在，不能用canonicalFilePath()
+    return QDir::cleanPath(QFileInfo(filePath).absoluteFilePath());
+}
@@ -0,0 +1,131 @@
+#include "XlsxArchive.hpp"
+
+#include <QFile>
+#include <stdexcept>
+#include <vector>
+
+#include <zippy.hpp>
+
+struct XlsxArchive::Impl
+{
+    QFile file;
+    ns_miniz::mz_zip_archive zip{};
+    bool opened = false;
+
+    // miniz的随机读取回调，m_pIO_opaque指向Impl
+    static size_t read(void* opaque, ns_miniz::mz_uint64 offset, void* buffer, size_t size)
+    {
+        auto* impl = static_cast<Impl*>(opaque);
+        if (!impl->file.seek(static_cast<qint64>(offset))) {
+            return 0;
+        }
+        const qint64 bytesRead = impl->file.read(static_cast<char*>(buffer), static_cast<qint64>(size));
+        return bytesRead < 0 ? 0 : static_cast<size_t>(bytesRead);
+    }
+
+    int locate(const std::string& name) const
+    {
+        return ns_miniz::mz_zip_reader_locate_file(const_cast<ns_miniz::mz_zip_archive*>(&zip), name.c_str(), nullptr, 0);
+    }
+};
+
+XlsxArchive::XlsxArchive() : d(std::make_unique<Impl>())
+{
+}
+
+XlsxArchive::~XlsxArchive()
+{
+    close();
+}
+
+void XlsxArchive::open(const QString& filePath)
+{
+    close();
+
+    d->file.setFileName(filePath);
+    if (!d->file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("无法打开文件: " + filePath.toStdString());
+    }
+
+    d->zip = ns_miniz::mz_zip_archive{};
+    d->zip.m_pRead = &Impl::read;
+    d->zip.m_pIO_opaque = d.get();
+    if (!ns_miniz::mz_zip_reader_init(&d->zip, static_cast<ns_miniz::mz_uint64>(d->file.size()), 0)) {
+        d->file.close();
+        throw std::runtime_error("不是有效的xlsx压缩包: " + filePath.toStdString());
+    }
+    d->opened = true;
+}
+
+void XlsxArchive::close()
+{
+    if (d->opened) {
+        ns_miniz::mz_zip_reader_end(&d->zip);
+        d->opened = false;
+    }
+    if (d->file.isOpen()) {
+        d->file.close();
+    }
+}
+
+bool XlsxArchive::isOpen() const
+{
+    return d->opened;
+}
+
+bool XlsxArchive::hasEntry(const std::string& name) const
+{
+    return d->opened && d->locate(name) >= 0;
+}
+
+std::string XlsxArchive::readEntry(const std::string& name) const
+{
+    std::string content;
+    streamEntry(name, [&content](const char* data, size_t size) {
+        content.append(data, size);
+        return true;
+    });
+    return content;
+}
+
+bool XlsxArchive::streamEntry(const std::string& name, const ChunkSink& sink) const
+{
+    if (!d->opened) {
+        throw std::runtime_error("压缩包未打开");
+    }
+
+    const int index = d->locate(name);
+    if (index < 0) {
+        throw std::runtime_error("压缩包中缺少条目: " + name);
+    }
+
+    auto* state = ns_miniz::mz_zip_reader_extract_iter_new(&d->zip, static_cast<ns_miniz::mz_uint>(index), 0);
+    if (!state) {
+        throw std::runtime_error("无法解压条目: " + name);
+    }
+
+    std::vector<char> buffer(ChunkSize);
+    bool completed = true;
+    try {
+        while (true) {
+            const size_t bytesRead = ns_miniz::mz_zip_reader_extract_iter_read(state, buffer.data(), buffer.size());
+            if (bytesRead == 0) {
+                break;
+            }
+            if (!sink(buffer.data(), bytesRead)) {
+                completed = false;
+                break;
+            }
+        }
+    } catch (...) {
+        ns_miniz::mz_zip_reader_extract_iter_free(state);
+        throw;
+    }
+
+    // 提前停止时不校验CRC，free()的返回值只在完整解压后才有意义
+    const bool valid = ns_miniz::mz_zip_reader_extract_iter_free(state);
+    if (completed && !valid) {
+        throw std::runtime_error("条目数据损坏: " + name);
+    }
+    return completed;
+}
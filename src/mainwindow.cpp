@@ -37,11 +37,16 @@
 
 // Model includes
 #include "model/OpenExcelModel.hpp"
+#include "model/CsvImportModel.hpp"
+#include "model/ParallelReadModel.hpp"
 #include "model/SelectSheetModel.hpp"
 #include "model/ReadCellModel.hpp"
 #include "model/DisplayCellModel.hpp"
 #include "model/ReadRangeModel.hpp"
 #include "model/DisplayRangeModel.hpp"
+#include "model/StreamRowsModel.hpp"
+#include "model/RecalculateModel.hpp"
+#include "model/DisplayRowStreamModel.hpp"
 #include "model/SaveExcelModel.hpp"
 
 // 条件逻辑节点
@@ -68,6 +73,7 @@
 #include "NodePalette.hpp"
 #include "NodeCommands.hpp"
 #include "ErrorHandler.hpp"
+#include "WorkbookWriteSession.hpp"
 #include "DataValidator.hpp"
 #include "IPropertyProvider.hpp"
 #include "widget/PropertyWidget.hpp"
@@ -142,7 +148,7 @@ void MainWindow::setupNodeEditor()
     // 注册自定义节点
     std::shared_ptr<QtNodes::NodeDelegateModelRegistry> modelRegistry = registerDataModels();
 
-    m_graphModel = std::make_unique<QtNodes::DataFlowGraphModel>(modelRegistry);
+    m_graphModel = std::make_unique<TinaFlowGraphModel>(modelRegistry);
     m_graphicsScene = new QtNodes::DataFlowGraphicsScene(*m_graphModel, this);
     m_graphicsView = new TinaFlowGraphicsView(m_graphicsScene, this);
 
@@ -208,6 +214,24 @@ void MainWindow::setupNodeEditor()
                 }
             }, Qt::QueuedConnection);
 
+    // 合并写入：其他节点都完成后每个文件写出一次，运行结束后释放登记的工作表
+    connect(m_graphModel.get(), &TinaFlowGraphModel::runDrained,
+            &WorkbookWriteSession::instance(), &WorkbookWriteSession::flush);
+    connect(m_graphModel.get(), &TinaFlowGraphModel::runFinished,
+            &WorkbookWriteSession::instance(), &WorkbookWriteSession::end);
+
+    // 运行调度完成后在状态栏显示实际计算的节点数
+    connect(m_graphModel.get(), &TinaFlowGraphModel::runFinished,
+            this, [this](int computedNodes, int reusedNodes, int skippedNodes, qint64 elapsedMs)
+            {
+                QString message = tr("流程运行完成，计算了 %1 个节点，复用 %2 个").arg(computedNodes).arg(reusedNodes);
+                if (skippedNodes > 0)
+                {
+                    message += tr("，%1 个节点没有收到输入而跳过").arg(skippedNodes);
+                }
+                ui->statusbar->showMessage(message + tr("（%1 ms）").arg(elapsedMs), 0);
+            });
+
     // 核心视图将直接由ADS系统管理，不再添加到传统容器
     // m_graphicsView会在setupADSCentralWidget()中被设置为ADS中央部件
 }
@@ -244,7 +268,7 @@ void MainWindow::reinitializeNodeEditor()
 
     // 重新创建所有组件
     std::shared_ptr<QtNodes::NodeDelegateModelRegistry> modelRegistry = registerDataModels();
-    m_graphModel = std::make_unique<QtNodes::DataFlowGraphModel>(modelRegistry);
+    m_graphModel = std::make_unique<TinaFlowGraphModel>(modelRegistry);
     m_graphicsScene = new QtNodes::DataFlowGraphicsScene(*m_graphModel, this);
     m_graphicsView = new TinaFlowGraphicsView(m_graphicsScene, this);
 
@@ -285,6 +309,24 @@ void MainWindow::reinitializeNodeEditor()
                 }
             }, Qt::QueuedConnection);
 
+    // 合并写入：其他节点都完成后每个文件写出一次，运行结束后释放登记的工作表
+    connect(m_graphModel.get(), &TinaFlowGraphModel::runDrained,
+            &WorkbookWriteSession::instance(), &WorkbookWriteSession::flush);
+    connect(m_graphModel.get(), &TinaFlowGraphModel::runFinished,
+            &WorkbookWriteSession::instance(), &WorkbookWriteSession::end);
+
+    // 运行调度完成后在状态栏显示实际计算的节点数
+    connect(m_graphModel.get(), &TinaFlowGraphModel::runFinished,
+            this, [this](int computedNodes, int reusedNodes, int skippedNodes, qint64 elapsedMs)
+            {
+                QString message = tr("流程运行完成，计算了 %1 个节点，复用 %2 个").arg(computedNodes).arg(reusedNodes);
+                if (skippedNodes > 0)
+                {
+                    message += tr("，%1 个节点没有收到输入而跳过").arg(skippedNodes);
+                }
+                ui->statusbar->showMessage(message + tr("（%1 ms）").arg(elapsedMs), 0);
+            });
+
     // 使用统一的节点更新连接方法
     setupNodeUpdateConnections();
 
@@ -319,15 +361,20 @@ std::shared_ptr<QtNodes::NodeDelegateModelRegistry> MainWindow::registerDataMode
     auto ret = std::make_shared<QtNodes::NodeDelegateModelRegistry>();
     // 核心节点注册
     ret->registerModel<OpenExcelModel>("OpenExcel");
+    ret->registerModel<CsvImportModel>("ImportCsv");
+    ret->registerModel<ParallelReadModel>("ParallelRead");
     ret->registerModel<SelectSheetModel>("SelectSheet");
     ret->registerModel<ReadCellModel>("ReadCell");
     ret->registerModel<ReadRangeModel>("ReadRange");
+    ret->registerModel<StreamRowsModel>("StreamRows");
+    ret->registerModel<RecalculateModel>("Recalculate");
     ret->registerModel<SaveExcelModel>("SaveExcel");
     ret->registerModel<ConstantValueModel>("ConstantValue");
 
     // 显示节点
     ret->registerModel<DisplayCellModel>("DisplayCell");
     ret->registerModel<DisplayRangeModel>("DisplayRange");
+    ret->registerModel<DisplayRowStreamModel>("DisplayRowStream");
 
     // 积木脚本节点
     ret->registerModel<BlockScriptModel>("BlockScript");
@@ -673,6 +720,22 @@ void MainWindow::onStopClicked()
     // 停止按钮被点击
     setGlobalExecutionState(false);
 
+    // 停止调度尚未执行的节点，并取消所有节点正在后台进行的计算（加载、读取、保存）；
+    // 尚未合并写出的工作表不再写出
+    WorkbookWriteSession::instance().abort();
+    if (m_graphModel)
+    {
+        m_graphModel->stopRun();
+
+        for (const auto& nodeId : m_graphModel->allNodeIds())
+        {
+            if (auto* baseModel = m_graphModel->delegateModel<BaseNodeModel>(nodeId))
+            {
+                baseModel->cancelExecution();
+            }
+        }
+    }
+
     // 更新现代化工具栏状态 - 回到空闲状态
     if (m_modernToolBar)
     {
@@ -1176,55 +1239,57 @@ void MainWindow::triggerDataFlow()
         return;
     }
 
-    // 获取所有节点ID
-    auto nodeIds = m_graphModel->allNodeIds();
-    // 找到节点
-
-    // 遍历所有节点，找到源节点（没有输入连接的节点）并触发它们
-    for (const auto& nodeId : nodeIds)
-    {
-        auto nodeDelegate = m_graphModel->delegateModel<QtNodes::NodeDelegateModel>(nodeId);
-        if (!nodeDelegate) continue;
+    // 运行期间写往同一文件的保存节点合并写入
+    WorkbookWriteSession::instance().begin();
 
-        QString nodeName = nodeDelegate->name();
+    // 按拓扑顺序调度：从源节点（没有输入连接的节点）开始，每个节点在所有上游完成后计算一次
+    m_graphModel->startRun([this](QtNodes::NodeId nodeId) { triggerSourceNode(nodeId); });
+}
 
+void MainWindow::triggerSourceNode(QtNodes::NodeId nodeId)
+{
+    auto nodeDelegate = m_graphModel->delegateModel<QtNodes::NodeDelegateModel>(nodeId);
+    if (!nodeDelegate) return;
 
-        // 检查是否为源节点（没有输入端口或输入端口没有连接）
-        bool isSourceNode = true;
-        unsigned int inputPorts = nodeDelegate->nPorts(QtNodes::PortType::In);
+    QString nodeName = nodeDelegate->name();
 
-        for (unsigned int portIndex = 0; portIndex < inputPorts; ++portIndex)
+    // 根据节点类型调用特定的触发方法
+    if (nodeName == "OpenExcel")
+    {
+        auto* openExcelModel = m_graphModel->delegateModel<OpenExcelModel>(nodeId);
+        if (openExcelModel)
         {
-            auto connections = m_graphModel->connections(nodeId, QtNodes::PortType::In, portIndex);
-            if (!connections.empty())
-            {
-                isSourceNode = false;
-                break;
-            }
+            // 触发OpenExcelModel执行，工作簿在后台加载完成后自行发出dataUpdated
+            openExcelModel->triggerExecution();
+            return;
         }
-
-        if (isSourceNode)
+    }
+    else if (nodeName == "ImportCsv")
+    {
+        auto* csvImportModel = m_graphModel->delegateModel<CsvImportModel>(nodeId);
+        if (csvImportModel)
         {
-            // 找到源节点
-
-            // 根据节点类型调用特定的触发方法
-            if (nodeName == "OpenExcel")
-            {
-                auto* openExcelModel = m_graphModel->delegateModel<OpenExcelModel>(nodeId);
-                if (openExcelModel)
-                {
-                    // 触发OpenExcelModel执行
-                    openExcelModel->triggerExecution();
-                }
-            }
-
-            // 触发源节点的数据更新
-            for (unsigned int portIndex = 0; portIndex < nodeDelegate->nPorts(QtNodes::PortType::Out); ++portIndex)
-            {
-                emit nodeDelegate->dataUpdated(portIndex);
-            }
+            // 后台读取完成后自行发出dataUpdated
+            csvImportModel->triggerExecution();
+            return;
+        }
+    }
+    else if (nodeName == "ParallelRead")
+    {
+        auto* parallelReadModel = m_graphModel->delegateModel<ParallelReadModel>(nodeId);
+        if (parallelReadModel)
+        {
+            // 各读取任务完成后分别发出对应端口的dataUpdated
+            parallelReadModel->triggerExecution();
+            return;
         }
     }
+
+    // 触发源节点的数据更新
+    for (unsigned int portIndex = 0; portIndex < nodeDelegate->nPorts(QtNodes::PortType::Out); ++portIndex)
+    {
+        emit nodeDelegate->dataUpdated(portIndex);
+    }
 }
 
 void MainWindow::setupCustomStyles()
@@ -1338,6 +1403,7 @@ QString MainWindow::getPortTypeDescription(QtNodes::NodeDelegateModel* nodeModel
         {"SheetData", "工作表"},
         {"RangeData", "范围数据"},
         {"RowData", "行数据"},
+        {"RowBatchData", "行批次"},
         {"CellData", "单元格"},
         {"BooleanData", "布尔值"}
     };
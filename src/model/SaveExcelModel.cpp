@@ -3,150 +3,277 @@
 //
 
 #include "model/SaveExcelModel.hpp"
-#include <QApplication>
-#include <QDir>
-#include <QFileInfo>
 
 void SaveExcelModel::saveDataToExcel(const QString& filePath, const QString& sheetName)
 {
     qDebug() << "SaveExcelModel: Starting to save data to" << filePath << "sheet:" << sheetName;
-    
+
+    abandonSessionSave();
+    // 写入期间不处理事件，进度条无法重绘，同步保存不显示进度
+    beginSaveUI(m_rangeData->rowCount(), false);
+
+    SaveResult result;
+    result.rows = m_rangeData->rowCount();
+    result.cols = m_rangeData->columnCount();
+    result.filePath = filePath;
+    result.sheetName = sheetName;
+
+    try {
+        WorkbookWriteSession::writeWorkbook(filePath, {sheetEntry(sheetName, m_rangeData)});
+        result.success = true;
+    } catch (const std::exception& e) {
+        result.message = QString("保存失败: %1").arg(e.what());
+    }
+
+    finishSave(result);
+}
+
+void SaveExcelModel::saveDataToExcelAsync(const QString& filePath, const QString& sheetName)
+{
+    qDebug() << "SaveExcelModel: Starting background save to" << filePath << "sheet:" << sheetName;
+
+    // 新数据到达时startCompute()取消尚未完成的保存，临时文件会被丢弃，目标文件保持不变
+    abandonSessionSave();
+    beginSaveUI(m_rangeData->rowCount());
+
+    // 上游输出的数据不会再被修改，工作线程直接共享而不是复制
+    const WorkbookWriteSession::SheetEntry entry = sheetEntry(sheetName, m_rangeData);
+
+    startCompute([this, entry, filePath](ComputeContext& context) -> ApplyResult {
+        SaveResult result;
+        result.rows = entry.data->rowCount();
+        result.cols = entry.data->columnCount();
+        result.filePath = filePath;
+        result.sheetName = entry.sheetName;
+
+        context.setProgressRange(0, result.rows);
+        try {
+            WorkbookWriteSession::writeWorkbook(filePath, {entry}, [&context](int rowsWritten, int) {
+                context.setProgress(rowsWritten);
+            }, [&context]() {
+                return context.isCancelled();
+            });
+            result.success = true;
+        } catch (const std::exception& e) {
+            result.message = QString("保存失败: %1").arg(e.what());
+        }
+        if (context.isCancelled()) {
+            qDebug() << "SaveExcelModel: Background save was cancelled";
+            return {};
+        }
+        return [this, result]() { finishSave(result); };
+    });
+}
+
+void SaveExcelModel::queueSessionSave(const QString& filePath, const QString& sheetName)
+{
+    // 之前直接保存的结果会被合并写入覆盖，不必再等它完成；节点在合并写入完成前一直处于计算状态，
+    // 流程运行等到写出后才把新的保存结果交给下游
+    m_sessionPromise = startPendingCompute();
+
+    beginSaveUI(m_rangeData->rowCount());
+    m_progressBar->setRange(0, 0);
+    m_statusLabel->setText("等待与同一文件的其他工作表合并写入...");
+
+    m_sessionSave.rows = m_rangeData->rowCount();
+    m_sessionSave.cols = m_rangeData->columnCount();
+    m_sessionSave.filePath = filePath;
+    m_sessionSave.sheetName = sheetName;
+    // 本节点之前登记的工作表（包括改名或改路径之前的）被替换
+    m_sessionTicket = WorkbookWriteSession::instance().addSheet(this, filePath,
+        sheetEntry(sheetName, m_rangeData));
+    qDebug() << "SaveExcelModel: Queued sheet" << sheetName << "for coalesced write to" << filePath;
+}
+
+void SaveExcelModel::onWorkbookWritten(const QString& filePath, const QList<quint64>& tickets, int sheetCount,
+                                       bool success, const QString& message)
+{
+    // 只处理包含本节点最近一次登记的写出
+    if (m_sessionTicket == 0 || !tickets.contains(m_sessionTicket)) {
+        return;
+    }
+    m_sessionTicket = 0;
+
+    SaveResult result = m_sessionSave;
+    result.success = success;
+    result.message = message;
+    qDebug() << "SaveExcelModel: Coalesced write of" << sheetCount << "sheets to" << filePath << "finished";
+
+    // 结果由BaseNodeModel应用，之后发出computingFinished
+    const auto promise = std::exchange(m_sessionPromise, nullptr);
+    promise->addResult([this, result]() { finishSave(result); });
+    promise->finish();
+}
+
+void SaveExcelModel::abandonSessionSave()
+{
+    // 登记的工作表不再写出，也不再等待它的结果
+    WorkbookWriteSession::instance().withdraw(this);
+    m_sessionTicket = 0;
+    m_sessionPromise.reset();
+}
+
+void SaveExcelModel::beginSaveUI(int totalRows, bool showProgress)
+{
     // 显示进度条
-    m_progressBar->setVisible(true);
-    m_progressBar->setRange(0, m_rangeData->rowCount());
+    m_progressBar->setVisible(showProgress);
+    m_progressBar->setRange(0, totalRows);
     m_progressBar->setValue(0);
     m_saveButton->setText("保存中...");
     m_saveButton->setStyleSheet("QPushButton { background-color: #cce5ff; color: #004085; }");
     m_statusLabel->setText("正在保存...");
-    
-    QApplication::processEvents(); // 更新UI
-    
-    try {
-        // 确保目录存在
-        QFileInfo fileInfo(filePath);
-        QDir dir = fileInfo.absoluteDir();
-        if (!dir.exists()) {
-            if (!dir.mkpath(".")) {
-                throw std::runtime_error("无法创建目录: " + dir.absolutePath().toStdString());
-            }
-        }
-        
-        // 创建或打开Excel文档
-        OpenXLSX::XLDocument doc;
-        bool fileExists = QFileInfo::exists(filePath);
-        
-        if (fileExists) {
-            qDebug() << "SaveExcelModel: Opening existing file";
-            doc.open(filePath.toStdString());
-        } else {
-            qDebug() << "SaveExcelModel: Creating new file";
-            doc.create(filePath.toStdString());
-        }
-        
-        // 获取或创建工作表
-        OpenXLSX::XLWorksheet worksheet;
-        std::string sheetNameStd = sheetName.toStdString();
-        
-        if (doc.workbook().worksheetExists(sheetNameStd)) {
-            qDebug() << "SaveExcelModel: Using existing worksheet:" << sheetName;
-            worksheet = doc.workbook().worksheet(sheetNameStd);
-            // 清空现有数据（可选）
-            // worksheet.clear();
-        } else {
-            qDebug() << "SaveExcelModel: Creating new worksheet:" << sheetName;
-            if (fileExists && doc.workbook().worksheetCount() > 0) {
-                // 如果文件已存在且有工作表，添加新的工作表
-                doc.workbook().addWorksheet(sheetNameStd);
-                worksheet = doc.workbook().worksheet(sheetNameStd);
-            } else {
-                // 新文件或没有工作表，重命名默认工作表
-                if (doc.workbook().worksheetCount() > 0) {
-                    worksheet = doc.workbook().worksheet(1);
-                    worksheet.setName(sheetNameStd);
-                } else {
-                    doc.workbook().addWorksheet(sheetNameStd);
-                    worksheet = doc.workbook().worksheet(sheetNameStd);
-                }
-            }
-        }
-        
-        // 写入数据
-        int rows = m_rangeData->rowCount();
-        int cols = m_rangeData->columnCount();
-        
-        qDebug() << "SaveExcelModel: Writing" << rows << "x" << cols << "data";
-        
-        for (int row = 0; row < rows; ++row) {
-            for (int col = 0; col < cols; ++col) {
-                QVariant cellValue = m_rangeData->cellValue(row, col);
-                
-                // 计算Excel单元格地址 (1-based)
-                auto cell = worksheet.cell(row + 1, col + 1);
-                
-                // 根据数据类型写入值
-                if (cellValue.isNull() || !cellValue.isValid()) {
-                    // 空值
-                    cell.value() = "";
-                } else if (cellValue.type() == QVariant::Bool) {
-                    cell.value() = cellValue.toBool();
-                } else if (cellValue.type() == QVariant::Int || 
-                          cellValue.type() == QVariant::LongLong) {
-                    cell.value() = cellValue.toLongLong();
-                } else if (cellValue.type() == QVariant::Double) {
-                    cell.value() = cellValue.toDouble();
-                } else {
-                    // 字符串或其他类型
-                    cell.value() = cellValue.toString().toStdString();
-                }
-            }
-            
-            // 更新进度
-            m_progressBar->setValue(row + 1);
-            if (row % 10 == 0) { // 每10行更新一次UI
-                QApplication::processEvents();
-            }
-        }
-        
-        // 保存文档
-        m_statusLabel->setText("正在保存文件...");
-        QApplication::processEvents();
-        
-        doc.save();
-        doc.close();
-        
-        // 成功完成
-        m_progressBar->setVisible(false);
+}
+
+void SaveExcelModel::finishSave(const SaveResult& result)
+{
+    m_progressBar->setVisible(false);
+
+    if (result.success) {
         m_saveButton->setText("保存成功");
         m_saveButton->setStyleSheet("QPushButton { background-color: #d4edda; color: #155724; }");
         m_statusLabel->setText(QString("成功保存 %1行x%2列 数据到 %3")
-            .arg(rows)
-            .arg(cols)
-            .arg(sheetName));
-        
+            .arg(result.rows)
+            .arg(result.cols)
+            .arg(result.sheetName));
+
         // 更新输出数据
-        m_saveResult = std::make_shared<BooleanData>(true, 
-            QString("成功保存到 %1").arg(filePath));
+        m_saveResult = std::make_shared<BooleanData>(true,
+            QString("成功保存到 %1").arg(result.filePath));
         emit dataUpdated(0);
-        
-        qDebug() << "SaveExcelModel: Successfully saved data to" << filePath;
-        
+
+        qDebug() << "SaveExcelModel: Successfully saved data to" << result.filePath;
+
         // 不显示成功弹窗，通过状态标签和输出数据反馈结果
-        
-    } catch (const std::exception& e) {
-        // 错误处理
-        QString errorMsg = QString("保存失败: %1").arg(e.what());
-        qDebug() << "SaveExcelModel: Error:" << errorMsg;
-        
-        m_progressBar->setVisible(false);
-        m_saveButton->setText("保存失败");
-        m_saveButton->setStyleSheet("QPushButton { background-color: #f8d7da; color: #721c24; }");
-        m_statusLabel->setText(errorMsg);
-        
-        // 更新输出数据
-        m_saveResult = std::make_shared<BooleanData>(false, errorMsg);
-        emit dataUpdated(0);
-        
-        // 显示错误消息
-        QMessageBox::critical(nullptr, "错误", errorMsg);
+        return;
+    }
+
+    // 错误处理
+    qDebug() << "SaveExcelModel: Error:" << result.message;
+
+    m_saveButton->setText("保存失败");
+    m_saveButton->setStyleSheet("QPushButton { background-color: #f8d7da; color: #721c24; }");
+    m_statusLabel->setText(result.message);
+
+    // 更新输出数据
+    m_saveResult = std::make_shared<BooleanData>(false, result.message);
+    emit dataUpdated(0);
+
+    // 显示错误消息
+    QMessageBox::critical(nullptr, "错误", result.message);
+}
+
+void SaveExcelModel::onRowBatch(const std::shared_ptr<RowBatchData>& data)
+{
+    if (!data) {
+        return;
+    }
+
+    if (data->isBegin()) {
+        // 新的流替换尚未结束的旧流，旧流的临时数据直接丢弃
+        m_rowWriter.reset();
+        m_rowStreamId = data->streamId();
+        m_rowStreamColumns = data->columnCount();
+        m_rowStreamPath = m_filePathEdit->text().trimmed();
+        m_rowStreamSheet = m_sheetNameEdit->text().trimmed();
+
+        if (m_rowStreamPath.isEmpty() || m_rowStreamSheet.isEmpty()) {
+            qDebug() << "SaveExcelModel: Cannot save row stream, missing path or sheet name";
+            updateUI();
+            return;
+        }
+
+        // 正在进行的后台保存与本次写入的是同一目标，以最新的数据为准
+        cancelCompute();
+        abandonSessionSave();
+
+        m_rowWriter = std::make_unique<StreamingSheetWriter::RowWriter>(stringMode());
+        beginSaveUI(qMax(0, data->totalRows()));
+        qDebug() << "SaveExcelModel: Receiving row stream" << m_rowStreamId << "to" << m_rowStreamPath;
+        return;
+    }
+
+    if (!m_rowWriter || data->streamId() != m_rowStreamId) {
+        return;
     }
+
+    if (data->isBatch()) {
+        try {
+            for (const RowData& row : data->rows()) {
+                m_rowWriter->appendRow(row.rowData());
+            }
+        } catch (const std::exception& e) {
+            m_rowWriter.reset();
+            SaveResult result;
+            result.filePath = m_rowStreamPath;
+            result.sheetName = m_rowStreamSheet;
+            result.message = QString("保存失败: %1").arg(e.what());
+            finishSave(result);
+            return;
+        }
+        m_progressBar->setValue(m_rowWriter->rowCount());
+        m_statusLabel->setText(QString("正在写入，已写入 %1 行...").arg(m_rowWriter->rowCount()));
+        return;
+    }
+
+    finishRowStream(*data);
+}
+
+void SaveExcelModel::finishRowStream(const RowBatchData& end)
+{
+    // 读取失败或被取消时放弃本次写入，目标文件保持不变
+    if (!end.succeeded()) {
+        m_rowWriter.reset();
+        if (end.isCancelled()) {
+            m_progressBar->setVisible(false);
+            m_saveButton->setText("已取消");
+            m_saveButton->setStyleSheet("QPushButton { background-color: #fff3cd; color: #856404; }");
+            m_statusLabel->setText("行流已取消，未写入文件");
+            return;
+        }
+        SaveResult result;
+        result.filePath = m_rowStreamPath;
+        result.sheetName = m_rowStreamSheet;
+        result.message = QString("保存失败: %1").arg(end.errorMessage());
+        finishSave(result);
+        return;
+    }
+
+    // 压缩打包耗时较长，在后台完成
+    std::shared_ptr<StreamingSheetWriter::RowWriter> writer = std::move(m_rowWriter);
+    const QString filePath = m_rowStreamPath;
+    const QString sheetName = m_rowStreamSheet;
+    const int cols = m_rowStreamColumns;
+    const int level = compressionLevel();
+
+    m_progressBar->setRange(0, 0);
+    m_statusLabel->setText("正在压缩...");
+
+    startCompute([this, writer, filePath, sheetName, cols, level](ComputeContext&) -> ApplyResult {
+        SaveResult result;
+        result.rows = writer->rowCount();
+        result.cols = cols;
+        result.filePath = filePath;
+        result.sheetName = sheetName;
+        try {
+            WorkbookWriteSession::replaceFileAtomically(filePath, [&](const QString& tempPath) {
+                writer->finish(tempPath, sheetName.toStdString(), level);
+            });
+            result.success = true;
+        } catch (const std::exception& e) {
+            result.message = QString("保存失败: %1").arg(e.what());
+        }
+        return [this, result]() { finishSave(result); };
+    });
+}
+
+WorkbookWriteSession::SheetEntry SaveExcelModel::sheetEntry(const QString& sheetName,
+                                                            std::shared_ptr<const RangeData> data) const
+{
+    WorkbookWriteSession::SheetEntry entry;
+    entry.sheetName = sheetName;
+    entry.data = std::move(data);
+    entry.keepOtherSheets = exportMode() == ExportMode::Document;
+    entry.stringMode = stringMode();
+    entry.compressionLevel = compressionLevel();
+    return entry;
 }
@@ -10916,6 +10916,21 @@ namespace Zippy
                                m_ZipEntries.end());
         }
 
+        /**
+         * @brief Discard the extracted data of an unmodified entry to free its memory.
+         * @param name The name of the entry in the archive.
+         * @note The data is extracted from the archive again on the next call to GetEntry.
+         */
+        void ReleaseEntryData(const std::string& name)
+        {
+            if (!IsOpen()) return;
+
+            auto result = std::find_if(m_ZipEntries.begin(), m_ZipEntries.end(), [&](const Impl::ZipEntry& entry) {
+                return name == entry.GetName();
+            });
+            if (result != m_ZipEntries.end() && !result->IsModified()) ZipEntryData().swap(result->m_EntryData);
+        }
+
         /**
          * @brief Get the entry with the specified name.
          * @param name The name of the entry in the archive.
@@ -404,6 +404,12 @@ namespace OpenXLSX
          */
         std::string extractXmlFromArchive(const std::string& path);
 
+        /**
+         * @brief Discard the archive's extracted copy of an XML file. It is extracted again by the next extractXmlFromArchive() call.
+         * @param path The relative path of the file.
+         */
+        void releaseXmlFromArchive(const std::string& path);
+
         /**
          * @brief fetch the XLXmlData object as stored in m_data, throw XLInternalError if path is not found
          * @param path The relative path of the file.
@@ -226,6 +226,12 @@ namespace OpenXLSX
          */
         const XMLDocument* getXmlDocument() const;
 
+        /**
+         * @brief Discard the parsed XMLDocument. It is parsed again from the archive on the next access.
+         * @note Unsaved changes are lost, and XMLNode objects pointing into the document become invalid.
+         */
+        void releaseXmlDocument();
+
         /**
          * @brief Test whether there is an XML file linked to this object
          * @return true if there is no underlying XML file, otherwise false
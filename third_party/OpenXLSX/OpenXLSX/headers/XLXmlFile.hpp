@@ -118,6 +118,12 @@ namespace OpenXLSX
          */
         bool valid() const { return m_xmlData != nullptr; }
 
+        /**
+         * @brief Discard the parsed XML of this file to free its memory. It is parsed again from the archive on the next access.
+         * @note Unsaved changes are lost. Other objects holding nodes of this file (cells, rows, ...) become invalid.
+         */
+        void releaseXmlData();
+
         /**
          * @brief The copy assignment operator. The default implementation has been used.
          * @param other The object to copy.
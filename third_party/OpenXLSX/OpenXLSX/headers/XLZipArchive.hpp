@@ -155,6 +155,12 @@ namespace OpenXLSX
          */
         std::string getEntry(const std::string& name) const;
 
+        /**
+         * @brief Discard the extracted data of an unmodified entry. It is extracted again by the next getEntry() call.
+         * @param name
+         */
+        void releaseEntry(const std::string& name);
+
         /**
          * @brief
          * @param entryName
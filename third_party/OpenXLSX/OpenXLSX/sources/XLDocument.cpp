@@ -1522,6 +1522,14 @@ std::string XLDocument::extractXmlFromArchive(const std::string& path)
     return (m_archive.hasEntry(path) ? m_archive.getEntry(path) : "");
 }
 
+/**
+ * @details
+ */
+void XLDocument::releaseXmlFromArchive(const std::string& path)
+{
+    m_archive.releaseEntry(path);
+}
+
 /**
  * @details
  */
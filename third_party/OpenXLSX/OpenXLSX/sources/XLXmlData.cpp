@@ -181,3 +181,13 @@ const XMLDocument* XLXmlData::getXmlDocument() const
 
     return m_xmlDoc.get();
 }
+
+/**
+ * @details getXmlDocument() re-extracts the XML from the archive when the document is empty, so the archive's
+ *          extracted copy is discarded as well.
+ */
+void XLXmlData::releaseXmlDocument()
+{
+    m_xmlDoc->reset();
+    m_parentDoc->releaseXmlFromArchive(m_xmlPath);
+}
@@ -123,6 +123,14 @@ const XMLDocument& XLXmlFile::xmlDocument() const
     return *m_xmlData->getXmlDocument();
 }
 
+/**
+ * @details provide access to the underlying XLXmlData::releaseXmlDocument() function
+ */
+void XLXmlFile::releaseXmlData()
+{
+    if (m_xmlData != nullptr) m_xmlData->releaseXmlDocument();
+}
+
 /**
  * @details provide access to the underlying XLXmlData::getXmlPath() function
  */
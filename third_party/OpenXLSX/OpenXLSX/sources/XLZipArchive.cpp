@@ -134,6 +134,13 @@ std::string XLZipArchive::getEntry(const std::string& name) const {
     return m_archive->GetEntry(name).GetDataAsString();
 }
 
+/**
+ * @details
+ */
+void XLZipArchive::releaseEntry(const std::string& name) {
+    m_archive->ReleaseEntryData(name);
+}
+
 /**
  * @details
  */